@@ -0,0 +1,40 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+
+/* kdLogMessagefKHR is silent with NDEBUG, benchmarks are built optimized. */
+#include <stdio.h>
+
+/* Keeps results alive so the compiler cannot drop the measured work. */
+KD_UNUSED static volatile KDfloat64KHR bench_sink;
+
+#define BENCH_BEGIN() kdGetTimeUST()
+
+/* Print time per operation and throughput for ops operations since start. */
+#define BENCH_END(name, start, ops) do {\
+    KDust _elapsed = kdGetTimeUST() - (start);\
+    KDfloat64KHR _ns = (KDfloat64KHR)_elapsed / (KDfloat64KHR)(ops);\
+    printf("%-36s %10.2f ns/op %14.0f op/s\n", (name), _ns, _ns > 0.0 ? 1e9 / _ns : 0.0);\
+} while (0)
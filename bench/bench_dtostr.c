@@ -0,0 +1,119 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+#define ROUNDS 16
+#define NUMBERS 65536
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    KDfloat32 *floats = (KDfloat32 *)kdMalloc(NUMBERS * sizeof(KDfloat32));
+    KDfloat64KHR *doubles = (KDfloat64KHR *)kdMalloc(NUMBERS * sizeof(KDfloat64KHR));
+    KDsize capacity = NUMBERS * (KD_DTOSTR_MAXLEN_KHR + 1);
+    KDchar *text = (KDchar *)kdMalloc(capacity);
+    KDuint32 seed = 12345;
+    for(KDint i = 0; i < NUMBERS; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        doubles[i] = ((KDfloat64KHR)(seed >> 8) / 16777216.0 - 0.5) * 2000.0;
+        floats[i] = (KDfloat32)doubles[i];
+    }
+
+    KDsize pos = 0;
+    KDust start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        pos = 0;
+        for(KDint i = 0; i < NUMBERS; i++)
+        {
+            pos += (KDsize)snprintf(text + pos, capacity - pos, "%.17g ", doubles[i]);
+        }
+    }
+    BENCH_END("snprintf %.17g (libc)", start, ROUNDS * NUMBERS);
+    bench_sink = (KDfloat64KHR)pos;
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        pos = 0;
+        for(KDint i = 0; i < NUMBERS; i++)
+        {
+            pos += (KDsize)kdSnprintfKHR(text + pos, capacity - pos, "%.17g ", doubles[i]);
+        }
+    }
+    BENCH_END("kdSnprintfKHR %.17g", start, ROUNDS * NUMBERS);
+    bench_sink = (KDfloat64KHR)pos;
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        pos = 0;
+        for(KDint i = 0; i < NUMBERS; i++)
+        {
+            pos += (KDsize)kdDtostrKHR(text + pos, capacity - pos, doubles[i]);
+            text[pos++] = ' ';
+        }
+    }
+    BENCH_END("kdDtostrKHR", start, ROUNDS * NUMBERS);
+    bench_sink = (KDfloat64KHR)pos;
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        pos = 0;
+        for(KDint i = 0; i < NUMBERS; i++)
+        {
+            pos += (KDsize)kdSnprintfKHR(text + pos, capacity - pos, "%.9g ", (KDfloat64KHR)floats[i]);
+        }
+    }
+    BENCH_END("kdSnprintfKHR %.9g", start, ROUNDS * NUMBERS);
+    bench_sink = (KDfloat64KHR)pos;
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        pos = 0;
+        for(KDint i = 0; i < NUMBERS; i++)
+        {
+            pos += (KDsize)kdFtostr(text + pos, capacity - pos, floats[i]);
+            text[pos++] = ' ';
+        }
+    }
+    BENCH_END("kdFtostr", start, ROUNDS * NUMBERS);
+    bench_sink = (KDfloat64KHR)pos;
+
+    KDssize len = 0;
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        len = kdFtostrArrayVEN(text, capacity, floats, NUMBERS, ' ');
+    }
+    BENCH_END("kdFtostrArrayVEN", start, ROUNDS * NUMBERS);
+    bench_sink = (KDfloat64KHR)len;
+
+    kdFree(text);
+    kdFree(doubles);
+    kdFree(floats);
+    return 0;
+}
@@ -0,0 +1,73 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+#define EVENTS 200000
+
+static KDint handled = 0;
+
+static void KD_APIENTRY callback(KD_UNUSED const KDEvent *event)
+{
+    handled++;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    const KDchar *path = "bench_event_replay.bin";
+
+    /* Record a stream of pointer input, half of it handled by a callback */
+    kdInstallCallback(&callback, KD_EVENT_INPUT_POINTER, KD_NULL);
+    kdEventTraceStartVEN(path);
+    KDust start = BENCH_BEGIN();
+    for(KDint i = 0; i < EVENTS; i++)
+    {
+        KDEvent *event = kdCreateEvent();
+        event->type = (i % 2) ? KD_EVENT_INPUT_POINTER : KD_EVENT_INPUT;
+        event->data.inputpointer.index = KD_INPUT_POINTER_X;
+        event->data.inputpointer.x = i;
+        event->data.inputpointer.y = -i;
+        kdPostEvent(event);
+        while(kdWaitEvent(-1))
+        {
+        }
+    }
+    BENCH_END("post + dispatch, recording", start, EVENTS);
+    kdEventTraceStopVEN();
+
+    /* Replay all of it at once, dispatch throughput without the producer */
+    handled = 0;
+    start = BENCH_BEGIN();
+    KDint count = kdEventTraceReplayVEN(path, kdThreadSelf(), 0.0f);
+    BENCH_END("kdEventTraceReplayVEN (read + schedule)", start, count);
+    start = BENCH_BEGIN();
+    KDint delivered = 0;
+    while(kdWaitEvent(-1))
+    {
+        delivered++;
+    }
+    BENCH_END("replayed dispatch", start, delivered + handled);
+    bench_sink = delivered + handled;
+    kdRemove(path);
+    return 0;
+}
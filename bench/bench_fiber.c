@@ -0,0 +1,89 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+#define SWITCHES 10000000
+#define HANDOFFS 200000
+
+static KDThreadSem *ping = KD_NULL;
+static KDThreadSem *pong = KD_NULL;
+
+static void KD_APIENTRY yield_func(KD_UNUSED void *arg)
+{
+    for(;;)
+    {
+        kdFiberYieldVEN();
+    }
+}
+
+static void KD_APIENTRY empty_func(KD_UNUSED void *arg)
+{
+}
+
+static void *pong_thread(KD_UNUSED void *arg)
+{
+    for(KDint i = 0; i < HANDOFFS; i++)
+    {
+        kdThreadSemWait(ping);
+        kdThreadSemPost(pong);
+    }
+    return KD_NULL;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    /* Switch in and yield back, two context switches per iteration */
+    KDFiberVEN *fiber = kdFiberCreateVEN(0, yield_func, KD_NULL);
+    KDust start = BENCH_BEGIN();
+    for(KDint i = 0; i < SWITCHES; i++)
+    {
+        kdFiberSwitchVEN(fiber);
+    }
+    BENCH_END("kdFiberSwitchVEN + kdFiberYieldVEN", start, SWITCHES);
+
+    start = BENCH_BEGIN();
+    for(KDint i = 0; i < SWITCHES / 10; i++)
+    {
+        KDFiberVEN *oneshot = kdFiberCreateVEN(0, empty_func, KD_NULL);
+        kdFiberSwitchVEN(oneshot);
+        kdFiberFreeVEN(oneshot);
+    }
+    BENCH_END("kdFiberCreateVEN + run + kdFiberFreeVEN", start, SWITCHES / 10);
+
+    /* Same handoff between two threads */
+    ping = kdThreadSemCreate(0);
+    pong = kdThreadSemCreate(0);
+    KDThread *thread = kdThreadCreate(KD_NULL, pong_thread, KD_NULL);
+    start = BENCH_BEGIN();
+    for(KDint i = 0; i < HANDOFFS; i++)
+    {
+        kdThreadSemPost(ping);
+        kdThreadSemWait(pong);
+    }
+    BENCH_END("thread handoff (semaphore ping-pong)", start, HANDOFFS);
+    kdThreadJoin(thread, KD_NULL);
+    kdThreadSemFree(pong);
+    kdThreadSemFree(ping);
+    return 0;
+}
@@ -0,0 +1,127 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+#define JOBS 100000
+#define SPAWNS 1000
+#define FIB 24
+#define FIB_CUTOFF 12
+
+static KDJobSystemVEN *system = KD_NULL;
+
+static KDuint work(KDuint seed)
+{
+    for(KDint i = 0; i < 500; i++)
+    {
+        seed = seed * 1664525U + 1013904223U;
+    }
+    return seed;
+}
+
+static void KD_APIENTRY work_job(void *arg)
+{
+    bench_sink = work((KDuint)(KDuintptr)arg);
+}
+
+static void *work_thread(void *arg)
+{
+    bench_sink = work((KDuint)(KDuintptr)arg);
+    return KD_NULL;
+}
+
+static KDuint fib(KDuint n)
+{
+    return (n < 2) ? n : fib(n - 1) + fib(n - 2);
+}
+
+/* Fork-join, every level waits while helping. */
+typedef struct {
+    KDuint n;
+    KDuint result;
+} Fib;
+static void KD_APIENTRY fib_job(void *arg)
+{
+    Fib *f = (Fib *)arg;
+    if(f->n < FIB_CUTOFF)
+    {
+        f->result = fib(f->n);
+        return;
+    }
+    Fib a = {f->n - 1, 0};
+    Fib b = {f->n - 2, 0};
+    KDJobCounterVEN *counter = kdJobCounterCreateVEN();
+    kdJobSubmitVEN(system, fib_job, &a, counter, KD_NULL);
+    fib_job(&b);
+    kdJobWaitVEN(system, counter);
+    kdJobCounterFreeVEN(counter);
+    f->result = a.result + b.result;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    KDchar name[64];
+    KDust start = BENCH_BEGIN();
+    for(KDint i = 0; i < SPAWNS; i++)
+    {
+        KDThread *thread = kdThreadCreate(KD_NULL, work_thread, (void *)(KDuintptr)i);
+        kdThreadJoin(thread, KD_NULL);
+    }
+    BENCH_END("kdThreadCreate per task", start, SPAWNS);
+
+    system = kdJobSystemCreateVEN(0);
+    KDint cores = kdJobSystemGetWorkerCountVEN(system);
+    kdJobSystemFreeVEN(system);
+
+    /* Scaling from one worker to one per processor */
+    KDust single = 0;
+    for(KDint workers = 1; workers <= cores; workers++)
+    {
+        system = kdJobSystemCreateVEN(workers);
+        KDJobCounterVEN *counter = kdJobCounterCreateVEN();
+
+        start = BENCH_BEGIN();
+        for(KDint i = 0; i < JOBS; i++)
+        {
+            kdJobSubmitVEN(system, work_job, (void *)(KDuintptr)i, counter, KD_NULL);
+        }
+        kdJobWaitVEN(system, counter);
+        KDust elapsed = kdGetTimeUST() - start;
+        single = (workers == 1) ? elapsed : single;
+        snprintf(name, sizeof(name), "independent jobs (%d workers)", workers);
+        BENCH_END(name, start, JOBS);
+        printf("%-36s %10.2fx\n", "speedup", (KDfloat64KHR)single / (KDfloat64KHR)elapsed);
+
+        Fib f = {FIB, 0};
+        start = BENCH_BEGIN();
+        kdJobSubmitVEN(system, fib_job, &f, counter, KD_NULL);
+        kdJobWaitVEN(system, counter);
+        snprintf(name, sizeof(name), "fork-join fib(%d) (%d workers)", FIB, workers);
+        BENCH_END(name, start, 1);
+        bench_sink = f.result;
+
+        kdJobCounterFreeVEN(counter);
+        kdJobSystemFreeVEN(system);
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+#if defined(KD_WINDOW_X11) || defined(KD_WINDOW_WAYLAND) || defined(KD_WINDOW_WIN32) || defined(KD_WINDOW_ANDROID) || defined(KD_WINDOW_EMSCRIPTEN)
+#define NATIVE_KEYS
+#define ROUNDS 4096
+
+#if defined(KD_WINDOW_X11) || defined(KD_WINDOW_WAYLAND)
+/* Keysym page of the function keys, XF86 multimedia keys are timed on their own */
+#define FIRST 0xff00
+#define LAST 0xffff
+#else
+/* Android keycodes, Win32 virtual keys and DOM keyCodes */
+#define FIRST 0
+#define LAST 0x1ff
+#endif
+
+static KDint32 translate(KDint32 first, KDint32 last)
+{
+    KDint32 sum = 0;
+    for(KDint32 round = 0; round < ROUNDS; round++)
+    {
+        for(KDint32 keycode = first; keycode <= last; keycode++)
+        {
+            sum += kdTranslateKeycodeVEN(keycode);
+        }
+    }
+    return sum;
+}
+#endif
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+#if defined(NATIVE_KEYS)
+    KDint32 mapped = 0;
+    for(KDint32 keycode = FIRST; keycode <= LAST; keycode++)
+    {
+        mapped += kdTranslateKeycodeVEN(keycode) != 0;
+    }
+    printf("%d of %d native keys map to KD keys\n", mapped, LAST - FIRST + 1);
+
+    KDust start = BENCH_BEGIN();
+    KDint32 sum = translate(FIRST, LAST);
+    BENCH_END("native keys", start, ROUNDS * (LAST - FIRST + 1));
+#if defined(KD_WINDOW_X11) || defined(KD_WINDOW_WAYLAND)
+    start = BENCH_BEGIN();
+    sum += translate(0x1008ff00, 0x1008ffff);
+    BENCH_END("xf86 keysyms", start, ROUNDS * 256);
+#endif
+    bench_sink = (KDfloat64KHR)sum;
+#else
+    printf("no native keys on this window backend, skipped\n");
+#endif
+    return 0;
+}
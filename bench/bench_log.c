@@ -0,0 +1,113 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+#include <KD/KHR_formatted.h>
+
+/* Synchronous write per message for comparison */
+#include <fcntl.h>
+#include <unistd.h>
+
+#define MESSAGES 200000
+#define THREAD_COUNT 4
+
+static void *bench_func(void *arg)
+{
+    KDint count = *(KDint *)arg;
+    for(KDint i = 0; i < count; i++)
+    {
+        kdLogMessagefKHR("frame %d took %.3f ms\n", i, 16.6);
+    }
+    return 0;
+}
+
+static void *bench_deferred_func(void *arg)
+{
+    KDint count = *(KDint *)arg;
+    for(KDint i = 0; i < count; i++)
+    {
+        kdLogDeferredVEN("frame %d took %.3f ms\n", i, 16.6);
+    }
+    return 0;
+}
+
+static void bench_threads(const KDchar *name, void *(*func)(void *))
+{
+    KDThread *threads[THREAD_COUNT];
+    KDint count = MESSAGES / THREAD_COUNT;
+    KDint dropped = kdLogGetDroppedVEN();
+    KDust start = BENCH_BEGIN();
+    for(KDint i = 0; i < THREAD_COUNT; i++)
+    {
+        threads[i] = kdThreadCreate(KD_NULL, func, &count);
+    }
+    for(KDint i = 0; i < THREAD_COUNT; i++)
+    {
+        kdThreadJoin(threads[i], KD_NULL);
+    }
+    BENCH_END(name, start, MESSAGES);
+    kdLogFlushVEN();
+    printf("%-36s %10d\n", "dropped", kdLogGetDroppedVEN() - dropped);
+}
+
+static void bench_single(const KDchar *name, void *(*func)(void *))
+{
+    KDint count = MESSAGES;
+    KDint dropped = kdLogGetDroppedVEN();
+    KDust start = BENCH_BEGIN();
+    func(&count);
+    BENCH_END(name, start, MESSAGES);
+    kdLogFlushVEN();
+    printf("%-36s %10d\n", "dropped", kdLogGetDroppedVEN() - dropped);
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    KDint fd = open("/dev/null", O_WRONLY);
+    KDchar line[128];
+    KDust start = BENCH_BEGIN();
+    for(KDint i = 0; i < MESSAGES; i++)
+    {
+        KDint len = snprintf(line, sizeof(line), "frame %d took %.3f ms\n", i, 16.6);
+        bench_sink = (KDfloat64KHR)write(fd, line, (size_t)len);
+    }
+    BENCH_END("snprintf + write (blocking)", start, MESSAGES);
+    close(fd);
+
+    kdLogSetSinkVEN("/dev/null");
+    /* kdLogMessagefKHR is compiled out with NDEBUG. */
+#if !defined(KD_NDEBUG)
+    bench_single("kdLogMessagefKHR", bench_func);
+    bench_threads("kdLogMessagefKHR (4 threads)", bench_func);
+#endif
+
+    /* Only arguments are copied, formatting happens on the writer or offline. */
+    bench_single("kdLogDeferredVEN (text)", bench_deferred_func);
+    bench_threads("kdLogDeferredVEN (text, 4 threads)", bench_deferred_func);
+    kdLogSetModeVEN(KD_LOG_BINARY_VEN);
+    bench_single("kdLogDeferredVEN (binary)", bench_deferred_func);
+    bench_threads("kdLogDeferredVEN (binary, 4 threads)", bench_deferred_func);
+    kdLogSetModeVEN(KD_LOG_TEXT_VEN);
+    kdLogSetSinkVEN(KD_NULL);
+    return 0;
+}
@@ -0,0 +1,191 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+#define UNCONTENDED 10000000
+#define CONTENDED 1000000
+#define PINGPONG 100000
+#define THREADS 4
+
+static KDThreadMutex *kdmutex = KD_NULL;
+static KDThreadSem *kdsems[2] = {KD_NULL, KD_NULL};
+static KDint counter = 0;
+
+static void *kd_contended(KD_UNUSED void *arg)
+{
+    for(KDint i = 0; i < CONTENDED; i++)
+    {
+        kdThreadMutexLock(kdmutex);
+        counter++;
+        kdThreadMutexUnlock(kdmutex);
+    }
+    return KD_NULL;
+}
+
+static void *kd_pong(KD_UNUSED void *arg)
+{
+    for(KDint i = 0; i < PINGPONG; i++)
+    {
+        kdThreadSemWait(kdsems[0]);
+        kdThreadSemPost(kdsems[1]);
+    }
+    return KD_NULL;
+}
+
+#if !defined(_WIN32)
+static pthread_mutex_t pmutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void *pthread_contended(KD_UNUSED void *arg)
+{
+    for(KDint i = 0; i < CONTENDED; i++)
+    {
+        pthread_mutex_lock(&pmutex);
+        counter++;
+        pthread_mutex_unlock(&pmutex);
+    }
+    return KD_NULL;
+}
+
+/* Mutex, condition variable and counter, the portable semaphore. */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    KDuint count;
+} PthreadSem;
+static PthreadSem psems[2] = {
+    {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0},
+    {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0}};
+
+static void psem_wait(PthreadSem *sem)
+{
+    pthread_mutex_lock(&sem->mutex);
+    while(sem->count == 0)
+    {
+        pthread_cond_wait(&sem->cond, &sem->mutex);
+    }
+    sem->count--;
+    pthread_mutex_unlock(&sem->mutex);
+}
+
+static void psem_post(PthreadSem *sem)
+{
+    pthread_mutex_lock(&sem->mutex);
+    sem->count++;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+}
+
+static void *pthread_pong(KD_UNUSED void *arg)
+{
+    for(KDint i = 0; i < PINGPONG; i++)
+    {
+        psem_wait(&psems[0]);
+        psem_post(&psems[1]);
+    }
+    return KD_NULL;
+}
+#endif
+
+static void run_threads(const KDchar *name, void *(*func)(void *), KDint count, KDint ops)
+{
+    KDThread *threads[THREADS];
+    counter = 0;
+    KDust start = BENCH_BEGIN();
+    for(KDint i = 0; i < count; i++)
+    {
+        threads[i] = kdThreadCreate(KD_NULL, func, KD_NULL);
+    }
+    for(KDint i = 0; i < count; i++)
+    {
+        kdThreadJoin(threads[i], KD_NULL);
+    }
+    BENCH_END(name, start, ops);
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    kdmutex = kdThreadMutexCreate(KD_NULL);
+    KDust start = BENCH_BEGIN();
+    for(KDint i = 0; i < UNCONTENDED; i++)
+    {
+        kdThreadMutexLock(kdmutex);
+        counter++;
+        kdThreadMutexUnlock(kdmutex);
+    }
+    BENCH_END("kdThreadMutex uncontended", start, UNCONTENDED);
+#if !defined(_WIN32)
+    start = BENCH_BEGIN();
+    for(KDint i = 0; i < UNCONTENDED; i++)
+    {
+        pthread_mutex_lock(&pmutex);
+        counter++;
+        pthread_mutex_unlock(&pmutex);
+    }
+    BENCH_END("pthread_mutex uncontended", start, UNCONTENDED);
+#endif
+
+    KDchar name[64];
+    for(KDint threads = 2; threads <= THREADS; threads *= 2)
+    {
+        snprintf(name, sizeof(name), "kdThreadMutex contended (%d threads)", threads);
+        run_threads(name, kd_contended, threads, CONTENDED * threads);
+#if !defined(_WIN32)
+        snprintf(name, sizeof(name), "pthread_mutex contended (%d threads)", threads);
+        run_threads(name, pthread_contended, threads, CONTENDED * threads);
+#endif
+    }
+    kdThreadMutexFree(kdmutex);
+
+    kdsems[0] = kdThreadSemCreate(0);
+    kdsems[1] = kdThreadSemCreate(0);
+    KDThread *thread = kdThreadCreate(KD_NULL, kd_pong, KD_NULL);
+    start = BENCH_BEGIN();
+    for(KDint i = 0; i < PINGPONG; i++)
+    {
+        kdThreadSemPost(kdsems[0]);
+        kdThreadSemWait(kdsems[1]);
+    }
+    kdThreadJoin(thread, KD_NULL);
+    BENCH_END("kdThreadSem ping-pong", start, PINGPONG);
+    kdThreadSemFree(kdsems[1]);
+    kdThreadSemFree(kdsems[0]);
+#if !defined(_WIN32)
+    pthread_t pthread;
+    pthread_create(&pthread, KD_NULL, pthread_pong, KD_NULL);
+    start = BENCH_BEGIN();
+    for(KDint i = 0; i < PINGPONG; i++)
+    {
+        psem_post(&psems[0]);
+        psem_wait(&psems[1]);
+    }
+    pthread_join(pthread, KD_NULL);
+    BENCH_END("pthread mutex+cond ping-pong", start, PINGPONG);
+#endif
+    bench_sink = counter;
+    return 0;
+}
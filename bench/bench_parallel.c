@@ -0,0 +1,121 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+#define COUNT (1 << 22)
+#define ROUNDS 10
+
+static KDfloat32 *x = KD_NULL;
+static KDfloat32 *y = KD_NULL;
+
+static void KD_APIENTRY update(KDint64 begin, KDint64 end, KD_UNUSED void *ctx)
+{
+    for(KDint64 i = begin; i < end; i++)
+    {
+        y[i] = kdSqrtf(x[i]) * 0.5f + y[i];
+    }
+}
+
+static void KD_APIENTRY sum(KDint64 begin, KDint64 end, void *partial, KD_UNUSED void *ctx)
+{
+    KDfloat64KHR s = 0.0;
+    for(KDint64 i = begin; i < end; i++)
+    {
+        s += (KDfloat64KHR)y[i];
+    }
+    *(KDfloat64KHR *)partial += s;
+}
+
+static void KD_APIENTRY sum_join(void *result, const void *partial, KD_UNUSED void *ctx)
+{
+    *(KDfloat64KHR *)result += *(const KDfloat64KHR *)partial;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    x = (KDfloat32 *)kdMalloc(COUNT * sizeof(KDfloat32));
+    y = (KDfloat32 *)kdMalloc(COUNT * sizeof(KDfloat32));
+    for(KDint i = 0; i < COUNT; i++)
+    {
+        x[i] = (KDfloat32)i;
+        y[i] = 0.0f;
+    }
+    printf("%d workers + caller\n", kdJobSystemGetWorkerCountVEN(kdJobSystemGetDefaultVEN()));
+
+    KDust start = BENCH_BEGIN();
+    for(KDint r = 0; r < ROUNDS; r++)
+    {
+        update(0, COUNT, KD_NULL);
+    }
+    KDust serial = kdGetTimeUST() - start;
+    BENCH_END("serial loop", start, (KDint64)COUNT * ROUNDS);
+
+    const KDint64 grains[] = {64, 1024, 16384, 262144, 0};
+    KDchar name[64];
+    for(KDsize g = 0; g < sizeof(grains) / sizeof(grains[0]); g++)
+    {
+        start = BENCH_BEGIN();
+        for(KDint r = 0; r < ROUNDS; r++)
+        {
+            kdParallelForVEN(0, COUNT, grains[g], update, KD_NULL);
+        }
+        KDust elapsed = kdGetTimeUST() - start;
+        snprintf(name, sizeof(name), "kdParallelForVEN (grain %lld)", (long long)grains[g]);
+        BENCH_END(name, start, (KDint64)COUNT * ROUNDS);
+        printf("%-36s %10.2fx\n", "speedup", (KDfloat64KHR)serial / (KDfloat64KHR)elapsed);
+    }
+
+    /* Small ranges run inline */
+    start = BENCH_BEGIN();
+    for(KDint r = 0; r < 100000; r++)
+    {
+        kdParallelForVEN(0, 32, 64, update, KD_NULL);
+    }
+    BENCH_END("kdParallelForVEN (32 indices)", start, 100000);
+
+    KDfloat64KHR total = 0.0;
+    start = BENCH_BEGIN();
+    for(KDint r = 0; r < ROUNDS; r++)
+    {
+        total = 0.0;
+        sum(0, COUNT, &total, KD_NULL);
+    }
+    serial = kdGetTimeUST() - start;
+    BENCH_END("serial sum", start, (KDint64)COUNT * ROUNDS);
+    bench_sink = total;
+    start = BENCH_BEGIN();
+    for(KDint r = 0; r < ROUNDS; r++)
+    {
+        total = 0.0;
+        kdParallelReduceVEN(0, COUNT, 0, sum, sum_join, &total, sizeof(total), KD_NULL);
+    }
+    KDust elapsed = kdGetTimeUST() - start;
+    BENCH_END("kdParallelReduceVEN", start, (KDint64)COUNT * ROUNDS);
+    printf("%-36s %10.2fx\n", "speedup", (KDfloat64KHR)serial / (KDfloat64KHR)elapsed);
+    bench_sink = total;
+
+    kdFree(y);
+    kdFree(x);
+    return 0;
+}
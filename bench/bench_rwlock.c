@@ -0,0 +1,177 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L /* pthread_rwlock_t */
+#endif
+#include "bench.h"
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+#define OPS 1000000
+#define WRITE_EVERY 100
+#define THREADS 4
+#define PHASES 10000
+#define TABLE 64
+
+/* A read-mostly table, reads sum a few entries. */
+static KDint table[TABLE];
+static KDThreadRWLockVEN *rwlock = KD_NULL;
+static KDThreadMutex *mutex = KD_NULL;
+static KDThreadBarrierVEN *barrier = KD_NULL;
+#if !defined(_WIN32)
+static pthread_rwlock_t prwlock = PTHREAD_RWLOCK_INITIALIZER;
+#endif
+
+static KDint read_table(KDint seed)
+{
+    KDint sum = 0;
+    for(KDint i = 0; i < 4; i++)
+    {
+        sum += table[(seed + i * 7) % TABLE];
+    }
+    return sum;
+}
+
+static void *rwlock_func(KD_UNUSED void *arg)
+{
+    KDint sum = 0;
+    for(KDint i = 0; i < OPS; i++)
+    {
+        if(i % WRITE_EVERY == 0)
+        {
+            kdThreadRWLockWriteLockVEN(rwlock);
+            table[i % TABLE]++;
+            kdThreadRWLockWriteUnlockVEN(rwlock);
+        }
+        else
+        {
+            kdThreadRWLockReadLockVEN(rwlock);
+            sum += read_table(i);
+            kdThreadRWLockReadUnlockVEN(rwlock);
+        }
+    }
+    bench_sink = sum;
+    return KD_NULL;
+}
+
+static void *mutex_func(KD_UNUSED void *arg)
+{
+    KDint sum = 0;
+    for(KDint i = 0; i < OPS; i++)
+    {
+        kdThreadMutexLock(mutex);
+        if(i % WRITE_EVERY == 0)
+        {
+            table[i % TABLE]++;
+        }
+        else
+        {
+            sum += read_table(i);
+        }
+        kdThreadMutexUnlock(mutex);
+    }
+    bench_sink = sum;
+    return KD_NULL;
+}
+
+#if !defined(_WIN32)
+static void *pthread_func(KD_UNUSED void *arg)
+{
+    KDint sum = 0;
+    for(KDint i = 0; i < OPS; i++)
+    {
+        if(i % WRITE_EVERY == 0)
+        {
+            pthread_rwlock_wrlock(&prwlock);
+            table[i % TABLE]++;
+            pthread_rwlock_unlock(&prwlock);
+        }
+        else
+        {
+            pthread_rwlock_rdlock(&prwlock);
+            sum += read_table(i);
+            pthread_rwlock_unlock(&prwlock);
+        }
+    }
+    bench_sink = sum;
+    return KD_NULL;
+}
+#endif
+
+static void *barrier_func(KD_UNUSED void *arg)
+{
+    for(KDint i = 0; i < PHASES; i++)
+    {
+        kdThreadBarrierWaitVEN(barrier);
+    }
+    return KD_NULL;
+}
+
+static void run_threads(const KDchar *name, void *(*func)(void *), KDint count, KDint ops)
+{
+    KDThread *threads[THREADS];
+    KDust start = BENCH_BEGIN();
+    for(KDint i = 0; i < count; i++)
+    {
+        threads[i] = kdThreadCreate(KD_NULL, func, KD_NULL);
+    }
+    for(KDint i = 0; i < count; i++)
+    {
+        kdThreadJoin(threads[i], KD_NULL);
+    }
+    BENCH_END(name, start, ops);
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    rwlock = kdThreadRWLockCreateVEN();
+    mutex = kdThreadMutexCreate(KD_NULL);
+
+    KDchar name[64];
+    for(KDint threads = 1; threads <= THREADS; threads *= 2)
+    {
+        snprintf(name, sizeof(name), "kdThreadRWLockVEN 99%% reads (%d)", threads);
+        run_threads(name, rwlock_func, threads, OPS * threads);
+        snprintf(name, sizeof(name), "kdThreadMutex 99%% reads (%d)", threads);
+        run_threads(name, mutex_func, threads, OPS * threads);
+#if !defined(_WIN32)
+        snprintf(name, sizeof(name), "pthread_rwlock 99%% reads (%d)", threads);
+        run_threads(name, pthread_func, threads, OPS * threads);
+#endif
+    }
+
+    for(KDint threads = 2; threads <= THREADS; threads *= 2)
+    {
+        barrier = kdThreadBarrierCreateVEN((KDuint)threads);
+        snprintf(name, sizeof(name), "kdThreadBarrierVEN phase (%d)", threads);
+        run_threads(name, barrier_func, threads, PHASES);
+        kdThreadBarrierFreeVEN(barrier);
+    }
+
+    kdThreadMutexFree(mutex);
+    kdThreadRWLockFreeVEN(rwlock);
+    return 0;
+}
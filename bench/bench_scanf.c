@@ -0,0 +1,101 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+#include <KD/KHR_formatted.h>
+
+/* libc sscanf for comparison */
+#include <stdio.h>
+
+#define ROUNDS 4
+#define LINES 16384
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    /* OBJ-like vertex lines */
+    KDsize capacity = LINES * 64;
+    KDchar *text = (KDchar *)kdMalloc(capacity);
+    const KDchar **lines = (const KDchar **)kdMalloc(LINES * sizeof(KDchar *));
+    KDuint64 seed = 0x2545F4914F6CDD1DULL;
+    KDsize pos = 0;
+    for(KDint i = 0; i < LINES; i++)
+    {
+        KDfloat32 v[3];
+        for(KDint j = 0; j < 3; j++)
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            v[j] = (KDfloat32)(seed % 200000) / 1000.0f - 100.0f;
+        }
+        lines[i] = text + pos;
+        pos += (KDsize)kdSnprintfKHR(text + pos, capacity - pos, "v %.4f %.4f %.4f %d", v[0], v[1], v[2], i) + 1;
+    }
+
+    KDfloat32 x = 0.0f, y = 0.0f, z = 0.0f;
+    KDint index = 0;
+    KDfloat64KHR sum = 0.0;
+    KDust start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        for(KDint i = 0; i < LINES; i++)
+        {
+            sscanf(lines[i], "v %f %f %f %d", &x, &y, &z, &index);
+            sum += x + y + z + index;
+        }
+    }
+    BENCH_END("sscanf (libc)", start, ROUNDS * LINES);
+    bench_sink = sum;
+
+    sum = 0.0;
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        for(KDint i = 0; i < LINES; i++)
+        {
+            kdSscanfKHR(lines[i], "v %f %f %f %d", &x, &y, &z, &index);
+            sum += x + y + z + index;
+        }
+    }
+    BENCH_END("kdSscanfKHR", start, ROUNDS * LINES);
+    bench_sink = sum;
+
+    sum = 0.0;
+    KDScanfPlanVEN *plan = kdScanfCompileVEN("v %f %f %f %d");
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        for(KDint i = 0; i < LINES; i++)
+        {
+            kdSscanfPlanVEN(lines[i], plan, &x, &y, &z, &index);
+            sum += x + y + z + index;
+        }
+    }
+    BENCH_END("kdSscanfPlanVEN", start, ROUNDS * LINES);
+    bench_sink = sum;
+    kdScanfFreeVEN(plan);
+
+    kdFree(lines);
+    kdFree(text);
+    return 0;
+}
@@ -0,0 +1,87 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+#include <stdlib.h>
+
+#define FRAMES 500
+#define PERIOD 1000000LL
+
+static KDust errors[FRAMES];
+
+static int compare_ust(const void *a, const void *b)
+{
+    KDust x = *(const KDust *)a;
+    KDust y = *(const KDust *)b;
+    return (x > y) - (x < y);
+}
+
+/* Wake-up error percentiles in microseconds for a 1 ms frame loop. */
+static void report(const char *name, KDust drift)
+{
+    qsort(errors, FRAMES, sizeof(KDust), compare_ust);
+    printf("%-36s p50 %8.1f p90 %8.1f p99 %8.1f max %8.1f us, drift %8.1f us\n", name,
+        (double)errors[FRAMES / 2] / 1000.0,
+        (double)errors[FRAMES * 9 / 10] / 1000.0,
+        (double)errors[FRAMES * 99 / 100] / 1000.0,
+        (double)errors[FRAMES - 1] / 1000.0,
+        (double)drift / 1000.0);
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    /* Relative sleeps accumulate every late wakeup into the frame clock */
+    KDust deadline = kdGetTimeUST();
+    for(KDint i = 0; i < FRAMES; i++)
+    {
+        deadline += PERIOD;
+        KDust before = kdGetTimeUST();
+        kdThreadSleepVEN(PERIOD);
+        KDust now = kdGetTimeUST();
+        errors[i] = now - before - PERIOD;
+    }
+    report("kdThreadSleepVEN (relative)", kdGetTimeUST() - deadline);
+
+    /* Absolute deadlines do not drift, only the wake-up latency remains */
+    deadline = kdGetTimeUST();
+    for(KDint i = 0; i < FRAMES; i++)
+    {
+        deadline += PERIOD;
+        kdThreadSleepUntilVEN(deadline);
+        KDust now = kdGetTimeUST();
+        errors[i] = now - deadline;
+    }
+    report("kdThreadSleepUntilVEN", kdGetTimeUST() - deadline);
+
+    deadline = kdGetTimeUST();
+    for(KDint i = 0; i < FRAMES; i++)
+    {
+        deadline += PERIOD;
+        kdThreadSleepUntilPreciseVEN(deadline);
+        KDust now = kdGetTimeUST();
+        errors[i] = now - deadline;
+    }
+    report("kdThreadSleepUntilPreciseVEN", kdGetTimeUST() - deadline);
+    return 0;
+}
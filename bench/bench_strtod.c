@@ -0,0 +1,158 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+/* libc strtod for comparison */
+#include <stdlib.h>
+
+#define ROUNDS 16
+#define VERTICES 65536
+
+/* Parse all numbers in an OBJ-style vertex list, returns the count. */
+static KDint parse_obj_float(const KDchar *text, KDfloat32 *out)
+{
+    KDint n = 0;
+    const KDchar *p = text;
+    while(*p == 'v')
+    {
+        KDchar *end = KD_NULL;
+        p++;
+        for(KDint i = 0; i < 3; i++)
+        {
+            out[n++] = kdStrtof(p, &end);
+            p = end;
+        }
+        p++;
+    }
+    return n;
+}
+
+static KDint parse_obj_double(const KDchar *text, KDfloat64KHR *out)
+{
+    KDint n = 0;
+    const KDchar *p = text;
+    while(*p == 'v')
+    {
+        KDchar *end = KD_NULL;
+        p++;
+        for(KDint i = 0; i < 3; i++)
+        {
+            out[n++] = kdStrtodKHR(p, &end);
+            p = end;
+        }
+        p++;
+    }
+    return n;
+}
+
+static KDint parse_obj_libc(const KDchar *text, KDfloat64KHR *out)
+{
+    KDint n = 0;
+    const KDchar *p = text;
+    while(*p == 'v')
+    {
+        KDchar *end = KD_NULL;
+        p++;
+        for(KDint i = 0; i < 3; i++)
+        {
+            out[n++] = strtod(p, &end);
+            p = end;
+        }
+        p++;
+    }
+    return n;
+}
+
+/* Generate vertices like exporters write them, in fixed and shortest notation. */
+static KDchar *generate_obj(KDboolean shortest, KDsize *length)
+{
+    KDsize capacity = VERTICES * 3 * 32 + 1;
+    KDchar *text = (KDchar *)kdMalloc(capacity);
+    KDsize pos = 0;
+    KDuint32 seed = 12345;
+    for(KDint i = 0; i < VERTICES; i++)
+    {
+        KDfloat64KHR v[3];
+        for(KDint j = 0; j < 3; j++)
+        {
+            seed = seed * 1103515245 + 12345;
+            v[j] = ((KDfloat64KHR)(seed >> 8) / 16777216.0 - 0.5) * 200.0;
+        }
+        if(shortest)
+        {
+            pos += (KDsize)snprintf(text + pos, capacity - pos, "v %.17g %.17g %.17g\n", v[0], v[1], v[2]);
+        }
+        else
+        {
+            pos += (KDsize)snprintf(text + pos, capacity - pos, "v %.6f %.6f %.6f\n", v[0], v[1], v[2]);
+        }
+    }
+    *length = pos;
+    return text;
+}
+
+static void bench_text(const KDchar *label, KDboolean shortest)
+{
+    KDsize length = 0;
+    KDchar *text = generate_obj(shortest, &length);
+    KDfloat32 *outf = (KDfloat32 *)kdMalloc(VERTICES * 3 * sizeof(KDfloat32));
+    KDfloat64KHR *outd = (KDfloat64KHR *)kdMalloc(VERTICES * 3 * sizeof(KDfloat64KHR));
+    KDint count = 0;
+    printf("%s (%.1f MB)\n", label, (KDfloat64KHR)length / 1e6);
+
+    KDust start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        count = parse_obj_libc(text, outd);
+    }
+    BENCH_END("  strtod (libc)", start, ROUNDS * count);
+    bench_sink = outd[7];
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        count = parse_obj_double(text, outd);
+    }
+    BENCH_END("  kdStrtodKHR", start, ROUNDS * count);
+    bench_sink = outd[7];
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        count = parse_obj_float(text, outf);
+    }
+    BENCH_END("  kdStrtof", start, ROUNDS * count);
+    bench_sink = outf[7];
+
+    kdFree(outd);
+    kdFree(outf);
+    kdFree(text);
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    bench_text("OBJ vertices, 6 decimals", 0);
+    bench_text("OBJ vertices, 17 significant digits", 1);
+    return 0;
+}
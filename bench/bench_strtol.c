@@ -0,0 +1,133 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+/* libc strtol for comparison */
+#include <stdlib.h>
+
+#define ROUNDS 16
+#define NUMBERS 65536
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    KDint64 *values = (KDint64 *)kdMalloc(NUMBERS * sizeof(KDint64));
+    KDint64 *parsed = (KDint64 *)kdMalloc(NUMBERS * sizeof(KDint64));
+    KDsize capacity = NUMBERS * KD_LLTOSTR_MAXLEN_VEN;
+    KDchar *text = (KDchar *)kdMalloc(capacity);
+
+    /* CSV-like mix of short counters and wide ids */
+    KDuint64 seed = 0x2545F4914F6CDD1DULL;
+    for(KDint i = 0; i < NUMBERS; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        values[i] = (i & 1) ? (KDint64)(seed % 100000) : (KDint64)(seed >> 1) - (KDint64)(seed >> 2);
+    }
+
+    KDsize pos = 0;
+    KDust start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        pos = 0;
+        for(KDint i = 0; i < NUMBERS; i++)
+        {
+            pos += (KDsize)snprintf(text + pos, capacity - pos, "%lld,", values[i]);
+        }
+    }
+    BENCH_END("snprintf %lld (libc)", start, ROUNDS * NUMBERS);
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        pos = 0;
+        for(KDint i = 0; i < NUMBERS; i++)
+        {
+            pos += (KDsize)kdLltostrVEN(text + pos, capacity - pos, values[i]);
+            text[pos++] = ',';
+        }
+    }
+    BENCH_END("kdLltostrVEN", start, ROUNDS * NUMBERS);
+    text[pos] = '\0';
+
+    KDchar small[KD_LTOSTR_MAXLEN];
+    KDssize len = 0;
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        for(KDint i = 0; i < NUMBERS; i++)
+        {
+            len += kdLtostr(small, sizeof(small), (KDint)values[i]);
+        }
+    }
+    BENCH_END("kdLtostr", start, ROUNDS * NUMBERS);
+    bench_sink = (KDfloat64KHR)len;
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        const KDchar *p = text;
+        for(KDint i = 0; i < NUMBERS; i++)
+        {
+            KDchar *end = KD_NULL;
+            parsed[i] = strtoll(p, &end, 10);
+            p = end + 1;
+        }
+    }
+    BENCH_END("strtoll (libc)", start, ROUNDS * NUMBERS);
+    bench_sink = (KDfloat64KHR)parsed[7];
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        const KDchar *p = text;
+        for(KDint i = 0; i < NUMBERS; i++)
+        {
+            KDchar *end = KD_NULL;
+            parsed[i] = kdStrtollVEN(p, &end, 10);
+            p = end + 1;
+        }
+    }
+    BENCH_END("kdStrtollVEN", start, ROUNDS * NUMBERS);
+    bench_sink = (KDfloat64KHR)parsed[7];
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        const KDchar *p = text;
+        for(KDint i = 0; i < NUMBERS; i++)
+        {
+            KDchar *end = KD_NULL;
+            parsed[i] = kdStrtol(p, &end, 10);
+            p = end + 1;
+        }
+    }
+    BENCH_END("kdStrtol (saturating)", start, ROUNDS * NUMBERS);
+    bench_sink = (KDfloat64KHR)parsed[7];
+
+    kdFree(text);
+    kdFree(parsed);
+    kdFree(values);
+    return 0;
+}
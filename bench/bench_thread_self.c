@@ -0,0 +1,81 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+#define CALLS 50000000
+
+static KDint key_id = 0;
+
+static void *self_thread(KD_UNUSED void *arg)
+{
+    KDuintptr sum = 0;
+    KDust start = BENCH_BEGIN();
+    for(KDint i = 0; i < CALLS; i++)
+    {
+        sum += (KDuintptr)kdThreadSelf();
+    }
+    BENCH_END("kdThreadSelf (other thread)", start, CALLS);
+    bench_sink = (KDfloat64KHR)sum;
+    return KD_NULL;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    KDuintptr sum = 0;
+    KDust start = BENCH_BEGIN();
+    for(KDint i = 0; i < CALLS; i++)
+    {
+        sum += (KDuintptr)kdThreadSelf();
+    }
+    BENCH_END("kdThreadSelf", start, CALLS);
+
+    start = BENCH_BEGIN();
+    for(KDint i = 0; i < CALLS; i++)
+    {
+        sum += (KDuintptr)kdGetError();
+    }
+    BENCH_END("kdGetError", start, CALLS);
+
+    start = BENCH_BEGIN();
+    for(KDint i = 0; i < CALLS; i++)
+    {
+        sum += (KDuintptr)kdGetTLS();
+    }
+    BENCH_END("kdGetTLS", start, CALLS);
+
+    /* The key table path kdThreadSelf used before */
+    KDThreadStorageKeyKHR key = kdMapThreadStorageKHR(&key_id);
+    kdSetThreadStorageKHR(key, &key_id);
+    start = BENCH_BEGIN();
+    for(KDint i = 0; i < CALLS; i++)
+    {
+        sum += (KDuintptr)kdGetThreadStorageKHR(key);
+    }
+    BENCH_END("kdGetThreadStorageKHR", start, CALLS);
+    bench_sink = (KDfloat64KHR)sum;
+
+    KDThread *thread = kdThreadCreate(KD_NULL, self_thread, KD_NULL);
+    kdThreadJoin(thread, KD_NULL);
+    return 0;
+}
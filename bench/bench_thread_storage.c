@@ -0,0 +1,90 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+#define IDS 10000
+#define LOOKUPS 20000000
+#define CALLS 50000000
+#define THREADS 4
+
+static KDchar ids[IDS];
+
+/* Objects lazily mapping their key on every access */
+static void *map_thread(KD_UNUSED void *arg)
+{
+    KDuint64 sum = 0;
+    for(KDint i = 0; i < LOOKUPS / THREADS; i++)
+    {
+        sum += kdMapThreadStorageKHR(&ids[i % IDS]);
+    }
+    bench_sink = (KDfloat64KHR)sum;
+    return KD_NULL;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    KDust start = BENCH_BEGIN();
+    for(KDint i = 0; i < IDS; i++)
+    {
+        kdMapThreadStorageKHR(&ids[i]);
+    }
+    BENCH_END("kdMapThreadStorageKHR (new id)", start, IDS);
+
+    KDuint64 sum = 0;
+    start = BENCH_BEGIN();
+    for(KDint i = 0; i < LOOKUPS; i++)
+    {
+        sum += kdMapThreadStorageKHR(&ids[i % IDS]);
+    }
+    BENCH_END("kdMapThreadStorageKHR (mapped id)", start, LOOKUPS);
+
+    KDThread *threads[THREADS] = {KD_NULL};
+    start = BENCH_BEGIN();
+    for(KDint i = 0; i < THREADS; i++)
+    {
+        threads[i] = kdThreadCreate(KD_NULL, map_thread, KD_NULL);
+    }
+    for(KDint i = 0; i < THREADS; i++)
+    {
+        kdThreadJoin(threads[i], KD_NULL);
+    }
+    BENCH_END("kdMapThreadStorageKHR (mapped id, 4 threads)", start, LOOKUPS);
+
+    KDThreadStorageKeyKHR key = kdMapThreadStorageKHR(&ids[IDS - 1]);
+    start = BENCH_BEGIN();
+    for(KDint i = 0; i < CALLS; i++)
+    {
+        kdSetThreadStorageKHR(key, &ids[i & 1]);
+    }
+    BENCH_END("kdSetThreadStorageKHR", start, CALLS);
+
+    start = BENCH_BEGIN();
+    for(KDint i = 0; i < CALLS; i++)
+    {
+        sum += (KDuintptr)kdGetThreadStorageKHR(key);
+    }
+    BENCH_END("kdGetThreadStorageKHR", start, CALLS);
+    bench_sink = (KDfloat64KHR)sum;
+    return 0;
+}
@@ -0,0 +1,132 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+
+#define ROUNDS 4096
+#define MATRICES 256
+#define POINTS 1024
+
+/* Plain column-major multiply for comparison. */
+static void scalar_multiply(KDfloat32 *out, const KDfloat32 *a, const KDfloat32 *b)
+{
+    for(KDint col = 0; col < 4; col++)
+    {
+        for(KDint row = 0; row < 4; row++)
+        {
+            out[col * 4 + row] = a[row] * b[col * 4] + a[4 + row] * b[col * 4 + 1] + a[8 + row] * b[col * 4 + 2] + a[12 + row] * b[col * 4 + 3];
+        }
+    }
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    KDMat4VEN *a = (KDMat4VEN *)kdMalloc(MATRICES * sizeof(KDMat4VEN));
+    KDMat4VEN *r = (KDMat4VEN *)kdMalloc(MATRICES * sizeof(KDMat4VEN));
+    KDMat4VEN b;
+    kdMat4RotationVEN(&b, 0.5f, 1.0f, 2.0f, 3.0f);
+    kdMat4TranslateVEN(&b, 1.0f, 2.0f, 3.0f);
+    for(KDint i = 0; i < MATRICES; i++)
+    {
+        kdMat4PerspectiveVEN(&a[i], 1.0f, 1.0f + (KDfloat32)i * 0.01f, 0.1f, 100.0f);
+    }
+
+    KDust start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        for(KDint i = 0; i < MATRICES; i++)
+        {
+            scalar_multiply(r[i].m, a[i].m, b.m);
+        }
+    }
+    BENCH_END("mat4 multiply (scalar)", start, ROUNDS * MATRICES);
+    bench_sink = r[7].m[5];
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        for(KDint i = 0; i < MATRICES; i++)
+        {
+            kdMat4MultiplyVEN(&r[i], &a[i], &b);
+        }
+    }
+    BENCH_END("kdMat4MultiplyVEN", start, ROUNDS * MATRICES);
+    bench_sink = r[7].m[5];
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        for(KDint i = 0; i < MATRICES; i++)
+        {
+            kdMat4TransposeVEN(&r[i], &a[i]);
+        }
+    }
+    BENCH_END("kdMat4TransposeVEN", start, ROUNDS * MATRICES);
+    bench_sink = r[7].m[5];
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        for(KDint i = 0; i < MATRICES; i++)
+        {
+            kdMat4InverseVEN(&r[i], &a[i]);
+        }
+    }
+    BENCH_END("kdMat4InverseVEN", start, ROUNDS * MATRICES);
+    bench_sink = r[7].m[5];
+
+    KDVec3VEN *in = (KDVec3VEN *)kdMalloc(POINTS * sizeof(KDVec3VEN));
+    KDVec3VEN *out = (KDVec3VEN *)kdMalloc(POINTS * sizeof(KDVec3VEN));
+    for(KDint i = 0; i < POINTS; i++)
+    {
+        kdVec3SetVEN(&in[i], (KDfloat32)i, (KDfloat32)(i & 7), 1.0f);
+    }
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        for(KDint i = 0; i < POINTS; i++)
+        {
+            KDVec4VEN v;
+            kdVec4SetVEN(&v, in[i].x, in[i].y, in[i].z, 1.0f);
+            kdMat4TransformVec4VEN(&v, &b, &v);
+            kdVec3SetVEN(&out[i], v.x, v.y, v.z);
+        }
+    }
+    BENCH_END("transform point (one at a time)", start, ROUNDS * POINTS);
+    bench_sink = out[7].y;
+
+    start = BENCH_BEGIN();
+    for(KDint k = 0; k < ROUNDS; k++)
+    {
+        kdMat4TransformPointsVEN(out, &b, in, POINTS);
+    }
+    BENCH_END("kdMat4TransformPointsVEN", start, ROUNDS * POINTS);
+    bench_sink = out[7].y;
+
+    kdFree(out);
+    kdFree(in);
+    kdFree(r);
+    kdFree(a);
+    return 0;
+}
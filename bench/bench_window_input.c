@@ -0,0 +1,110 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include "bench.h"
+#include <KD/ATX_keyboard.h>
+
+#define MOTIONS 200000
+#define KEYS 100000
+#define PACED 800
+
+static KDint handled = 0;
+
+static void KD_APIENTRY callback(KD_UNUSED const KDEvent *event)
+{
+    handled++;
+}
+
+static KDint drain(void)
+{
+    KDint count = 0;
+    while(kdWaitEvent(-1))
+    {
+        count++;
+    }
+    return count;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+#if defined(KD_WINDOW_SUPPORTED)
+    KDWindow *window = kdCreateWindow(KD_NULL, KD_NULL, KD_NULL);
+    if(kdInjectInputPointerVEN(window, KD_INPUT_POINTER_X, 0, 0, 0, 0) == -1)
+    {
+        printf("needs a headless window, run with KD_WINDOW_PLATFORM=null\n");
+        kdDestroyWindow(window);
+        return 0;
+    }
+    drain();
+
+    /* Pointer motion, every event reaches kdWaitEvent */
+    KDust now = kdGetTimeUST();
+    for(KDint32 i = 0; i < MOTIONS; i++)
+    {
+        kdInjectInputPointerVEN(window, KD_INPUT_POINTER_X, 0, i, i, now);
+    }
+    KDust start = BENCH_BEGIN();
+    KDint delivered = drain();
+    BENCH_END("pointer motion, pump + dispatch", start, delivered);
+
+    /* Same flood merged by coalescing */
+    kdSetEventCoalescingVEN(KD_EVENT_INPUT_POINTER, 1);
+    now = kdGetTimeUST();
+    for(KDint32 i = 0; i < MOTIONS; i++)
+    {
+        kdInjectInputPointerVEN(window, KD_INPUT_POINTER_X, 0, i, i, now);
+    }
+    start = BENCH_BEGIN();
+    bench_sink = drain();
+    BENCH_END("pointer motion, coalesced", start, MOTIONS);
+    kdSetEventCoalescingVEN(KD_EVENT_INPUT_POINTER, 0);
+
+    /* Key presses taken by a callback, dpad and game keys events included */
+    kdInstallCallback(&callback, KD_EVENT_INPUT_KEY_ATX, window);
+    now = kdGetTimeUST();
+    for(KDint32 i = 0; i < KEYS; i++)
+    {
+        kdInjectInputKeyVEN(window, KD_KEY_UP_ATX, (i % 2) ? 0 : KD_KEY_PRESS_ATX, now);
+    }
+    start = BENCH_BEGIN();
+    delivered = drain();
+    BENCH_END("key events, callback + special keys", start, delivered + handled);
+
+    /* 8 kHz mouse, measures how late blocked waits pick up input */
+    now = kdGetTimeUST();
+    for(KDint32 i = 0; i < PACED; i++)
+    {
+        kdInjectInputPointerVEN(window, KD_INPUT_POINTER_X, 0, i, i, now + (KDust)i * 125000);
+    }
+    KDust late = 0;
+    for(KDint32 i = 0; i < PACED; i++)
+    {
+        kdWaitEvent(1000000000LL);
+        late += kdGetTimeUST() - (now + (KDust)i * 125000);
+    }
+    printf("%-36s %10.2f us late on average\n", "8 kHz pointer, blocking wait", (KDfloat64KHR)late / PACED / 1000.0);
+
+    kdDestroyWindow(window);
+#endif
+    return 0;
+}
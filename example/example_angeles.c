@@ -157,8 +157,8 @@ static SHADERLIT sShaderLit;
 static SHADERFLAT sShaderFlat;
 static SHADERFADE sShaderFade;
 
-static Matrix4x4 sModelView;
-static Matrix4x4 sProjection;
+static KDMat4VEN sModelView;
+static KDMat4VEN sProjection;
 
 static KDust sStartTick = 0;
 static KDust sTick = 0;
@@ -299,8 +299,9 @@ static GLuint createVBO(GLOBJECT **superShapes, KDint superShapeCount,
 }
 
 
-static void computeNormalMatrix(Matrix4x4 m, Matrix3x3 normal)
+static void computeNormalMatrix(const KDMat4VEN *modelview, KDfloat32 normal[9])
 {
+    const KDfloat32 *m = modelview->m;
     KDfloat32 det = m[0 * 4 + 0] * (m[1 * 4 + 1] * m[2 * 4 + 2] - m[2 * 4 + 1] * m[1 * 4 + 2]) -
         m[0 * 4 + 1] * (m[1 * 4 + 0] * m[2 * 4 + 2] - m[1 * 4 + 2] * m[2 * 4 + 0]) +
         m[0 * 4 + 2] * (m[1 * 4 + 0] * m[2 * 4 + 1] - m[1 * 4 + 1] * m[2 * 4 + 0]);
@@ -359,8 +360,8 @@ static KDint getLocations()
 
 KDint initShaderPrograms()
 {
-    exampleMatrixIdentity(sModelView);
-    exampleMatrixIdentity(sProjection);
+    kdMat4IdentityVEN(&sModelView);
+    kdMat4IdentityVEN(&sProjection);
 
     sShaderFlat.program = exampleCreateProgram(sFlatVertexSource, sFlatFragmentSource, KD_TRUE);
     sShaderLit.program = exampleCreateProgram(sLitVertexSource, sFlatFragmentSource, KD_TRUE);
@@ -401,15 +402,14 @@ void bindShaderProgram(GLuint program)
 
     if(loc_mvp != -1)
     {
-        Matrix4x4 mvp;
-        kdMemcpy(mvp, sProjection, sizeof(sProjection));
-        exampleMatrixMultiply(mvp, sModelView);
-        glUniformMatrix4fv(loc_mvp, 1, GL_FALSE, (GLfloat *)mvp);
+        KDMat4VEN mvp;
+        kdMat4MultiplyVEN(&mvp, &sProjection, &sModelView);
+        glUniformMatrix4fv(loc_mvp, 1, GL_FALSE, mvp.m);
     }
     if(loc_normalMatrix != -1)
     {
-        Matrix3x3 normalMatrix;
-        computeNormalMatrix(sModelView, normalMatrix);
+        KDfloat32 normalMatrix[9];
+        computeNormalMatrix(&sModelView, normalMatrix);
         glUniformMatrix3fv(loc_normalMatrix, 1, GL_FALSE,
             (GLfloat *)normalMatrix);
     }
@@ -816,30 +816,25 @@ static void prepareFrame(KDint width, KDint height)
     glClearColor(0.1f, 0.2f, 0.3f, 1.0f);
     glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
-    exampleMatrixIdentity(sProjection);
-    exampleMatrixPerspective(sProjection, 45.0f, (KDfloat32)width / height, 0.5f, 150.0f);
+    kdMat4PerspectiveVEN(&sProjection, 45.0f * KD_DEG_TO_RAD_F, (KDfloat32)width / height, 0.5f, 150.0f);
 
-    exampleMatrixIdentity(sModelView);
+    kdMat4IdentityVEN(&sModelView);
 }
 
 
 static void configureLightAndMaterial()
 {
-    GLfloat light0Position[] = {-4.f, 1.f, 1.f, 0};
-    GLfloat light1Position[] = {1.f, -2.f, -1.f, 0};
-    GLfloat light2Position[] = {-1.f, 0, -4.f, 0};
+    KDVec3VEN lightPosition[3];
+    kdVec3SetVEN(&lightPosition[0], -4.f, 1.f, 1.f);
+    kdVec3SetVEN(&lightPosition[1], 1.f, -2.f, -1.f);
+    kdVec3SetVEN(&lightPosition[2], -1.f, 0, -4.f);
 
-    exampleMatrixTransform(sModelView,
-        light0Position, light0Position + 1, light0Position + 2);
-    exampleMatrixTransform(sModelView,
-        light1Position, light1Position + 1, light1Position + 2);
-    exampleMatrixTransform(sModelView,
-        light2Position, light2Position + 1, light2Position + 2);
+    kdMat4TransformNormalsVEN(lightPosition, &sModelView, lightPosition, 3);
 
     bindShaderProgram(sShaderLit.program);
-    glUniform3fv(sShaderLit.light_0_direction, 1, light0Position);
-    glUniform3fv(sShaderLit.light_1_direction, 1, light1Position);
-    glUniform3fv(sShaderLit.light_2_direction, 1, light2Position);
+    glUniform3fv(sShaderLit.light_0_direction, 1, &lightPosition[0].x);
+    glUniform3fv(sShaderLit.light_1_direction, 1, &lightPosition[1].x);
+    glUniform3fv(sShaderLit.light_2_direction, 1, &lightPosition[2].x);
 }
 
 
@@ -850,24 +845,24 @@ static void drawModels(KDfloat32 zScale)
 
     seedRandom(9);
 
-    exampleMatrixScale(sModelView, 1.f, 1.f, zScale);
+    kdMat4ScaleVEN(&sModelView, 1.f, 1.f, zScale);
 
     for(y = -5; y <= 5; ++y)
     {
         for(x = -5; x <= 5; ++x)
         {
             KDfloat32 buildingScale;
-            Matrix4x4 tmp;
+            KDMat4VEN tmp;
 
             KDint curShape = randomUInt() % SUPERSHAPE_COUNT;
             buildingScale = sSuperShapeParams[curShape][SUPERSHAPE_PARAMS - 1];
-            kdMemcpy(tmp, sModelView, sizeof(sModelView));
-            exampleMatrixTranslate(sModelView, (KDfloat32)(x * translationScale), (KDfloat32)(y * translationScale), 0);
-            exampleMatrixRotate(sModelView, (KDfloat32)(randomUInt() % 360), 0, 0, 1.f);
-            exampleMatrixScale(sModelView, buildingScale, buildingScale, buildingScale);
+            tmp = sModelView;
+            kdMat4TranslateVEN(&sModelView, (KDfloat32)(x * translationScale), (KDfloat32)(y * translationScale), 0);
+            kdMat4RotateVEN(&sModelView, (KDfloat32)(randomUInt() % 360) * KD_DEG_TO_RAD_F, 0, 0, 1.f);
+            kdMat4ScaleVEN(&sModelView, buildingScale, buildingScale, buildingScale);
 
             drawGLObject(sSuperShapeObjects[curShape]);
-            kdMemcpy(sModelView, tmp, sizeof(tmp));
+            sModelView = tmp;
         }
     }
 
@@ -876,101 +871,28 @@ static void drawModels(KDfloat32 zScale)
         const KDint shipScale100 = translationScale * 500;
         const KDint offs100 = x * shipScale100 + (sTick % shipScale100);
         KDfloat32 offs = offs100 * 0.01f;
-        Matrix4x4 tmp;
-        kdMemcpy(tmp, sModelView, sizeof(sModelView));
-        exampleMatrixTranslate(sModelView, offs, -4.f, 2.f);
+        KDMat4VEN tmp = sModelView;
+        kdMat4TranslateVEN(&sModelView, offs, -4.f, 2.f);
         drawGLObject(sSuperShapeObjects[SUPERSHAPE_COUNT - 1]);
-        kdMemcpy(sModelView, tmp, sizeof(tmp));
-        exampleMatrixTranslate(sModelView, -4.f, offs, 4.f);
-        exampleMatrixRotate(sModelView, 90.f, 0, 0, 1.f);
+        sModelView = tmp;
+        kdMat4TranslateVEN(&sModelView, -4.f, offs, 4.f);
+        kdMat4RotateVEN(&sModelView, KD_PI_2_F, 0, 0, 1.f);
         drawGLObject(sSuperShapeObjects[SUPERSHAPE_COUNT - 1]);
-        kdMemcpy(sModelView, tmp, sizeof(tmp));
+        sModelView = tmp;
     }
 }
 
-/* Following gluLookAt implementation is adapted from the
- * Mesa 3D Graphics library. http://www.mesa3d.org
- */
 static void gluLookAt(GLfloat eyex, GLfloat eyey, GLfloat eyez,
     GLfloat centerx, GLfloat centery, GLfloat centerz,
     GLfloat upx, GLfloat upy, GLfloat upz)
 {
-    Matrix4x4 m;
-    GLfloat x[3], y[3], z[3];
-    GLfloat mag;
-
-    /* Make rotation matrix */
-
-    /* Z vector */
-    z[0] = eyex - centerx;
-    z[1] = eyey - centery;
-    z[2] = eyez - centerz;
-    mag = kdSqrtf(z[0] * z[0] + z[1] * z[1] + z[2] * z[2]);
-    if(mag)
-    { /* mpichler, 19950515 */
-        z[0] /= mag;
-        z[1] /= mag;
-        z[2] /= mag;
-    }
-
-    /* Y vector */
-    y[0] = upx;
-    y[1] = upy;
-    y[2] = upz;
-
-    /* X vector = Y cross Z */
-    x[0] = y[1] * z[2] - y[2] * z[1];
-    x[1] = -y[0] * z[2] + y[2] * z[0];
-    x[2] = y[0] * z[1] - y[1] * z[0];
-
-    /* Recompute Y = Z cross X */
-    y[0] = z[1] * x[2] - z[2] * x[1];
-    y[1] = -z[0] * x[2] + z[2] * x[0];
-    y[2] = z[0] * x[1] - z[1] * x[0];
-
-    /* mpichler, 19950515 */
-    /* cross product gives area of parallelogram, which is < 1.0 for
-     * non-perpendicular unit-length vectors; so normalize x, y here
-     */
-
-    mag = kdSqrtf(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
-    if(mag)
-    {
-        x[0] /= mag;
-        x[1] /= mag;
-        x[2] /= mag;
-    }
-
-    mag = kdSqrtf(y[0] * y[0] + y[1] * y[1] + y[2] * y[2]);
-    if(mag)
-    {
-        y[0] /= mag;
-        y[1] /= mag;
-        y[2] /= mag;
-    }
-
-#define M(row, col) m[col * 4 + row]
-    M(0, 0) = x[0];
-    M(0, 1) = x[1];
-    M(0, 2) = x[2];
-    M(0, 3) = 0.0;
-    M(1, 0) = y[0];
-    M(1, 1) = y[1];
-    M(1, 2) = y[2];
-    M(1, 3) = 0.0;
-    M(2, 0) = z[0];
-    M(2, 1) = z[1];
-    M(2, 2) = z[2];
-    M(2, 3) = 0.0;
-    M(3, 0) = 0.0;
-    M(3, 1) = 0.0;
-    M(3, 2) = 0.0;
-    M(3, 3) = 1.0;
-#undef M
-
-    exampleMatrixMultiply(sModelView, m);
-
-    exampleMatrixTranslate(sModelView, -eyex, -eyey, -eyez);
+    KDMat4VEN m;
+    KDVec3VEN eye, center, up;
+    kdVec3SetVEN(&eye, eyex, eyey, eyez);
+    kdVec3SetVEN(&center, centerx, centery, centerz);
+    kdVec3SetVEN(&up, upx, upy, upz);
+    kdMat4LookAtVEN(&m, &eye, &center, &up);
+    kdMat4MultiplyVEN(&sModelView, &sModelView, &m);
 }
 
 static void camTrack()
@@ -1025,7 +947,7 @@ static void camTrack()
  */
 void appRender(Example *example, KDust tick, KDint width, KDint height)
 {
-    Matrix4x4 tmp;
+    KDMat4VEN tmp;
 
     if(sStartTick == 0)
         sStartTick = tick;
@@ -1053,9 +975,9 @@ void appRender(Example *example, KDust tick, KDint width, KDint height)
 
     // Draw the reflection by drawing models with negated Z-axis.
 
-    kdMemcpy(tmp, sModelView, sizeof(sModelView));
+    tmp = sModelView;
     drawModels(-1);
-    kdMemcpy(sModelView, tmp, sizeof(tmp));
+    sModelView = tmp;
 
     // Blend the ground plane to the window.
     drawGroundPlane();
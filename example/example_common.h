@@ -79,22 +79,6 @@ static GLuint exampleLoadTexture(const KDchar *filename);
 static GLuint exampleCreateShader(GLenum type, const KDchar *shadersrc);
 static GLuint exampleCreateProgram(const KDchar *vertexsrc, const KDchar *fragmentsrc, KDboolean link);
 
-/****************************************************************************** 
- * 4x4 Matrix
- ******************************************************************************/
-
-typedef KDfloat32 Matrix4x4[16];
-typedef KDfloat32 Matrix3x3[9];
-static void exampleMatrixCopy(Matrix4x4 dst, Matrix4x4 src);
-static void exampleMatrixFrustum(Matrix4x4 m, KDfloat32 left, KDfloat32 right, KDfloat32 bottom, KDfloat32 top, KDfloat32 _near, KDfloat32 far);
-static void exampleMatrixMultiply(Matrix4x4 m, Matrix4x4 n);
-static void exampleMatrixIdentity(Matrix4x4 m);
-static void exampleMatrixPerspective(Matrix4x4 m, KDfloat32 fovy, KDfloat32 aspect, KDfloat32 nearz, KDfloat32 farz);
-static void exampleMatrixRotate(Matrix4x4 m, KDfloat32 angle, KDfloat32 x, KDfloat32 y, KDfloat32 z);
-static void exampleMatrixScale(Matrix4x4 m, KDfloat32 x, KDfloat32 y, KDfloat32 z);
-static void exampleMatrixTransform(Matrix4x4 m, KDfloat32 *x, KDfloat32 *y, KDfloat32 *z);
-static void exampleMatrixTranslate(Matrix4x4 m, KDfloat32 x, KDfloat32 y, KDfloat32 z);
-
 #ifdef __cplusplus
 }
 #endif
@@ -475,193 +459,5 @@ GLuint exampleCreateProgram(const KDchar *vertexsrc, const KDchar *fragmentsrc,
     return program;
 }
 
-/****************************************************************************** 
- * 4x4 Matrix
- ******************************************************************************/
-/******************************************************************************
- * Copyright 2010 The Chromium Authors. All rights reserved.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions are
- * met:
- *
- *     * Redistributions of source code must retain the above copyright
- *       notice, this list of conditions and the following disclaimer.
- *     * Redistributions in binary form must reproduce the above
- *       copyright notice, this list of conditions and the following disclaimer
- *       in the documentation and/or other materials provided with the
- *       distribution.
- *     * Neither the name of Google Inc. nor the names of its
- *       contributors may be used to endorse or promote products derived from
- *       this software without specific prior written permission.
- * 
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
- * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
- * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
- * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
- * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
- * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
- * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
- * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
- * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
- * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
- * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
- ******************************************************************************/
-
-void exampleMatrixCopy(Matrix4x4 dst, Matrix4x4 src)
-{
-    KDint i;
-    for (i = 0; i < 16; ++i)
-    {
-        dst[i] = src[i];
-    }
-}
-
-void exampleMatrixFrustum(Matrix4x4 m, KDfloat32 left, KDfloat32 right, KDfloat32 bottom, KDfloat32 top, KDfloat32 _near, KDfloat32 _far)
-{
-    KDfloat32 dx = right - left;
-    KDfloat32 dy = top - bottom;
-    KDfloat32 dz = _far - _near;
-    Matrix4x4 frust;
-
-    if (_near <= 0.f || _far <= 0.f || dx <= 0.f || dy <= 0.f || dz <= 0.f)
-    {
-        return;
-    }
-
-    frust[0*4 + 0] = 2.f * _near / dx;
-    frust[0*4 + 1] = 0.f;
-    frust[0*4 + 2] = 0.f;
-    frust[0*4 + 3] = 0.f;
-
-    frust[1*4 + 0] = 0.f;
-    frust[1*4 + 1] = 2.f * _near / dy;
-    frust[1*4 + 2] = 0.f;
-    frust[1*4 + 3] = 0.f;
-
-    frust[2*4 + 0] = (right + left) / dx;
-    frust[2*4 + 1] = (top + bottom) / dy;
-    frust[2*4 + 2] = -(_near + _far) / dz;
-    frust[2*4 + 3] = -1.f;
-
-    frust[3*4 + 0] = 0.f;
-    frust[3*4 + 1] = 0.f;
-    frust[3*4 + 2] = -2.f * _near * _far / dz;
-    frust[3*4 + 3] = 0.f;
-
-    exampleMatrixMultiply(m, frust);
-}
-
-void exampleMatrixMultiply(Matrix4x4 m, Matrix4x4 n)
-{
-    Matrix4x4 tmp;
-    KDint i, j, k;
-    for (i = 0; i < 4; i++)
-    {
-        for (j = 0; j < 4; ++j) 
-        {
-            tmp[i*4 + j] = 0;
-            for (k = 0; k < 4; ++k)
-            {
-                tmp[i*4 + j] += n[i*4 + k] * m[k*4 + j];
-            }
-        }
-    }
-    exampleMatrixCopy(m, tmp);
-}
-
-void exampleMatrixIdentity(Matrix4x4 m)
-{
-    KDint i;
-    for (i = 0; i < 16; ++i)
-    {
-        m[i] = 0;
-    }
-    for (i = 0; i < 4; ++i)
-    {
-        m[i*4 + i] = 1.f;
-    }
-}
-
-void exampleMatrixPerspective(Matrix4x4 m, KDfloat32 fovy, KDfloat32 aspect, KDfloat32 nearz, KDfloat32 farz)
-{
-    KDfloat32 frustumh = kdTanf(fovy / 360.f * KD_PI_F) * nearz;
-    KDfloat32 frustumw = frustumh * aspect;
-
-    exampleMatrixFrustum(m, -frustumw, frustumw, -frustumh, frustumh, nearz, farz);
-}
-
-void exampleMatrixRotate(Matrix4x4 m, KDfloat32 angle, KDfloat32 x, KDfloat32 y, KDfloat32 z)
-{
-    Matrix4x4 rot;
-    KDfloat32 r = angle * KD_PI_F / 180.f;
-    KDfloat32 s = kdSinf(r);
-    KDfloat32 c = kdCosf(r);
-    KDfloat32 one_c = 1.0f - c;
-    KDfloat32 xx, yy, zz, xy, yz, xz, xs, ys, zs;
-    
-    xx = x * x;
-    yy = y * y;
-    zz = z * z;
-    xy = x * y;
-    yz = y * z;
-    xz = x * z;
-    xs = x * s;
-    ys = y * s;
-    zs = z * s;
-
-    rot[0*4 + 0] = xx + (1.f - xx) * c;
-    rot[1*4 + 0] = xy * one_c - zs;
-    rot[2*4 + 0] = xz * one_c + ys;
-    rot[3*4 + 0] = 0.f;
-
-    rot[0*4 + 1] = xy * one_c + zs;
-    rot[1*4 + 1] = yy + (1.f - yy) * c;
-    rot[2*4 + 1] = yz * one_c - xs;
-    rot[3*4 + 1] = 0.f;
-
-    rot[0*4 + 2] = xz * one_c - ys;
-    rot[1*4 + 2] = yz * one_c + xs;
-    rot[2*4 + 2] = zz + (1.f - zz) * c;
-    rot[3*4 + 2] = 0.f;
-
-    rot[0*4 + 3] = 0.f;
-    rot[1*4 + 3] = 0.f;
-    rot[2*4 + 3] = 0.f;
-    rot[3*4 + 3] = 1.f;
-
-    exampleMatrixMultiply(m, rot);
-}
-
-void exampleMatrixScale(Matrix4x4 m, KDfloat32 x, KDfloat32 y, KDfloat32 z)
-{
-    KDint i;
-    for (i = 0; i < 4; ++i)
-    {
-        m[0*4 + i] *= x;
-        m[1*4 + i] *= y;
-        m[2*4 + i] *= z;
-    }
-}
-
-void exampleMatrixTransform(Matrix4x4 m, KDfloat32 *x, KDfloat32 *y, KDfloat32 *z)
-{
-    KDfloat32 tx = m[0*4 + 0] * (*x) + m[1*4 + 0] * (*y) + m[2*4 + 0] * (*z);
-    KDfloat32 ty = m[0*4 + 1] * (*x) + m[1*4 + 1] * (*y) + m[2*4 + 1] * (*z);
-    KDfloat32 tz = m[0*4 + 2] * (*x) + m[1*4 + 2] * (*y) + m[2*4 + 2] * (*z);
-    *x = tx;
-    *y = ty;
-    *z = tz;
-}
-
-void exampleMatrixTranslate(Matrix4x4 m, KDfloat32 x, KDfloat32 y, KDfloat32 z)
-{
-    KDint i;
-    for (i = 0; i < 4; ++i)
-    {
-        m[3*4 + i] += m[0*4 + i] * x + m[1*4 + i] * y + m[2*4 + i] * z;
-    }
-}
-
 #endif // EXAMPLE_COMMON_IMPLEMENTATION
 #endif // EXAMPLE_COMMON_H
\ No newline at end of file
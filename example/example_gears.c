@@ -81,7 +81,7 @@ static GLuint ModelViewProjectionMatrix_location,
     LightSourcePosition_location,
     MaterialColor_location;
 /** The projection matrix */
-static GLfloat ProjectionMatrix[16];
+static KDMat4VEN ProjectionMatrix;
 /** The direction of the directional light for the scene */
 static const GLfloat LightSourcePosition[4] = {5.0, 5.0, 10.0, 1.0};
 
@@ -280,88 +280,6 @@ create_gear(GLfloat inner_radius, GLfloat outer_radius, GLfloat width,
     return gear;
 }
 
-/** 
- * Transposes a 4x4 matrix.
- *
- * @param m the matrix to transpose
- */
-static void
-transpose(GLfloat *m)
-{
-    GLfloat t[16] = {
-        m[0], m[4], m[8], m[12],
-        m[1], m[5], m[9], m[13],
-        m[2], m[6], m[10], m[14],
-        m[3], m[7], m[11], m[15]};
-
-    kdMemcpy(m, t, sizeof(t));
-}
-
-/**
- * Inverts a 4x4 matrix.
- *
- * This function can currently handle only pure translation-rotation matrices.
- * Read http://www.gamedev.net/community/forums/topic.asp?topic_id=425118
- * for an explanation.
- */
-static void
-invert(GLfloat *m)
-{
-    GLfloat t[16];
-    exampleMatrixIdentity(t);
-
-    // Extract and invert the translation part 't'. The inverse of a
-    // translation matrix can be calculated by negating the translation
-    // coordinates.
-    t[12] = -m[12];
-    t[13] = -m[13];
-    t[14] = -m[14];
-
-    // Invert the rotation part 'r'. The inverse of a rotation matrix is
-    // equal to its transpose.
-    m[12] = m[13] = m[14] = 0;
-    transpose(m);
-
-    // inv(m) = inv(r) * inv(t)
-    exampleMatrixMultiply(m, t);
-}
-
-/** 
- * Calculate a perspective projection transformation.
- * 
- * @param m the matrix to save the transformation in
- * @param fovy the field of view in the y direction
- * @param aspect the view aspect ratio
- * @param zNear the near clipping plane
- * @param zFar the far clipping plane
- */
-void perspective(GLfloat *m, GLfloat fovy, GLfloat aspect, GLfloat zNear, GLfloat zFar)
-{
-    GLfloat tmp[16];
-    exampleMatrixIdentity(tmp);
-
-    KDfloat64KHR sine, cosine;
-    GLfloat radians = fovy / 2 * KD_PI_F / 180;
-
-    GLfloat deltaZ = zFar - zNear;
-    sine = kdSinKHR(radians);
-    cosine = kdSinKHR(radians);
-
-    if((deltaZ == 0) || (sine == 0) || (aspect == 0))
-        return;
-
-    GLfloat cotangent = (GLfloat)(cosine / sine);
-
-    tmp[0] = cotangent / aspect;
-    tmp[5] = cotangent;
-    tmp[10] = -(zFar + zNear) / deltaZ;
-    tmp[11] = -1;
-    tmp[14] = -2 * zNear * zFar / deltaZ;
-    tmp[15] = 0;
-
-    kdMemcpy(m, tmp, sizeof(tmp));
-}
-
 /**
  * Draws a gear.
  *
@@ -373,33 +291,31 @@ void perspective(GLfloat *m, GLfloat fovy, GLfloat aspect, GLfloat zNear, GLfloa
  * @param color the color of the gear
  */
 static void
-draw_gear(struct gear *gear, GLfloat *transform,
+draw_gear(struct gear *gear, const KDMat4VEN *transform,
     GLfloat x, GLfloat y, GLfloat angle, const GLfloat color[4])
 {
-    GLfloat model_view[16];
-    GLfloat normal_matrix[16];
-    GLfloat model_view_projection[16];
+    KDMat4VEN model_view;
+    KDMat4VEN normal_matrix;
+    KDMat4VEN model_view_projection;
 
     /* Translate and rotate the gear */
-    kdMemcpy(model_view, transform, sizeof(model_view));
-    exampleMatrixTranslate(model_view, x, y, 0);
-    exampleMatrixRotate(model_view, angle, 0, 0, 1);
+    model_view = *transform;
+    kdMat4TranslateVEN(&model_view, x, y, 0);
+    kdMat4RotateVEN(&model_view, angle * KD_DEG_TO_RAD_F, 0, 0, 1);
 
     /* Create and set the ModelViewProjectionMatrix */
-    kdMemcpy(model_view_projection, ProjectionMatrix, sizeof(model_view_projection));
-    exampleMatrixMultiply(model_view_projection, model_view);
+    kdMat4MultiplyVEN(&model_view_projection, &ProjectionMatrix, &model_view);
 
     glUniformMatrix4fv(ModelViewProjectionMatrix_location, 1, GL_FALSE,
-        model_view_projection);
+        model_view_projection.m);
 
     /* 
     * Create and set the NormalMatrix. It's the inverse transpose of the
     * ModelView matrix.
     */
-    kdMemcpy(normal_matrix, model_view, sizeof(normal_matrix));
-    invert(normal_matrix);
-    transpose(normal_matrix);
-    glUniformMatrix4fv(NormalMatrix_location, 1, GL_FALSE, normal_matrix);
+    kdMat4InverseVEN(&normal_matrix, &model_view);
+    kdMat4TransposeVEN(&normal_matrix, &normal_matrix);
+    glUniformMatrix4fv(NormalMatrix_location, 1, GL_FALSE, normal_matrix.m);
 
     /* Set the gear color */
     glUniform4fv(MaterialColor_location, 1, color);
@@ -436,22 +352,21 @@ gears_draw(GLfloat angle)
     const static GLfloat red[4] = {0.8f, 0.1f, 0.0f, 1.0f};
     const static GLfloat green[4] = {0.0f, 0.8f, 0.2f, 1.0f};
     const static GLfloat blue[4] = {0.2f, 0.2f, 1.0f, 1.0f};
-    GLfloat transform[16];
-    exampleMatrixIdentity(transform);
+    KDMat4VEN transform;
 
     glClearColor(0.0, 0.0, 0.0, 0.0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     /* Translate and rotate the view */
-    exampleMatrixTranslate(transform, 0, 0, -20);
-    exampleMatrixRotate(transform, view_rot[0], 1, 0, 0);
-    exampleMatrixRotate(transform, view_rot[1], 0, 1, 0);
-    exampleMatrixRotate(transform, view_rot[2], 0, 0, 1);
+    kdMat4TranslationVEN(&transform, 0, 0, -20);
+    kdMat4RotateVEN(&transform, view_rot[0] * KD_DEG_TO_RAD_F, 1, 0, 0);
+    kdMat4RotateVEN(&transform, view_rot[1] * KD_DEG_TO_RAD_F, 0, 1, 0);
+    kdMat4RotateVEN(&transform, view_rot[2] * KD_DEG_TO_RAD_F, 0, 0, 1);
 
     /* Draw the gears */
-    draw_gear(gear1, transform, -3.0f, -2.0f, angle, red);
-    draw_gear(gear2, transform, 3.1f, -2.0f, -2 * angle - 9.0f, green);
-    draw_gear(gear3, transform, -3.1f, 4.2f, -2 * angle - 25.0f, blue);
+    draw_gear(gear1, &transform, -3.0f, -2.0f, angle, red);
+    draw_gear(gear2, &transform, 3.1f, -2.0f, -2 * angle - 9.0f, green);
+    draw_gear(gear3, &transform, -3.1f, 4.2f, -2 * angle - 25.0f, blue);
 }
 
 /** 
@@ -464,8 +379,7 @@ static void
 gears_reshape(KDint width, KDint height)
 {
     /* Update the projection matrix */
-    exampleMatrixIdentity(ProjectionMatrix);
-    exampleMatrixPerspective(ProjectionMatrix, 60.0, (KDfloat32)width / height, 1.0, 1024.0);
+    kdMat4PerspectiveVEN(&ProjectionMatrix, 60.0f * KD_DEG_TO_RAD_F, (KDfloat32)width / height, 1.0f, 1024.0f);
 
     /* Set the viewport */
     glViewport(0, 0, (GLint)width, (GLint)height);
@@ -205,23 +205,13 @@ void render(KDint w, KDint h)
 	fAngle += 0.01f;
 
 	// Rotate and translate the model view matrix
-	KDfloat32 matModelView[16] = {0};
-	matModelView[ 0] = +kdCosf( fAngle );
-	matModelView[ 2] = +kdSinf( fAngle );
-	matModelView[ 5] = 1.0f;
-	matModelView[ 8] = -kdSinf( fAngle );
-	matModelView[10] = +kdCosf( fAngle );
-	matModelView[12] = 0.0f; //X
-	matModelView[14] = -6.0f; //z
-	matModelView[15] = 1.0f;
+	KDMat4VEN matModelView;
+	kdMat4TranslationVEN( &matModelView, 0.0f, 0.0f, -6.0f );
+	kdMat4RotateVEN( &matModelView, -fAngle, 0.0f, 1.0f, 0.0f );
 
 	// Build a perspective projection matrix
-	KDfloat32 matProj[16] = {0};
-	matProj[ 0] = kdCosf( 0.5f ) / kdSinf( 0.5f );
-	matProj[ 5] = matProj[0] * (w/h) ;
-	matProj[10] = -( 10.0f ) / ( 9.0f );
-	matProj[11] = -1.0f;
-	matProj[14] = -( 10.0f ) / ( 9.0f );
+	KDMat4VEN matProj;
+	kdMat4PerspectiveVEN( &matProj, 1.0f, (KDfloat32)w / (KDfloat32)h, 10.0f / 19.0f, 10.0f );
 
 	// Clear the colorbuffer and depth-buffer
 	glClearColor( 0.0f, 0.0f, 0.5f, 1.0f );
@@ -234,8 +224,8 @@ void render(KDint w, KDint h)
 
 	// Set the shader program
 	glUseProgram( g_hShaderProgram );
-	glUniformMatrix4fv( g_hModelViewMatrixLoc, 1, 0, matModelView );
-	glUniformMatrix4fv( g_hProjMatrixLoc,      1, 0, matProj );
+	glUniformMatrix4fv( g_hModelViewMatrixLoc, 1, 0, matModelView.m );
+	glUniformMatrix4fv( g_hProjMatrixLoc,      1, 0, matProj.m );
 
 	// Bind the vertex attributes
 	glBindBuffer(GL_ARRAY_BUFFER, g_hVertexBuf);
@@ -0,0 +1,43 @@
+
+
+/*******************************************************
+ * OpenKODE Core extension: VEN_fiber
+ *******************************************************/
+
+#ifndef __kd_VEN_fiber_h_
+#define __kd_VEN_fiber_h_
+#include <KD/kd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct KDFiberVEN KDFiberVEN;
+typedef void (KD_APIENTRY KDFiberFuncVEN)(void *arg);
+
+/* kdFiberCreateVEN: Create a fiber on the calling thread, running func on a pooled stack of at least stacksize bytes. 0 picks the default size. */
+KD_API KDFiberVEN *KD_APIENTRY kdFiberCreateVEN(KDsize stacksize, KDFiberFuncVEN *func, void *arg);
+
+/* kdFiberFreeVEN: Free a fiber that is not running, its stack goes back to the pool. */
+KD_API KDint KD_APIENTRY kdFiberFreeVEN(KDFiberVEN *fiber);
+
+/* kdFiberSwitchVEN: Suspend the calling fiber or thread and resume fiber, returns once control comes back. */
+KD_API KDint KD_APIENTRY kdFiberSwitchVEN(KDFiberVEN *fiber);
+
+/* kdFiberYieldVEN: Suspend the calling fiber and resume the one that switched to it. */
+KD_API KDint KD_APIENTRY kdFiberYieldVEN(void);
+
+/* kdFiberSelfVEN: The running fiber, KD_NULL on the thread's own stack. */
+KD_API KDFiberVEN *KD_APIENTRY kdFiberSelfVEN(void);
+
+/* kdFiberIsFinishedVEN: Check if the function of a fiber returned. */
+KD_API KDboolean KD_APIENTRY kdFiberIsFinishedVEN(const KDFiberVEN *fiber);
+
+/* kdFiberWaitEventVEN: Suspend the calling fiber until kdPumpEvents on its thread sees an event matching type and userptr. Type 0 matches any type. The event stays valid until the fiber suspends again. */
+KD_API const KDEvent *KD_APIENTRY kdFiberWaitEventVEN(KDint32 type, void *userptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __kd_VEN_fiber_h_ */
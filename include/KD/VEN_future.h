@@ -0,0 +1,55 @@
+
+
+/*******************************************************
+ * OpenKODE Core extension: VEN_future
+ *******************************************************/
+
+#ifndef __kd_VEN_future_h_
+#define __kd_VEN_future_h_
+#include <KD/kd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct KDFutureVEN KDFutureVEN;
+typedef void (KD_APIENTRY KDFutureFuncVEN)(KDFutureVEN *future, void *arg);
+
+/* kdFutureCreateVEN: Create a pending future, completed by kdFutureSetValueVEN or kdFutureSetErrorVEN. */
+KD_API KDFutureVEN *KD_APIENTRY kdFutureCreateVEN(void);
+
+/* kdFutureFreeVEN: Release a future, scheduled continuations keep it alive until they ran. */
+KD_API KDint KD_APIENTRY kdFutureFreeVEN(KDFutureVEN *future);
+
+/* kdFutureSetValueVEN: Complete a future with a value and schedule its continuations. */
+KD_API KDint KD_APIENTRY kdFutureSetValueVEN(KDFutureVEN *future, void *value);
+
+/* kdFutureSetErrorVEN: Complete a future with a KD error code and schedule its continuations. */
+KD_API KDint KD_APIENTRY kdFutureSetErrorVEN(KDFutureVEN *future, KDint error);
+
+/* kdFutureIsReadyVEN: Check if a future is complete. */
+KD_API KDboolean KD_APIENTRY kdFutureIsReadyVEN(KDFutureVEN *future);
+
+/* kdFutureWaitVEN: Block until a future is complete or timeout nanoseconds passed, -1 waits forever. */
+KD_API KDint KD_APIENTRY kdFutureWaitVEN(KDFutureVEN *future, KDust timeout);
+
+/* kdFutureGetVEN: Value of a complete future, KD_NULL and the error is set if it failed or is pending. */
+KD_API void *KD_APIENTRY kdFutureGetVEN(KDFutureVEN *future);
+
+/* kdFutureGetErrorVEN: Error a future completed with, 0 on success or while pending. */
+KD_API KDint KD_APIENTRY kdFutureGetErrorVEN(KDFutureVEN *future);
+
+/* kdFutureThenVEN: Call func once a future is complete. With thread KD_NULL it runs on the completing thread, otherwise in kdPumpEvents of thread. */
+KD_API KDint KD_APIENTRY kdFutureThenVEN(KDFutureVEN *future, KDThread *thread, KDFutureFuncVEN *func, void *arg);
+
+/* kdFutureWhenAllVEN: Future completing after all futures, with the first error if any of them failed. */
+KD_API KDFutureVEN *KD_APIENTRY kdFutureWhenAllVEN(KDFutureVEN *const *futures, KDsize count);
+
+/* kdFutureWhenAnyVEN: Future completing with the first of futures to complete as its value. */
+KD_API KDFutureVEN *KD_APIENTRY kdFutureWhenAnyVEN(KDFutureVEN *const *futures, KDsize count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __kd_VEN_future_h_ */
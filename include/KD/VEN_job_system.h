@@ -0,0 +1,64 @@
+
+/*******************************************************
+ * OpenKODE Core extension: VEN_job_system
+ *******************************************************/
+
+#ifndef __kd_VEN_job_system_h_
+#define __kd_VEN_job_system_h_
+#include <KD/kd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct KDJobSystemVEN KDJobSystemVEN;
+typedef struct KDJobCounterVEN KDJobCounterVEN;
+typedef void (KD_APIENTRY KDJobFuncVEN)(void *arg);
+
+/* KD_EVENT_JOB_COMPLETE_VEN: Posted by kdJobNotifyVEN, data.user.value1.p is the counter. */
+#define KD_EVENT_JOB_COMPLETE_VEN 1000
+
+/* kdJobSystemCreateVEN: Create a job system with one worker per processor if workers is 0. */
+KD_API KDJobSystemVEN *KD_APIENTRY kdJobSystemCreateVEN(KDint workers);
+
+/* kdJobSystemFreeVEN: Run the queued jobs and stop the workers. */
+KD_API KDint KD_APIENTRY kdJobSystemFreeVEN(KDJobSystemVEN *system);
+
+/* kdJobSystemGetWorkerCountVEN: Number of worker threads. */
+KD_API KDint KD_APIENTRY kdJobSystemGetWorkerCountVEN(KDJobSystemVEN *system);
+
+/* kdJobCounterCreateVEN: Create a counter tracking unfinished jobs. */
+KD_API KDJobCounterVEN *KD_APIENTRY kdJobCounterCreateVEN(void);
+
+/* kdJobCounterFreeVEN: Free a counter, its jobs have to be finished. */
+KD_API KDint KD_APIENTRY kdJobCounterFreeVEN(KDJobCounterVEN *counter);
+
+/* kdJobCounterGetVEN: Number of unfinished jobs. */
+KD_API KDint KD_APIENTRY kdJobCounterGetVEN(KDJobCounterVEN *counter);
+
+/* kdJobSubmitVEN: Queue a job, counter and dependency may be KD_NULL. The job starts once dependency reaches zero. */
+KD_API KDint KD_APIENTRY kdJobSubmitVEN(KDJobSystemVEN *system, KDJobFuncVEN *func, void *arg, KDJobCounterVEN *counter, KDJobCounterVEN *dependency);
+
+/* kdJobWaitVEN: Run queued jobs until counter reaches zero. */
+KD_API KDint KD_APIENTRY kdJobWaitVEN(KDJobSystemVEN *system, KDJobCounterVEN *counter);
+
+/* kdJobNotifyVEN: Post KD_EVENT_JOB_COMPLETE_VEN to the calling thread once counter reaches zero. */
+KD_API KDint KD_APIENTRY kdJobNotifyVEN(KDJobCounterVEN *counter, void *eventuserptr);
+
+/* kdJobSystemGetDefaultVEN: Shared job system, created on first use and used by the parallel loops. */
+KD_API KDJobSystemVEN *KD_APIENTRY kdJobSystemGetDefaultVEN(void);
+
+/* kdParallelForVEN: Call func for subranges of [begin, end), at least grain indices long. grain 0 picks a size. */
+typedef void (KD_APIENTRY KDParallelForFuncVEN)(KDint64 begin, KDint64 end, void *ctx);
+KD_API KDint KD_APIENTRY kdParallelForVEN(KDint64 begin, KDint64 end, KDint64 grain, KDParallelForFuncVEN *func, void *ctx);
+
+/* kdParallelReduceVEN: Accumulate subranges into partial results of size bytes and join them into result in order. Partial results start as copies of result, which has to hold the identity. */
+typedef void (KD_APIENTRY KDParallelReduceFuncVEN)(KDint64 begin, KDint64 end, void *partial, void *ctx);
+typedef void (KD_APIENTRY KDParallelJoinFuncVEN)(void *result, const void *partial, void *ctx);
+KD_API KDint KD_APIENTRY kdParallelReduceVEN(KDint64 begin, KDint64 end, KDint64 grain, KDParallelReduceFuncVEN *func, KDParallelJoinFuncVEN *join, void *result, KDsize size, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __kd_VEN_job_system_h_ */
@@ -0,0 +1,103 @@
+
+/*******************************************************
+ * OpenKODE Core extension: VEN_vecmath
+ *******************************************************/
+
+#ifndef __kd_VEN_vecmath_h_
+#define __kd_VEN_vecmath_h_
+#include <KD/kd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Matrices are column-major (OpenGL layout), angles are in radians. */
+
+#if defined(_MSC_VER)
+#define KD_ALIGN16_VEN __declspec(align(16))
+#elif defined(__GNUC__) || defined(__clang__) || defined(__TINYC__)
+#define KD_ALIGN16_VEN __attribute__((__aligned__(16)))
+#else
+#define KD_ALIGN16_VEN
+#endif
+
+/* The pad lane keeps KDVec3VEN at 16 bytes; its value is unspecified. */
+typedef struct KDVec3VEN {
+    KD_ALIGN16_VEN KDfloat32 x;
+    KDfloat32 y;
+    KDfloat32 z;
+    KDfloat32 pad;
+} KDVec3VEN;
+
+typedef struct KDVec4VEN {
+    KD_ALIGN16_VEN KDfloat32 x;
+    KDfloat32 y;
+    KDfloat32 z;
+    KDfloat32 w;
+} KDVec4VEN;
+
+typedef struct KDQuatVEN {
+    KD_ALIGN16_VEN KDfloat32 x;
+    KDfloat32 y;
+    KDfloat32 z;
+    KDfloat32 w;
+} KDQuatVEN;
+
+typedef struct KDMat4VEN {
+    KD_ALIGN16_VEN KDfloat32 m[16];
+} KDMat4VEN;
+
+/* Vectors */
+KD_API void KD_APIENTRY kdVec3SetVEN(KDVec3VEN *out, KDfloat32 x, KDfloat32 y, KDfloat32 z);
+KD_API void KD_APIENTRY kdVec3AddVEN(KDVec3VEN *out, const KDVec3VEN *a, const KDVec3VEN *b);
+KD_API void KD_APIENTRY kdVec3SubVEN(KDVec3VEN *out, const KDVec3VEN *a, const KDVec3VEN *b);
+KD_API void KD_APIENTRY kdVec3ScaleVEN(KDVec3VEN *out, const KDVec3VEN *v, KDfloat32 s);
+KD_API KDfloat32 KD_APIENTRY kdVec3DotVEN(const KDVec3VEN *a, const KDVec3VEN *b);
+KD_API void KD_APIENTRY kdVec3CrossVEN(KDVec3VEN *out, const KDVec3VEN *a, const KDVec3VEN *b);
+KD_API KDfloat32 KD_APIENTRY kdVec3LengthVEN(const KDVec3VEN *v);
+KD_API void KD_APIENTRY kdVec3NormalizeVEN(KDVec3VEN *out, const KDVec3VEN *v);
+
+KD_API void KD_APIENTRY kdVec4SetVEN(KDVec4VEN *out, KDfloat32 x, KDfloat32 y, KDfloat32 z, KDfloat32 w);
+KD_API void KD_APIENTRY kdVec4AddVEN(KDVec4VEN *out, const KDVec4VEN *a, const KDVec4VEN *b);
+KD_API void KD_APIENTRY kdVec4SubVEN(KDVec4VEN *out, const KDVec4VEN *a, const KDVec4VEN *b);
+KD_API void KD_APIENTRY kdVec4ScaleVEN(KDVec4VEN *out, const KDVec4VEN *v, KDfloat32 s);
+KD_API KDfloat32 KD_APIENTRY kdVec4DotVEN(const KDVec4VEN *a, const KDVec4VEN *b);
+
+/* Matrix builders */
+KD_API void KD_APIENTRY kdMat4IdentityVEN(KDMat4VEN *out);
+KD_API void KD_APIENTRY kdMat4TranslationVEN(KDMat4VEN *out, KDfloat32 x, KDfloat32 y, KDfloat32 z);
+KD_API void KD_APIENTRY kdMat4ScalingVEN(KDMat4VEN *out, KDfloat32 x, KDfloat32 y, KDfloat32 z);
+KD_API void KD_APIENTRY kdMat4RotationVEN(KDMat4VEN *out, KDfloat32 angle, KDfloat32 x, KDfloat32 y, KDfloat32 z);
+KD_API void KD_APIENTRY kdMat4FrustumVEN(KDMat4VEN *out, KDfloat32 left, KDfloat32 right, KDfloat32 bottom, KDfloat32 top, KDfloat32 nearz, KDfloat32 farz);
+KD_API void KD_APIENTRY kdMat4PerspectiveVEN(KDMat4VEN *out, KDfloat32 fovy, KDfloat32 aspect, KDfloat32 nearz, KDfloat32 farz);
+KD_API void KD_APIENTRY kdMat4OrthoVEN(KDMat4VEN *out, KDfloat32 left, KDfloat32 right, KDfloat32 bottom, KDfloat32 top, KDfloat32 nearz, KDfloat32 farz);
+KD_API void KD_APIENTRY kdMat4LookAtVEN(KDMat4VEN *out, const KDVec3VEN *eye, const KDVec3VEN *center, const KDVec3VEN *up);
+KD_API void KD_APIENTRY kdMat4FromQuatVEN(KDMat4VEN *out, const KDQuatVEN *q);
+
+/* Matrix operations (out may alias any input) */
+KD_API void KD_APIENTRY kdMat4MultiplyVEN(KDMat4VEN *out, const KDMat4VEN *a, const KDMat4VEN *b);
+KD_API void KD_APIENTRY kdMat4TransposeVEN(KDMat4VEN *out, const KDMat4VEN *m);
+KD_API KDint KD_APIENTRY kdMat4InverseVEN(KDMat4VEN *out, const KDMat4VEN *m);
+KD_API void KD_APIENTRY kdMat4TranslateVEN(KDMat4VEN *m, KDfloat32 x, KDfloat32 y, KDfloat32 z);
+KD_API void KD_APIENTRY kdMat4RotateVEN(KDMat4VEN *m, KDfloat32 angle, KDfloat32 x, KDfloat32 y, KDfloat32 z);
+KD_API void KD_APIENTRY kdMat4ScaleVEN(KDMat4VEN *m, KDfloat32 x, KDfloat32 y, KDfloat32 z);
+
+/* Transformations */
+KD_API void KD_APIENTRY kdMat4TransformVec4VEN(KDVec4VEN *out, const KDMat4VEN *m, const KDVec4VEN *v);
+KD_API void KD_APIENTRY kdMat4TransformVec4ArrayVEN(KDVec4VEN *out, const KDMat4VEN *m, const KDVec4VEN *in, KDsize count);
+KD_API void KD_APIENTRY kdMat4TransformPointsVEN(KDVec3VEN *out, const KDMat4VEN *m, const KDVec3VEN *in, KDsize count);
+KD_API void KD_APIENTRY kdMat4TransformNormalsVEN(KDVec3VEN *out, const KDMat4VEN *m, const KDVec3VEN *in, KDsize count);
+
+/* Quaternions */
+KD_API void KD_APIENTRY kdQuatIdentityVEN(KDQuatVEN *out);
+KD_API void KD_APIENTRY kdQuatFromAxisAngleVEN(KDQuatVEN *out, const KDVec3VEN *axis, KDfloat32 angle);
+KD_API void KD_APIENTRY kdQuatMultiplyVEN(KDQuatVEN *out, const KDQuatVEN *a, const KDQuatVEN *b);
+KD_API void KD_APIENTRY kdQuatNormalizeVEN(KDQuatVEN *out, const KDQuatVEN *q);
+KD_API void KD_APIENTRY kdQuatSlerpVEN(KDQuatVEN *out, const KDQuatVEN *a, const KDQuatVEN *b, KDfloat32 t);
+KD_API void KD_APIENTRY kdQuatRotateVec3VEN(KDVec3VEN *out, const KDQuatVEN *q, const KDVec3VEN *v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __kd_VEN_vecmath_h_ */
@@ -35,6 +35,10 @@
 #include <KD/KHR_thread_storage.h>
 #include <KD/NV_extwindowprops.h>
 #include <KD/VEN_atomic_ops.h>
+#include <KD/VEN_fiber.h>
+#include <KD/VEN_future.h>
+#include <KD/VEN_job_system.h>
+#include <KD/VEN_vecmath.h>
 
 #define KD_ATX_dxtcomp 1
 #define KD_ATX_imgdec 1
@@ -47,6 +51,10 @@
 #define KD_KHR_thread_storage 1
 #define KD_NV_extwindowprops 1
 #define KD_VEN_atomic_ops 1
+#define KD_VEN_fiber 1
+#define KD_VEN_future 1
+#define KD_VEN_job_system 1
+#define KD_VEN_vecmath 1
 
 /*******************************************************
  * Errors (extensions)
@@ -60,10 +68,138 @@ KD_API void KD_APIENTRY kdSetErrorPlatformVEN(KDint error, KDint allowed);
 
 /* kdThreadAttrSetDebugNameVEN: Set debugname attribute. */
 KD_API KDint KD_APIENTRY kdThreadAttrSetDebugNameVEN(KDThreadAttr *attr, const char * debugname);
+
+/* kdThreadAttrSetAffinityVEN: Set the processors a thread may run on, bit n of the words is processor id n. */
+KD_API KDint KD_APIENTRY kdThreadAttrSetAffinityVEN(KDThreadAttr *attr, const KDuint64 *mask, KDint words);
+
+/* kdThreadAttrSetSchedulingVEN: Set scheduling policy and priority. */
+/* Normal priority is a nice value from -20 to 19, realtime priority from 1 to 99 (SCHED_FIFO where permitted, the best allowed nice value otherwise). */
+#define KD_THREAD_SCHED_NORMAL_VEN 0
+#define KD_THREAD_SCHED_REALTIME_VEN 1
+KD_API KDint KD_APIENTRY kdThreadAttrSetSchedulingVEN(KDThreadAttr *attr, KDint policy, KDint priority);
+
+/* kdThreadAttrSetNumaNodeVEN: Prefer memory and processors of a NUMA node, -1 for none. */
+KD_API KDint KD_APIENTRY kdThreadAttrSetNumaNodeVEN(KDThreadAttr *attr, KDint node);
  
+/* kdThreadMutexTryLockVEN: Lock a mutex, failing with KD_EBUSY if it is held. */
+KD_API KDint KD_APIENTRY kdThreadMutexTryLockVEN(KDThreadMutex *mutex);
+
+/* kdThreadCondTimedWaitVEN: Wait for a condition variable, failing with KD_ETIMEDOUT at deadline (kdGetTimeUST). */
+KD_API KDint KD_APIENTRY kdThreadCondTimedWaitVEN(KDThreadCond *cond, KDThreadMutex *mutex, KDust deadline);
+
+/* kdThreadSemTryWaitVEN: Lock a semaphore, failing with KD_EBUSY if its value is zero. */
+KD_API KDint KD_APIENTRY kdThreadSemTryWaitVEN(KDThreadSem *sem);
+
+/* kdThreadSemTimedWaitVEN: Lock a semaphore, failing with KD_ETIMEDOUT at deadline (kdGetTimeUST). */
+KD_API KDint KD_APIENTRY kdThreadSemTimedWaitVEN(KDThreadSem *sem, KDust deadline);
+
+/* kdGetCpuTopologyVEN: Query the processor topology and describe up to count processors. */
+typedef struct KDCpuTopologyVEN {
+    KDint processors;    /* Online logical processors */
+    KDint cores;         /* Physical cores */
+    KDint packages;
+    KDint nodes;         /* NUMA nodes */
+    KDint cachelinesize; /* Cache sizes in bytes, 0 if unknown */
+    KDint l1cachesize;
+    KDint l2cachesize;
+    KDint l3cachesize;
+} KDCpuTopologyVEN;
+typedef struct KDCpuVEN {
+    KDint id;      /* Processor id used in affinity masks */
+    KDint core;    /* Physical core from 0 to cores - 1 */
+    KDint package;
+    KDint node;
+    KDint smt;     /* Index among the hardware threads of its core */
+} KDCpuVEN;
+KD_API KDint KD_APIENTRY kdGetCpuTopologyVEN(KDCpuTopologyVEN *topology, KDCpuVEN *cpus, KDint count);
+
 /* kdThreadSleepVEN: Blocks the current thread for nanoseconds. */
 KD_API KDint KD_APIENTRY kdThreadSleepVEN(KDust timeout);
 
+/* kdThreadSleepUntilVEN: Blocks the current thread until an absolute UST. */
+KD_API KDint KD_APIENTRY kdThreadSleepUntilVEN(KDust deadline);
+
+/* kdThreadSleepUntilPreciseVEN: Sleeps, then spins the remainder to an absolute UST. */
+KD_API KDint KD_APIENTRY kdThreadSleepUntilPreciseVEN(KDust deadline);
+
+/* kdThreadRWLockCreateVEN: Create a reader-writer lock, waiting writers go before new readers. */
+typedef struct KDThreadRWLockVEN KDThreadRWLockVEN;
+KD_API KDThreadRWLockVEN *KD_APIENTRY kdThreadRWLockCreateVEN(void);
+
+/* kdThreadRWLockFreeVEN: Free a reader-writer lock. */
+KD_API KDint KD_APIENTRY kdThreadRWLockFreeVEN(KDThreadRWLockVEN *rwlock);
+
+/* kdThreadRWLockReadLockVEN, kdThreadRWLockReadUnlockVEN: Shared access, not recursive. */
+KD_API KDint KD_APIENTRY kdThreadRWLockReadLockVEN(KDThreadRWLockVEN *rwlock);
+KD_API KDint KD_APIENTRY kdThreadRWLockReadUnlockVEN(KDThreadRWLockVEN *rwlock);
+
+/* kdThreadRWLockWriteLockVEN, kdThreadRWLockWriteUnlockVEN: Exclusive access. */
+KD_API KDint KD_APIENTRY kdThreadRWLockWriteLockVEN(KDThreadRWLockVEN *rwlock);
+KD_API KDint KD_APIENTRY kdThreadRWLockWriteUnlockVEN(KDThreadRWLockVEN *rwlock);
+
+/* kdThreadBarrierCreateVEN: Create a reusable barrier for count threads. */
+typedef struct KDThreadBarrierVEN KDThreadBarrierVEN;
+KD_API KDThreadBarrierVEN *KD_APIENTRY kdThreadBarrierCreateVEN(KDuint count);
+
+/* kdThreadBarrierFreeVEN: Free a barrier. */
+KD_API KDint KD_APIENTRY kdThreadBarrierFreeVEN(KDThreadBarrierVEN *barrier);
+
+/* kdThreadBarrierWaitVEN: Wait for all threads, one of them gets KD_THREAD_BARRIER_SERIAL_VEN. */
+#define KD_THREAD_BARRIER_SERIAL_VEN 1
+KD_API KDint KD_APIENTRY kdThreadBarrierWaitVEN(KDThreadBarrierVEN *barrier);
+
+/* kdThreadLatchCreateVEN: Create a single-use latch counting down from count. */
+typedef struct KDThreadLatchVEN KDThreadLatchVEN;
+KD_API KDThreadLatchVEN *KD_APIENTRY kdThreadLatchCreateVEN(KDuint count);
+
+/* kdThreadLatchFreeVEN: Free a latch. */
+KD_API KDint KD_APIENTRY kdThreadLatchFreeVEN(KDThreadLatchVEN *latch);
+
+/* kdThreadLatchCountDownVEN: Decrement a latch, releasing all waiters at zero. */
+KD_API KDint KD_APIENTRY kdThreadLatchCountDownVEN(KDThreadLatchVEN *latch);
+
+/* kdThreadLatchWaitVEN: Wait until a latch reached zero. */
+KD_API KDint KD_APIENTRY kdThreadLatchWaitVEN(KDThreadLatchVEN *latch);
+
+/* kdSetThreadStorageDestructorVEN: Set a function called with the value of a key on thread exit. */
+KD_API KDint KD_APIENTRY kdSetThreadStorageDestructorVEN(KDThreadStorageKeyKHR key, void(KD_APIENTRY *destructor)(void *));
+
+/*******************************************************
+ * Events (extensions)
+ *******************************************************/
+
+/* Priority lanes of a thread's event queue, kdWaitEvent serves higher lanes first. */
+/* Events go to a lane by type: quit, pause, resume, orientation, state and window changes to system, */
+/* input to input, timers, sockets and name lookups to timer, everything else to user. */
+#define KD_EVENT_PRIORITY_SYSTEM_VEN 0
+#define KD_EVENT_PRIORITY_INPUT_VEN 1
+#define KD_EVENT_PRIORITY_TIMER_VEN 2
+#define KD_EVENT_PRIORITY_USER_VEN 3
+
+/* kdPostThreadEventPriorityVEN: Post an event into a priority lane of a thread's queue. */
+KD_API KDint KD_APIENTRY kdPostThreadEventPriorityVEN(KDEvent *event, KDThread *thread, KDint priority);
+
+/* kdPostEventAtVEN, kdPostThreadEventAtVEN: Post an event for delivery once a deadline in kdGetTimeUST time passed. */
+/* The receiving thread keeps scheduled events in a heap and delivers them from kdWaitEvent and kdPumpEvents, no timer thread is involved. */
+KD_API KDint KD_APIENTRY kdPostEventAtVEN(KDEvent *event, KDust deadline);
+KD_API KDint KD_APIENTRY kdPostThreadEventAtVEN(KDEvent *event, KDThread *thread, KDust deadline);
+
+/* kdEventTraceStartVEN, kdEventTraceStopVEN: Record the events delivered to the calling thread to a file. */
+/* Covers events returned by kdWaitEvent and events taken by callbacks or waiting fibers. */
+KD_API KDint KD_APIENTRY kdEventTraceStartVEN(const KDchar *pathname);
+KD_API KDint KD_APIENTRY kdEventTraceStopVEN(void);
+
+/* kdEventTraceReplayVEN: Post the events of a recorded trace to a thread, returns the number of events. */
+/* Gaps between events are divided by speed, zero or less posts all of them at once in recorded order. */
+KD_API KDint KD_APIENTRY kdEventTraceReplayVEN(const KDchar *pathname, KDThread *thread, KDfloat32 speed);
+
+/* kdSetEventCoalescingVEN: Merge consecutive pointer motion or property change events of a window. */
+/* Applies to KD_EVENT_INPUT_POINTER motion and KD_EVENT_WINDOWPROPERTY_CHANGE on the calling thread, off by default. */
+KD_API KDint KD_APIENTRY kdSetEventCoalescingVEN(KDint32 eventtype, KDboolean enable);
+
+/* kdGetEventCoalescedCountVEN: Number of events of a type merged away on this thread. */
+KD_API KDuint64 KD_APIENTRY kdGetEventCoalescedCountVEN(KDint32 eventtype);
+
 /*******************************************************
  * Utility library functions (extensions)
  *******************************************************/
@@ -86,6 +222,16 @@ KD_API KDint KD_APIENTRY kdMaxVEN(KDint a, KDint b);
 /* kdMinVEN: Returns the smaller of the given values. */
 KD_API KDint KD_APIENTRY kdMinVEN(KDint a, KDint b);
 
+/* kdStrtollVEN: Convert a string to a 64-bit integer. */
+KD_API KDint64 KD_APIENTRY kdStrtollVEN(const KDchar *nptr, KDchar **endptr, KDint base);
+
+/* kdLltostrVEN: Convert a 64-bit integer to a string. */
+#define KD_LLTOSTR_MAXLEN_VEN 21
+KD_API KDssize KD_APIENTRY kdLltostrVEN(KDchar *buffer, KDsize buflen, KDint64 number);
+
+/* kdFtostrArrayVEN: Convert an array of floats to a string, separated by separator. */
+KD_API KDssize KD_APIENTRY kdFtostrArrayVEN(KDchar *buffer, KDsize buflen, const KDfloat32 *numbers, KDsize count, KDchar separator);
+
 /* kdGetEnvVEN: Get an environment variable. */
 KD_API KDchar *KD_APIENTRY kdGetEnvVEN(const KDchar *env);
 
@@ -115,12 +261,64 @@ KD_API KDsize KD_APIENTRY kdStrcspnVEN(const KDchar *str1, const KDchar *str2);
 /* kdStrdupVEN:  Duplicate a string. */
 KD_API KDchar* KD_APIENTRY kdStrdupVEN(const KDchar *str);
 
+/*******************************************************
+ * Logging (extensions)
+ *******************************************************/
+
+/* kdLogSetSinkVEN: Send log messages to a file, or to stdout if pathname is KD_NULL. */
+KD_API KDint KD_APIENTRY kdLogSetSinkVEN(const KDchar *pathname);
+
+/* kdLogFlushVEN: Write out all pending log messages. */
+KD_API void KD_APIENTRY kdLogFlushVEN(void);
+
+/* kdLogGetDroppedVEN: Number of messages dropped because a ring buffer was full. */
+KD_API KDint KD_APIENTRY kdLogGetDroppedVEN(void);
+
+/* kdLogSetModeVEN: Choose between formatted text and a binary log for kdLogDecodeVEN. */
+#define KD_LOG_TEXT_VEN 0
+#define KD_LOG_BINARY_VEN 1
+KD_API KDint KD_APIENTRY kdLogSetModeVEN(KDint mode);
+
+/* kdLogDeferredVEN: Log a message formatted later by the writer, format has to stay valid. */
+KD_API KDint KD_APIENTRY kdLogDeferredVEN(const KDchar *format, ...);
+
+/* kdLogDecodeVEN: Format a binary log written in KD_LOG_BINARY_VEN mode, to stdout if output is KD_NULL. */
+KD_API KDint KD_APIENTRY kdLogDecodeVEN(const KDchar *input, const KDchar *output);
+
+/*******************************************************
+ * Formatted input (extensions)
+ *******************************************************/
+
+typedef struct KDScanfPlanVEN KDScanfPlanVEN;
+
+/* kdScanfCompileVEN: Compile a scanf format string into a reusable plan. */
+KD_API KDScanfPlanVEN *KD_APIENTRY kdScanfCompileVEN(const KDchar *format);
+
+/* kdScanfFreeVEN: Free a compiled scanf plan. */
+KD_API void KD_APIENTRY kdScanfFreeVEN(KDScanfPlanVEN *plan);
+
+/* kdSscanfPlanVEN, kdVsscanfPlanVEN: Read formatted input from a buffer using a compiled plan. */
+KD_API KDint KD_APIENTRY kdSscanfPlanVEN(const KDchar *str, const KDScanfPlanVEN *plan, ...);
+KD_API KDint KD_APIENTRY kdVsscanfPlanVEN(const KDchar *str, const KDScanfPlanVEN *plan, KDVaListKHR ap);
+
 /*******************************************************
  * Windowing (extensions)
  *******************************************************/
 #ifdef KD_WINDOW_SUPPORTED
 /* kdGetPlatformDisplayVEN: Wayland only. */
 KD_API NativeDisplayType KD_APIENTRY kdGetDisplayVEN(void);
+
+/* kdInjectInputPointerVEN, kdInjectInputKeyVEN, kdInjectInputKeyCharVEN: Queue synthetic input for a headless window. */
+/* kdPumpEvents turns it into events once time in kdGetTimeUST passed, in injection order. Any thread may inject. */
+/* Headless windows are used when no display server backend is built, or with KD_WINDOW_PLATFORM=null. */
+KD_API KDint KD_APIENTRY kdInjectInputPointerVEN(KDWindow *window, KDint32 index, KDint32 select, KDint32 x, KDint32 y, KDust time);
+KD_API KDint KD_APIENTRY kdInjectInputKeyVEN(KDWindow *window, KDint32 keycode, KDuint32 flags, KDust time);
+KD_API KDint KD_APIENTRY kdInjectInputKeyCharVEN(KDWindow *window, KDint32 character, KDuint32 flags, KDust time);
+
+/* kdTranslateKeycodeVEN: Translate a native key of the window backend to KD_KEY_*_ATX, or 0 if it has none. */
+/* What keycode means depends on the backend: an xkb keysym on X11 and Wayland, a virtual-key code (VK_*) on Win32, */
+/* an AKEYCODE_* on Android and a DOM keyCode on Emscripten. Headless builds have no native keys and always return 0. */
+KD_API KDint32 KD_APIENTRY kdTranslateKeycodeVEN(KDint32 keycode);
 #endif
 
 #endif /* __kdext_h_ */
@@ -57,6 +57,9 @@
 #include <EGL/egl.h>     // for EGLConfig, EGLDisplay, EGL_...
 #include <EGL/eglext.h>  // for EGL_PLATFORM_WAYLAND_KHR
 #endif
+#if defined(KD_WINDOW_NULL) && !defined(EGL_PLATFORM_SURFACELESS_MESA)
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
 
 #include "kd_internal.h"  // for _KDCallback, KDThread, __kd...
 
@@ -98,7 +101,7 @@
 #include <xcb/xcb.h>                      // for xcb_flush, xcb_connect, xcb...
 #include <xkbcommon/xkbcommon-keysyms.h>  // for XKB_KEY_Alt_L, XKB_KEY_Alt_R
 #include <xkbcommon/xkbcommon-names.h>    // for XKB_MOD_NAME_ALT, XKB_MOD_N...
-#include <xkbcommon/xkbcommon.h>          // for xkb_state_mod_name_is_active
+#include <xkbcommon/xkbcommon.h>          // for xkb_state_serialize_mods
 #endif
 #if defined(KD_WINDOW_WAYLAND)
 // IWYU pragma: no_include <wayland-client-core.h>
@@ -114,6 +117,7 @@
 // IWYU pragma: no_forward_declare wl_shell_surface
 // IWYU pragma: no_forward_declare wl_surface
 #include <wayland-egl.h>  // IWYU pragma: keep
+#include <poll.h>         // for poll, pollfd, POLLIN
 #endif
 #if defined(KD_WINDOW_X11)
 #include <xcb/xcb_ewmh.h>             // for xcb_ewmh_connection_t, xcb_...
@@ -136,30 +140,329 @@
  * Events
  ******************************************************************************/
 
-/* kdWaitEvent: Get next event from thread's event queue. */
-KD_API const KDEvent *KD_APIENTRY kdWaitEvent(KDust timeout)
+/* Every thread has one queue per KD_EVENT_PRIORITY_*_VEN lane. Posting stays a
+ * lock-free push into a single lane, kdWaitEvent takes from the highest
+ * waiting lane. A lane passed over __KD_EVENT_STARVATION times is served next,
+ * so a flood of input cannot hold back timers and user events for long. */
+#define __KD_EVENT_STARVATION 8
+
+/* Default lane of an event type. */
+static KDint __kdEventLane(KDint32 type)
 {
-    _KDQueue *eventqueue = kdThreadSelf()->eventqueue;
-    KDEvent *lastevent = kdThreadSelf()->lastevent;
-    if(lastevent)
+    switch(type)
     {
-        kdFreeEvent(lastevent);
+        case(KD_EVENT_QUIT):
+        case(KD_EVENT_PAUSE):
+        case(KD_EVENT_RESUME):
+        case(KD_EVENT_ORIENTATION):
+        case(KD_EVENT_STATE):
+#ifdef KD_WINDOW_SUPPORTED
+        case(KD_EVENT_WINDOW_CLOSE):
+        case(KD_EVENT_WINDOWPROPERTY_CHANGE):
+        case(KD_EVENT_WINDOW_REDRAW):
+        case(KD_EVENT_WINDOW_FOCUS):
+#endif
+        {
+            return KD_EVENT_PRIORITY_SYSTEM_VEN;
+        }
+        case(KD_EVENT_INPUT):
+        case(KD_EVENT_INPUT_POINTER):
+        case(KD_EVENT_INPUT_STICK):
+        case(KD_EVENT_INPUT_JOG):
+        case(KD_EVENT_INPUT_KEY_ATX):
+        case(KD_EVENT_INPUT_KEYCHAR_ATX):
+        {
+            return KD_EVENT_PRIORITY_INPUT_VEN;
+        }
+        case(KD_EVENT_TIMER):
+        case(KD_EVENT_SOCKET_READABLE):
+        case(KD_EVENT_SOCKET_WRITABLE):
+        case(KD_EVENT_SOCKET_CONNECT_COMPLETE):
+        case(KD_EVENT_SOCKET_INCOMING):
+        case(KD_EVENT_NAME_LOOKUP_COMPLETE):
+        {
+            return KD_EVENT_PRIORITY_TIMER_VEN;
+        }
+        default:
+        {
+            return KD_EVENT_PRIORITY_USER_VEN;
+        }
     }
-    if(timeout != -1)
+}
+
+/* Queued events whose data became invalid point their userptr here, pulling
+ * frees them. Any type may be posted, an address private to libKD may not. */
+static KDuint8 __kd_droppedevent = 0;
+static KDboolean __kdEventDropped(const KDEvent *event)
+{
+    return event->userptr == &__kd_droppedevent;
+}
+
+static KDint __kdPostThreadEventLane(KDEvent *event, KDThread *thread, KDint lane)
+{
+    if(event->timestamp == 0)
     {
-        kdThreadSleepVEN(timeout);
+        event->timestamp = kdGetTimeUST();
     }
-    kdPumpEvents();
-    if(__kdQueueSize(eventqueue) > 0)
+    KDint error = __kdQueuePush(thread->eventqueue[lane], (void *)event);
+    if(error == -1)
     {
-        lastevent = (KDEvent *)__kdQueuePull(eventqueue);
+        kdFreeEvent(event);
+        kdSetError(KD_ENOMEM);
+        return -1;
     }
-    else
+    __kdReactorWake(thread->reactor);
+    return 0;
+}
+
+/* Take the next event, highest lane first unless a lower one is starving. */
+static KDEvent *__kdPullEvent(KDThread *thread)
+{
+    KDint lane = -1;
+    for(KDint i = 0; i < __KD_EVENT_LANES; i++)
+    {
+        if(__kdQueueSize(thread->eventqueue[i]) > 0)
+        {
+            if(lane == -1)
+            {
+                lane = i;
+            }
+            else if(thread->starved[i] >= __KD_EVENT_STARVATION)
+            {
+                lane = i;
+                break;
+            }
+        }
+    }
+    if(lane == -1)
+    {
+        return KD_NULL;
+    }
+    for(KDint i = 0; i < __KD_EVENT_LANES; i++)
+    {
+        if(i != lane && __kdQueueSize(thread->eventqueue[i]) > 0)
+        {
+            thread->starved[i]++;
+        }
+    }
+    thread->starved[lane] = 0;
+    KDEvent *event = (KDEvent *)__kdQueuePull(thread->eventqueue[lane]);
+    if(event && __kdEventDropped(event))
+    {
+        kdFreeEvent(event);
+        return __kdPullEvent(thread);
+    }
+    return event;
+}
+
+/* Events posted for later wait in a binary min-heap per thread, ordered by
+ * deadline and then by posting order. kdPumpEvents moves the due ones into
+ * their lanes, the reactor sleeps no longer than the earliest deadline. */
+typedef struct _KDScheduledEvent _KDScheduledEvent;
+struct _KDScheduledEvent {
+    KDust deadline;
+    KDuint64 serial;
+    KDEvent *event;
+#if KDSIZE_MAX != KDUINT64_MAX
+    KDint8 padding[4];
+#endif
+};
+struct _KDEventSchedule {
+    KDThreadMutex *mutex;
+    _KDScheduledEvent *heap;
+    KDsize count;
+    KDsize capacity;
+    KDuint64 serial;
+};
+
+_KDEventSchedule *__kdEventScheduleCreate(void)
+{
+    _KDEventSchedule *schedule = (_KDEventSchedule *)kdMalloc(sizeof(_KDEventSchedule));
+    if(schedule == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    schedule->mutex = kdThreadMutexCreate(KD_NULL);
+    if(schedule->mutex == KD_NULL)
+    {
+        kdFree(schedule);
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    schedule->heap = KD_NULL;
+    schedule->count = 0;
+    schedule->capacity = 0;
+    schedule->serial = 0;
+    return schedule;
+}
+
+void __kdEventScheduleFree(_KDEventSchedule *schedule)
+{
+    for(KDsize i = 0; i < schedule->count; i++)
+    {
+        kdFreeEvent(schedule->heap[i].event);
+    }
+    kdFree(schedule->heap);
+    kdThreadMutexFree(schedule->mutex);
+    kdFree(schedule);
+}
+
+static KDboolean __kdScheduledBefore(const _KDScheduledEvent *a, const _KDScheduledEvent *b)
+{
+    return a->deadline < b->deadline || (a->deadline == b->deadline && a->serial < b->serial);
+}
+
+/* Remove the root, schedule->mutex is held. */
+static void __kdEventSchedulePop(_KDEventSchedule *schedule)
+{
+    _KDScheduledEvent last = schedule->heap[--schedule->count];
+    KDsize i = 0;
+    for(;;)
+    {
+        KDsize child = 2 * i + 1;
+        if(child >= schedule->count)
+        {
+            break;
+        }
+        if(child + 1 < schedule->count && __kdScheduledBefore(&schedule->heap[child + 1], &schedule->heap[child]))
+        {
+            child++;
+        }
+        if(!__kdScheduledBefore(&schedule->heap[child], &last))
+        {
+            break;
+        }
+        schedule->heap[i] = schedule->heap[child];
+        i = child;
+    }
+    schedule->heap[i] = last;
+}
+
+/* Earliest deadline, KDINT64_MAX if nothing is scheduled. */
+KDust __kdEventScheduleNext(KDThread *thread)
+{
+    _KDEventSchedule *schedule = thread->schedule;
+    kdThreadMutexLock(schedule->mutex);
+    KDust next = schedule->count ? schedule->heap[0].deadline : KDINT64_MAX;
+    kdThreadMutexUnlock(schedule->mutex);
+    return next;
+}
+
+/* Move every event whose deadline passed into its lane. A full lane leaves
+ * the rest scheduled for the next pump instead of dropping them. */
+static void __kdEventScheduleRun(KDThread *thread)
+{
+    _KDEventSchedule *schedule = thread->schedule;
+    kdThreadMutexLock(schedule->mutex);
+    if(schedule->count > 0)
+    {
+        KDust now = kdGetTimeUST();
+        while(schedule->count > 0 && schedule->heap[0].deadline <= now)
+        {
+            KDEvent *event = schedule->heap[0].event;
+            if(event->timestamp == 0)
+            {
+                event->timestamp = now;
+            }
+            if(__kdQueuePush(thread->eventqueue[__kdEventLane(event->type)], (void *)event) == -1)
+            {
+                break;
+            }
+            __kdEventSchedulePop(schedule);
+        }
+    }
+    kdThreadMutexUnlock(schedule->mutex);
+}
+
+static KDboolean __kdEventRefersToSocket(const KDEvent *event, const KDSocket *socket)
+{
+    switch(event->type)
+    {
+        case(KD_EVENT_SOCKET_READABLE):
+        case(KD_EVENT_SOCKET_WRITABLE):
+        case(KD_EVENT_SOCKET_INCOMING):
+        {
+            return event->data.socketreadable.socket == socket;
+        }
+        case(KD_EVENT_SOCKET_CONNECT_COMPLETE):
+        {
+            return event->data.socketconnect.socket == socket;
+        }
+        default:
+        {
+            return KD_FALSE;
+        }
+    }
+}
+static void __kdEventDropSocketVisit(void *value, void *arg)
+{
+    KDEvent *event = (KDEvent *)value;
+    if(__kdEventRefersToSocket(event, (const KDSocket *)arg))
+    {
+        event->userptr = &__kd_droppedevent;
+    }
+}
+/* Forget events of a socket that is closing, called by the owning thread. Events
+ * cannot leave the middle of a lane, so they stay queued as dropped. */
+void __kdEventDropSocket(KDThread *thread, const KDSocket *socket)
+{
+    for(KDint i = 0; i < __KD_EVENT_LANES; i++)
+    {
+        __kdQueueVisit(thread->eventqueue[i], __kdEventDropSocketVisit, (void *)socket);
+    }
+    if(thread->coalesced && __kdEventRefersToSocket(thread->coalesced, socket))
+    {
+        kdFreeEvent(thread->coalesced);
+        thread->coalesced = KD_NULL;
+    }
+    _KDEventSchedule *schedule = thread->schedule;
+    kdThreadMutexLock(schedule->mutex);
+    for(KDsize i = 0; i < schedule->count; i++)
+    {
+        __kdEventDropSocketVisit(schedule->heap[i].event, (void *)socket);
+    }
+    kdThreadMutexUnlock(schedule->mutex);
+}
+
+/* kdWaitEvent: Get next event from thread's event queue. */
+/* A timeout of -1 only polls, render loops depend on that. Otherwise the
+ * thread blocks in its reactor until an event arrives or the timeout ends. */
+KD_API const KDEvent *KD_APIENTRY kdWaitEvent(KDust timeout)
+{
+    KDThread *thread = kdThreadSelf();
+    if(thread->lastevent)
+    {
+        kdFreeEvent(thread->lastevent);
+        thread->lastevent = KD_NULL;
+    }
+    kdPumpEvents();
+    thread->lastevent = __kdPullEvent(thread);
+    if(thread->lastevent == KD_NULL && timeout > 0)
+    {
+        /* Saturated, huge timeouts must not wrap into the past */
+        KDust now = kdGetTimeUST();
+        KDust deadline = (timeout > KDINT64_MAX - now) ? KDINT64_MAX : now + timeout;
+        for(; now < deadline; now = kdGetTimeUST())
+        {
+            __kdReactorWait(thread, deadline - now);
+            kdPumpEvents();
+            thread->lastevent = __kdPullEvent(thread);
+            if(thread->lastevent)
+            {
+                break;
+            }
+        }
+    }
+    if(thread->lastevent == KD_NULL)
     {
-        lastevent = KD_NULL;
         kdSetError(KD_EAGAIN);
     }
-    return lastevent;
+    else if(thread->tracefile)
+    {
+        __kdEventTraceRecord(thread, thread->lastevent);
+    }
+    return thread->lastevent;
 }
 
 /* kdSetEventUserptr: Set the userptr for global events. */
@@ -186,8 +489,19 @@ struct _KDCallback {
 };
 static KDboolean __kdExecCallback(KDEvent *event)
 {
-    KDint callbackindex = kdThreadSelf()->callbackindex;
-    _KDCallback **callbacks = kdThreadSelf()->callbacks;
+    KDThread *thread = kdThreadSelf();
+    /* Fibers waiting in kdFiberWaitEventVEN come first */
+    if(__kdFiberDispatchEvent(event))
+    {
+        if(thread->tracefile)
+        {
+            __kdEventTraceRecord(thread, event);
+        }
+        kdFreeEvent(event);
+        return KD_TRUE;
+    }
+    KDint callbackindex = thread->callbackindex;
+    _KDCallback **callbacks = thread->callbacks;
     for(KDint i = 0; i < callbackindex; i++)
     {
         if(callbacks[i]->func)
@@ -196,6 +510,10 @@ static KDboolean __kdExecCallback(KDEvent *event)
             KDboolean userptrmatch = (callbacks[i]->eventuserptr == event->userptr);
             if(typematch && userptrmatch)
             {
+                if(thread->tracefile)
+                {
+                    __kdEventTraceRecord(thread, event);
+                }
                 callbacks[i]->func(event);
                 kdFreeEvent(event);
                 return KD_TRUE;
@@ -205,7 +523,111 @@ static KDboolean __kdExecCallback(KDEvent *event)
     return KD_FALSE;
 }
 
+/* Slot of an event type in KDThread coalescedcount, -1 if it never merges. */
+static KDint __kdCoalesceIndex(KDint32 type)
+{
+    switch(type)
+    {
+        case(KD_EVENT_INPUT_POINTER):
+        {
+            return 0;
+        }
+#ifdef KD_WINDOW_SUPPORTED
+        case(KD_EVENT_WINDOWPROPERTY_CHANGE):
+        {
+            return 1;
+        }
+#endif
+        default:
+        {
+            return -1;
+        }
+    }
+}
+
+/* Events of this type are held back by kdSetEventCoalescingVEN on the thread. */
+static KDboolean __kdCoalescing(KDThread *thread, KDint32 type)
+{
+    KDint index = __kdCoalesceIndex(type);
+    return index != -1 && (thread->coalescetypes & (1U << index));
+}
+
+/* Hand the held back event to callbacks or the queue. */
+static void __kdFlushCoalescedEvent(KDThread *thread)
+{
+    KDEvent *event = thread->coalesced;
+    if(event)
+    {
+        thread->coalesced = KD_NULL;
+        if(!__kdExecCallback(event))
+        {
+            __kdPostThreadEventLane(event, thread, thread->coalescedlane);
+        }
+    }
+}
+
+/* Perform callbacks or queue an event. With coalescing enabled, pointer motion
+ * and property changes are held back until the next different event, so a
+ * flood of them for one window arrives as a single event. The merged event
+ * has the latest data and the earliest timestamp. */
+static void __kdDeliverEventLane(KDEvent *event, KDint lane)
+{
+    KDThread *thread = kdThreadSelf();
+    KDint index = __kdCoalesceIndex(event->type);
+    KDboolean motion = event->type != KD_EVENT_INPUT_POINTER || event->data.inputpointer.index == KD_INPUT_POINTER_X;
+    if(motion && __kdCoalescing(thread, event->type))
+    {
+        if(event->timestamp == 0)
+        {
+            event->timestamp = kdGetTimeUST();
+        }
+        KDEvent *pending = thread->coalesced;
+        KDboolean same = pending && pending->type == event->type && pending->userptr == event->userptr && thread->coalescedlane == lane;
+#ifdef KD_WINDOW_SUPPORTED
+        if(same && event->type == KD_EVENT_WINDOWPROPERTY_CHANGE)
+        {
+            same = pending->data.windowproperty.pname == event->data.windowproperty.pname;
+        }
+#endif
+        if(same)
+        {
+            KDust timestamp = pending->timestamp < event->timestamp ? pending->timestamp : event->timestamp;
+            kdMemcpy(pending, event, sizeof(KDEvent));
+            pending->timestamp = timestamp;
+            kdFreeEvent(event);
+            thread->coalescedcount[index]++;
+            return;
+        }
+        __kdFlushCoalescedEvent(thread);
+        thread->coalesced = event;
+        thread->coalescedlane = lane;
+        return;
+    }
+    __kdFlushCoalescedEvent(thread);
+    if(!__kdExecCallback(event))
+    {
+        __kdPostThreadEventLane(event, thread, lane);
+    }
+}
+static void __kdDeliverEvent(KDEvent *event)
+{
+    __kdDeliverEventLane(event, __kdEventLane(event->type));
+}
+
 #ifdef KD_WINDOW_SUPPORTED
+#if defined(KD_WINDOW_NULL)
+/* Input waiting in a headless window, see kdInjectInputPointerVEN. */
+typedef struct _KDWindowInput _KDWindowInput;
+struct _KDWindowInput {
+    KDust time;
+    KDint32 type;
+    KDint32 index;
+    KDint32 value;
+    KDuint32 flags;
+    KDint32 x;
+    KDint32 y;
+};
+#endif
 struct KDWindow {
     void *nativewindow;
     void *nativedisplay;
@@ -264,6 +686,7 @@ struct KDWindow {
         struct xkb_context *context;
         struct xkb_state *state;
         struct xkb_keymap *keymap;
+        xkb_mod_mask_t modifiers[4];
         KDuint8 firstevent;
         KDint8 padding[7];
     } xkb;
@@ -287,6 +710,17 @@ struct KDWindow {
         xcb_ewmh_connection_t ewmh;
     } xcb;
 #endif
+#if defined(KD_WINDOW_NULL)
+    struct
+    {
+        KDThreadMutex *mutex;
+        /* Ring buffer in injection order */
+        _KDWindowInput *input;
+        KDsize head;
+        KDsize count;
+        KDsize capacity;
+    } null;
+#endif
 };
 
 static KDWindow *__kd_window = KD_NULL;
@@ -372,14 +806,8 @@ static void __kdHandleSpecialKeys(KDWindow *window, KDEventInputKeyATX *keyevent
         }
     }
 
-    if(!__kdExecCallback(dpadevent))
-    {
-        kdPostEvent(dpadevent);
-    }
-    if(!__kdExecCallback(gamekeysevent))
-    {
-        kdPostEvent(gamekeysevent);
-    }
+    __kdDeliverEvent(dpadevent);
+    __kdDeliverEvent(gamekeysevent);
 }
 
 #if defined(__ANDROID__)
@@ -387,1294 +815,725 @@ static void __kdHandleSpecialKeys(KDWindow *window, KDEventInputKeyATX *keyevent
 static KD_UNUSED void (*__dummyfunc)(KDWindow *, KDEventInputKeyATX *) = &__kdHandleSpecialKeys;
 #endif
 
-static KDint32 __KDKeycodeLookup(KDint32 keycode)
-{
-    switch(keycode)
-    {
+/* Native keys to KD_KEY_*_ATX, dense tables indexed by the platform keycode.
+ * Keys in comments have no counterpart on the platform. */
 #if defined(KD_WINDOW_ANDROID)
-        /* KD_KEY_ACCEPT_ATX */
-        /* KD_KEY_AGAIN_ATX */
-        /* KD_KEY_ALLCANDIDATES_ATX */
-        case(AKEYCODE_EISU):
-        {
-            return KD_KEY_ALPHANUMERIC_ATX;
-        }
-        case(AKEYCODE_ALT_LEFT):
-        case(AKEYCODE_ALT_RIGHT):
-        {
-            return KD_KEY_ALT_ATX;
-        }
-        /* KD_KEY_ALTGRAPH_ATX
-           KD_KEY_APPS_ATX
-           KD_KEY_ATTN_ATX */
-        case(AKEYCODE_BACK):
-        {
-            return KD_KEY_BROWSERBACK_ATX;
-        }
-        /* KD_KEY_BROWSERFAVORITES_ATX
-           KD_KEY_BROWSERFORWARD_ATX
-           KD_KEY_BROWSERHOME_ATX
-           KD_KEY_BROWSERREFRESH_ATX
-           KD_KEY_BROWSERSEARCH_ATX
-           KD_KEY_BROWSERSTOP_ATX */
-        case(AKEYCODE_CAPS_LOCK):
-        {
-            return KD_KEY_CAPSLOCK_ATX;
-        }
-        case(AKEYCODE_CLEAR):
-        {
-            return KD_KEY_CLEAR_ATX;
-        }
-        /* KD_KEY_CODEINPUT_ATX */
-        /* KD_KEY_COMPOSE_ATX */
-        case(AKEYCODE_CTRL_LEFT):
-        case(AKEYCODE_CTRL_RIGHT):
-        {
-            return KD_KEY_CONTROL_ATX;
-        }
-        /* KD_KEY_CRSEL_ATX
-           KD_KEY_CONVERT_ATX */
-        case(AKEYCODE_COPY):
-        {
-            return KD_KEY_COPY_ATX;
-        }
-        case(AKEYCODE_CUT):
-        {
-            return KD_KEY_CUT_ATX;
-        }
-        case(AKEYCODE_DPAD_DOWN):
-        {
-            return KD_KEY_DOWN_ATX;
-        }
-        /* KD_KEY_END_ATX */
-        case(AKEYCODE_ENTER):
-        {
-            return KD_KEY_ENTER_ATX;
-        }
-        /* KD_KEY_ERASEEOF_ATX
-           KD_KEY_EXECUTE_ATX
-           KD_KEY_EXSEL_ATX */
-        case(AKEYCODE_F1):
-        {
-            return KD_KEY_F1_ATX;
-        }
-        case(AKEYCODE_F2):
-        {
-            return KD_KEY_F2_ATX;
-        }
-        case(AKEYCODE_F3):
-        {
-            return KD_KEY_F3_ATX;
-        }
-        case(AKEYCODE_F4):
-        {
-            return KD_KEY_F4_ATX;
-        }
-        case(AKEYCODE_F5):
-        {
-            return KD_KEY_F5_ATX;
-        }
-        case(AKEYCODE_F6):
-        {
-            return KD_KEY_F6_ATX;
-        }
-        case(AKEYCODE_F7):
-        {
-            return KD_KEY_F7_ATX;
-        }
-        case(AKEYCODE_F8):
-        {
-            return KD_KEY_F8_ATX;
-        }
-        case(AKEYCODE_F9):
-        {
-            return KD_KEY_F9_ATX;
-        }
-        case(AKEYCODE_F10):
-        {
-            return KD_KEY_F10_ATX;
-        }
-        case(AKEYCODE_F11):
-        {
-            return KD_KEY_F11_ATX;
-        }
-        case(AKEYCODE_F12):
-        {
-            return KD_KEY_F12_ATX;
-        }
-        /* KD_KEY_F13_ATX
-           KD_KEY_F14_ATX
-           KD_KEY_F15_ATX
-           KD_KEY_F16_ATX
-           KD_KEY_F17_ATX
-           KD_KEY_F18_ATX
-           KD_KEY_F19_ATX
-           KD_KEY_F20_ATX
-           KD_KEY_F21_ATX
-           KD_KEY_F22_ATX
-           KD_KEY_F23_ATX
-           KD_KEY_F24_ATX
-           KD_KEY_FINALMODE_ATX
-           KD_KEY_FIND_ATX
-           KD_KEY_FULLWIDTH_ATX
-           KD_KEY_HALFWIDTH_ATX
-           KD_KEY_HANGULMODE_ATX
-           KD_KEY_HANJAMODE_ATX */
-        case(AKEYCODE_HELP):
-        {
-            return KD_KEY_HELP_ATX;
-        }
-        /* KD_KEY_HIRAGANA_ATX */
-        case(AKEYCODE_HOME):
-        {
-            return KD_KEY_HOME_ATX;
-        }
-        case(AKEYCODE_DEL):
-        {
-            return KD_KEY_INSERT_ATX;
-        }
-        /* KD_KEY_JAPANESEHIRAGANA_ATX
-           KD_KEY_JAPANESEKATAKANA_ATX
-           KD_KEY_JAPANESEROMAJI_ATX
-           KD_KEY_JUNJAMODE_ATX
-           KD_KEY_KANAMODE_ATX
-           KD_KEY_KANJIMODE_ATX
-           KD_KEY_KATAKANA_ATX */
-        /* KD_KEY_LAUNCHAPPLICATION1_ATX
-           KD_KEY_LAUNCHAPPLICATION2_ATX */
-        case(AKEYCODE_ENVELOPE):
-        {
-            return KD_KEY_LAUNCHMAIL_ATX;
-        }
-        case(AKEYCODE_SOFT_LEFT):
-        case(AKEYCODE_DPAD_LEFT):
-        {
-            return KD_KEY_LEFT_ATX;
-        }
-        /* KD_KEY_META_ATX */
-        case(AKEYCODE_MEDIA_NEXT):
-        {
-            return KD_KEY_MEDIANEXTTRACK_ATX;
-        }
-        case(AKEYCODE_MEDIA_PLAY_PAUSE):
-        {
-            return KD_KEY_MEDIAPLAYPAUSE_ATX;
-        }
-        case(AKEYCODE_MEDIA_PREVIOUS):
-        {
-            return KD_KEY_MEDIAPREVIOUSTRACK_ATX;
-        }
-        case(AKEYCODE_MEDIA_STOP):
-        {
-            return KD_KEY_MEDIASTOP_ATX;
-        }
-        /* KD_KEY_MODECHANGE_ATX
-           KD_KEY_NONCONVERT_ATX */
-        case(AKEYCODE_NUM_LOCK):
-        {
-            return KD_KEY_NUMLOCK_ATX;
-        }
-        case(AKEYCODE_PAGE_DOWN):
-        {
-            return KD_KEY_PAGEDOWN_ATX;
-        }
-        case(AKEYCODE_PAGE_UP):
-        {
-            return KD_KEY_PAGEUP_ATX;
-        }
-        case(AKEYCODE_MEDIA_PAUSE):
-        {
-            return KD_KEY_PAUSE_ATX;
-        }
-        case(AKEYCODE_MEDIA_PLAY):
-        {
-            return KD_KEY_PLAY_ATX;
-        }
-        /* KD_KEY_PREVIOUSCANDIDATE_ATX */
-        case(AKEYCODE_SYSRQ):
-        {
-            return KD_KEY_PRINTSCREEN_ATX;
-        }
-        /* KD_KEY_PROCESS_ATX
-           KD_KEY_PROPS_ATX */
-        case(AKEYCODE_SOFT_RIGHT):
-        case(AKEYCODE_DPAD_RIGHT):
-        {
-            return KD_KEY_RIGHT_ATX;
-        }
-        /* KD_KEY_ROMANCHARACTERS_ATX */
-        case(AKEYCODE_MOVE_END):
-        {
-            return KD_KEY_SCROLL_ATX;
-        }
-        case(AKEYCODE_BUTTON_SELECT):
-        {
-            return KD_KEY_SELECT_ATX;
-        }
-        case(AKEYCODE_MEDIA_TOP_MENU):
-        {
-            return KD_KEY_SELECTMEDIA_ATX;
-        }
-        case(AKEYCODE_SHIFT_LEFT):
-        case(AKEYCODE_SHIFT_RIGHT):
-        {
-            return KD_KEY_SHIFT_ATX;
-        }
-        /* KD_KEY_STOP_ATX */
-        case(AKEYCODE_DPAD_UP):
-        {
-            return KD_KEY_UP_ATX;
-        }
-        /* KD_KEY_UNDO_ATX */
-        case(AKEYCODE_VOLUME_DOWN):
-        {
-            return KD_KEY_VOLUMEDOWN_ATX;
-        }
-        case(AKEYCODE_VOLUME_MUTE):
-        {
-            return KD_KEY_VOLUMEMUTE_ATX;
-        }
-        case(AKEYCODE_VOLUME_UP):
-        {
-            return KD_KEY_VOLUMEUP_ATX;
-        }
-        /* KD_KEY_WIN_ATX */
-        case(AKEYCODE_ZOOM_IN):
-        {
-            return KD_KEY_ZOOM_ATX;
-        }
+static const KDint32 __kd_keycodes[] = {
+    /* KD_KEY_ACCEPT_ATX */
+    /* KD_KEY_AGAIN_ATX */
+    /* KD_KEY_ALLCANDIDATES_ATX */
+    [AKEYCODE_EISU] = KD_KEY_ALPHANUMERIC_ATX,
+    [AKEYCODE_ALT_LEFT] = KD_KEY_ALT_ATX,
+    [AKEYCODE_ALT_RIGHT] = KD_KEY_ALT_ATX,
+    /* KD_KEY_ALTGRAPH_ATX
+       KD_KEY_APPS_ATX
+       KD_KEY_ATTN_ATX */
+    [AKEYCODE_BACK] = KD_KEY_BROWSERBACK_ATX,
+    /* KD_KEY_BROWSERFAVORITES_ATX
+       KD_KEY_BROWSERFORWARD_ATX
+       KD_KEY_BROWSERHOME_ATX
+       KD_KEY_BROWSERREFRESH_ATX
+       KD_KEY_BROWSERSEARCH_ATX
+       KD_KEY_BROWSERSTOP_ATX */
+    [AKEYCODE_CAPS_LOCK] = KD_KEY_CAPSLOCK_ATX,
+    [AKEYCODE_CLEAR] = KD_KEY_CLEAR_ATX,
+    /* KD_KEY_CODEINPUT_ATX */
+    /* KD_KEY_COMPOSE_ATX */
+    [AKEYCODE_CTRL_LEFT] = KD_KEY_CONTROL_ATX,
+    [AKEYCODE_CTRL_RIGHT] = KD_KEY_CONTROL_ATX,
+    /* KD_KEY_CRSEL_ATX
+       KD_KEY_CONVERT_ATX */
+    [AKEYCODE_COPY] = KD_KEY_COPY_ATX,
+    [AKEYCODE_CUT] = KD_KEY_CUT_ATX,
+    [AKEYCODE_DPAD_DOWN] = KD_KEY_DOWN_ATX,
+    /* KD_KEY_END_ATX */
+    [AKEYCODE_ENTER] = KD_KEY_ENTER_ATX,
+    /* KD_KEY_ERASEEOF_ATX
+       KD_KEY_EXECUTE_ATX
+       KD_KEY_EXSEL_ATX */
+    [AKEYCODE_F1] = KD_KEY_F1_ATX,
+    [AKEYCODE_F2] = KD_KEY_F2_ATX,
+    [AKEYCODE_F3] = KD_KEY_F3_ATX,
+    [AKEYCODE_F4] = KD_KEY_F4_ATX,
+    [AKEYCODE_F5] = KD_KEY_F5_ATX,
+    [AKEYCODE_F6] = KD_KEY_F6_ATX,
+    [AKEYCODE_F7] = KD_KEY_F7_ATX,
+    [AKEYCODE_F8] = KD_KEY_F8_ATX,
+    [AKEYCODE_F9] = KD_KEY_F9_ATX,
+    [AKEYCODE_F10] = KD_KEY_F10_ATX,
+    [AKEYCODE_F11] = KD_KEY_F11_ATX,
+    [AKEYCODE_F12] = KD_KEY_F12_ATX,
+    /* KD_KEY_F13_ATX
+       KD_KEY_F14_ATX
+       KD_KEY_F15_ATX
+       KD_KEY_F16_ATX
+       KD_KEY_F17_ATX
+       KD_KEY_F18_ATX
+       KD_KEY_F19_ATX
+       KD_KEY_F20_ATX
+       KD_KEY_F21_ATX
+       KD_KEY_F22_ATX
+       KD_KEY_F23_ATX
+       KD_KEY_F24_ATX
+       KD_KEY_FINALMODE_ATX
+       KD_KEY_FIND_ATX
+       KD_KEY_FULLWIDTH_ATX
+       KD_KEY_HALFWIDTH_ATX
+       KD_KEY_HANGULMODE_ATX
+       KD_KEY_HANJAMODE_ATX */
+    [AKEYCODE_HELP] = KD_KEY_HELP_ATX,
+    /* KD_KEY_HIRAGANA_ATX */
+    [AKEYCODE_HOME] = KD_KEY_HOME_ATX,
+    [AKEYCODE_DEL] = KD_KEY_INSERT_ATX,
+    /* KD_KEY_JAPANESEHIRAGANA_ATX
+       KD_KEY_JAPANESEKATAKANA_ATX
+       KD_KEY_JAPANESEROMAJI_ATX
+       KD_KEY_JUNJAMODE_ATX
+       KD_KEY_KANAMODE_ATX
+       KD_KEY_KANJIMODE_ATX
+       KD_KEY_KATAKANA_ATX */
+    /* KD_KEY_LAUNCHAPPLICATION1_ATX
+       KD_KEY_LAUNCHAPPLICATION2_ATX */
+    [AKEYCODE_ENVELOPE] = KD_KEY_LAUNCHMAIL_ATX,
+    [AKEYCODE_SOFT_LEFT] = KD_KEY_LEFT_ATX,
+    [AKEYCODE_DPAD_LEFT] = KD_KEY_LEFT_ATX,
+    /* KD_KEY_META_ATX */
+    [AKEYCODE_MEDIA_NEXT] = KD_KEY_MEDIANEXTTRACK_ATX,
+    [AKEYCODE_MEDIA_PLAY_PAUSE] = KD_KEY_MEDIAPLAYPAUSE_ATX,
+    [AKEYCODE_MEDIA_PREVIOUS] = KD_KEY_MEDIAPREVIOUSTRACK_ATX,
+    [AKEYCODE_MEDIA_STOP] = KD_KEY_MEDIASTOP_ATX,
+    /* KD_KEY_MODECHANGE_ATX
+       KD_KEY_NONCONVERT_ATX */
+    [AKEYCODE_NUM_LOCK] = KD_KEY_NUMLOCK_ATX,
+    [AKEYCODE_PAGE_DOWN] = KD_KEY_PAGEDOWN_ATX,
+    [AKEYCODE_PAGE_UP] = KD_KEY_PAGEUP_ATX,
+    [AKEYCODE_MEDIA_PAUSE] = KD_KEY_PAUSE_ATX,
+    [AKEYCODE_MEDIA_PLAY] = KD_KEY_PLAY_ATX,
+    /* KD_KEY_PREVIOUSCANDIDATE_ATX */
+    [AKEYCODE_SYSRQ] = KD_KEY_PRINTSCREEN_ATX,
+    /* KD_KEY_PROCESS_ATX
+       KD_KEY_PROPS_ATX */
+    [AKEYCODE_SOFT_RIGHT] = KD_KEY_RIGHT_ATX,
+    [AKEYCODE_DPAD_RIGHT] = KD_KEY_RIGHT_ATX,
+    /* KD_KEY_ROMANCHARACTERS_ATX */
+    [AKEYCODE_MOVE_END] = KD_KEY_SCROLL_ATX,
+    [AKEYCODE_BUTTON_SELECT] = KD_KEY_SELECT_ATX,
+    [AKEYCODE_MEDIA_TOP_MENU] = KD_KEY_SELECTMEDIA_ATX,
+    [AKEYCODE_SHIFT_LEFT] = KD_KEY_SHIFT_ATX,
+    [AKEYCODE_SHIFT_RIGHT] = KD_KEY_SHIFT_ATX,
+    /* KD_KEY_STOP_ATX */
+    [AKEYCODE_DPAD_UP] = KD_KEY_UP_ATX,
+    /* KD_KEY_UNDO_ATX */
+    [AKEYCODE_VOLUME_DOWN] = KD_KEY_VOLUMEDOWN_ATX,
+    [AKEYCODE_VOLUME_MUTE] = KD_KEY_VOLUMEMUTE_ATX,
+    [AKEYCODE_VOLUME_UP] = KD_KEY_VOLUMEUP_ATX,
+    /* KD_KEY_WIN_ATX */
+    [AKEYCODE_ZOOM_IN] = KD_KEY_ZOOM_ATX,
+};
 #elif defined(KD_WINDOW_WIN32)
-        case(VK_ACCEPT):
-        {
-            return KD_KEY_ACCEPT_ATX;
-        }
-        /* KD_KEY_AGAIN_ATX */
-        /* KD_KEY_ALLCANDIDATES_ATX */
-        /* KD_KEY_ALPHANUMERIC_ATX */
-        case(VK_MENU):
-        {
-            return KD_KEY_ALT_ATX;
-        }
-        /* KD_KEY_ALTGRAPH_ATX */
-        case(VK_APPS):
-        {
-            return KD_KEY_APPS_ATX;
-        }
-        case(VK_ATTN):
-        {
-            return KD_KEY_ATTN_ATX;
-        }
-        case(VK_BACK):
-        {
-            return KD_KEY_BROWSERBACK_ATX;
-        }
-        case(VK_BROWSER_FAVORITES):
-        {
-            return KD_KEY_BROWSERFAVORITES_ATX;
-        }
-        case(VK_BROWSER_FORWARD):
-        {
-            return KD_KEY_BROWSERFORWARD_ATX;
-        }
-        case(VK_BROWSER_HOME):
-        {
-            return KD_KEY_BROWSERHOME_ATX;
-        }
-        case(VK_BROWSER_REFRESH):
-        {
-            return KD_KEY_BROWSERREFRESH_ATX;
-        }
-        case(VK_BROWSER_SEARCH):
-        {
-            return KD_KEY_BROWSERSEARCH_ATX;
-        }
-        case(VK_BROWSER_STOP):
-        {
-            return KD_KEY_BROWSERSTOP_ATX;
-        }
-        case(VK_CAPITAL):
-        {
-            return KD_KEY_CAPSLOCK_ATX;
-        }
-        case(VK_CLEAR):
-        case(VK_OEM_CLEAR):
-        {
-            return KD_KEY_CLEAR_ATX;
-        }
-        /* KD_KEY_CODEINPUT_ATX */
-        /* KD_KEY_COMPOSE_ATX */
-        case(VK_CONTROL):
-        {
-            return KD_KEY_CONTROL_ATX;
-        }
-        case(VK_CRSEL):
-        {
-            return KD_KEY_CRSEL_ATX;
-        }
-        case(VK_CONVERT):
-        {
-            return KD_KEY_CONVERT_ATX;
-        }
-        /* KD_KEY_COPY_ATX */
-        /* KD_KEY_CUT_ATX */
-        case(VK_DOWN):
-        {
-            return KD_KEY_DOWN_ATX;
-        }
-        case(VK_END):
-        {
-            return KD_KEY_END_ATX;
-        }
-        case(VK_RETURN):
-        {
-            return KD_KEY_ENTER_ATX;
-        }
-        case(VK_EREOF):
-        {
-            return KD_KEY_ERASEEOF_ATX;
-        }
-        case(VK_EXECUTE):
-        {
-            return KD_KEY_EXECUTE_ATX;
-        }
-        case(VK_EXSEL):
-        {
-            return KD_KEY_EXSEL_ATX;
-        }
-        case(VK_F1):
-        {
-            return KD_KEY_F1_ATX;
-        }
-        case(VK_F2):
-        {
-            return KD_KEY_F2_ATX;
-        }
-        case(VK_F3):
-        {
-            return KD_KEY_F3_ATX;
-        }
-        case(VK_F4):
-        {
-            return KD_KEY_F4_ATX;
-        }
-        case(VK_F5):
-        {
-            return KD_KEY_F5_ATX;
-        }
-        case(VK_F6):
-        {
-            return KD_KEY_F6_ATX;
-        }
-        case(VK_F7):
-        {
-            return KD_KEY_F7_ATX;
-        }
-        case(VK_F8):
-        {
-            return KD_KEY_F8_ATX;
-        }
-        case(VK_F9):
-        {
-            return KD_KEY_F9_ATX;
-        }
-        case(VK_F10):
-        {
-            return KD_KEY_F10_ATX;
-        }
-        case(VK_F11):
-        {
-            return KD_KEY_F11_ATX;
-        }
-        case(VK_F12):
-        {
-            return KD_KEY_F12_ATX;
-        }
-        case(VK_F13):
-        {
-            return KD_KEY_F13_ATX;
-        }
-        case(VK_F14):
-        {
-            return KD_KEY_F14_ATX;
-        }
-        case(VK_F15):
-        {
-            return KD_KEY_F15_ATX;
-        }
-        case(VK_F16):
-        {
-            return KD_KEY_F16_ATX;
-        }
-        case(VK_F17):
-        {
-            return KD_KEY_F17_ATX;
-        }
-        case(VK_F18):
-        {
-            return KD_KEY_F18_ATX;
-        }
-        case(VK_F19):
-        {
-            return KD_KEY_F19_ATX;
-        }
-        case(VK_F20):
-        {
-            return KD_KEY_F20_ATX;
-        }
-        case(VK_F21):
-        {
-            return KD_KEY_F21_ATX;
-        }
-        case(VK_F22):
-        {
-            return KD_KEY_F22_ATX;
-        }
-        case(VK_F23):
-        {
-            return KD_KEY_F23_ATX;
-        }
-        case(VK_F24):
-        {
-            return KD_KEY_F24_ATX;
-        }
-        case(VK_FINAL):
-        {
-            return KD_KEY_FINALMODE_ATX;
-        }
-        /* KD_KEY_FIND_ATX
-           KD_KEY_FULLWIDTH_ATX
-           KD_KEY_HALFWIDTH_ATX */
-        case(VK_HANGUL):
-        {
-            return KD_KEY_HANGULMODE_ATX;
-        }
-        case(VK_HANJA):
-        {
-            return KD_KEY_HANJAMODE_ATX;
-        }
-        case(VK_HELP):
-        {
-            return KD_KEY_HELP_ATX;
-        }
-        /* KD_KEY_HIRAGANA_ATX */
-        case(VK_HOME):
-        {
-            return KD_KEY_HOME_ATX;
-        }
-        case(VK_INSERT):
-        {
-            return KD_KEY_INSERT_ATX;
-        }
-        /* KD_KEY_JAPANESEHIRAGANA_ATX
-           KD_KEY_JAPANESEKATAKANA_ATX
-           KD_KEY_JAPANESEROMAJI_ATX
-           KD_KEY_JUNJAMODE_ATX
-           KD_KEY_KANAMODE_ATX
-           KD_KEY_KANJIMODE_ATX
-           KD_KEY_KATAKANA_ATX */
-        case(VK_LAUNCH_APP1):
-        {
-            return KD_KEY_LAUNCHAPPLICATION1_ATX;
-        }
-        case(VK_LAUNCH_APP2):
-        {
-            return KD_KEY_LAUNCHAPPLICATION2_ATX;
-        }
-        case(VK_LAUNCH_MAIL):
-        {
-            return KD_KEY_LAUNCHMAIL_ATX;
-        }
-        case(VK_LEFT):
-        {
-            return KD_KEY_LEFT_ATX;
-        }
-        /* KD_KEY_META_ATX */
-        case(VK_MEDIA_NEXT_TRACK):
-        {
-            return KD_KEY_MEDIANEXTTRACK_ATX;
-        }
-        case(VK_MEDIA_PLAY_PAUSE):
-        {
-            return KD_KEY_MEDIAPLAYPAUSE_ATX;
-        }
-        case(VK_MEDIA_PREV_TRACK):
-        {
-            return KD_KEY_MEDIAPREVIOUSTRACK_ATX;
-        }
-        case(VK_MEDIA_STOP):
-        {
-            return KD_KEY_MEDIASTOP_ATX;
-        }
-        case(VK_MODECHANGE):
-        {
-            return KD_KEY_MODECHANGE_ATX;
-        }
-        case(VK_NONCONVERT):
-        {
-            return KD_KEY_NONCONVERT_ATX;
-        }
-        case(VK_NUMLOCK):
-        {
-            return KD_KEY_NUMLOCK_ATX;
-        }
-        case(VK_NEXT):
-        {
-            return KD_KEY_PAGEDOWN_ATX;
-        }
-        case(VK_PRIOR):
-        {
-            return KD_KEY_PAGEUP_ATX;
-        }
-        case(VK_PAUSE):
-        {
-            return KD_KEY_PAUSE_ATX;
-        }
-        case(VK_PLAY):
-        {
-            return KD_KEY_PLAY_ATX;
-        }
-        /* KD_KEY_PREVIOUSCANDIDATE_ATX */
-        case(VK_PRINT):
-        {
-            return KD_KEY_PRINTSCREEN_ATX;
-        }
-        case(VK_PROCESSKEY):
-        {
-            return KD_KEY_PROCESS_ATX;
-        }
-        /* KD_KEY_PROPS_ATX */
-        case(VK_RIGHT):
-        {
-            return KD_KEY_RIGHT_ATX;
-        }
-        /* KD_KEY_ROMANCHARACTERS_ATX */
-        case(VK_SCROLL):
-        {
-            return KD_KEY_SCROLL_ATX;
-        }
-        case(VK_SELECT):
-        {
-            return KD_KEY_SELECT_ATX;
-        }
-        case(VK_LAUNCH_MEDIA_SELECT):
-        {
-            return KD_KEY_SELECTMEDIA_ATX;
-        }
-        case(VK_SHIFT):
-        {
-            return KD_KEY_SHIFT_ATX;
-        }
-        case(VK_CANCEL):
-        {
-            return KD_KEY_STOP_ATX;
-        }
-        case(VK_UP):
-        {
-            return KD_KEY_UP_ATX;
-        }
-        /* KD_KEY_UNDO_ATX */
-        case(VK_VOLUME_DOWN):
-        {
-            return KD_KEY_VOLUMEDOWN_ATX;
-        }
-        case(VK_VOLUME_MUTE):
-        {
-            return KD_KEY_VOLUMEMUTE_ATX;
-        }
-        case(VK_VOLUME_UP):
-        {
-            return KD_KEY_VOLUMEUP_ATX;
-        }
-        case(VK_LWIN):
-        case(VK_RWIN):
-        {
-            return KD_KEY_WIN_ATX;
-        }
-        case(VK_ZOOM):
-        {
-            return KD_KEY_ZOOM_ATX;
-        }
-#elif defined(KD_WINDOW_EMSCRIPTEN)
-        case(30):
-        {
-            return KD_KEY_ACCEPT_ATX;
-        }
-        /* KD_KEY_AGAIN_ATX */
-        /* KD_KEY_ALLCANDIDATES_ATX */
-        /* KD_KEY_ALPHANUMERIC_ATX */
-        case(18):
-        {
-            return KD_KEY_ALT_ATX;
-        }
-        /* KD_KEY_ALTGRAPH_ATX */
-        /* KD_KEY_APPS_ATX */
-        case(240):
-        case(246):
-        {
-            return KD_KEY_ATTN_ATX;
-        }
-        /* KD_KEY_BROWSERBACK_ATX
-           KD_KEY_BROWSERFAVORITES_ATX
-           KD_KEY_BROWSERFORWARD_ATX
-           KD_KEY_BROWSERHOME_ATX
-           KD_KEY_BROWSERREFRESH_ATX
-           KD_KEY_BROWSERSEARCH_ATX
-           KD_KEY_BROWSERSTOP_ATX */
-        case(20):
-        {
-            return KD_KEY_CAPSLOCK_ATX;
-        }
-        case(12):
-        case(230):
-        case(254):
-        {
-            return KD_KEY_CLEAR_ATX;
-        }
-        /* KD_KEY_CODEINPUT_ATX
-           KD_KEY_COMPOSE_ATX */
-        case(17):
-        {
-            return KD_KEY_CONTROL_ATX;
-        }
-        case(247):
-        {
-            return KD_KEY_CRSEL_ATX;
-        }
-        case(28):
-        {
-            return KD_KEY_CONVERT_ATX;
-        }
-        case(242):
-        {
-            return KD_KEY_COPY_ATX;
-        }
-        /* KD_KEY_CUT_ATX */
-        case(40):
-        {
-            return KD_KEY_DOWN_ATX;
-        }
-        case(35):
-        {
-            return KD_KEY_END_ATX;
-        }
-        case(13):
-        {
-            return KD_KEY_ENTER_ATX;
-        }
-        case(249):
-        {
-            return KD_KEY_ERASEEOF_ATX;
-        }
-        case(43):
-        {
-            return KD_KEY_EXECUTE_ATX;
-        }
-        case(248):
-        {
-            return KD_KEY_EXSEL_ATX;
-        }
-        case(112):
-        {
-            return KD_KEY_F1_ATX;
-        }
-        case(113):
-        {
-            return KD_KEY_F2_ATX;
-        }
-        case(114):
-        {
-            return KD_KEY_F3_ATX;
-        }
-        case(115):
-        {
-            return KD_KEY_F4_ATX;
-        }
-        case(116):
-        {
-            return KD_KEY_F5_ATX;
-        }
-        case(117):
-        {
-            return KD_KEY_F6_ATX;
-        }
-        case(118):
-        {
-            return KD_KEY_F7_ATX;
-        }
-        case(119):
-        {
-            return KD_KEY_F8_ATX;
-        }
-        case(120):
-        {
-            return KD_KEY_F9_ATX;
-        }
-        case(121):
-        {
-            return KD_KEY_F10_ATX;
-        }
-        case(122):
-        {
-            return KD_KEY_F11_ATX;
-        }
-        case(123):
-        {
-            return KD_KEY_F12_ATX;
-        }
-        case(124):
-        {
-            return KD_KEY_F13_ATX;
-        }
-        case(125):
-        {
-            return KD_KEY_F14_ATX;
-        }
-        case(126):
-        {
-            return KD_KEY_F15_ATX;
-        }
-        case(127):
-        {
-            return KD_KEY_F16_ATX;
-        }
-        case(128):
-        {
-            return KD_KEY_F17_ATX;
-        }
-        case(129):
-        {
-            return KD_KEY_F18_ATX;
-        }
-        case(130):
-        {
-            return KD_KEY_F19_ATX;
-        }
-        case(131):
-        {
-            return KD_KEY_F20_ATX;
-        }
-        case(132):
-        {
-            return KD_KEY_F21_ATX;
-        }
-        case(133):
-        {
-            return KD_KEY_F22_ATX;
-        }
-        case(134):
-        {
-            return KD_KEY_F23_ATX;
-        }
-        case(135):
-        {
-            return KD_KEY_F24_ATX;
-        }
-        case(24):
-        {
-            return KD_KEY_FINALMODE_ATX;
-        }
-        /* KD_KEY_FIND_ATX
-           KD_KEY_FULLWIDTH_ATX
-           KD_KEY_HALFWIDTH_ATX */
-        case(21):
-        {
-            return KD_KEY_HANGULMODE_ATX;
-        }
-        case(25):
-        {
-            return KD_KEY_HANJAMODE_ATX;
-        }
-        case(6):
-        {
-            return KD_KEY_HELP_ATX;
-        }
-        /* KD_KEY_HIRAGANA_ATX */
-        case(36):
-        {
-            return KD_KEY_HOME_ATX;
-        }
-        case(45):
-        {
-            return KD_KEY_INSERT_ATX;
-        }
-        /* KD_KEY_JAPANESEHIRAGANA_ATX
-           KD_KEY_JAPANESEKATAKANA_ATX
-           KD_KEY_JAPANESEROMAJI_ATX
-           KD_KEY_JUNJAMODE_ATX
-           KD_KEY_KANAMODE_ATX
-           KD_KEY_KANJIMODE_ATX
-           KD_KEY_KATAKANA_ATX */
-        /* KD_KEY_LAUNCHAPPLICATION1_ATX
-           KD_KEY_LAUNCHAPPLICATION2_ATX
-           KD_KEY_LAUNCHMAIL_ATX*/
-        case(37):
-        {
-            return KD_KEY_LEFT_ATX;
-        }
-        case(224):
-        {
-            return KD_KEY_META_ATX;
-        }
-        /* KD_KEY_MEDIANEXTTRACK_ATX;
-           KD_KEY_MEDIAPLAYPAUSE_ATX
-           KD_KEY_MEDIAPREVIOUSTRACK_ATX
-           KD_KEY_MEDIASTOP_ATX */
-        case(31):
-        {
-            return KD_KEY_MODECHANGE_ATX;
-        }
-        case(29):
-        {
-            return KD_KEY_NONCONVERT_ATX;
-        }
-        case(144):
-        {
-            return KD_KEY_NUMLOCK_ATX;
-        }
-        case(34):
-        {
-            return KD_KEY_PAGEDOWN_ATX;
-        }
-        case(33):
-        {
-            return KD_KEY_PAGEUP_ATX;
-        }
-        case(19):
-        {
-            return KD_KEY_PAUSE_ATX;
-        }
-        case(250):
-        {
-            return KD_KEY_PLAY_ATX;
-        }
-        /* KD_KEY_PREVIOUSCANDIDATE_ATX */
-        case(42):
-        {
-            return KD_KEY_PRINTSCREEN_ATX;
-        }
-        /* KD_KEY_PROCESS_ATX */
-        /* KD_KEY_PROPS_ATX */
-        case(39):
-        {
-            return KD_KEY_RIGHT_ATX;
-        }
-        /* KD_KEY_ROMANCHARACTERS_ATX */
-        case(145):
-        {
-            return KD_KEY_SCROLL_ATX;
-        }
-        case(41):
-        {
-            return KD_KEY_SELECT_ATX;
-        }
-        /* KD_KEY_SELECTMEDIA_ATX */
-        case(16):
-        {
-            return KD_KEY_SHIFT_ATX;
-        }
-        case(3):
-        {
-            return KD_KEY_STOP_ATX;
-        }
-        case(38):
-        {
-            return KD_KEY_UP_ATX;
-        }
-        /* KD_KEY_UNDO_ATX */
-        case(182):
-        {
-            return KD_KEY_VOLUMEDOWN_ATX;
-        }
-        case(181):
-        {
-            return KD_KEY_VOLUMEMUTE_ATX;
-        }
-        case(183):
-        {
-            return KD_KEY_VOLUMEUP_ATX;
-        }
-        case(91):
-        {
-            return KD_KEY_WIN_ATX;
-        }
-        case(251):
-        {
-            return KD_KEY_ZOOM_ATX;
-        }
-#elif defined(KD_WINDOW_WAYLAND) || defined(KD_WINDOW_X11)
-        /* KD_KEY_ACCEPT_ATX */
-        case(XKB_KEY_Redo):
-        {
-            return KD_KEY_AGAIN_ATX;
-        }
-        /* KD_KEY_ALLCANDIDATES_ATX */
-        /* KD_KEY_ALPHANUMERIC_ATX */
-        case(XKB_KEY_Alt_L):
-        case(XKB_KEY_Alt_R):
-        {
-            return KD_KEY_ALT_ATX;
-        }
-        /* KD_KEY_ALTGRAPH_ATX */
-        /* KD_KEY_APPS_ATX */
-        /* KD_KEY_ATTN_ATX */
-        case(XKB_KEY_XF86Back):
-        {
-            return KD_KEY_BROWSERBACK_ATX;
-        }
-        case(XKB_KEY_XF86Favorites):
-        {
-            return KD_KEY_BROWSERFAVORITES_ATX;
-        }
-        case(XKB_KEY_XF86Forward):
-        {
-            return KD_KEY_BROWSERFORWARD_ATX;
-        }
-        case(XKB_KEY_XF86HomePage):
-        {
-            return KD_KEY_BROWSERHOME_ATX;
-        }
-        case(XKB_KEY_XF86Refresh):
-        {
-            return KD_KEY_BROWSERREFRESH_ATX;
-        }
-        case(XKB_KEY_XF86Search):
-        {
-            return KD_KEY_BROWSERSEARCH_ATX;
-        }
-        case(XKB_KEY_XF86Stop):
-        {
-            return KD_KEY_BROWSERSTOP_ATX;
-        }
-        case(XKB_KEY_Caps_Lock):
-        {
-            return KD_KEY_CAPSLOCK_ATX;
-        }
-        case(XKB_KEY_Clear):
-        {
-            return KD_KEY_CLEAR_ATX;
-        }
-        case(XKB_KEY_Codeinput):
-        {
-            return KD_KEY_CODEINPUT_ATX;
-        }
-        case(XKB_KEY_Multi_key):
-        {
-            return KD_KEY_COMPOSE_ATX;
-        }
-        case(XKB_KEY_Control_L):
-        case(XKB_KEY_Control_R):
-        {
-            return KD_KEY_CONTROL_ATX;
-        }
-        /* KD_KEY_CRSEL_ATX */
-        /* KD_KEY_CONVERT_ATX */
-        case(XKB_KEY_XF86Copy):
-        {
-            return KD_KEY_COPY_ATX;
-        }
-        case(XKB_KEY_XF86Cut):
-        {
-            return KD_KEY_CUT_ATX;
-        }
-        case(XKB_KEY_Down):
-        case(XKB_KEY_KP_Down):
-        {
-            return KD_KEY_DOWN_ATX;
-        }
-        case(XKB_KEY_End):
-        case(XKB_KEY_KP_End):
-        {
-            return KD_KEY_END_ATX;
-        }
-        case(XKB_KEY_Return):
-        case(XKB_KEY_KP_Enter):
-        case(XKB_KEY_ISO_Enter):
-        {
-            return KD_KEY_ENTER_ATX;
-        }
-        /* KD_KEY_ERASEEOF_ATX */
-        case(XKB_KEY_Execute):
-        {
-            return KD_KEY_EXECUTE_ATX;
-        }
-        /* KD_KEY_EXSEL_ATX */
-        case(XKB_KEY_F1):
-        case(XKB_KEY_KP_F1):
-        {
-            return KD_KEY_F1_ATX;
-        }
-        case(XKB_KEY_F2):
-        case(XKB_KEY_KP_F2):
-        {
-            return KD_KEY_F2_ATX;
-        }
-        case(XKB_KEY_F3):
-        case(XKB_KEY_KP_F3):
-        {
-            return KD_KEY_F3_ATX;
-        }
-        case(XKB_KEY_F4):
-        case(XKB_KEY_KP_F4):
-        {
-            return KD_KEY_F4_ATX;
-        }
-        case(XKB_KEY_F5):
-        {
-            return KD_KEY_F5_ATX;
-        }
-        case(XKB_KEY_F6):
-        {
-            return KD_KEY_F6_ATX;
-        }
-        case(XKB_KEY_F7):
-        {
-            return KD_KEY_F7_ATX;
-        }
-        case(XKB_KEY_F8):
-        {
-            return KD_KEY_F8_ATX;
-        }
-        case(XKB_KEY_F9):
-        {
-            return KD_KEY_F9_ATX;
-        }
-        case(XKB_KEY_F10):
-        {
-            return KD_KEY_F10_ATX;
-        }
-        case(XKB_KEY_F11):
-        {
-            return KD_KEY_F11_ATX;
-        }
-        case(XKB_KEY_F12):
-        {
-            return KD_KEY_F12_ATX;
-        }
-        case(XKB_KEY_F13):
-        {
-            return KD_KEY_F13_ATX;
-        }
-        case(XKB_KEY_F14):
-        {
-            return KD_KEY_F14_ATX;
-        }
-        case(XKB_KEY_F15):
-        {
-            return KD_KEY_F15_ATX;
-        }
-        case(XKB_KEY_F16):
-        {
-            return KD_KEY_F16_ATX;
-        }
-        case(XKB_KEY_F17):
-        {
-            return KD_KEY_F17_ATX;
-        }
-        case(XKB_KEY_F18):
-        {
-            return KD_KEY_F18_ATX;
-        }
-        case(XKB_KEY_F19):
-        {
-            return KD_KEY_F19_ATX;
-        }
-        case(XKB_KEY_F20):
-        {
-            return KD_KEY_F20_ATX;
-        }
-        case(XKB_KEY_F21):
-        {
-            return KD_KEY_F21_ATX;
-        }
-        case(XKB_KEY_F22):
-        {
-            return KD_KEY_F22_ATX;
-        }
-        case(XKB_KEY_F23):
-        {
-            return KD_KEY_F23_ATX;
-        }
-        case(XKB_KEY_F24):
-        {
-            return KD_KEY_F24_ATX;
-        }
-        /* KD_KEY_FINALMODE_ATX */
-        case(XKB_KEY_Find):
-        {
-            return KD_KEY_FIND_ATX;
-        }
-        /* KD_KEY_FULLWIDTH_ATX
-           KD_KEY_HALFWIDTH_ATX
-           KD_KEY_HANGULMODE_ATX
-           KD_KEY_HANJAMODE_ATX */
-        case(XKB_KEY_Help):
-        {
-            return KD_KEY_HELP_ATX;
-        }
-        case(XKB_KEY_Hiragana):
-        {
-            return KD_KEY_HIRAGANA_ATX;
-        }
-        case(XKB_KEY_Home):
-        {
-            return KD_KEY_HOME_ATX;
-        }
-        case(XKB_KEY_Insert):
-        {
-            return KD_KEY_INSERT_ATX;
-        }
-        /* KD_KEY_JAPANESEHIRAGANA_ATX
-           KD_KEY_JAPANESEKATAKANA_ATX
-           KD_KEY_JAPANESEROMAJI_ATX
-           KD_KEY_JUNJAMODE_ATX
-           KD_KEY_KANAMODE_ATX
-           KD_KEY_KANJIMODE_ATX
-           KD_KEY_KATAKANA_ATX */
-        case(XKB_KEY_XF86Launch0):
-        {
-            return KD_KEY_LAUNCHAPPLICATION1_ATX;
-        }
-        case(XKB_KEY_XF86Launch1):
-        {
-            return KD_KEY_LAUNCHAPPLICATION2_ATX;
-        }
-        case(XKB_KEY_XF86Mail):
-        {
-            return KD_KEY_LAUNCHMAIL_ATX;
-        }
-        case(XKB_KEY_Left):
-        {
-            return KD_KEY_LEFT_ATX;
-        }
-        case(XKB_KEY_Meta_L):
-        case(XKB_KEY_Meta_R):
-        {
-            return KD_KEY_META_ATX;
-        }
-        case(XKB_KEY_XF86AudioForward):
-        {
-            return KD_KEY_MEDIANEXTTRACK_ATX;
-        }
-        case(XKB_KEY_XF86AudioPlay):
-        case(XKB_KEY_XF86AudioPause):
-        {
-            return KD_KEY_MEDIAPLAYPAUSE_ATX;
-        }
-        case(XKB_KEY_XF86AudioPrev):
-        {
-            return KD_KEY_MEDIAPREVIOUSTRACK_ATX;
-        }
-        case(XKB_KEY_XF86AudioStop):
-        {
-            return KD_KEY_MEDIASTOP_ATX;
-        }
-        case(XKB_KEY_Mode_switch):
-        {
-            return KD_KEY_MODECHANGE_ATX;
-        }
-        /* KD_KEY_NONCONVERT_ATX */
-        case(XKB_KEY_Num_Lock):
-        {
-            return KD_KEY_NUMLOCK_ATX;
-        }
-        case(XKB_KEY_Page_Down):
-        case(XKB_KEY_KP_Page_Down):
-        {
-            return KD_KEY_PAGEDOWN_ATX;
-        }
-        case(XKB_KEY_KP_Up):
-        case(XKB_KEY_KP_Page_Up):
-        {
-            return KD_KEY_PAGEUP_ATX;
-        }
-        case(XKB_KEY_Pause):
-        {
-            return KD_KEY_PAUSE_ATX;
-        }
-        /* KD_KEY_PLAY_ATX */
-        /* KD_KEY_PREVIOUSCANDIDATE_ATX */
-        case(XKB_KEY_Print):
-        {
-            return KD_KEY_PRINTSCREEN_ATX;
-        }
-        /* KD_KEY_PROCESS_ATX */
-        /* KD_KEY_PROPS_ATX */
-        case(XKB_KEY_Right):
-        {
-            return KD_KEY_RIGHT_ATX;
-        }
-        /* KD_KEY_ROMANCHARACTERS_ATX */
-        /* KD_KEY_SCROLL_ATX */
-        case(XKB_KEY_Select):
-        {
-            return KD_KEY_SELECT_ATX;
-        }
-        case(XKB_KEY_XF86AudioMedia):
+static const KDint32 __kd_keycodes[] = {
+    [VK_ACCEPT] = KD_KEY_ACCEPT_ATX,
+    /* KD_KEY_AGAIN_ATX */
+    /* KD_KEY_ALLCANDIDATES_ATX */
+    /* KD_KEY_ALPHANUMERIC_ATX */
+    [VK_MENU] = KD_KEY_ALT_ATX,
+    /* KD_KEY_ALTGRAPH_ATX */
+    [VK_APPS] = KD_KEY_APPS_ATX,
+    [VK_ATTN] = KD_KEY_ATTN_ATX,
+    [VK_BACK] = KD_KEY_BROWSERBACK_ATX,
+    [VK_BROWSER_FAVORITES] = KD_KEY_BROWSERFAVORITES_ATX,
+    [VK_BROWSER_FORWARD] = KD_KEY_BROWSERFORWARD_ATX,
+    [VK_BROWSER_HOME] = KD_KEY_BROWSERHOME_ATX,
+    [VK_BROWSER_REFRESH] = KD_KEY_BROWSERREFRESH_ATX,
+    [VK_BROWSER_SEARCH] = KD_KEY_BROWSERSEARCH_ATX,
+    [VK_BROWSER_STOP] = KD_KEY_BROWSERSTOP_ATX,
+    [VK_CAPITAL] = KD_KEY_CAPSLOCK_ATX,
+    [VK_CLEAR] = KD_KEY_CLEAR_ATX,
+    [VK_OEM_CLEAR] = KD_KEY_CLEAR_ATX,
+    /* KD_KEY_CODEINPUT_ATX */
+    /* KD_KEY_COMPOSE_ATX */
+    [VK_CONTROL] = KD_KEY_CONTROL_ATX,
+    [VK_CRSEL] = KD_KEY_CRSEL_ATX,
+    [VK_CONVERT] = KD_KEY_CONVERT_ATX,
+    /* KD_KEY_COPY_ATX */
+    /* KD_KEY_CUT_ATX */
+    [VK_DOWN] = KD_KEY_DOWN_ATX,
+    [VK_END] = KD_KEY_END_ATX,
+    [VK_RETURN] = KD_KEY_ENTER_ATX,
+    [VK_EREOF] = KD_KEY_ERASEEOF_ATX,
+    [VK_EXECUTE] = KD_KEY_EXECUTE_ATX,
+    [VK_EXSEL] = KD_KEY_EXSEL_ATX,
+    [VK_F1] = KD_KEY_F1_ATX,
+    [VK_F2] = KD_KEY_F2_ATX,
+    [VK_F3] = KD_KEY_F3_ATX,
+    [VK_F4] = KD_KEY_F4_ATX,
+    [VK_F5] = KD_KEY_F5_ATX,
+    [VK_F6] = KD_KEY_F6_ATX,
+    [VK_F7] = KD_KEY_F7_ATX,
+    [VK_F8] = KD_KEY_F8_ATX,
+    [VK_F9] = KD_KEY_F9_ATX,
+    [VK_F10] = KD_KEY_F10_ATX,
+    [VK_F11] = KD_KEY_F11_ATX,
+    [VK_F12] = KD_KEY_F12_ATX,
+    [VK_F13] = KD_KEY_F13_ATX,
+    [VK_F14] = KD_KEY_F14_ATX,
+    [VK_F15] = KD_KEY_F15_ATX,
+    [VK_F16] = KD_KEY_F16_ATX,
+    [VK_F17] = KD_KEY_F17_ATX,
+    [VK_F18] = KD_KEY_F18_ATX,
+    [VK_F19] = KD_KEY_F19_ATX,
+    [VK_F20] = KD_KEY_F20_ATX,
+    [VK_F21] = KD_KEY_F21_ATX,
+    [VK_F22] = KD_KEY_F22_ATX,
+    [VK_F23] = KD_KEY_F23_ATX,
+    [VK_F24] = KD_KEY_F24_ATX,
+    [VK_FINAL] = KD_KEY_FINALMODE_ATX,
+    /* KD_KEY_FIND_ATX
+       KD_KEY_FULLWIDTH_ATX
+       KD_KEY_HALFWIDTH_ATX */
+    [VK_HANGUL] = KD_KEY_HANGULMODE_ATX,
+    [VK_HANJA] = KD_KEY_HANJAMODE_ATX,
+    [VK_HELP] = KD_KEY_HELP_ATX,
+    /* KD_KEY_HIRAGANA_ATX */
+    [VK_HOME] = KD_KEY_HOME_ATX,
+    [VK_INSERT] = KD_KEY_INSERT_ATX,
+    /* KD_KEY_JAPANESEHIRAGANA_ATX
+       KD_KEY_JAPANESEKATAKANA_ATX
+       KD_KEY_JAPANESEROMAJI_ATX
+       KD_KEY_JUNJAMODE_ATX
+       KD_KEY_KANAMODE_ATX
+       KD_KEY_KANJIMODE_ATX
+       KD_KEY_KATAKANA_ATX */
+    [VK_LAUNCH_APP1] = KD_KEY_LAUNCHAPPLICATION1_ATX,
+    [VK_LAUNCH_APP2] = KD_KEY_LAUNCHAPPLICATION2_ATX,
+    [VK_LAUNCH_MAIL] = KD_KEY_LAUNCHMAIL_ATX,
+    [VK_LEFT] = KD_KEY_LEFT_ATX,
+    /* KD_KEY_META_ATX */
+    [VK_MEDIA_NEXT_TRACK] = KD_KEY_MEDIANEXTTRACK_ATX,
+    [VK_MEDIA_PLAY_PAUSE] = KD_KEY_MEDIAPLAYPAUSE_ATX,
+    [VK_MEDIA_PREV_TRACK] = KD_KEY_MEDIAPREVIOUSTRACK_ATX,
+    [VK_MEDIA_STOP] = KD_KEY_MEDIASTOP_ATX,
+    [VK_MODECHANGE] = KD_KEY_MODECHANGE_ATX,
+    [VK_NONCONVERT] = KD_KEY_NONCONVERT_ATX,
+    [VK_NUMLOCK] = KD_KEY_NUMLOCK_ATX,
+    [VK_NEXT] = KD_KEY_PAGEDOWN_ATX,
+    [VK_PRIOR] = KD_KEY_PAGEUP_ATX,
+    [VK_PAUSE] = KD_KEY_PAUSE_ATX,
+    [VK_PLAY] = KD_KEY_PLAY_ATX,
+    /* KD_KEY_PREVIOUSCANDIDATE_ATX */
+    [VK_PRINT] = KD_KEY_PRINTSCREEN_ATX,
+    [VK_PROCESSKEY] = KD_KEY_PROCESS_ATX,
+    /* KD_KEY_PROPS_ATX */
+    [VK_RIGHT] = KD_KEY_RIGHT_ATX,
+    /* KD_KEY_ROMANCHARACTERS_ATX */
+    [VK_SCROLL] = KD_KEY_SCROLL_ATX,
+    [VK_SELECT] = KD_KEY_SELECT_ATX,
+    [VK_LAUNCH_MEDIA_SELECT] = KD_KEY_SELECTMEDIA_ATX,
+    [VK_SHIFT] = KD_KEY_SHIFT_ATX,
+    [VK_CANCEL] = KD_KEY_STOP_ATX,
+    [VK_UP] = KD_KEY_UP_ATX,
+    /* KD_KEY_UNDO_ATX */
+    [VK_VOLUME_DOWN] = KD_KEY_VOLUMEDOWN_ATX,
+    [VK_VOLUME_MUTE] = KD_KEY_VOLUMEMUTE_ATX,
+    [VK_VOLUME_UP] = KD_KEY_VOLUMEUP_ATX,
+    [VK_LWIN] = KD_KEY_WIN_ATX,
+    [VK_RWIN] = KD_KEY_WIN_ATX,
+    [VK_ZOOM] = KD_KEY_ZOOM_ATX,
+};
+#elif defined(KD_WINDOW_EMSCRIPTEN)
+static const KDint32 __kd_keycodes[] = {
+    [30] = KD_KEY_ACCEPT_ATX,
+    /* KD_KEY_AGAIN_ATX */
+    /* KD_KEY_ALLCANDIDATES_ATX */
+    /* KD_KEY_ALPHANUMERIC_ATX */
+    [18] = KD_KEY_ALT_ATX,
+    /* KD_KEY_ALTGRAPH_ATX */
+    /* KD_KEY_APPS_ATX */
+    [240] = KD_KEY_ATTN_ATX,
+    [246] = KD_KEY_ATTN_ATX,
+    /* KD_KEY_BROWSERBACK_ATX
+       KD_KEY_BROWSERFAVORITES_ATX
+       KD_KEY_BROWSERFORWARD_ATX
+       KD_KEY_BROWSERHOME_ATX
+       KD_KEY_BROWSERREFRESH_ATX
+       KD_KEY_BROWSERSEARCH_ATX
+       KD_KEY_BROWSERSTOP_ATX */
+    [20] = KD_KEY_CAPSLOCK_ATX,
+    [12] = KD_KEY_CLEAR_ATX,
+    [230] = KD_KEY_CLEAR_ATX,
+    [254] = KD_KEY_CLEAR_ATX,
+    /* KD_KEY_CODEINPUT_ATX
+       KD_KEY_COMPOSE_ATX */
+    [17] = KD_KEY_CONTROL_ATX,
+    [247] = KD_KEY_CRSEL_ATX,
+    [28] = KD_KEY_CONVERT_ATX,
+    [242] = KD_KEY_COPY_ATX,
+    /* KD_KEY_CUT_ATX */
+    [40] = KD_KEY_DOWN_ATX,
+    [35] = KD_KEY_END_ATX,
+    [13] = KD_KEY_ENTER_ATX,
+    [249] = KD_KEY_ERASEEOF_ATX,
+    [43] = KD_KEY_EXECUTE_ATX,
+    [248] = KD_KEY_EXSEL_ATX,
+    [112] = KD_KEY_F1_ATX,
+    [113] = KD_KEY_F2_ATX,
+    [114] = KD_KEY_F3_ATX,
+    [115] = KD_KEY_F4_ATX,
+    [116] = KD_KEY_F5_ATX,
+    [117] = KD_KEY_F6_ATX,
+    [118] = KD_KEY_F7_ATX,
+    [119] = KD_KEY_F8_ATX,
+    [120] = KD_KEY_F9_ATX,
+    [121] = KD_KEY_F10_ATX,
+    [122] = KD_KEY_F11_ATX,
+    [123] = KD_KEY_F12_ATX,
+    [124] = KD_KEY_F13_ATX,
+    [125] = KD_KEY_F14_ATX,
+    [126] = KD_KEY_F15_ATX,
+    [127] = KD_KEY_F16_ATX,
+    [128] = KD_KEY_F17_ATX,
+    [129] = KD_KEY_F18_ATX,
+    [130] = KD_KEY_F19_ATX,
+    [131] = KD_KEY_F20_ATX,
+    [132] = KD_KEY_F21_ATX,
+    [133] = KD_KEY_F22_ATX,
+    [134] = KD_KEY_F23_ATX,
+    [135] = KD_KEY_F24_ATX,
+    [24] = KD_KEY_FINALMODE_ATX,
+    /* KD_KEY_FIND_ATX
+       KD_KEY_FULLWIDTH_ATX
+       KD_KEY_HALFWIDTH_ATX */
+    [21] = KD_KEY_HANGULMODE_ATX,
+    [25] = KD_KEY_HANJAMODE_ATX,
+    [6] = KD_KEY_HELP_ATX,
+    /* KD_KEY_HIRAGANA_ATX */
+    [36] = KD_KEY_HOME_ATX,
+    [45] = KD_KEY_INSERT_ATX,
+    /* KD_KEY_JAPANESEHIRAGANA_ATX
+       KD_KEY_JAPANESEKATAKANA_ATX
+       KD_KEY_JAPANESEROMAJI_ATX
+       KD_KEY_JUNJAMODE_ATX
+       KD_KEY_KANAMODE_ATX
+       KD_KEY_KANJIMODE_ATX
+       KD_KEY_KATAKANA_ATX */
+    /* KD_KEY_LAUNCHAPPLICATION1_ATX
+       KD_KEY_LAUNCHAPPLICATION2_ATX
+       KD_KEY_LAUNCHMAIL_ATX*/
+    [37] = KD_KEY_LEFT_ATX,
+    [224] = KD_KEY_META_ATX,
+    /* KD_KEY_MEDIANEXTTRACK_ATX;
+       KD_KEY_MEDIAPLAYPAUSE_ATX
+       KD_KEY_MEDIAPREVIOUSTRACK_ATX
+       KD_KEY_MEDIASTOP_ATX */
+    [31] = KD_KEY_MODECHANGE_ATX,
+    [29] = KD_KEY_NONCONVERT_ATX,
+    [144] = KD_KEY_NUMLOCK_ATX,
+    [34] = KD_KEY_PAGEDOWN_ATX,
+    [33] = KD_KEY_PAGEUP_ATX,
+    [19] = KD_KEY_PAUSE_ATX,
+    [250] = KD_KEY_PLAY_ATX,
+    /* KD_KEY_PREVIOUSCANDIDATE_ATX */
+    [42] = KD_KEY_PRINTSCREEN_ATX,
+    /* KD_KEY_PROCESS_ATX */
+    /* KD_KEY_PROPS_ATX */
+    [39] = KD_KEY_RIGHT_ATX,
+    /* KD_KEY_ROMANCHARACTERS_ATX */
+    [145] = KD_KEY_SCROLL_ATX,
+    [41] = KD_KEY_SELECT_ATX,
+    /* KD_KEY_SELECTMEDIA_ATX */
+    [16] = KD_KEY_SHIFT_ATX,
+    [3] = KD_KEY_STOP_ATX,
+    [38] = KD_KEY_UP_ATX,
+    /* KD_KEY_UNDO_ATX */
+    [182] = KD_KEY_VOLUMEDOWN_ATX,
+    [181] = KD_KEY_VOLUMEMUTE_ATX,
+    [183] = KD_KEY_VOLUMEUP_ATX,
+    [91] = KD_KEY_WIN_ATX,
+    [251] = KD_KEY_ZOOM_ATX,
+};
+#elif defined(KD_WINDOW_WAYLAND) || defined(KD_WINDOW_X11)
+/* Keysyms 0xff00 to 0xffff */
+static const KDint32 __kd_keysyms[256] = {
+    /* KD_KEY_ACCEPT_ATX */
+    [XKB_KEY_Redo & 0xff] = KD_KEY_AGAIN_ATX,
+    /* KD_KEY_ALLCANDIDATES_ATX */
+    /* KD_KEY_ALPHANUMERIC_ATX */
+    [XKB_KEY_Alt_L & 0xff] = KD_KEY_ALT_ATX,
+    [XKB_KEY_Alt_R & 0xff] = KD_KEY_ALT_ATX,
+    /* KD_KEY_ALTGRAPH_ATX */
+    /* KD_KEY_APPS_ATX */
+    /* KD_KEY_ATTN_ATX */
+    [XKB_KEY_Caps_Lock & 0xff] = KD_KEY_CAPSLOCK_ATX,
+    [XKB_KEY_Clear & 0xff] = KD_KEY_CLEAR_ATX,
+    [XKB_KEY_Codeinput & 0xff] = KD_KEY_CODEINPUT_ATX,
+    [XKB_KEY_Multi_key & 0xff] = KD_KEY_COMPOSE_ATX,
+    [XKB_KEY_Control_L & 0xff] = KD_KEY_CONTROL_ATX,
+    [XKB_KEY_Control_R & 0xff] = KD_KEY_CONTROL_ATX,
+    /* KD_KEY_CRSEL_ATX */
+    /* KD_KEY_CONVERT_ATX */
+    [XKB_KEY_Down & 0xff] = KD_KEY_DOWN_ATX,
+    [XKB_KEY_KP_Down & 0xff] = KD_KEY_DOWN_ATX,
+    [XKB_KEY_End & 0xff] = KD_KEY_END_ATX,
+    [XKB_KEY_KP_End & 0xff] = KD_KEY_END_ATX,
+    [XKB_KEY_Return & 0xff] = KD_KEY_ENTER_ATX,
+    [XKB_KEY_KP_Enter & 0xff] = KD_KEY_ENTER_ATX,
+    /* XKB_KEY_ISO_Enter is on another page, see __KDKeycodeLookup */
+    /* KD_KEY_ERASEEOF_ATX */
+    [XKB_KEY_Execute & 0xff] = KD_KEY_EXECUTE_ATX,
+    /* KD_KEY_EXSEL_ATX */
+    [XKB_KEY_F1 & 0xff] = KD_KEY_F1_ATX,
+    [XKB_KEY_KP_F1 & 0xff] = KD_KEY_F1_ATX,
+    [XKB_KEY_F2 & 0xff] = KD_KEY_F2_ATX,
+    [XKB_KEY_KP_F2 & 0xff] = KD_KEY_F2_ATX,
+    [XKB_KEY_F3 & 0xff] = KD_KEY_F3_ATX,
+    [XKB_KEY_KP_F3 & 0xff] = KD_KEY_F3_ATX,
+    [XKB_KEY_F4 & 0xff] = KD_KEY_F4_ATX,
+    [XKB_KEY_KP_F4 & 0xff] = KD_KEY_F4_ATX,
+    [XKB_KEY_F5 & 0xff] = KD_KEY_F5_ATX,
+    [XKB_KEY_F6 & 0xff] = KD_KEY_F6_ATX,
+    [XKB_KEY_F7 & 0xff] = KD_KEY_F7_ATX,
+    [XKB_KEY_F8 & 0xff] = KD_KEY_F8_ATX,
+    [XKB_KEY_F9 & 0xff] = KD_KEY_F9_ATX,
+    [XKB_KEY_F10 & 0xff] = KD_KEY_F10_ATX,
+    [XKB_KEY_F11 & 0xff] = KD_KEY_F11_ATX,
+    [XKB_KEY_F12 & 0xff] = KD_KEY_F12_ATX,
+    [XKB_KEY_F13 & 0xff] = KD_KEY_F13_ATX,
+    [XKB_KEY_F14 & 0xff] = KD_KEY_F14_ATX,
+    [XKB_KEY_F15 & 0xff] = KD_KEY_F15_ATX,
+    [XKB_KEY_F16 & 0xff] = KD_KEY_F16_ATX,
+    [XKB_KEY_F17 & 0xff] = KD_KEY_F17_ATX,
+    [XKB_KEY_F18 & 0xff] = KD_KEY_F18_ATX,
+    [XKB_KEY_F19 & 0xff] = KD_KEY_F19_ATX,
+    [XKB_KEY_F20 & 0xff] = KD_KEY_F20_ATX,
+    [XKB_KEY_F21 & 0xff] = KD_KEY_F21_ATX,
+    [XKB_KEY_F22 & 0xff] = KD_KEY_F22_ATX,
+    [XKB_KEY_F23 & 0xff] = KD_KEY_F23_ATX,
+    [XKB_KEY_F24 & 0xff] = KD_KEY_F24_ATX,
+    /* KD_KEY_FINALMODE_ATX */
+    [XKB_KEY_Find & 0xff] = KD_KEY_FIND_ATX,
+    /* KD_KEY_FULLWIDTH_ATX
+       KD_KEY_HALFWIDTH_ATX
+       KD_KEY_HANGULMODE_ATX
+       KD_KEY_HANJAMODE_ATX */
+    [XKB_KEY_Help & 0xff] = KD_KEY_HELP_ATX,
+    [XKB_KEY_Hiragana & 0xff] = KD_KEY_HIRAGANA_ATX,
+    [XKB_KEY_Home & 0xff] = KD_KEY_HOME_ATX,
+    [XKB_KEY_Insert & 0xff] = KD_KEY_INSERT_ATX,
+    /* KD_KEY_JAPANESEHIRAGANA_ATX
+       KD_KEY_JAPANESEKATAKANA_ATX
+       KD_KEY_JAPANESEROMAJI_ATX
+       KD_KEY_JUNJAMODE_ATX
+       KD_KEY_KANAMODE_ATX
+       KD_KEY_KANJIMODE_ATX
+       KD_KEY_KATAKANA_ATX */
+    [XKB_KEY_Left & 0xff] = KD_KEY_LEFT_ATX,
+    [XKB_KEY_Meta_L & 0xff] = KD_KEY_META_ATX,
+    [XKB_KEY_Meta_R & 0xff] = KD_KEY_META_ATX,
+    [XKB_KEY_Mode_switch & 0xff] = KD_KEY_MODECHANGE_ATX,
+    /* KD_KEY_NONCONVERT_ATX */
+    [XKB_KEY_Num_Lock & 0xff] = KD_KEY_NUMLOCK_ATX,
+    [XKB_KEY_Page_Down & 0xff] = KD_KEY_PAGEDOWN_ATX,
+    [XKB_KEY_KP_Page_Down & 0xff] = KD_KEY_PAGEDOWN_ATX,
+    [XKB_KEY_KP_Up & 0xff] = KD_KEY_PAGEUP_ATX,
+    [XKB_KEY_KP_Page_Up & 0xff] = KD_KEY_PAGEUP_ATX,
+    [XKB_KEY_Pause & 0xff] = KD_KEY_PAUSE_ATX,
+    /* KD_KEY_PLAY_ATX */
+    /* KD_KEY_PREVIOUSCANDIDATE_ATX */
+    [XKB_KEY_Print & 0xff] = KD_KEY_PRINTSCREEN_ATX,
+    /* KD_KEY_PROCESS_ATX */
+    /* KD_KEY_PROPS_ATX */
+    [XKB_KEY_Right & 0xff] = KD_KEY_RIGHT_ATX,
+    /* KD_KEY_ROMANCHARACTERS_ATX */
+    /* KD_KEY_SCROLL_ATX */
+    [XKB_KEY_Select & 0xff] = KD_KEY_SELECT_ATX,
+    [XKB_KEY_Shift_L & 0xff] = KD_KEY_SHIFT_ATX,
+    [XKB_KEY_Shift_R & 0xff] = KD_KEY_SHIFT_ATX,
+    [XKB_KEY_Cancel & 0xff] = KD_KEY_STOP_ATX,
+    [XKB_KEY_Up & 0xff] = KD_KEY_UP_ATX,
+    [XKB_KEY_Undo & 0xff] = KD_KEY_UNDO_ATX,
+    [XKB_KEY_Super_L & 0xff] = KD_KEY_WIN_ATX,
+    [XKB_KEY_Super_R & 0xff] = KD_KEY_WIN_ATX,
+    /* KD_KEY_ZOOM_ATX */
+};
+/* XF86 keysyms 0x1008ff00 to 0x1008ffff */
+static const KDint32 __kd_xf86keysyms[256] = {
+    [XKB_KEY_XF86Back & 0xff] = KD_KEY_BROWSERBACK_ATX,
+    [XKB_KEY_XF86Favorites & 0xff] = KD_KEY_BROWSERFAVORITES_ATX,
+    [XKB_KEY_XF86Forward & 0xff] = KD_KEY_BROWSERFORWARD_ATX,
+    [XKB_KEY_XF86HomePage & 0xff] = KD_KEY_BROWSERHOME_ATX,
+    [XKB_KEY_XF86Refresh & 0xff] = KD_KEY_BROWSERREFRESH_ATX,
+    [XKB_KEY_XF86Search & 0xff] = KD_KEY_BROWSERSEARCH_ATX,
+    [XKB_KEY_XF86Stop & 0xff] = KD_KEY_BROWSERSTOP_ATX,
+    [XKB_KEY_XF86Copy & 0xff] = KD_KEY_COPY_ATX,
+    [XKB_KEY_XF86Cut & 0xff] = KD_KEY_CUT_ATX,
+    [XKB_KEY_XF86Launch0 & 0xff] = KD_KEY_LAUNCHAPPLICATION1_ATX,
+    [XKB_KEY_XF86Launch1 & 0xff] = KD_KEY_LAUNCHAPPLICATION2_ATX,
+    [XKB_KEY_XF86Mail & 0xff] = KD_KEY_LAUNCHMAIL_ATX,
+    [XKB_KEY_XF86AudioForward & 0xff] = KD_KEY_MEDIANEXTTRACK_ATX,
+    [XKB_KEY_XF86AudioPlay & 0xff] = KD_KEY_MEDIAPLAYPAUSE_ATX,
+    [XKB_KEY_XF86AudioPause & 0xff] = KD_KEY_MEDIAPLAYPAUSE_ATX,
+    [XKB_KEY_XF86AudioPrev & 0xff] = KD_KEY_MEDIAPREVIOUSTRACK_ATX,
+    [XKB_KEY_XF86AudioStop & 0xff] = KD_KEY_MEDIASTOP_ATX,
+    [XKB_KEY_XF86AudioMedia & 0xff] = KD_KEY_SELECTMEDIA_ATX,
+    [XKB_KEY_XF86AudioLowerVolume & 0xff] = KD_KEY_VOLUMEDOWN_ATX,
+    [XKB_KEY_XF86AudioMute & 0xff] = KD_KEY_VOLUMEMUTE_ATX,
+    [XKB_KEY_XF86AudioRaiseVolume & 0xff] = KD_KEY_VOLUMEUP_ATX,
+};
+#endif
+
+static KDint32 __KDKeycodeLookup(KD_UNUSED KDint32 keycode)
+{
+#if defined(KD_WINDOW_ANDROID) || defined(KD_WINDOW_WIN32) || defined(KD_WINDOW_EMSCRIPTEN)
+    if(keycode >= 0 && (KDsize)keycode < sizeof(__kd_keycodes) / sizeof(__kd_keycodes[0]))
+    {
+        return __kd_keycodes[keycode];
+    }
+#elif defined(KD_WINDOW_WAYLAND) || defined(KD_WINDOW_X11)
+    switch((KDuint32)keycode >> 8)
+    {
+        case(XKB_KEY_Home >> 8):
         {
-            return KD_KEY_SELECTMEDIA_ATX;
+            return __kd_keysyms[keycode & 0xff];
         }
-        case(XKB_KEY_Shift_L):
-        case(XKB_KEY_Shift_R):
+        case(XKB_KEY_XF86Back >> 8):
         {
-            return KD_KEY_SHIFT_ATX;
+            return __kd_xf86keysyms[keycode & 0xff];
         }
-        case(XKB_KEY_Cancel):
+        default:
         {
-            return KD_KEY_STOP_ATX;
+            break;
         }
-        case(XKB_KEY_Up):
+    }
+    if(keycode == XKB_KEY_ISO_Enter)
+    {
+        return KD_KEY_ENTER_ATX;
+    }
+#endif
+    return 0;
+}
+
+KD_API KDint32 KD_APIENTRY kdTranslateKeycodeVEN(KDint32 keycode)
+{
+    return __KDKeycodeLookup(keycode);
+}
+
+#if defined(KD_WINDOW_WAYLAND) || defined(KD_WINDOW_X11)
+/* Modifier indices are resolved by name once per keymap, key events only test the effective mask. */
+static const KDuint32 __kd_xkbmodifierflags[4] = {KD_KEY_MODIFIER_SHIFT_ATX, KD_KEY_MODIFIER_CTRL_ATX, KD_KEY_MODIFIER_ALT_ATX, KD_KEY_MODIFIER_META_ATX};
+static void __kdXkbCacheModifiers(KDWindow *window)
+{
+    static const KDchar *const names[4] = {XKB_MOD_NAME_SHIFT, XKB_MOD_NAME_CTRL, XKB_MOD_NAME_ALT, XKB_MOD_NAME_LOGO};
+    for(KDint i = 0; i < 4; i++)
+    {
+        xkb_mod_index_t index = window->xkb.keymap ? xkb_keymap_mod_get_index(window->xkb.keymap, names[i]) : XKB_MOD_INVALID;
+        window->xkb.modifiers[i] = (index < 32) ? ((xkb_mod_mask_t)1 << index) : 0;
+    }
+}
+static KDuint32 __kdXkbModifierFlags(KDWindow *window)
+{
+    xkb_mod_mask_t active = xkb_state_serialize_mods(window->xkb.state, XKB_STATE_MODS_EFFECTIVE);
+    KDuint32 flags = 0;
+    for(KDint i = 0; i < 4; i++)
+    {
+        if(active & window->xkb.modifiers[i])
         {
-            return KD_KEY_UP_ATX;
+            flags |= __kd_xkbmodifierflags[i];
         }
-        case(XKB_KEY_Undo):
+    }
+    return flags;
+}
+#endif
+
+#if defined(KD_WINDOW_NULL)
+/* Headless unless a display server backend is built and wanted. */
+static KDboolean __kdWindowNullRequested(void)
+{
+    return kdStrstrVEN(kdGetEnvVEN("KD_WINDOW_PLATFORM"), "null") != KD_NULL;
+}
+static KDboolean __kdWindowNullSelected(void)
+{
+#if defined(KD_WINDOW_WAYLAND)
+    if(__kd_wl_display)
+    {
+        return __kdWindowNullRequested();
+    }
+#endif
+#if defined(KD_WINDOW_X11)
+    /* X11 is the fallback, without a server it has nothing to connect to */
+    return __kdWindowNullRequested() || kdGetEnvVEN("DISPLAY") == KD_NULL;
+#else
+    return KD_TRUE;
+#endif
+}
+
+static KDint __kdWindowNullInject(KDWindow *window, const _KDWindowInput *input)
+{
+    if(window->platform != EGL_PLATFORM_SURFACELESS_MESA)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    kdThreadMutexLock(window->null.mutex);
+    if(window->null.count == window->null.capacity)
+    {
+        KDsize capacity = window->null.capacity ? window->null.capacity * 2 : 64;
+        _KDWindowInput *grown = (_KDWindowInput *)kdMalloc(capacity * sizeof(_KDWindowInput));
+        if(grown == KD_NULL)
         {
-            return KD_KEY_UNDO_ATX;
+            kdThreadMutexUnlock(window->null.mutex);
+            kdSetError(KD_ENOMEM);
+            return -1;
         }
-        case(XKB_KEY_XF86AudioLowerVolume):
+        for(KDsize i = 0; i < window->null.count; i++)
         {
-            return KD_KEY_VOLUMEDOWN_ATX;
+            grown[i] = window->null.input[(window->null.head + i) % window->null.capacity];
         }
-        case(XKB_KEY_XF86AudioMute):
+        kdFree(window->null.input);
+        window->null.input = grown;
+        window->null.head = 0;
+        window->null.capacity = capacity;
+    }
+    window->null.input[(window->null.head + window->null.count) % window->null.capacity] = *input;
+    window->null.count++;
+    KDboolean first = window->null.count == 1;
+    kdThreadMutexUnlock(window->null.mutex);
+    if(first)
+    {
+        /* The window thread may be blocked without a deadline for it */
+        __kdReactorWake(window->originthr->reactor);
+    }
+    return 0;
+}
+
+/* Earliest injected input for the reactor wait, KDINT64_MAX if none. */
+KDust __kdWindowNullNext(KDThread *thread)
+{
+    KDWindow *window = __kd_window;
+    KDust next = KDINT64_MAX;
+    if(window && window->originthr == thread && window->platform == EGL_PLATFORM_SURFACELESS_MESA)
+    {
+        kdThreadMutexLock(window->null.mutex);
+        if(window->null.count > 0)
         {
-            return KD_KEY_VOLUMEMUTE_ATX;
+            next = window->null.input[window->null.head].time;
         }
-        case(XKB_KEY_XF86AudioRaiseVolume):
+        kdThreadMutexUnlock(window->null.mutex);
+    }
+    return next;
+}
+
+/* Turn due input into events, the way a display server connection would. */
+static void __kdWindowNullPump(KDWindow *window)
+{
+    KDust now = kdGetTimeUST();
+    for(;;)
+    {
+        kdThreadMutexLock(window->null.mutex);
+        if(window->null.count == 0 || window->null.input[window->null.head].time > now)
         {
-            return KD_KEY_VOLUMEUP_ATX;
+            kdThreadMutexUnlock(window->null.mutex);
+            break;
         }
-        case(XKB_KEY_Super_L):
-        case(XKB_KEY_Super_R):
+        /* Leave the rest for the next pump rather than overflow the queue,
+         * a key press may add dpad and game keys events */
+        _KDQueue *queue = window->originthr->eventqueue[__kdEventLane(window->null.input[window->null.head].type)];
+        if(__kdQueueSize(queue) + 3 > __KD_EVENT_QUEUE_SIZE)
         {
-            return KD_KEY_WIN_ATX;
+            kdThreadMutexUnlock(window->null.mutex);
+            break;
         }
-/* KD_KEY_ZOOM_ATX */
-#endif
-        default:
+        _KDWindowInput input = window->null.input[window->null.head];
+        window->null.head = (window->null.head + 1) % window->null.capacity;
+        window->null.count--;
+        kdThreadMutexUnlock(window->null.mutex);
+
+        KDEvent *kdevent = kdCreateEvent();
+        kdevent->userptr = window->eventuserptr;
+        kdevent->type = input.type;
+        switch(input.type)
         {
-            return 0;
+            case(KD_EVENT_INPUT_POINTER):
+            {
+                kdevent->data.inputpointer.index = input.index;
+                kdevent->data.inputpointer.select = input.value;
+                kdevent->data.inputpointer.x = input.x;
+                kdevent->data.inputpointer.y = input.y;
+
+                window->states.pointer.select = kdevent->data.inputpointer.select;
+                window->states.pointer.x = kdevent->data.inputpointer.x;
+                window->states.pointer.y = kdevent->data.inputpointer.y;
+                break;
+            }
+            case(KD_EVENT_INPUT_KEY_ATX):
+            {
+                KDEventInputKeyATX *keyevent = (KDEventInputKeyATX *)(&kdevent->data);
+                keyevent->flags = input.flags;
+                keyevent->keycode = input.value;
+
+                window->states.keyboard.flags = keyevent->flags;
+                window->states.keyboard.keycode = keyevent->keycode;
+
+                __kdHandleSpecialKeys(window, keyevent);
+                break;
+            }
+            case(KD_EVENT_INPUT_KEYCHAR_ATX):
+            {
+                KDEventInputKeyCharATX *keycharevent = (KDEventInputKeyCharATX *)(&kdevent->data);
+                keycharevent->flags = input.flags;
+                keycharevent->character = input.value;
+
+                window->states.keyboard.charflags = keycharevent->flags;
+                window->states.keyboard.character = keycharevent->character;
+                break;
+            }
+            default:
+            {
+                break;
+            }
         }
+        __kdDeliverEvent(kdevent);
     }
 }
 #endif
+#endif
 
 KD_API KDint KD_APIENTRY kdPumpEvents(void)
 {
-    KDsize queuesize = __kdQueueSize(kdThreadSelf()->eventqueue);
-    for(KDuint i = 0; i < queuesize; i++)
+    /* Readiness of sockets, timers and the window connection */
+    __kdReactorWait(kdThreadSelf(), 0);
+
+    /* Events posted for a deadline that has passed */
+    __kdEventScheduleRun(kdThreadSelf());
+
+    /* Continuations of futures scheduled on this thread */
+    __kdFutureRunContinuations(kdThreadSelf(), KD_TRUE);
+
+    for(KDint lane = 0; lane < __KD_EVENT_LANES; lane++)
     {
-        KDEvent *callbackevent = __kdQueuePull(kdThreadSelf()->eventqueue);
-        if(callbackevent)
+        _KDQueue *eventqueue = kdThreadSelf()->eventqueue[lane];
+        KDsize queuesize = __kdQueueSize(eventqueue);
+        for(KDuint i = 0; i < queuesize; i++)
         {
-            if(!__kdExecCallback(callbackevent))
+            KDEvent *callbackevent = __kdQueuePull(eventqueue);
+            if(callbackevent && __kdEventDropped(callbackevent))
+            {
+                kdFreeEvent(callbackevent);
+            }
+            else if(callbackevent)
             {
-                /* Not a callback */
-                kdPostEvent(callbackevent);
+                __kdDeliverEventLane(callbackevent, lane);
             }
         }
     }
 
 #ifdef KD_WINDOW_SUPPORTED
     KD_UNUSED KDWindow *window = __kd_window;
+#if defined(KD_WINDOW_NULL)
+    if(window && window->platform == EGL_PLATFORM_SURFACELESS_MESA)
+    {
+        __kdWindowNullPump(window);
+    }
+#endif
 #if defined(KD_WINDOW_ANDROID)
     AInputEvent *aevent = KD_NULL;
     kdThreadMutexLock(__kd_androidinputqueue_mutex);
@@ -1709,10 +1568,7 @@ KD_API KDint KD_APIENTRY kdPumpEvents(void)
                         keycharevent->character = keycode;
                     }
 
-                    if(!__kdExecCallback(event))
-                    {
-                        kdPostEvent(event);
-                    }
+                    __kdDeliverEvent(event);
                     break;
                 }
                 default:
@@ -1741,10 +1597,7 @@ KD_API KDint KD_APIENTRY kdPumpEvents(void)
                 {
                     ShowWindow(window->nativewindow, SW_HIDE);
                     kdevent->type = KD_EVENT_WINDOW_CLOSE;
-                    if(!__kdExecCallback(kdevent))
-                    {
-                        kdPostEvent(kdevent);
-                    }
+                    __kdDeliverEvent(kdevent);
                     break;
                 }
                 case WM_INPUT:
@@ -1854,10 +1707,7 @@ KD_API KDint KD_APIENTRY kdPumpEvents(void)
                             }
                         }
                     }
-                    if(!__kdExecCallback(kdevent))
-                    {
-                        kdPostEvent(kdevent);
-                    }
+                    __kdDeliverEvent(kdevent);
                     break;
                 }
                 default:
@@ -1897,10 +1747,7 @@ KD_API KDint KD_APIENTRY kdPumpEvents(void)
                     window->states.pointer.x = kdevent->data.inputpointer.x;
                     window->states.pointer.y = kdevent->data.inputpointer.y;
 
-                    if(!__kdExecCallback(kdevent))
-                    {
-                        kdPostEvent(kdevent);
-                    }
+                    __kdDeliverEvent(kdevent);
                     break;
                 }
                 case XCB_KEY_PRESS:
@@ -1944,27 +1791,11 @@ KD_API KDint KD_APIENTRY kdPumpEvents(void)
                         {
                             kdevent->type = KD_EVENT_INPUT_KEY_ATX;
                             KDEventInputKeyATX *keyevent = (KDEventInputKeyATX *)(&kdevent->data);
-                            keyevent->flags = 0;
+                            keyevent->flags = __kdXkbModifierFlags(window);
                             if(type == XCB_KEY_PRESS)
                             {
                                 keyevent->flags |= KD_KEY_PRESS_ATX;
                             }
-                            if(xkb_state_mod_name_is_active(window->xkb.state, XKB_MOD_NAME_SHIFT, XKB_STATE_MODS_EFFECTIVE) > 0)
-                            {
-                                keyevent->flags |= KD_KEY_MODIFIER_SHIFT_ATX;
-                            }
-                            if(xkb_state_mod_name_is_active(window->xkb.state, XKB_MOD_NAME_CTRL, XKB_STATE_MODS_EFFECTIVE) > 0)
-                            {
-                                keyevent->flags |= KD_KEY_MODIFIER_CTRL_ATX;
-                            }
-                            if(xkb_state_mod_name_is_active(window->xkb.state, XKB_MOD_NAME_ALT, XKB_STATE_MODS_EFFECTIVE) > 0)
-                            {
-                                keyevent->flags |= KD_KEY_MODIFIER_ALT_ATX;
-                            }
-                            if(xkb_state_mod_name_is_active(window->xkb.state, XKB_MOD_NAME_LOGO, XKB_STATE_MODS_EFFECTIVE) > 0)
-                            {
-                                keyevent->flags |= KD_KEY_MODIFIER_META_ATX;
-                            }
                             keyevent->keycode = keycode;
 
                             window->states.keyboard.flags = keyevent->flags;
@@ -1979,10 +1810,7 @@ KD_API KDint KD_APIENTRY kdPumpEvents(void)
                         }
                     }
 
-                    if(!__kdExecCallback(kdevent))
-                    {
-                        kdPostEvent(kdevent);
-                    }
+                    __kdDeliverEvent(kdevent);
                     break;
                 }
                 case XCB_MOTION_NOTIFY:
@@ -1998,10 +1826,7 @@ KD_API KDint KD_APIENTRY kdPumpEvents(void)
                     window->states.pointer.x = kdevent->data.inputpointer.x;
                     window->states.pointer.y = kdevent->data.inputpointer.y;
 
-                    if(!__kdExecCallback(kdevent))
-                    {
-                        kdPostEvent(kdevent);
-                    }
+                    __kdDeliverEvent(kdevent);
                     break;
                 }
                 case XCB_ENTER_NOTIFY:
@@ -2010,10 +1835,7 @@ KD_API KDint KD_APIENTRY kdPumpEvents(void)
                     kdevent->type = KD_EVENT_WINDOW_FOCUS;
                     kdevent->data.windowfocus.focusstate = (type == XCB_ENTER_NOTIFY) ? 1 : 0;
 
-                    if(!__kdExecCallback(kdevent))
-                    {
-                        kdPostEvent(kdevent);
-                    }
+                    __kdDeliverEvent(kdevent);
                     break;
                 }
                 case XCB_CLIENT_MESSAGE:
@@ -2023,10 +1845,7 @@ KD_API KDint KD_APIENTRY kdPumpEvents(void)
                     if((*(xcb_client_message_event_t *)event).data.data32[0] == (*delreply).atom)
                     {
                         kdevent->type = KD_EVENT_WINDOW_CLOSE;
-                        if(!__kdExecCallback(kdevent))
-                        {
-                            kdPostEvent(kdevent);
-                        }
+                        __kdDeliverEvent(kdevent);
                         break;
                     }
                     kdFreeEvent(kdevent);
@@ -2046,6 +1865,7 @@ KD_API KDint KD_APIENTRY kdPumpEvents(void)
                                 window->xkb.keymap = xkb_x11_keymap_new_from_device(window->xkb.context, window->nativedisplay, device, XKB_KEYMAP_COMPILE_NO_FLAGS);
                                 xkb_state_unref(window->xkb.state);
                                 window->xkb.state = xkb_x11_state_new_from_device(window->xkb.keymap, window->nativedisplay, device);
+                                __kdXkbCacheModifiers(window);
                                 break;
                             }
                             case XCB_XKB_STATE_NOTIFY:
@@ -2072,11 +1892,28 @@ KD_API KDint KD_APIENTRY kdPumpEvents(void)
 #if defined(KD_WINDOW_WAYLAND)
     if(window && window->platform == EGL_PLATFORM_WAYLAND_KHR)
     {
+        /* Read whatever arrived without blocking, the reactor does the waiting */
+        while(wl_display_prepare_read(window->nativedisplay) != 0)
+        {
+            wl_display_dispatch_pending(window->nativedisplay);
+        }
+        wl_display_flush(window->nativedisplay);
+        struct pollfd pfd = {wl_display_get_fd(window->nativedisplay), POLLIN, 0};
+        if(poll(&pfd, 1, 0) > 0)
+        {
+            wl_display_read_events(window->nativedisplay);
+        }
+        else
+        {
+            wl_display_cancel_read(window->nativedisplay);
+        }
         wl_display_dispatch_pending(window->nativedisplay);
     }
 #endif
 #endif
 #endif
+    /* Nothing more to merge with in this pass */
+    __kdFlushCoalescedEvent(kdThreadSelf());
     return 0;
 }
 
@@ -2095,6 +1932,17 @@ KD_API KDint KD_APIENTRY kdInstallCallback(KDCallbackFunc *func, KDint eventtype
             return 0;
         }
     }
+    /* The array starts with a single slot */
+    if(callbackindex > 0)
+    {
+        callbacks = (_KDCallback **)kdRealloc(callbacks, sizeof(_KDCallback *) * (KDsize)(callbackindex + 1));
+        if(callbacks == KD_NULL)
+        {
+            kdSetError(KD_ENOMEM);
+            return -1;
+        }
+        kdThreadSelf()->callbacks = callbacks;
+    }
     callbacks[callbackindex] = (_KDCallback *)kdMalloc(sizeof(_KDCallback));
     if(callbacks[callbackindex] == KD_NULL)
     {
@@ -2130,17 +1978,62 @@ KD_API KDint KD_APIENTRY kdPostEvent(KDEvent *event)
 }
 KD_API KDint KD_APIENTRY kdPostThreadEvent(KDEvent *event, KDThread *thread)
 {
-    if(event->timestamp == 0)
-    {
-        event->timestamp = kdGetTimeUST();
-    }
-    KDint error = __kdQueuePush(thread->eventqueue, (void *)event);
-    if(error == -1)
+    return __kdPostThreadEventLane(event, thread, __kdEventLane(event->type));
+}
+
+/* kdPostThreadEventPriorityVEN: Post an event into a priority lane of a thread's queue. */
+KD_API KDint KD_APIENTRY kdPostThreadEventPriorityVEN(KDEvent *event, KDThread *thread, KDint priority)
+{
+    if(priority < KD_EVENT_PRIORITY_SYSTEM_VEN || priority > KD_EVENT_PRIORITY_USER_VEN)
     {
         kdFreeEvent(event);
-        kdSetError(KD_ENOMEM);
+        kdSetError(KD_EINVAL);
         return -1;
     }
+    return __kdPostThreadEventLane(event, thread, priority);
+}
+
+/* kdPostEventAtVEN, kdPostThreadEventAtVEN: Post an event for delivery once a deadline in kdGetTimeUST time passed. */
+KD_API KDint KD_APIENTRY kdPostEventAtVEN(KDEvent *event, KDust deadline)
+{
+    return kdPostThreadEventAtVEN(event, kdThreadSelf(), deadline);
+}
+
+KD_API KDint KD_APIENTRY kdPostThreadEventAtVEN(KDEvent *event, KDThread *thread, KDust deadline)
+{
+    _KDEventSchedule *schedule = thread->schedule;
+    kdThreadMutexLock(schedule->mutex);
+    if(schedule->count == schedule->capacity)
+    {
+        KDsize capacity = schedule->capacity ? schedule->capacity * 2 : 16;
+        _KDScheduledEvent *heap = (_KDScheduledEvent *)kdRealloc(schedule->heap, capacity * sizeof(_KDScheduledEvent));
+        if(heap == KD_NULL)
+        {
+            kdThreadMutexUnlock(schedule->mutex);
+            kdFreeEvent(event);
+            kdSetError(KD_ENOMEM);
+            return -1;
+        }
+        schedule->heap = heap;
+        schedule->capacity = capacity;
+    }
+    _KDScheduledEvent entry;
+    entry.deadline = deadline;
+    entry.serial = schedule->serial++;
+    entry.event = event;
+    KDsize i = schedule->count++;
+    while(i > 0 && __kdScheduledBefore(&entry, &schedule->heap[(i - 1) / 2]))
+    {
+        schedule->heap[i] = schedule->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    schedule->heap[i] = entry;
+    kdThreadMutexUnlock(schedule->mutex);
+    if(i == 0)
+    {
+        /* New earliest deadline, a blocked owner has to shorten its wait */
+        __kdReactorWake(thread->reactor);
+    }
     return 0;
 }
 
@@ -2150,6 +2043,40 @@ KD_API void KD_APIENTRY kdFreeEvent(KDEvent *event)
     kdFree(event);
 }
 
+/* kdSetEventCoalescingVEN: Merge consecutive pointer motion or property change events of a window. */
+KD_API KDint KD_APIENTRY kdSetEventCoalescingVEN(KDint32 eventtype, KDboolean enable)
+{
+    KDint index = __kdCoalesceIndex(eventtype);
+    if(index == -1)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    KDThread *thread = kdThreadSelf();
+    if(enable)
+    {
+        thread->coalescetypes |= 1U << index;
+    }
+    else
+    {
+        __kdFlushCoalescedEvent(thread);
+        thread->coalescetypes &= ~(1U << index);
+    }
+    return 0;
+}
+
+/* kdGetEventCoalescedCountVEN: Number of events of a type merged away on this thread. */
+KD_API KDuint64 KD_APIENTRY kdGetEventCoalescedCountVEN(KDint32 eventtype)
+{
+    KDint index = __kdCoalesceIndex(eventtype);
+    if(index == -1)
+    {
+        kdSetError(KD_EINVAL);
+        return 0;
+    }
+    return kdThreadSelf()->coalescedcount[index];
+}
+
 /******************************************************************************
  * Application startup and exit.
  ******************************************************************************/
@@ -2278,7 +2205,8 @@ static KDint __kdPreMain(KDint argc, KDchar **argv)
     thread = __kdThreadInit();
 #endif
     kdThreadOnce(&__kd_threadinit_once, __kdThreadInitOnce);
-    kdSetThreadStorageKHR(__kd_threadlocal, thread);
+    __kdThreadSetSelf(thread);
+    __kdLogInit();
 
     KDint result = 0;
 #if defined(__ANDROID__) || defined(__EMSCRIPTEN__) || (defined(__MINGW32__) && !defined(__MINGW64__))
@@ -2316,6 +2244,8 @@ static KDint __kdPreMain(KDint argc, KDchar **argv)
 #endif
 #endif
 
+    __kdJobSystemShutdown();
+    __kdLogShutdown();
     __kdCleanupThreadStorageKHR();
 #if !defined(__ANDROID__)
     __kdThreadFree(thread);
@@ -2405,6 +2335,7 @@ void WINAPI mainCRTStartup(void)
 /* kdExit: Exit the application. */
 KD_API KD_NORETURN void KD_APIENTRY kdExit(KDint status)
 {
+    kdLogFlushVEN();
     if(status == 0)
     {
         status = EXIT_SUCCESS;
@@ -2678,10 +2609,7 @@ static EM_BOOL __kd_EmscriptenMouseCallback(KDint type, const EmscriptenMouseEve
     __kd_window->states.pointer.x = kdevent->data.inputpointer.x;
     __kd_window->states.pointer.y = kdevent->data.inputpointer.y;
 
-    if(!__kdExecCallback(kdevent))
-    {
-        kdPostEvent(kdevent);
-    }
+    __kdDeliverEvent(kdevent);
     return 1;
 }
 
@@ -2771,10 +2699,7 @@ static EM_BOOL __kd_EmscriptenKeyboardCallback(KDint type, const EmscriptenKeybo
         return 1;
     }
 
-    if(!__kdExecCallback(kdevent))
-    {
-        kdPostEvent(kdevent);
-    }
+    __kdDeliverEvent(kdevent);
     return 1;
 }
 
@@ -2794,10 +2719,7 @@ static EM_BOOL __kd_EmscriptenFocusCallback(KDint type, KD_UNUSED const Emscript
     kdevent->type = KD_EVENT_WINDOW_FOCUS;
     kdevent->data.windowfocus.focusstate = __kd_window->properties.focused;
 
-    if(!__kdExecCallback(kdevent))
-    {
-        kdPostEvent(kdevent);
-    }
+    __kdDeliverEvent(kdevent);
     return 1;
 }
 
@@ -2810,10 +2732,7 @@ static EM_BOOL __kd_EmscriptenVisibilityCallback(KD_UNUSED KDint type, const Ems
     kdevent->type = KD_EVENT_WINDOWPROPERTY_CHANGE;
     kdevent->data.windowproperty.pname = KD_WINDOWPROPERTY_VISIBILITY;
 
-    if(!__kdExecCallback(kdevent))
-    {
-        kdPostEvent(kdevent);
-    }
+    __kdDeliverEvent(kdevent);
     return 1;
 }
 
@@ -2837,10 +2756,7 @@ static void __kdWaylandPointerHandleEnter(void *data, KD_UNUSED struct wl_pointe
     kdevent->type = KD_EVENT_WINDOW_FOCUS;
     kdevent->data.windowfocus.focusstate = 1;
 
-    if(!__kdExecCallback(kdevent))
-    {
-        kdPostEvent(kdevent);
-    }
+    __kdDeliverEvent(kdevent);
 }
 static void __kdWaylandPointerHandleLeave(void *data, KD_UNUSED struct wl_pointer *pointer, KD_UNUSED KDuint32 serial, KD_UNUSED struct wl_surface *surface)
 {
@@ -2850,15 +2766,13 @@ static void __kdWaylandPointerHandleLeave(void *data, KD_UNUSED struct wl_pointe
     kdevent->type = KD_EVENT_WINDOW_FOCUS;
     kdevent->data.windowfocus.focusstate = 0;
 
-    if(!__kdExecCallback(kdevent))
-    {
-        kdPostEvent(kdevent);
-    }
+    __kdDeliverEvent(kdevent);
 }
 static void __kdWaylandPointerHandleMotion(void *data, KD_UNUSED struct wl_pointer *pointer, KD_UNUSED KDuint32 time, wl_fixed_t sx, wl_fixed_t sy)
 {
+    /* Coalescing keeps the latest position, no need to drop events */
     static KDuint32 lasttime = 0;
-    if((lasttime + 15) < time)
+    if(__kdCoalescing(kdThreadSelf(), KD_EVENT_INPUT_POINTER) || (lasttime + 15) < time)
     {
         struct KDWindow *window = data;
 
@@ -2872,10 +2786,7 @@ static void __kdWaylandPointerHandleMotion(void *data, KD_UNUSED struct wl_point
         window->states.pointer.x = kdevent->data.inputpointer.x;
         window->states.pointer.y = kdevent->data.inputpointer.y;
 
-        if(!__kdExecCallback(kdevent))
-        {
-            kdPostEvent(kdevent);
-        }
+        __kdDeliverEvent(kdevent);
     }
     lasttime = time;
 }
@@ -2893,10 +2804,7 @@ static void __kdWaylandPointerHandleButton(void *data, KD_UNUSED struct wl_point
 
     window->states.pointer.select = kdevent->data.inputpointer.select;
 
-    if(!__kdExecCallback(kdevent))
-    {
-        kdPostEvent(kdevent);
-    }
+    __kdDeliverEvent(kdevent);
 }
 
 static const struct wl_pointer_listener __kd_wl_pointer_listener = {
@@ -2922,6 +2830,7 @@ static void __kdWaylandKeyboardHandleKeymap(KD_UNUSED void *data, KD_UNUSED stru
         window->xkb.keymap = xkb_keymap_new_from_string(window->xkb.context, keymap_string, XKB_KEYMAP_FORMAT_TEXT_V1, XKB_KEYMAP_COMPILE_NO_FLAGS);
         munmap(keymap_string, size);
         window->xkb.state = xkb_state_new(window->xkb.keymap);
+        __kdXkbCacheModifiers(window);
     }
 }
 static void __kdWaylandKeyboardHandleEnter(KD_UNUSED void *data, KD_UNUSED struct wl_keyboard *keyboard, KD_UNUSED KDuint32 serial, KD_UNUSED struct wl_surface *surface, KD_UNUSED struct wl_array *keys) {}
@@ -2961,27 +2870,11 @@ static void __kdWaylandKeyboardHandleKey(KD_UNUSED void *data, KD_UNUSED struct
         {
             kdevent->type = KD_EVENT_INPUT_KEY_ATX;
             KDEventInputKeyATX *keyevent = (KDEventInputKeyATX *)(&kdevent->data);
-
+            keyevent->flags = __kdXkbModifierFlags(window);
             if(state == WL_KEYBOARD_KEY_STATE_PRESSED)
             {
                 keyevent->flags |= KD_KEY_PRESS_ATX;
             }
-            if(xkb_state_mod_name_is_active(window->xkb.state, XKB_MOD_NAME_SHIFT, XKB_STATE_MODS_EFFECTIVE) > 0)
-            {
-                keyevent->flags |= KD_KEY_MODIFIER_SHIFT_ATX;
-            }
-            if(xkb_state_mod_name_is_active(window->xkb.state, XKB_MOD_NAME_CTRL, XKB_STATE_MODS_EFFECTIVE) > 0)
-            {
-                keyevent->flags |= KD_KEY_MODIFIER_CTRL_ATX;
-            }
-            if(xkb_state_mod_name_is_active(window->xkb.state, XKB_MOD_NAME_ALT, XKB_STATE_MODS_EFFECTIVE) > 0)
-            {
-                keyevent->flags |= KD_KEY_MODIFIER_ALT_ATX;
-            }
-            if(xkb_state_mod_name_is_active(window->xkb.state, XKB_MOD_NAME_LOGO, XKB_STATE_MODS_EFFECTIVE) > 0)
-            {
-                keyevent->flags |= KD_KEY_MODIFIER_META_ATX;
-            }
 
             keyevent->keycode = keycode;
 
@@ -2997,10 +2890,7 @@ static void __kdWaylandKeyboardHandleKey(KD_UNUSED void *data, KD_UNUSED struct
         }
     }
 
-    if(!__kdExecCallback(kdevent))
-    {
-        kdPostEvent(kdevent);
-    }
+    __kdDeliverEvent(kdevent);
 }
 static void __kdWaylandKeyboardHandleModifiers(KD_UNUSED void *data, KD_UNUSED struct wl_keyboard *keyboard, KD_UNUSED KDuint32 serial, KDuint32 mods_depressed, KDuint32 mods_latched, KDuint32 mods_locked, KDuint32 group)
 {
@@ -3081,6 +2971,12 @@ KD_API NativeDisplayType KD_APIENTRY kdGetDisplayVEN(void)
 {
 #if defined(KD_WINDOW_WAYLAND)
     KDchar *sessiontype = kdGetEnvVEN("XDG_SESSION_TYPE");
+#if defined(KD_WINDOW_NULL)
+    if(__kdWindowNullRequested())
+    {
+        sessiontype = KD_NULL;
+    }
+#endif
     if(kdStrstrVEN(sessiontype, "wayland"))
     {
         __kd_wl_display = wl_display_connect(KD_NULL);
@@ -3134,6 +3030,21 @@ KD_API KDWindow *KD_APIENTRY kdCreateWindow(KD_UNUSED EGLDisplay display, KD_UNU
     const KDchar *caption = "OpenKODE";
     kdMemcpy(window->properties.caption, caption, 8);
 
+#if defined(KD_WINDOW_NULL)
+    kdMemset(&window->null, 0, sizeof(window->null));
+    if(__kdWindowNullSelected())
+    {
+        /* Properties and states live here only, input is injected */
+        window->null.mutex = kdThreadMutexCreate(KD_NULL);
+        if(window->null.mutex == KD_NULL)
+        {
+            kdFree(window);
+            kdSetError(KD_ENOMEM);
+            return KD_NULL;
+        }
+        window->platform = EGL_PLATFORM_SURFACELESS_MESA;
+    }
+#endif
 #if defined(KD_WINDOW_ANDROID)
     eglGetConfigAttrib(display, config, EGL_NATIVE_VISUAL_ID, &window->format);
 #elif defined(KD_WINDOW_EMSCRIPTEN)
@@ -3174,7 +3085,7 @@ KD_API KDWindow *KD_APIENTRY kdCreateWindow(KD_UNUSED EGLDisplay display, KD_UNU
     window->xkb.context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
 
 #if defined(KD_WINDOW_WAYLAND)
-    if(__kd_wl_display)
+    if(__kd_wl_display && !window->platform)
     {
         window->platform = EGL_PLATFORM_WAYLAND_KHR;
     }
@@ -3226,6 +3137,7 @@ KD_API KDWindow *KD_APIENTRY kdCreateWindow(KD_UNUSED EGLDisplay display, KD_UNU
         KDint32 device = xkb_x11_get_core_keyboard_device_id(window->nativedisplay);
         window->xkb.keymap = xkb_x11_keymap_new_from_device(window->xkb.context, window->nativedisplay, device, XKB_KEYMAP_COMPILE_NO_FLAGS);
         window->xkb.state = xkb_x11_state_new_from_device(window->xkb.keymap, window->nativedisplay, device);
+        __kdXkbCacheModifiers(window);
 
         enum {
             required_events =
@@ -3260,6 +3172,21 @@ KD_API KDWindow *KD_APIENTRY kdCreateWindow(KD_UNUSED EGLDisplay display, KD_UNU
             required_map_parts, required_map_parts, &details);
     }
 #endif
+#if defined(KD_REACTOR_EPOLL)
+    /* Display connections only wake the reactor, kdPumpEvents reads them */
+#if defined(KD_WINDOW_WAYLAND)
+    if(window->platform == EGL_PLATFORM_WAYLAND_KHR)
+    {
+        __kdReactorWatch(window->originthr->reactor, wl_display_get_fd(window->nativedisplay), __KD_REACTOR_IN, KD_NULL, KD_NULL);
+    }
+#endif
+#if defined(KD_WINDOW_X11)
+    if(window->platform == EGL_PLATFORM_X11_KHR)
+    {
+        __kdReactorWatch(window->originthr->reactor, xcb_get_file_descriptor(window->nativedisplay), __KD_REACTOR_IN, KD_NULL, KD_NULL);
+    }
+#endif
+#endif
 #endif
     __kd_window = window;
     return window;
@@ -3308,15 +3235,28 @@ KD_API KDint KD_APIENTRY kdDestroyWindow(KDWindow *window)
         wl_shell_surface_destroy(window->wayland.shell_surface);
         wl_surface_destroy(window->wayland.surface);
         wl_registry_destroy(window->wayland.registry);
+#if defined(KD_REACTOR_EPOLL)
+        __kdReactorUnwatch(window->originthr->reactor, wl_display_get_fd(window->nativedisplay));
+#endif
         wl_display_disconnect(window->nativedisplay);
     }
 #endif
 #if defined(KD_WINDOW_X11)
     if(window->platform == EGL_PLATFORM_X11_KHR)
     {
+#if defined(KD_REACTOR_EPOLL)
+        __kdReactorUnwatch(window->originthr->reactor, xcb_get_file_descriptor(window->nativedisplay));
+#endif
         xcb_disconnect(window->nativedisplay);
     }
 #endif
+#endif
+#if defined(KD_WINDOW_NULL)
+    if(window->platform == EGL_PLATFORM_SURFACELESS_MESA)
+    {
+        kdFree(window->null.input);
+        kdThreadMutexFree(window->null.mutex);
+    }
 #endif
     kdFree(window);
     __kd_window = KD_NULL;
@@ -3465,14 +3405,17 @@ KD_API KDint KD_APIENTRY kdGetWindowPropertybv(KDWindow *window, KDint pname, KD
     if(pname == KD_WINDOWPROPERTY_FOCUS)
     {
         param[0] = window->properties.focused;
+        return 0;
     }
     else if(pname == KD_WINDOWPROPERTY_VISIBILITY)
     {
         param[0] = window->properties.visible;
+        return 0;
     }
     else if(pname == KD_WINDOWPROPERTY_FULLSCREEN_NV)
     {
         param[0] = window->properties.fullscreen;
+        return 0;
     }
     kdSetError(KD_EINVAL);
     return -1;
@@ -3483,6 +3426,7 @@ KD_API KDint KD_APIENTRY kdGetWindowPropertyiv(KDWindow *window, KDint pname, KD
     {
         param[0] = window->properties.width;
         param[1] = window->properties.height;
+        return 0;
     }
     kdSetError(KD_EINVAL);
     return -1;
@@ -3493,6 +3437,7 @@ KD_API KDint KD_APIENTRY kdGetWindowPropertycv(KDWindow *window, KDint pname, KD
     {
         *size = kdStrlen(window->properties.caption);
         kdMemcpy(param, window->properties.caption, *size);
+        return 0;
     }
     kdSetError(KD_EINVAL);
     return -1;
@@ -3553,10 +3498,7 @@ KD_API KDint KD_APIENTRY kdRealizeWindow(KDWindow *window, EGLNativeWindowType *
     kdevent->type = KD_EVENT_WINDOWPROPERTY_CHANGE;
     kdevent->data.windowproperty.pname = KD_EVENT_WINDOW_REDRAW;
 
-    if(!__kdExecCallback(kdevent))
-    {
-        kdPostEvent(kdevent);
-    }
+    __kdDeliverEvent(kdevent);
 
     if(nativewindow)
     {
@@ -3565,4 +3507,57 @@ KD_API KDint KD_APIENTRY kdRealizeWindow(KDWindow *window, EGLNativeWindowType *
     return 0;
 }
 
+/* kdInjectInputPointerVEN, kdInjectInputKeyVEN, kdInjectInputKeyCharVEN: Queue synthetic input for a headless window. */
+KD_API KDint KD_APIENTRY kdInjectInputPointerVEN(KD_UNUSED KDWindow *window, KD_UNUSED KDint32 index, KD_UNUSED KDint32 select, KD_UNUSED KDint32 x, KD_UNUSED KDint32 y, KD_UNUSED KDust time)
+{
+#if defined(KD_WINDOW_NULL)
+    _KDWindowInput input;
+    input.time = time;
+    input.type = KD_EVENT_INPUT_POINTER;
+    input.index = index;
+    input.value = select;
+    input.flags = 0;
+    input.x = x;
+    input.y = y;
+    return __kdWindowNullInject(window, &input);
+#else
+    kdSetError(KD_ENOSYS);
+    return -1;
+#endif
+}
+KD_API KDint KD_APIENTRY kdInjectInputKeyVEN(KD_UNUSED KDWindow *window, KD_UNUSED KDint32 keycode, KD_UNUSED KDuint32 flags, KD_UNUSED KDust time)
+{
+#if defined(KD_WINDOW_NULL)
+    _KDWindowInput input;
+    input.time = time;
+    input.type = KD_EVENT_INPUT_KEY_ATX;
+    input.index = 0;
+    input.value = keycode;
+    input.flags = flags;
+    input.x = 0;
+    input.y = 0;
+    return __kdWindowNullInject(window, &input);
+#else
+    kdSetError(KD_ENOSYS);
+    return -1;
+#endif
+}
+KD_API KDint KD_APIENTRY kdInjectInputKeyCharVEN(KD_UNUSED KDWindow *window, KD_UNUSED KDint32 character, KD_UNUSED KDuint32 flags, KD_UNUSED KDust time)
+{
+#if defined(KD_WINDOW_NULL)
+    _KDWindowInput input;
+    input.time = time;
+    input.type = KD_EVENT_INPUT_KEYCHAR_ATX;
+    input.index = 0;
+    input.value = character;
+    input.flags = flags;
+    input.x = 0;
+    input.y = 0;
+    return __kdWindowNullInject(window, &input);
+#else
+    kdSetError(KD_ENOSYS);
+    return -1;
+#endif
+}
+
 #endif
@@ -0,0 +1,197 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+/******************************************************************************
+ * KD includes
+ ******************************************************************************/
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wpadded"
+#if __has_warning("-Wreserved-id-macro")
+#pragma clang diagnostic ignored "-Wreserved-id-macro"
+#endif
+#endif
+#include "kdplatform.h"  // for KD_API, KD_APIENTRY
+#include <KD/kd.h>       // for kdFopen, kdFwrite, kdCreateEvent
+#include <KD/kdext.h>    // for kdPostThreadEventAtVEN
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "kd_internal.h"  // for KDThread
+
+/******************************************************************************
+ * OpenKODE Core extension: KD_VEN_event_trace
+ *
+ * Notes:
+ * - A trace is a header followed by one record per delivered event. A record
+ *   is type, timestamp, userptr and the event data with trailing zero bytes
+ *   cut off, so most input events take a few dozen bytes.
+ * - Records are written in host byte order, traces are meant to be replayed
+ *   on the machine and build that recorded them.
+ * - userptr is stored as a tag and comes back unchanged, as do pointers in
+ *   the event data. They only mean something to the process that recorded
+ *   them unless the application keys them on fixed values.
+ * - Replay goes through kdPostThreadEventAtVEN, a trace of any length costs
+ *   one heap entry per event on the receiving thread.
+ ******************************************************************************/
+
+static const KDchar __kd_tracemagic[8] = {'K', 'D', 'T', 'R', 'A', 'C', 'E', '1'};
+
+typedef struct _KDTraceRecord _KDTraceRecord;
+struct _KDTraceRecord {
+    KDust timestamp;
+    KDuint64 userptr;
+    KDint32 type;
+    KDuint16 length;
+    KDuint16 reserved;
+};
+
+/* Called for every event handed to the application on this thread. */
+void __kdEventTraceRecord(KDThread *thread, const KDEvent *event)
+{
+    KDFile *file = thread->tracefile;
+    const KDuint8 *data = (const KDuint8 *)&event->data;
+    KDsize length = sizeof(event->data);
+    while(length > 0 && data[length - 1] == 0)
+    {
+        length--;
+    }
+    _KDTraceRecord record;
+    record.timestamp = event->timestamp ? event->timestamp : kdGetTimeUST();
+    record.userptr = (KDuint64)(KDuintptr)event->userptr;
+    record.type = event->type;
+    record.length = (KDuint16)length;
+    record.reserved = 0;
+    if(kdFwrite(&record, sizeof(record), 1, file) != 1 || (length > 0 && kdFwrite(data, length, 1, file) != 1))
+    {
+        /* Keep the trace readable up to the last complete record */
+        kdFclose(file);
+        thread->tracefile = KD_NULL;
+    }
+}
+
+/* kdEventTraceStartVEN: Record the events delivered to the calling thread. */
+KD_API KDint KD_APIENTRY kdEventTraceStartVEN(const KDchar *pathname)
+{
+    KDThread *thread = kdThreadSelf();
+    if(thread->tracefile)
+    {
+        kdSetError(KD_EBUSY);
+        return -1;
+    }
+    KDFile *file = kdFopen(pathname, "wb");
+    if(file == KD_NULL)
+    {
+        return -1;
+    }
+    if(kdFwrite(__kd_tracemagic, sizeof(__kd_tracemagic), 1, file) != 1)
+    {
+        kdFclose(file);
+        kdSetError(KD_EIO);
+        return -1;
+    }
+    thread->tracefile = file;
+    return 0;
+}
+
+/* kdEventTraceStopVEN: Stop recording and close the trace. */
+KD_API KDint KD_APIENTRY kdEventTraceStopVEN(void)
+{
+    KDThread *thread = kdThreadSelf();
+    if(thread->tracefile == KD_NULL)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    KDint result = kdFclose(thread->tracefile);
+    thread->tracefile = KD_NULL;
+    if(result == KD_EOF)
+    {
+        kdSetError(KD_EIO);
+        return -1;
+    }
+    return 0;
+}
+
+/* kdEventTraceReplayVEN: Post the events of a trace to a thread, speed scales the recorded gaps. */
+KD_API KDint KD_APIENTRY kdEventTraceReplayVEN(const KDchar *pathname, KDThread *thread, KDfloat32 speed)
+{
+    KDFile *file = kdFopen(pathname, "rb");
+    if(file == KD_NULL)
+    {
+        return -1;
+    }
+    KDchar magic[sizeof(__kd_tracemagic)];
+    if(kdFread(magic, sizeof(magic), 1, file) != 1 || kdMemcmp(magic, __kd_tracemagic, sizeof(magic)) != 0)
+    {
+        kdFclose(file);
+        kdSetError(KD_EILSEQ);
+        return -1;
+    }
+
+    KDust start = kdGetTimeUST();
+    KDust first = 0;
+    KDint count = 0;
+    _KDTraceRecord record;
+    while(kdFread(&record, sizeof(record), 1, file) == 1)
+    {
+        KDEvent *event = kdCreateEvent();
+        if(event == KD_NULL)
+        {
+            kdFclose(file);
+            return -1;
+        }
+        if(record.length > sizeof(event->data) || (record.length > 0 && kdFread(&event->data, record.length, 1, file) != 1))
+        {
+            /* Truncated or not a trace, keep what was posted */
+            kdFreeEvent(event);
+            break;
+        }
+        kdMemset((KDuint8 *)&event->data + record.length, 0, sizeof(event->data) - record.length);
+        event->type = record.type;
+        event->userptr = (void *)(KDuintptr)record.userptr;
+        if(count == 0)
+        {
+            first = record.timestamp;
+        }
+        /* Zero or less posts everything right away, in recorded order */
+        KDust deadline = start;
+        if(speed > 0.0f && record.timestamp > first)
+        {
+            deadline += (KDust)((KDfloat64KHR)(record.timestamp - first) / (KDfloat64KHR)speed);
+        }
+        if(kdPostThreadEventAtVEN(event, thread, deadline) == -1)
+        {
+            kdFclose(file);
+            return -1;
+        }
+        count++;
+    }
+    kdFclose(file);
+    return count;
+}
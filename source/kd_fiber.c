@@ -0,0 +1,552 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+/******************************************************************************
+ * KD includes
+ ******************************************************************************/
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wpadded"
+#if __has_warning("-Wreserved-id-macro")
+#pragma clang diagnostic ignored "-Wreserved-id-macro"
+#endif
+#endif
+#define _GNU_SOURCE /* MAP_ANONYMOUS, ucontext */
+#include "kdplatform.h"  // for KD_API, KD_APIENTRY
+#include <KD/kd.h>       // for kdSetError, kdFree, kdMalloc
+#include <KD/kdext.h>    // IWYU pragma: keep
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "kd_internal.h"  // for KDThread, _KDFiberScheduler
+
+/******************************************************************************
+ * OpenKODE Core extension: KD_VEN_fiber
+ *
+ * Notes:
+ * - x86-64 and AArch64 switch stacks with a few instructions saving the
+ *   callee-saved registers, other POSIX systems use ucontext.
+ * - Stacks are mapped with a guard page below them. Every thread keeps a
+ *   small pool of released stacks, so creating a fiber usually does not
+ *   enter the kernel.
+ * - Fibers waiting in kdFiberWaitEventVEN are resumed by kdPumpEvents
+ *   before callbacks are considered.
+ ******************************************************************************/
+
+#if defined(__ELF__) && ((defined(__x86_64__) && !defined(__ILP32__)) || defined(__aarch64__)) && (defined(__GNUC__) || defined(__clang__)) && !defined(__TINYC__)
+#define __KD_FIBER_ASM
+#elif !defined(_WIN32) && !defined(__ANDROID__) && !defined(__EMSCRIPTEN__) && !defined(KD_FREESTANDING)
+#define __KD_FIBER_UCONTEXT
+#endif
+
+#if defined(__KD_FIBER_ASM) || defined(__KD_FIBER_UCONTEXT)
+#include <sys/mman.h>  // for mmap, mprotect, munmap
+#include <unistd.h>    // for sysconf
+#endif
+#if defined(__KD_FIBER_UCONTEXT)
+#include <ucontext.h>  // for getcontext, makecontext, swapcontext
+#endif
+
+#define __KD_FIBER_STACK_DEFAULT (64 * 1024)
+#define __KD_FIBER_STACK_MIN (16 * 1024)
+#define __KD_FIBER_POOL_MAX 16
+
+#define __KD_FIBER_READY 0
+#define __KD_FIBER_WAITING 1
+#define __KD_FIBER_FINISHED 2
+
+/* Lives at the top of its own mapping */
+typedef struct _KDFiberStack _KDFiberStack;
+struct _KDFiberStack {
+    _KDFiberStack *next;
+    void *base;
+    KDsize mapsize;
+    KDsize size;
+};
+
+struct KDFiberVEN {
+#if defined(__KD_FIBER_UCONTEXT)
+    ucontext_t context;
+#else
+    void *sp;
+#endif
+    KDFiberVEN *caller;
+    KDFiberVEN *next;
+    _KDFiberScheduler *scheduler;
+    _KDFiberStack *stack;
+    KDFiberFuncVEN *func;
+    void *arg;
+    const KDEvent *event;
+    void *waituserptr;
+    KDint32 waittype;
+    KDint state;
+};
+
+struct _KDFiberScheduler {
+    KDFiberVEN root;
+    KDFiberVEN *current;
+    KDFiberVEN *waiters;
+    _KDFiberStack *pool;
+    KDsize pooled;
+};
+
+#if defined(__KD_FIBER_ASM)
+/* Saves the callee-saved registers on the current stack, stores the stack
+ * pointer to *from and continues on the stack to. A new stack starts in
+ * __kdFiberEntry, which calls the function in r12/x20 with rbx/x19. On
+ * x86-64 an indirect jump instead of ret keeps the return stack buffer from
+ * mispredicting every switch. */
+__attribute__((visibility("hidden"))) void __kdFiberSwap(void **from, void *to);
+__attribute__((visibility("hidden"))) void __kdFiberEntry(void);
+#if defined(__x86_64__)
+__asm__(
+    ".pushsection .text\n"
+    ".p2align 4\n"
+    ".globl __kdFiberSwap\n"
+    ".hidden __kdFiberSwap\n"
+    ".type __kdFiberSwap, %function\n"
+    "__kdFiberSwap:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    popq %rcx\n"
+    "    jmpq *%rcx\n"
+    ".size __kdFiberSwap, .-__kdFiberSwap\n"
+    ".p2align 4\n"
+    ".globl __kdFiberEntry\n"
+    ".hidden __kdFiberEntry\n"
+    ".type __kdFiberEntry, %function\n"
+    "__kdFiberEntry:\n"
+    "    movq %rbx, %rdi\n"
+    "    callq *%r12\n"
+    "    ud2\n"
+    ".size __kdFiberEntry, .-__kdFiberEntry\n"
+    ".popsection\n");
+#define __KD_FIBER_FRAME 72
+#elif defined(__aarch64__)
+__asm__(
+    ".pushsection .text\n"
+    ".p2align 4\n"
+    ".globl __kdFiberSwap\n"
+    ".hidden __kdFiberSwap\n"
+    ".type __kdFiberSwap, %function\n"
+    "__kdFiberSwap:\n"
+    "    sub sp, sp, #160\n"
+    "    stp x19, x20, [sp, #0]\n"
+    "    stp x21, x22, [sp, #16]\n"
+    "    stp x23, x24, [sp, #32]\n"
+    "    stp x25, x26, [sp, #48]\n"
+    "    stp x27, x28, [sp, #64]\n"
+    "    stp x29, x30, [sp, #80]\n"
+    "    stp d8, d9, [sp, #96]\n"
+    "    stp d10, d11, [sp, #112]\n"
+    "    stp d12, d13, [sp, #128]\n"
+    "    stp d14, d15, [sp, #144]\n"
+    "    mov x2, sp\n"
+    "    str x2, [x0]\n"
+    "    mov sp, x1\n"
+    "    ldp x19, x20, [sp, #0]\n"
+    "    ldp x21, x22, [sp, #16]\n"
+    "    ldp x23, x24, [sp, #32]\n"
+    "    ldp x25, x26, [sp, #48]\n"
+    "    ldp x27, x28, [sp, #64]\n"
+    "    ldp x29, x30, [sp, #80]\n"
+    "    ldp d8, d9, [sp, #96]\n"
+    "    ldp d10, d11, [sp, #112]\n"
+    "    ldp d12, d13, [sp, #128]\n"
+    "    ldp d14, d15, [sp, #144]\n"
+    "    add sp, sp, #160\n"
+    "    ret\n"
+    ".size __kdFiberSwap, .-__kdFiberSwap\n"
+    ".p2align 4\n"
+    ".globl __kdFiberEntry\n"
+    ".hidden __kdFiberEntry\n"
+    ".type __kdFiberEntry, %function\n"
+    "__kdFiberEntry:\n"
+    "    mov x0, x19\n"
+    "    blr x20\n"
+    "    brk #0\n"
+    ".size __kdFiberEntry, .-__kdFiberEntry\n"
+    ".popsection\n");
+#define __KD_FIBER_FRAME 160
+#endif
+#endif
+
+#if defined(__KD_FIBER_ASM) || defined(__KD_FIBER_UCONTEXT)
+static void __kdFiberSwitch(_KDFiberScheduler *scheduler, KDFiberVEN *from, KDFiberVEN *to)
+{
+    scheduler->current = to;
+#if defined(__KD_FIBER_ASM)
+    __kdFiberSwap(&from->sp, to->sp);
+#else
+    swapcontext(&from->context, &to->context);
+#endif
+}
+
+/* Go back to the fiber that switched in, or the thread if it cannot continue. */
+static void __kdFiberResumeCaller(_KDFiberScheduler *scheduler, KDFiberVEN *fiber)
+{
+    KDFiberVEN *caller = fiber->caller;
+    if(caller == KD_NULL || caller->state != __KD_FIBER_READY)
+    {
+        caller = &scheduler->root;
+    }
+    __kdFiberSwitch(scheduler, fiber, caller);
+}
+
+static void __kdFiberMain(KDFiberVEN *fiber)
+{
+    fiber->func(fiber->arg);
+    fiber->state = __KD_FIBER_FINISHED;
+    __kdFiberResumeCaller(fiber->scheduler, fiber);
+}
+
+#if defined(__KD_FIBER_UCONTEXT)
+static void __kdFiberContextEntry(void)
+{
+    __kdFiberMain(kdThreadSelf()->fibers->current);
+}
+#endif
+
+static KDsize __kdFiberPageSize(void)
+{
+    long pagesize = sysconf(_SC_PAGESIZE);
+    return pagesize > 0 ? (KDsize)pagesize : 4096;
+}
+
+static _KDFiberStack *__kdFiberStackAcquire(_KDFiberScheduler *scheduler, KDsize size)
+{
+    KDsize pagesize = __kdFiberPageSize();
+    size = (size + pagesize - 1) & ~(pagesize - 1);
+    for(_KDFiberStack **link = &scheduler->pool; *link; link = &(*link)->next)
+    {
+        if((*link)->size == size)
+        {
+            _KDFiberStack *stack = *link;
+            *link = stack->next;
+            scheduler->pooled--;
+            return stack;
+        }
+    }
+
+    KDsize mapsize = size + pagesize;
+    void *base = mmap(KD_NULL, mapsize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(base == MAP_FAILED)
+    {
+        return KD_NULL;
+    }
+    /* Overflows fault on the guard page instead of corrupting memory. */
+    mprotect(base, pagesize, PROT_NONE);
+    _KDFiberStack *stack = (_KDFiberStack *)((KDuint8 *)base + mapsize - sizeof(_KDFiberStack));
+    stack->next = KD_NULL;
+    stack->base = base;
+    stack->mapsize = mapsize;
+    stack->size = size;
+    return stack;
+}
+
+static void __kdFiberStackRelease(_KDFiberScheduler *scheduler, _KDFiberStack *stack)
+{
+    if(scheduler && scheduler->pooled < __KD_FIBER_POOL_MAX)
+    {
+        stack->next = scheduler->pool;
+        scheduler->pool = stack;
+        scheduler->pooled++;
+        return;
+    }
+    munmap(stack->base, stack->mapsize);
+}
+
+static _KDFiberScheduler *__kdFiberScheduler(void)
+{
+    KDThread *thread = kdThreadSelf();
+    if(thread->fibers == KD_NULL)
+    {
+        _KDFiberScheduler *scheduler = (_KDFiberScheduler *)kdMalloc(sizeof(_KDFiberScheduler));
+        if(scheduler == KD_NULL)
+        {
+            return KD_NULL;
+        }
+        kdMemset(scheduler, 0, sizeof(_KDFiberScheduler));
+        scheduler->root.scheduler = scheduler;
+        scheduler->root.state = __KD_FIBER_READY;
+        scheduler->current = &scheduler->root;
+        thread->fibers = scheduler;
+    }
+    return thread->fibers;
+}
+#endif
+
+void __kdFiberSchedulerFree(_KDFiberScheduler *scheduler)
+{
+#if defined(__KD_FIBER_ASM) || defined(__KD_FIBER_UCONTEXT)
+    if(scheduler)
+    {
+        while(scheduler->pool)
+        {
+            _KDFiberStack *stack = scheduler->pool;
+            scheduler->pool = stack->next;
+            munmap(stack->base, stack->mapsize);
+        }
+        kdFree(scheduler);
+    }
+#else
+    kdFree(scheduler);
+#endif
+}
+
+/* Called by kdPumpEvents for every queued event. */
+KDboolean __kdFiberDispatchEvent(KDEvent *event)
+{
+#if defined(__KD_FIBER_ASM) || defined(__KD_FIBER_UCONTEXT)
+    _KDFiberScheduler *scheduler = kdThreadSelf()->fibers;
+    if(scheduler == KD_NULL)
+    {
+        return KD_FALSE;
+    }
+    for(KDFiberVEN **link = &scheduler->waiters; *link; link = &(*link)->next)
+    {
+        KDFiberVEN *fiber = *link;
+        KDboolean typematch = (fiber->waittype == event->type) || (fiber->waittype == 0);
+        KDboolean userptrmatch = (fiber->waituserptr == event->userptr);
+        if(typematch && userptrmatch)
+        {
+            *link = fiber->next;
+            fiber->next = KD_NULL;
+            fiber->event = event;
+            fiber->state = __KD_FIBER_READY;
+            fiber->caller = scheduler->current;
+            __kdFiberSwitch(scheduler, scheduler->current, fiber);
+            return KD_TRUE;
+        }
+    }
+#else
+    (void)event;
+#endif
+    return KD_FALSE;
+}
+
+/* kdFiberCreateVEN: Create a fiber on the calling thread, running func on a pooled stack of at least stacksize bytes. */
+KD_API KDFiberVEN *KD_APIENTRY kdFiberCreateVEN(KDsize stacksize, KDFiberFuncVEN *func, void *arg)
+{
+#if defined(__KD_FIBER_ASM) || defined(__KD_FIBER_UCONTEXT)
+    if(func == KD_NULL)
+    {
+        kdSetError(KD_EINVAL);
+        return KD_NULL;
+    }
+    if(stacksize == 0)
+    {
+        stacksize = __KD_FIBER_STACK_DEFAULT;
+    }
+    else if(stacksize < __KD_FIBER_STACK_MIN)
+    {
+        stacksize = __KD_FIBER_STACK_MIN;
+    }
+
+    _KDFiberScheduler *scheduler = __kdFiberScheduler();
+    KDFiberVEN *fiber = (KDFiberVEN *)kdMalloc(sizeof(KDFiberVEN));
+    if(scheduler == KD_NULL || fiber == KD_NULL)
+    {
+        kdFree(fiber);
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    kdMemset(fiber, 0, sizeof(KDFiberVEN));
+    fiber->stack = __kdFiberStackAcquire(scheduler, stacksize);
+    if(fiber->stack == KD_NULL)
+    {
+        kdFree(fiber);
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    fiber->scheduler = scheduler;
+    fiber->func = func;
+    fiber->arg = arg;
+    fiber->state = __KD_FIBER_READY;
+
+#if defined(__KD_FIBER_ASM)
+    void (*fibermain)(KDFiberVEN *) = __kdFiberMain;
+    void (*fiberentry)(void) = __kdFiberEntry;
+    KDuintptr top = (KDuintptr)fiber->stack & ~(KDuintptr)15;
+    KDuintptr *frame = (KDuintptr *)(top - __KD_FIBER_FRAME);
+    kdMemset(frame, 0, __KD_FIBER_FRAME);
+#if defined(__x86_64__)
+    /* r15, r14, r13, r12, rbx, rbp, return address. The entry runs with a 16 byte aligned stack. */
+    kdMemcpy(&frame[3], &fibermain, sizeof(fibermain));
+    frame[4] = (KDuintptr)fiber;
+    kdMemcpy(&frame[6], &fiberentry, sizeof(fiberentry));
+#else
+    /* x19 to x30, d8 to d15 */
+    frame[0] = (KDuintptr)fiber;
+    kdMemcpy(&frame[1], &fibermain, sizeof(fibermain));
+    kdMemcpy(&frame[11], &fiberentry, sizeof(fiberentry));
+#endif
+    fiber->sp = frame;
+#else
+    getcontext(&fiber->context);
+    fiber->context.uc_stack.ss_sp = (KDuint8 *)fiber->stack->base + (fiber->stack->mapsize - fiber->stack->size);
+    fiber->context.uc_stack.ss_size = (KDsize)((KDuint8 *)fiber->stack - (KDuint8 *)fiber->context.uc_stack.ss_sp);
+    fiber->context.uc_link = KD_NULL;
+    makecontext(&fiber->context, __kdFiberContextEntry, 0);
+#endif
+    return fiber;
+#else
+    (void)stacksize;
+    (void)func;
+    (void)arg;
+    kdSetError(KD_ENOSYS);
+    return KD_NULL;
+#endif
+}
+
+/* kdFiberFreeVEN: Free a fiber that is not running, its stack goes back to the pool. */
+KD_API KDint KD_APIENTRY kdFiberFreeVEN(KDFiberVEN *fiber)
+{
+#if defined(__KD_FIBER_ASM) || defined(__KD_FIBER_UCONTEXT)
+    _KDFiberScheduler *scheduler = fiber->scheduler;
+    if(scheduler->current == fiber)
+    {
+        kdSetError(KD_EBUSY);
+        return -1;
+    }
+    for(KDFiberVEN **link = &scheduler->waiters; *link; link = &(*link)->next)
+    {
+        if(*link == fiber)
+        {
+            *link = fiber->next;
+            break;
+        }
+    }
+    __kdFiberStackRelease(kdThreadSelf()->fibers == scheduler ? scheduler : KD_NULL, fiber->stack);
+    kdFree(fiber);
+    return 0;
+#else
+    (void)fiber;
+    kdSetError(KD_ENOSYS);
+    return -1;
+#endif
+}
+
+/* kdFiberSwitchVEN: Suspend the calling fiber or thread and resume fiber. */
+KD_API KDint KD_APIENTRY kdFiberSwitchVEN(KDFiberVEN *fiber)
+{
+#if defined(__KD_FIBER_ASM) || defined(__KD_FIBER_UCONTEXT)
+    _KDFiberScheduler *scheduler = kdThreadSelf()->fibers;
+    if(fiber == KD_NULL || scheduler == KD_NULL || fiber->scheduler != scheduler || fiber == scheduler->current || fiber->state != __KD_FIBER_READY)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    fiber->caller = scheduler->current;
+    __kdFiberSwitch(scheduler, scheduler->current, fiber);
+    return 0;
+#else
+    (void)fiber;
+    kdSetError(KD_ENOSYS);
+    return -1;
+#endif
+}
+
+/* kdFiberYieldVEN: Suspend the calling fiber and resume the one that switched to it. */
+KD_API KDint KD_APIENTRY kdFiberYieldVEN(void)
+{
+#if defined(__KD_FIBER_ASM) || defined(__KD_FIBER_UCONTEXT)
+    _KDFiberScheduler *scheduler = kdThreadSelf()->fibers;
+    if(scheduler == KD_NULL || scheduler->current == &scheduler->root)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    __kdFiberResumeCaller(scheduler, scheduler->current);
+    return 0;
+#else
+    kdSetError(KD_ENOSYS);
+    return -1;
+#endif
+}
+
+/* kdFiberSelfVEN: The running fiber, KD_NULL on the thread's own stack. */
+KD_API KDFiberVEN *KD_APIENTRY kdFiberSelfVEN(void)
+{
+    _KDFiberScheduler *scheduler = kdThreadSelf()->fibers;
+    if(scheduler == KD_NULL || scheduler->current == &scheduler->root)
+    {
+        return KD_NULL;
+    }
+    return scheduler->current;
+}
+
+/* kdFiberIsFinishedVEN: Check if the function of a fiber returned. */
+KD_API KDboolean KD_APIENTRY kdFiberIsFinishedVEN(const KDFiberVEN *fiber)
+{
+    return fiber->state == __KD_FIBER_FINISHED;
+}
+
+/* kdFiberWaitEventVEN: Suspend the calling fiber until kdPumpEvents on its thread sees a matching event. */
+KD_API const KDEvent *KD_APIENTRY kdFiberWaitEventVEN(KDint32 type, void *userptr)
+{
+#if defined(__KD_FIBER_ASM) || defined(__KD_FIBER_UCONTEXT)
+    _KDFiberScheduler *scheduler = kdThreadSelf()->fibers;
+    if(scheduler == KD_NULL || scheduler->current == &scheduler->root)
+    {
+        kdSetError(KD_EINVAL);
+        return KD_NULL;
+    }
+    KDFiberVEN *fiber = scheduler->current;
+    fiber->waittype = type;
+    fiber->waituserptr = userptr;
+    fiber->event = KD_NULL;
+    fiber->state = __KD_FIBER_WAITING;
+    /* Keep the order of arrival for fibers waiting on the same event. */
+    KDFiberVEN **link = &scheduler->waiters;
+    while(*link)
+    {
+        link = &(*link)->next;
+    }
+    *link = fiber;
+    __kdFiberResumeCaller(scheduler, fiber);
+    return fiber->event;
+#else
+    (void)type;
+    (void)userptr;
+    kdSetError(KD_ENOSYS);
+    return KD_NULL;
+#endif
+}
@@ -113,7 +113,7 @@ KD_API KDFile *KD_APIENTRY kdFopen(const KDchar *pathname, const KDchar *mode)
             access = GENERIC_WRITE;
             create = CREATE_ALWAYS;
 #else
-            access = O_WRONLY | O_CREAT;
+            access = O_WRONLY | O_CREAT | O_TRUNC;
             create = S_IRUSR | S_IWUSR;
 #endif
             break;
@@ -136,6 +136,7 @@ KD_API KDFile *KD_APIENTRY kdFopen(const KDchar *pathname, const KDchar *mode)
             append = 1;
 #else
             access = O_WRONLY | O_CREAT | O_APPEND;
+            create = S_IRUSR | S_IWUSR;
 #endif
             break;
         }
@@ -252,14 +253,15 @@ KD_API KDsize KD_APIENTRY kdFread(void *buffer, KDsize size, KDsize count, KDFil
         KDint error = GetLastError();
 #else
     KDchar *temp = buffer;
-    while(length != 0 && (retval = __kdRead(file->nativefile, temp, size)) != 0)
+    while(length != 0 && (retval = __kdRead(file->nativefile, temp, length)) != 0)
     {
         if(retval == -1)
         {
-            if(errno != EINTR)
+            if(errno == EINTR)
             {
-                break;
+                continue;
             }
+            break;
         }
         length -= (KDsize)retval;
         temp += retval;
@@ -293,22 +295,20 @@ KD_API KDsize KD_APIENTRY kdFwrite(const void *buffer, KDsize size, KDsize count
     {
         KDint error = GetLastError();
 #else
-    KDchar *temp = kdMalloc(length);
-    KDchar *_temp = temp;
-    kdMemcpy(temp, buffer, length);
-    while(length != 0 && (retval = __kdWrite(file->nativefile, temp, size)) != 0)
+    const KDchar *temp = buffer;
+    while(length != 0 && (retval = __kdWrite(file->nativefile, temp, length)) != 0)
     {
         if(retval == -1)
         {
-            if(errno != EINTR)
+            if(errno == EINTR)
             {
-                break;
+                continue;
             }
+            break;
         }
         length -= (KDsize)retval;
         temp += retval;
     }
-    kdFree(_temp);
     if(retval == -1)
     {
         KDint error = errno;
@@ -460,8 +460,8 @@ KD_API KDint KD_APIENTRY kdFseek(KDFile *file, KDoff offset, KDfileSeekOrigin or
             {
                 error = GetLastError();
 #else
-            KDint retval = (KDint)lseek(file->nativefile, (KDint32)offset, seekorigins[i].seekorigin);
-            if(retval != 0)
+            KDoff retval = (KDoff)lseek(file->nativefile, (off_t)offset, seekorigins[i].seekorigin);
+            if(retval == -1)
             {
                 error = errno;
 #endif
@@ -39,6 +39,7 @@
 #include <KD/kd.h>             // for KDchar, KDint, kdStrncpy_s, kdSetError, kdS...
 #include "KD/KHR_formatted.h"  // for kdFprintfKHR, kdFscanfKHR, kdLogMessag...
 #include <KD/kdext.h>          // for kdIsspaceVEN, kdStrcspnVEN, kdIsdigitVEN
+#include <KD/VEN_atomic_ops.h>  // for kdAtomicIntLoadVEN, kdAtomicIntCreateVEN
 #if defined(__clang__)
 #pragma clang diagnostic pop
 #endif
@@ -123,38 +124,7 @@
 
 /******************************************************************************
  * OpenKODE Core extension: KD_KHR_formatted
- *
- * Notes:
- * - kdVsscanfKHR based on work by Opsycon AB
- ******************************************************************************/
-/******************************************************************************
- * Copyright (c) 2000-2002 Opsycon AB  (www.opsycon.se)
- * 
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions
- * are met:
- * 1. Redistributions of source code must retain the above copyright
- *    notice, this list of conditions and the following disclaimer.
- * 2. Redistributions in binary form must reproduce the above copyright
- *    notice, this list of conditions and the following disclaimer in the
- *    documentation and/or other materials provided with the distribution.
- * 3. All advertising materials mentioning features or use of this software
- *    must display the following acknowledgement:
- *  This product includes software developed by Opsycon AB.
- * 4. The name of the author may not be used to endorse or promote products
- *    derived from this software without specific prior written permission.
- *
- * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
- * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
- * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
- * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
- * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
- * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
- * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
- * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
- * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
- * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
- * SUCH DAMAGE.
+
  ******************************************************************************/
 
 /* kdSnprintfKHR, kdVsnprintfKHR, kdSprintfKHR, kdVsprintfKHR: Formatted output to a buffer. */
@@ -217,250 +187,1894 @@ static KDchar *__kdVfprintfCallback(KDchar *buf, void *user, KDint len)
 KD_API KDint KD_APIENTRY kdVfprintfKHR(KDFile *file, const KDchar *format, KDVaListKHR ap)
 {
     KDchar buf[STB_SPRINTF_MIN];
-    return stbsp_vsprintfcb(&__kdVfprintfCallback, &file, buf, format, ap);
+    return stbsp_vsprintfcb(&__kdVfprintfCallback, file, buf, format, ap);
 }
 
-/* kdLogMessagefKHR: Formatted output to the platform's debug logging facility. */
+/******************************************************************************
+ * Logging
+ *
+ * Notes:
+ * - Every thread appends to its own single-producer ring buffer, a writer
+ *   thread drains all rings to the sink and prefixes each line with the
+ *   time since startup and the thread number.
+ * - kdLogDeferredVEN only stores the format pointer and the raw arguments,
+ *   the writer formats them. In KD_LOG_BINARY_VEN mode the writer stores
+ *   the records as they are and kdLogDecodeVEN formats them offline.
+ * - A message that does not fit is dropped as a whole and counted.
+ * - Before __kdLogInit, after __kdLogShutdown and on threads unknown to
+ *   libKD messages are written synchronously without prefix. In binary
+ *   mode they go to stdout so the binary log stays intact.
+ ******************************************************************************/
+
 #if !defined(__ANDROID__) && !defined(__EMSCRIPTEN__)
-static KDchar *__kdLogMessagefCallback(KDchar *buf, KD_UNUSED void *user, KDint len)
+#if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX) || defined(KD_THREAD_WIN32)
+#define KD_LOG_ASYNC
+#endif
+#endif
+
+/* Ring size in bytes, must be a power of two. */
+#define __KD_LOG_RING_SIZE 32768
+
+/* Record kinds, shared by rings and binary logs. */
+#define __KD_LOG_FORMAT 1
+#define __KD_LOG_TEXT 2
+#define __KD_LOG_DEFERRED 3
+
+struct _KDLogRing {
+    _KDLogRing *next;
+    KDuint8 *buffer;
+    KDAtomicIntVEN *head; /* Written by the owning thread */
+    KDAtomicIntVEN *tail; /* Written by the consumer */
+    KDAtomicIntVEN *closed;
+    KDuint id;
+    KDboolean linestart; /* Consumer state */
+    KDint8 padding[3];
+};
+
+typedef struct _KDLogRecord {
+    KDust timestamp;
+    KDuint32 length;
+    KDuint32 kind;
+} _KDLogRecord;
+
+/* Binary logs start with a header, each record is followed by length bytes. */
+typedef struct _KDLogBinaryHeader {
+    KDchar magic[8];
+    KDuint32 version;
+    KDuint32 byteorder;
+} _KDLogBinaryHeader;
+
+typedef struct _KDLogBinaryRecord {
+    KDuint32 kind;
+    KDuint32 length;
+    KDust elapsed;   /* Since startup */
+    KDuint64 format; /* Format id of deferred records */
+    KDuint32 thread;
+    KDuint32 reserved;
+} _KDLogBinaryRecord;
+
+static const _KDLogBinaryHeader __kd_logheader = {{'K', 'D', 'L', 'O', 'G', 'B', 'I', 'N'}, 1, 0x01020304};
+
+/* The consumer side (writer thread, kdLogFlushVEN, kdLogSetSinkVEN, kdLogSetModeVEN) holds __kd_logmutex. */
+#if defined(KD_LOG_ASYNC)
+static KDAtomicPtrVEN *__kd_logrings = KD_NULL;
+static KDAtomicIntVEN *__kd_logrunning = KD_NULL;
+static KDAtomicIntVEN *__kd_logsleeping = KD_NULL;
+static KDAtomicIntVEN *__kd_logids = KD_NULL;
+static KDThreadSem *__kd_logsem = KD_NULL;
+static KDThreadAttr *__kd_logwriterattr = KD_NULL;
+static KDThread *__kd_logwriter = KD_NULL;
+static KDuint8 *__kd_logscratch = KD_NULL;
+#endif
+static KDAtomicIntVEN *__kd_logdropped = KD_NULL;
+static KDThreadMutex *__kd_logmutex = KD_NULL;
+static KDFile *__kd_logfile = KD_NULL;
+static KDust __kd_logstart = 0;
+static KDint __kd_logmode = KD_LOG_TEXT_VEN;
+static KDboolean __kd_logbinarystarted = 0;
+/* Formats already written to the binary log */
+static KDuint64 *__kd_logformats = KD_NULL;
+static KDsize __kd_logformatcount = 0;
+static KDsize __kd_logformatcapacity = 0;
+
+typedef struct _KDLogEmitter {
+    KDFile *file;          /* KD_NULL for stdout */
+    KDboolean *linestart;  /* KD_NULL for no prefix */
+    KDust elapsed;
+    KDsize length;
+    KDuint id;
+    KDint8 padding[4];
+    KDchar buffer[1024];
+} _KDLogEmitter;
+
+/* __kdLogWriteTo: Write to a file or stdout. */
+static void __kdLogWriteTo(KDFile *file, const void *buf, KDsize len)
 {
-#if defined(_WIN32)
+    if(file)
+    {
+        kdFwrite(buf, 1, len, file);
+        return;
+    }
+#if defined(__ANDROID__)
+    __android_log_print(ANDROID_LOG_INFO, "OpenKODE", "%.*s", (KDint)len, (const KDchar *)buf);
+#elif defined(__EMSCRIPTEN__)
+    printf("%.*s", (KDint)len, (const KDchar *)buf);
+#elif defined(_WIN32)
     HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
-    WriteFile(out, buf, len, (DWORD[]) {0}, KD_NULL);
+    WriteFile(out, buf, (DWORD)len, (DWORD[]) {0}, KD_NULL);
 #else
-    KDssize result = __kdWrite(STDOUT_FILENO, buf, (KDsize)len);
-    if(result != len)
+    __kdWrite(STDOUT_FILENO, buf, len);
+#endif
+}
+
+static void __kdLogEmitFlush(_KDLogEmitter *emitter)
+{
+    if(emitter->length)
     {
-        return KD_NULL;
+        __kdLogWriteTo(emitter->file, emitter->buffer, emitter->length);
+        emitter->length = 0;
     }
-#endif
+}
+
+/* __kdLogEmitRaw: Buffer bytes as they are. */
+static void __kdLogEmitRaw(_KDLogEmitter *emitter, const void *data, KDsize len)
+{
+    const KDuint8 *src = (const KDuint8 *)data;
+    while(len)
+    {
+        KDsize space = sizeof(emitter->buffer) - emitter->length;
+        KDsize n = (len < space) ? len : space;
+        kdMemcpy(emitter->buffer + emitter->length, src, n);
+        emitter->length += n;
+        src += n;
+        len -= n;
+        if(emitter->length == sizeof(emitter->buffer))
+        {
+            __kdLogEmitFlush(emitter);
+        }
+    }
+}
+
+/* __kdLogEmit: Buffer text, prefixing every line with time and thread. */
+static void __kdLogEmit(_KDLogEmitter *emitter, const KDchar *text, KDsize len)
+{
+    while(len)
+    {
+        if(emitter->linestart && *emitter->linestart)
+        {
+            KDchar prefix[64];
+            KDint n = stbsp_snprintf(prefix, sizeof(prefix), "[%5llu.%06llu] [%u] ", (KDuint64)emitter->elapsed / 1000000000ULL, ((KDuint64)emitter->elapsed / 1000ULL) % 1000000ULL, emitter->id);
+            __kdLogEmitRaw(emitter, prefix, (KDsize)n);
+            *emitter->linestart = 0;
+        }
+        KDsize n = 0;
+        while(n < len && text[n++] != '\n')
+        {
+            ;
+        }
+        if(emitter->linestart && text[n - 1] == '\n')
+        {
+            *emitter->linestart = 1;
+        }
+        __kdLogEmitRaw(emitter, text, n);
+        text += n;
+        len -= n;
+    }
+}
+
+static KDchar *__kdLogEmitCallback(KDchar *buf, void *user, KDint len)
+{
+    __kdLogEmit((_KDLogEmitter *)user, buf, (KDsize)len);
     if(len < STB_SPRINTF_MIN)
     {
-#if defined(_WIN32)
-        FlushFileBuffers(out);
-#endif
         return KD_NULL;
     }
     /* Reuse buffer */
     return buf;
 }
-#endif
 
-#if defined(__ANDROID__) || defined(__EMSCRIPTEN__)
-__attribute__((__format__(__printf__, 1, 2)))
-#endif
-KD_API KDint KD_APIENTRY
-kdLogMessagefKHR(const KDchar *format, ...)
+static void __kdLogEmitf(_KDLogEmitter *emitter, const KDchar *format, ...)
 {
-#ifdef KD_NDEBUG
-    return 0;
-#endif
-    KDint result = 0;
+    KDchar buf[STB_SPRINTF_MIN];
     KDVaListKHR ap;
     KD_VA_START_KHR(ap, format);
+    stbsp_vsprintfcb(&__kdLogEmitCallback, emitter, buf, format, ap);
+    KD_VA_END_KHR(ap);
+}
 
-#if defined(__ANDROID__)
-    result = __android_log_vprint(ANDROID_LOG_INFO, "OpenKODE", format, ap);
-#elif defined(__EMSCRIPTEN__)
-    result = vprintf(format, ap);
-#else
-    KDchar buf[STB_SPRINTF_MIN];
-    result = stbsp_vsprintfcb(&__kdLogMessagefCallback, KD_NULL, buf, format, ap);
-#endif
+/* Conversion specification of a deferred message */
+#define __KD_LOG_SIZE_DEFAULT 0
+#define __KD_LOG_SIZE_LONG 1
+#define __KD_LOG_SIZE_LONGLONG 2
+#define __KD_LOG_SIZE_SIZE 3
+typedef struct _KDLogSpec {
+    const KDchar *modifier; /* Start of the length modifier */
+    KDint size;
+    KDint conv;
+    KDint stars;  /* Width and precision passed as arguments */
+    KDint length; /* Characters in the specification */
+} _KDLogSpec;
 
-    KD_VA_END_KHR(ap);
-    return result;
+/* __kdLogParseSpec: Parse the specification starting at the '%' in format, the same way stb_sprintf does. */
+static void __kdLogParseSpec(const KDchar *format, _KDLogSpec *spec)
+{
+    const KDchar *f = format + 1;
+    spec->stars = 0;
+    spec->size = __KD_LOG_SIZE_DEFAULT;
+    while(*f == '-' || *f == '+' || *f == ' ' || *f == '#' || *f == '0' || *f == '\'')
+    {
+        f++;
+    }
+    for(KDint part = 0; part < 2; part++)
+    {
+        if(*f == '*')
+        {
+            spec->stars++;
+            f++;
+        }
+        while(*f >= '0' && *f <= '9')
+        {
+            f++;
+        }
+        if(part == 0 && *f == '.')
+        {
+            f++;
+        }
+        else
+        {
+            break;
+        }
+    }
+    spec->modifier = f;
+    switch(*f)
+    {
+        case 'h':
+            /* Arguments are promoted to int, stb_sprintf does not truncate them. */
+            f++;
+            break;
+        case 'l':
+            spec->size = (f[1] == 'l') ? __KD_LOG_SIZE_LONGLONG : __KD_LOG_SIZE_LONG;
+            f += (f[1] == 'l') ? 2 : 1;
+            break;
+        case 'L':
+        case 'j':
+            spec->size = __KD_LOG_SIZE_LONGLONG;
+            f++;
+            break;
+        case 'z':
+        case 't':
+            spec->size = __KD_LOG_SIZE_SIZE;
+            f++;
+            break;
+        default:
+            break;
+    }
+    spec->conv = (KDuint8)*f;
+    if(*f)
+    {
+        f++;
+    }
+    spec->length = (KDint)(f - format);
 }
 
-/* kdSscanfKHR, kdVsscanfKHR: Read formatted input from a buffer. */
-KD_API KDint KD_APIENTRY kdSscanfKHR(const KDchar *str, const KDchar *format, ...)
+/* Target of an append, rings and stack buffers alike. */
+typedef struct _KDLogAppend {
+    KDuint8 *buffer;
+    KDuint mask;
+    KDuint limit; /* Appending stops here */
+    KDuint pos;
+    KDboolean full;
+    KDint8 padding[3];
+} _KDLogAppend;
+
+static void __kdLogPut(_KDLogAppend *append, const void *src, KDsize len)
 {
-    KDint result = 0;
-    KDVaListKHR ap;
-    KD_VA_START_KHR(ap, format);
-    result = kdVsscanfKHR(str, format, ap);
-    KD_VA_END_KHR(ap);
-    return result;
+    if(append->full || len > (KDsize)(append->limit - append->pos))
+    {
+        append->full = 1;
+        return;
+    }
+    KDsize offset = append->pos & append->mask;
+    KDsize first = (len < append->mask + 1 - offset) ? len : append->mask + 1 - offset;
+    kdMemcpy(append->buffer + offset, src, first);
+    kdMemcpy(append->buffer, (const KDuint8 *)src + first, len - first);
+    append->pos += (KDuint)len;
 }
 
-KD_API KDint KD_APIENTRY kdVsscanfKHR(const KDchar *str, const KDchar *format, KDVaListKHR ap)
+static KDchar *__kdLogAppendCallback(KDchar *buf, void *user, KDint len)
 {
-    KDint count, noassign, width, base, lflag;
-    const KDchar *tc;
-    KDchar *t, tmp[128];
+    __kdLogPut((_KDLogAppend *)user, buf, (KDsize)len);
+    if(len < STB_SPRINTF_MIN)
+    {
+        return KD_NULL;
+    }
+    /* Reuse buffer */
+    return buf;
+}
 
-    count = noassign = width = lflag = 0;
-    while(*format && *str)
+/* __kdLogEncode: Store the arguments of format as 64-bit values, strings are copied. */
+static void __kdLogEncode(_KDLogAppend *append, const KDchar *format, KDVaListKHR *ap)
+{
+    for(const KDchar *f = format; *f; f++)
     {
-        while(kdIsspaceVEN(*format))
+        if(*f != '%')
+        {
+            continue;
+        }
+        _KDLogSpec spec;
+        __kdLogParseSpec(f, &spec);
+        f += spec.length - 1;
+        for(KDint i = 0; i < spec.stars; i++)
         {
-            format++;
+            KDint64 value = KD_VA_ARG_INT_KHR(*ap);
+            __kdLogPut(append, &value, sizeof(value));
         }
-        if(*format == '%')
+        switch(spec.conv)
         {
-            format++;
-            for(; *format; format++)
+            case 'd':
+            case 'i':
+            case 'c':
             {
-                if(kdStrchr("dibouxcsefg%", *format))
-                {
-                    break;
-                }
-                if(*format == '*')
+                KDint64 value = 0;
+                if(spec.size == __KD_LOG_SIZE_LONGLONG || ((spec.size == __KD_LOG_SIZE_LONG) && sizeof(long) == 8) || ((spec.size == __KD_LOG_SIZE_SIZE) && sizeof(KDsize) == 8))
                 {
-                    noassign = 1;
+                    value = KD_VA_ARG_INT64_KHR(*ap);
                 }
-                else if(*format == 'l' || *format == 'L')
-                {
-                }
-                else if(*format >= '1' && *format <= '9')
+                else
                 {
-                    tc = format;
-                    while(kdIsdigitVEN(*format))
-                    {
-                        format++;
-                    }
-                    kdStrncpy_s(tmp, (KDsize)(format - tc), tc, (KDsize)(format - tc));
-                    tmp[format - tc] = '\0';
-                    width = kdStrtol(tmp, KD_NULL, 10);
-                    format--;
+                    value = KD_VA_ARG_INT_KHR(*ap);
                 }
+                __kdLogPut(append, &value, sizeof(value));
+                break;
             }
-            if(*format == 's')
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'b':
+            case 'B':
             {
-                while(kdIsspaceVEN(*str))
-                {
-                    str++;
-                }
-                if(!width)
+                KDuint64 value = 0;
+                if(spec.size == __KD_LOG_SIZE_LONGLONG || ((spec.size == __KD_LOG_SIZE_LONG) && sizeof(long) == 8) || ((spec.size == __KD_LOG_SIZE_SIZE) && sizeof(KDsize) == 8))
                 {
-                    width = (KDint)kdStrcspnVEN(str, " \t\n\r\f\v");
+                    value = (KDuint64)KD_VA_ARG_INT64_KHR(*ap);
                 }
-                if(!noassign)
+                else
                 {
-                    kdStrncpy_s(t = (KDchar *)KD_VA_ARG_PTR_KHR(ap), (KDsize)width, str, (KDsize)width);
-                    t[width] = '\0';
+                    value = (KDuint32)KD_VA_ARG_INT_KHR(*ap);
                 }
-                str += width;
+                __kdLogPut(append, &value, sizeof(value));
+                break;
             }
-            else if(*format == 'c')
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
             {
-                if(!width)
-                {
-                    width = 1;
-                }
-                if(!noassign)
-                {
-                    kdStrncpy_s(t = (KDchar *)KD_VA_ARG_PTR_KHR(ap), (KDsize)width, str, (KDsize)width);
-                    t[width] = '\0';
-                }
-                str += width;
+                KDfloat64KHR value = KD_VA_ARG_FLOAT64_KHR(*ap);
+                __kdLogPut(append, &value, sizeof(value));
+                break;
             }
-            else if(kdStrchr("dobxu", *format))
+            case 's':
             {
-                while(kdIsspaceVEN(*str))
-                {
-                    str++;
-                }
-                if(*format == 'd' || *format == 'u')
-                {
-                    base = 10;
-                }
-                else if(*format == 'x')
+                const KDchar *value = KD_VA_ARG_PTR_KHR(*ap);
+                value = value ? value : "(null)";
+                KDuint32 length = (KDuint32)kdStrlen(value);
+                __kdLogPut(append, &length, sizeof(length));
+                __kdLogPut(append, value, length + 1);
+                break;
+            }
+            case 'p':
+            {
+                KDuint64 value = (KDuintptr)KD_VA_ARG_PTR_KHR(*ap);
+                __kdLogPut(append, &value, sizeof(value));
+                break;
+            }
+            case 'n':
+                (void)KD_VA_ARG_PTR_KHR(*ap);
+                break;
+            default:
+                break;
+        }
+        if(spec.conv == '\0')
+        {
+            break;
+        }
+    }
+}
+
+static KDboolean __kdLogRead(const KDuint8 **args, const KDuint8 *end, void *dst, KDsize len)
+{
+    if((KDsize)(end - *args) < len)
+    {
+        return 0;
+    }
+    kdMemcpy(dst, *args, len);
+    *args += len;
+    return 1;
+}
+
+/* __kdLogDecode: Format the arguments stored by __kdLogEncode. */
+static void __kdLogDecode(_KDLogEmitter *emitter, const KDchar *format, const KDuint8 *args, KDsize len)
+{
+    const KDuint8 *end = args + len;
+    const KDchar *literal = format;
+    const KDchar *f = format;
+    while(*f)
+    {
+        if(*f != '%')
+        {
+            f++;
+            continue;
+        }
+        __kdLogEmit(emitter, literal, (KDsize)(f - literal));
+        _KDLogSpec spec;
+        __kdLogParseSpec(f, &spec);
+        literal = f + spec.length;
+
+        /* Rebuild the specification with the stars resolved and 64-bit integers. */
+        KDchar rebuilt[64];
+        KDsize pos = 0;
+        for(const KDchar *c = f; c < spec.modifier && pos < 32; c++)
+        {
+            if(*c == '*')
+            {
+                KDint64 value = 0;
+                if(!__kdLogRead(&args, end, &value, sizeof(value)))
                 {
-                    base = 16;
+                    return;
                 }
-                else if(*format == 'o')
+                /* Keeps a corrupted log from producing gigabytes of padding. */
+                value = (value < -65536) ? -65536 : (value > 65536) ? 65536 : value;
+                pos += (KDsize)stbsp_snprintf(rebuilt + pos, 12, "%d", (KDint)value);
+            }
+            else
+            {
+                rebuilt[pos++] = *c;
+            }
+        }
+        switch(spec.conv)
+        {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'b':
+            case 'B':
+                rebuilt[pos++] = 'l';
+                rebuilt[pos++] = 'l';
+                break;
+            default:
+                break;
+        }
+        rebuilt[pos++] = (KDchar)spec.conv;
+        rebuilt[pos] = '\0';
+
+        switch(spec.conv)
+        {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'b':
+            case 'B':
+            case 'c':
+            {
+                KDint64 value = 0;
+                if(!__kdLogRead(&args, end, &value, sizeof(value)))
                 {
-                    base = 8;
+                    return;
                 }
-                else if(*format == 'b')
+                if(spec.conv == 'c')
                 {
-                    base = 2;
+                    __kdLogEmitf(emitter, rebuilt, (KDint)value);
                 }
                 else
                 {
-                    base = 10;
-                }
-                if(!width)
-                {
-                    if(kdIsspaceVEN(*(format + 1)) || *(format + 1) == 0)
-                    {
-                        width = (KDint)kdStrcspnVEN(str, " \t\n\r\f\v");
-                    }
-                    else
-                    {
-                        width = (KDint)(kdStrchr(str, *(format + 1)) - str);
-                    }
+                    __kdLogEmitf(emitter, rebuilt, value);
                 }
-                kdStrncpy_s(tmp, (KDsize)width, str, (KDsize)width);
-                tmp[width] = '\0';
-                str += width;
-                if(!noassign)
+                break;
+            }
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+            {
+                KDfloat64KHR value = 0.0;
+                if(!__kdLogRead(&args, end, &value, sizeof(value)))
                 {
-                    KDchar *i = KD_VA_ARG_PTR_KHR(ap);
-                    *i = (KDchar)kdStrtol(tmp, KD_NULL, base);
+                    return;
                 }
+                __kdLogEmitf(emitter, rebuilt, value);
+                break;
             }
-            if(!noassign)
+            case 's':
             {
-                count++;
+                KDuint32 length = 0;
+                if(!__kdLogRead(&args, end, &length, sizeof(length)) || (KDsize)(end - args) <= length || args[length] != '\0')
+                {
+                    return;
+                }
+                __kdLogEmitf(emitter, rebuilt, (const KDchar *)args);
+                args += length + 1;
+                break;
             }
-            width = noassign = 0;
-            format++;
-        }
-        else
-        {
-            while(kdIsspaceVEN(*str))
+            case 'p':
             {
-                str++;
+                KDuint64 value = 0;
+                if(!__kdLogRead(&args, end, &value, sizeof(value)))
+                {
+                    return;
+                }
+                __kdLogEmitf(emitter, rebuilt, (void *)(KDuintptr)value);
+                break;
             }
-            if(*format != *str)
+            default:
             {
+                /* Unknown conversions and '%' print themselves. */
+                KDchar c = (KDchar)spec.conv;
+                __kdLogEmit(emitter, &c, spec.conv ? 1 : 0);
                 break;
             }
-            else
+        }
+        f = literal;
+    }
+    __kdLogEmit(emitter, literal, (KDsize)(f - literal));
+}
+
+/* __kdLogFormatSeen: Check if a format was written to the binary log, remember it if not. */
+static KDboolean __kdLogFormatSeen(KDuint64 id)
+{
+    if((__kd_logformatcount + 1) * 2 > __kd_logformatcapacity)
+    {
+        KDsize capacity = __kd_logformatcapacity ? __kd_logformatcapacity * 2 : 64;
+        KDuint64 *formats = (KDuint64 *)kdMalloc(capacity * sizeof(KDuint64));
+        if(formats == KD_NULL)
+        {
+            /* Writing the format again is harmless. */
+            return 0;
+        }
+        kdMemset(formats, 0, capacity * sizeof(KDuint64));
+        for(KDsize i = 0; i < __kd_logformatcapacity; i++)
+        {
+            if(__kd_logformats[i])
             {
-                format++;
-                str++;
+                KDsize j = (KDsize)(__kd_logformats[i] >> 3) & (capacity - 1);
+                while(formats[j])
+                {
+                    j = (j + 1) & (capacity - 1);
+                }
+                formats[j] = __kd_logformats[i];
             }
         }
+        kdFree(__kd_logformats);
+        __kd_logformats = formats;
+        __kd_logformatcapacity = capacity;
+    }
+    KDsize i = (KDsize)(id >> 3) & (__kd_logformatcapacity - 1);
+    while(__kd_logformats[i])
+    {
+        if(__kd_logformats[i] == id)
+        {
+            return 1;
+        }
+        i = (i + 1) & (__kd_logformatcapacity - 1);
     }
-    return (count);
+    __kd_logformats[i] = id;
+    __kd_logformatcount++;
+    return 0;
 }
 
-/* kdFscanfKHR, kdVfscanfKHR: Read formatted input from a file. */
-KD_API KDint KD_APIENTRY kdFscanfKHR(KDFile *file, const KDchar *format, ...)
+/* __kdLogBinaryReset: The next binary write starts a new log. */
+static void __kdLogBinaryReset(void)
 {
-    KDint result = 0;
-    KDVaListKHR ap;
-    KD_VA_START_KHR(ap, format);
-    result = kdVfscanfKHR(file, format, ap);
-    KD_VA_END_KHR(ap);
-    return result;
+    __kd_logbinarystarted = 0;
+    kdFree(__kd_logformats);
+    __kd_logformats = KD_NULL;
+    __kd_logformatcount = 0;
+    __kd_logformatcapacity = 0;
 }
 
-KD_API KDint KD_APIENTRY kdVfscanfKHR(KDFile *file, const KDchar *format, KDVaListKHR ap)
+/* __kdLogWriteBinary: Write a ring record to the binary log. */
+static void __kdLogWriteBinary(_KDLogEmitter *emitter, const _KDLogRecord *record, const KDuint8 *payload)
 {
-    KDStat st;
-    if(kdFstat(file, &st) == -1)
+    if(!__kd_logbinarystarted)
     {
-        kdSetError(KD_EIO);
-        return KD_EOF;
+        __kdLogEmitRaw(emitter, &__kd_logheader, sizeof(__kd_logheader));
+        __kd_logbinarystarted = 1;
     }
-    KDsize size = (KDsize)st.st_size;
-    void *buffer = kdMalloc(size);
-    if(buffer == KD_NULL)
+    _KDLogBinaryRecord out = {record->kind, record->length, emitter->elapsed, 0, emitter->id, 0};
+    if(record->kind == __KD_LOG_DEFERRED)
     {
-        kdSetError(KD_ENOMEM);
-        return KD_EOF;
+        kdMemcpy(&out.format, payload, sizeof(out.format));
+        payload += sizeof(out.format);
+        out.length -= (KDuint32)sizeof(out.format);
+        if(!__kdLogFormatSeen(out.format))
+        {
+            const KDchar *format = (const KDchar *)(KDuintptr)out.format;
+            KDsize length = kdStrlen(format) + 1;
+            _KDLogBinaryRecord definition = {__KD_LOG_FORMAT, (KDuint32)length, 0, out.format, 0, 0};
+            __kdLogEmitRaw(emitter, &definition, sizeof(definition));
+            __kdLogEmitRaw(emitter, format, length);
+        }
+    }
+    __kdLogEmitRaw(emitter, &out, sizeof(out));
+    __kdLogEmitRaw(emitter, payload, out.length);
+}
+
+/* __kdLogWriteRecord: Format or store one record. */
+static void __kdLogWriteRecord(_KDLogEmitter *emitter, const _KDLogRecord *record, const KDuint8 *payload)
+{
+    if(__kd_logmode == KD_LOG_BINARY_VEN)
+    {
+        __kdLogWriteBinary(emitter, record, payload);
+    }
+    else if(record->kind == __KD_LOG_DEFERRED)
+    {
+        KDuint64 format = 0;
+        kdMemcpy(&format, payload, sizeof(format));
+        __kdLogDecode(emitter, (const KDchar *)(KDuintptr)format, payload + sizeof(format), record->length - sizeof(format));
+    }
+    else
+    {
+        __kdLogEmit(emitter, (const KDchar *)payload, record->length);
     }
-    if(kdFread(buffer, 1, size, file) != size)
+}
+
+#if defined(KD_LOG_ASYNC)
+static void __kdLogRingCopyOut(_KDLogRing *ring, KDuint pos, void *dst, KDsize len)
+{
+    KDsize offset = pos & (__KD_LOG_RING_SIZE - 1);
+    KDsize first = (len < __KD_LOG_RING_SIZE - offset) ? len : __KD_LOG_RING_SIZE - offset;
+    kdMemcpy(dst, ring->buffer + offset, first);
+    kdMemcpy((KDuint8 *)dst + first, ring->buffer, len - first);
+}
+
+static void __kdLogRingDestroy(_KDLogRing *ring)
+{
+    kdAtomicIntFreeVEN(ring->closed);
+    kdAtomicIntFreeVEN(ring->tail);
+    kdAtomicIntFreeVEN(ring->head);
+    kdFree(ring->buffer);
+    kdFree(ring);
+}
+
+static _KDLogRing *__kdLogRingCreate(void)
+{
+    _KDLogRing *ring = (_KDLogRing *)kdMalloc(sizeof(_KDLogRing));
+    if(ring == KD_NULL)
     {
-        kdFree(buffer);
-        kdSetError(KD_EIO);
-        return KD_EOF;
+        return KD_NULL;
     }
-    KDint retval = kdVsscanfKHR((const KDchar *)buffer, format, ap);
-    kdFree(buffer);
-    return retval;
+    kdMemset(ring, 0, sizeof(_KDLogRing));
+    ring->buffer = (KDuint8 *)kdMalloc(__KD_LOG_RING_SIZE);
+    ring->head = kdAtomicIntCreateVEN(0);
+    ring->tail = kdAtomicIntCreateVEN(0);
+    ring->closed = kdAtomicIntCreateVEN(0);
+    if(ring->buffer == KD_NULL || ring->head == KD_NULL || ring->tail == KD_NULL || ring->closed == KD_NULL)
+    {
+        kdFree(ring->buffer);
+        if(ring->head)
+        {
+            kdAtomicIntFreeVEN(ring->head);
+        }
+        if(ring->tail)
+        {
+            kdAtomicIntFreeVEN(ring->tail);
+        }
+        if(ring->closed)
+        {
+            kdAtomicIntFreeVEN(ring->closed);
+        }
+        kdFree(ring);
+        return KD_NULL;
+    }
+    ring->id = (KDuint)kdAtomicIntFetchAddVEN(__kd_logids, 1) + 1;
+    ring->linestart = 1;
+
+    /* Producers only ever push to the front. */
+    void *first = KD_NULL;
+    do
+    {
+        first = kdAtomicPtrLoadVEN(__kd_logrings);
+        ring->next = (_KDLogRing *)first;
+    } while(!kdAtomicPtrCompareExchangeVEN(__kd_logrings, first, ring));
+    return ring;
+}
+
+/* __kdLogDrain: Write out everything published in one ring. */
+static void __kdLogDrain(_KDLogRing *ring)
+{
+    _KDLogEmitter emitter;
+    emitter.file = __kd_logfile;
+    emitter.linestart = &ring->linestart;
+    emitter.id = ring->id;
+    emitter.length = 0;
+    KDuint tail = (KDuint)kdAtomicIntLoadVEN(ring->tail);
+    KDuint head = (KDuint)kdAtomicIntLoadVEN(ring->head);
+    while(tail != head)
+    {
+        _KDLogRecord record;
+        __kdLogRingCopyOut(ring, tail, &record, sizeof(record));
+        tail += (KDuint)sizeof(record);
+        __kdLogRingCopyOut(ring, tail, __kd_logscratch, record.length);
+        tail += record.length;
+        emitter.elapsed = record.timestamp - __kd_logstart;
+        __kdLogWriteRecord(&emitter, &record, __kd_logscratch);
+    }
+    __kdLogEmitFlush(&emitter);
+    kdAtomicIntStoreVEN(ring->tail, (KDint)tail);
+}
+
+/* __kdLogDrainAll: Drain every ring and free the ones of exited threads. */
+static KDboolean __kdLogDrainAll(void)
+{
+    KDboolean pending = 0;
+    _KDLogRing *prev = KD_NULL;
+    _KDLogRing *ring = (_KDLogRing *)kdAtomicPtrLoadVEN(__kd_logrings);
+    while(ring)
+    {
+        _KDLogRing *next = ring->next;
+        KDboolean closed = (KDboolean)kdAtomicIntLoadVEN(ring->closed);
+        __kdLogDrain(ring);
+        if(closed)
+        {
+            if(prev)
+            {
+                prev->next = next;
+            }
+            else if(!kdAtomicPtrCompareExchangeVEN(__kd_logrings, ring, next))
+            {
+                /* New rings were pushed in front of this one. */
+                prev = (_KDLogRing *)kdAtomicPtrLoadVEN(__kd_logrings);
+                while(prev->next != ring)
+                {
+                    prev = prev->next;
+                }
+                prev->next = next;
+            }
+            __kdLogRingDestroy(ring);
+        }
+        else
+        {
+            pending |= (kdAtomicIntLoadVEN(ring->head) != kdAtomicIntLoadVEN(ring->tail));
+            prev = ring;
+        }
+        ring = next;
+    }
+    return pending;
+}
+
+static void *__kdLogWriter(KD_UNUSED void *arg)
+{
+    for(;;)
+    {
+        KDboolean running = (KDboolean)kdAtomicIntLoadVEN(__kd_logrunning);
+        kdThreadMutexLock(__kd_logmutex);
+        __kdLogDrainAll();
+        kdThreadMutexUnlock(__kd_logmutex);
+        if(!running)
+        {
+            break;
+        }
+
+        /* Announce sleep, then check again so a concurrent append cannot be missed. */
+        kdAtomicIntStoreVEN(__kd_logsleeping, 1);
+        kdThreadMutexLock(__kd_logmutex);
+        KDboolean pending = __kdLogDrainAll();
+        kdThreadMutexUnlock(__kd_logmutex);
+        if((pending || !kdAtomicIntLoadVEN(__kd_logrunning)) && kdAtomicIntCompareExchangeVEN(__kd_logsleeping, 1, 0))
+        {
+            continue;
+        }
+        kdThreadSemWait(__kd_logsem);
+    }
+    return KD_NULL;
+}
+
+static void __kdLogWake(void)
+{
+    if(kdAtomicIntLoadVEN(__kd_logsleeping) && kdAtomicIntCompareExchangeVEN(__kd_logsleeping, 1, 0))
+    {
+        kdThreadSemPost(__kd_logsem);
+    }
+}
+
+/* __kdLogAppend: Add a record to the ring of the calling thread, returns -1 if there is none. */
+static KDint __kdLogAppend(KDuint32 kind, const KDchar *format, KDVaListKHR *ap)
+{
+    KDThread *thread = kdAtomicIntLoadVEN(__kd_logrunning) ? kdThreadSelf() : KD_NULL;
+    if(thread == KD_NULL)
+    {
+        return -1;
+    }
+    _KDLogRing *ring = thread->logring;
+    if(ring == KD_NULL)
+    {
+        ring = thread->logring = __kdLogRingCreate();
+        if(ring == KD_NULL)
+        {
+            return -1;
+        }
+    }
+
+    /* The record is published by moving head past it. */
+    KDuint head = (KDuint)kdAtomicIntLoadVEN(ring->head);
+    KDuint tail = (KDuint)kdAtomicIntLoadVEN(ring->tail);
+    _KDLogAppend append = {ring->buffer, __KD_LOG_RING_SIZE - 1, tail + __KD_LOG_RING_SIZE, head, 0, {0}};
+    _KDLogRecord record = {0, 0, kind};
+    __kdLogPut(&append, &record, sizeof(record));
+    KDint result = 0;
+    if(kind == __KD_LOG_DEFERRED)
+    {
+        KDuint64 id = (KDuintptr)format;
+        __kdLogPut(&append, &id, sizeof(id));
+        __kdLogEncode(&append, format, ap);
+    }
+    else
+    {
+        KDchar buf[STB_SPRINTF_MIN];
+        result = stbsp_vsprintfcb(&__kdLogAppendCallback, &append, buf, format, *ap);
+    }
+    if(append.full)
+    {
+        kdAtomicIntFetchAddVEN(__kd_logdropped, 1);
+        result = (kind == __KD_LOG_DEFERRED) ? -1 : result;
+    }
+    else
+    {
+        record.timestamp = kdGetTimeUST();
+        record.length = (KDuint32)(append.pos - head - sizeof(record));
+        append.pos = head;
+        append.limit = head + (KDuint)sizeof(record);
+        __kdLogPut(&append, &record, sizeof(record));
+        kdAtomicIntStoreVEN(ring->head, (KDint)(head + (KDuint)sizeof(record) + record.length));
+    }
+    __kdLogWake();
+    return result;
+}
+#endif /* KD_LOG_ASYNC */
+
+/* __kdLogInit: Start the log writer. */
+void __kdLogInit(void)
+{
+#if defined(KD_LOG_ASYNC)
+    __kd_logrings = kdAtomicPtrCreateVEN(KD_NULL);
+    __kd_logsleeping = kdAtomicIntCreateVEN(0);
+    __kd_logdropped = kdAtomicIntCreateVEN(0);
+    __kd_logids = kdAtomicIntCreateVEN(0);
+    __kd_logmutex = kdThreadMutexCreate(KD_NULL);
+    __kd_logsem = kdThreadSemCreate(0);
+    __kd_logscratch = (KDuint8 *)kdMalloc(__KD_LOG_RING_SIZE);
+    __kd_logstart = kdGetTimeUST();
+    __kd_logrunning = kdAtomicIntCreateVEN(1);
+
+    /* The attribute has to outlive the thread, it is read on startup. */
+    __kd_logwriterattr = kdThreadAttrCreate();
+    if(__kd_logwriterattr)
+    {
+        kdThreadAttrSetDebugNameVEN(__kd_logwriterattr, "KDLogWriter");
+    }
+    __kd_logwriter = kdThreadCreate(__kd_logwriterattr, __kdLogWriter, KD_NULL);
+    if(__kd_logwriter == KD_NULL)
+    {
+        /* Stay synchronous. */
+        kdAtomicIntStoreVEN(__kd_logrunning, 0);
+    }
+#else
+    __kd_logstart = kdGetTimeUST();
+#endif
+}
+
+/* __kdLogShutdown: Write out pending messages and stop the log writer. */
+void __kdLogShutdown(void)
+{
+#if defined(KD_LOG_ASYNC)
+    if(__kd_logwriter)
+    {
+        kdAtomicIntStoreVEN(__kd_logrunning, 0);
+        kdThreadSemPost(__kd_logsem);
+        kdThreadJoin(__kd_logwriter, KD_NULL);
+        __kd_logwriter = KD_NULL;
+    }
+    if(__kd_logwriterattr)
+    {
+        kdThreadAttrFree(__kd_logwriterattr);
+        __kd_logwriterattr = KD_NULL;
+    }
+#endif
+}
+
+/* __kdLogRingRelease: Called when a thread goes away, its ring is freed once drained. */
+void __kdLogRingRelease(KD_UNUSED _KDLogRing *ring)
+{
+#if defined(KD_LOG_ASYNC)
+    if(ring)
+    {
+        kdAtomicIntStoreVEN(ring->closed, 1);
+        if(kdAtomicIntLoadVEN(__kd_logrunning))
+        {
+            __kdLogWake();
+        }
+        else
+        {
+            kdLogFlushVEN();
+        }
+    }
+#endif
+}
+
+/* __kdLogSync: Write a message directly from the calling thread. */
+static KDint __kdLogSync(KDuint32 kind, const KDchar *format, KDVaListKHR *ap)
+{
+    _KDLogEmitter emitter;
+    emitter.file = (__kd_logmode == KD_LOG_BINARY_VEN) ? KD_NULL : __kd_logfile;
+    emitter.linestart = KD_NULL;
+    emitter.length = 0;
+    KDint result = 0;
+    if(kind == __KD_LOG_DEFERRED)
+    {
+        KDuint8 args[4096];
+        _KDLogAppend append = {args, sizeof(args) - 1, sizeof(args), 0, 0, {0}};
+        __kdLogEncode(&append, format, ap);
+        if(append.full)
+        {
+            if(__kd_logdropped)
+            {
+                kdAtomicIntFetchAddVEN(__kd_logdropped, 1);
+            }
+            return -1;
+        }
+        __kdLogDecode(&emitter, format, args, append.pos);
+    }
+    else
+    {
+        KDchar buf[STB_SPRINTF_MIN];
+        result = stbsp_vsprintfcb(&__kdLogEmitCallback, &emitter, buf, format, *ap);
+    }
+    __kdLogEmitFlush(&emitter);
+    return result;
+}
+
+/* kdLogFlushVEN: Write out all pending log messages. */
+KD_API void KD_APIENTRY kdLogFlushVEN(void)
+{
+#if defined(KD_LOG_ASYNC)
+    if(__kd_logmutex)
+    {
+        kdThreadMutexLock(__kd_logmutex);
+        __kdLogDrainAll();
+        kdThreadMutexUnlock(__kd_logmutex);
+    }
+#endif
+}
+
+/* kdLogSetSinkVEN: Send log messages to a file, or to stdout if pathname is KD_NULL. */
+KD_API KDint KD_APIENTRY kdLogSetSinkVEN(const KDchar *pathname)
+{
+    KDFile *file = KD_NULL;
+    if(pathname)
+    {
+        file = kdFopen(pathname, "a");
+        if(file == KD_NULL)
+        {
+            return -1;
+        }
+    }
+    if(__kd_logmutex)
+    {
+        kdThreadMutexLock(__kd_logmutex);
+    }
+#if defined(KD_LOG_ASYNC)
+    /* Pending messages still go to the old sink. */
+    if(__kd_logmutex)
+    {
+        __kdLogDrainAll();
+    }
+#endif
+    if(__kd_logfile)
+    {
+        kdFclose(__kd_logfile);
+    }
+    __kd_logfile = file;
+    __kdLogBinaryReset();
+    if(__kd_logmutex)
+    {
+        kdThreadMutexUnlock(__kd_logmutex);
+    }
+    return 0;
+}
+
+/* kdLogSetModeVEN: Choose between formatted text and a binary log for kdLogDecodeVEN. */
+KD_API KDint KD_APIENTRY kdLogSetModeVEN(KDint mode)
+{
+    if(mode != KD_LOG_TEXT_VEN && mode != KD_LOG_BINARY_VEN)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    if(__kd_logmutex)
+    {
+        kdThreadMutexLock(__kd_logmutex);
+    }
+#if defined(KD_LOG_ASYNC)
+    if(__kd_logmutex)
+    {
+        __kdLogDrainAll();
+    }
+#endif
+    __kd_logmode = mode;
+    __kdLogBinaryReset();
+    if(__kd_logmutex)
+    {
+        kdThreadMutexUnlock(__kd_logmutex);
+    }
+    return 0;
+}
+
+/* kdLogGetDroppedVEN: Number of messages dropped because a ring buffer was full. */
+KD_API KDint KD_APIENTRY kdLogGetDroppedVEN(void)
+{
+    return __kd_logdropped ? kdAtomicIntLoadVEN(__kd_logdropped) : 0;
+}
+
+/* kdLogDeferredVEN: Log a message formatted later by the writer, format has to stay valid. */
+KD_API KDint KD_APIENTRY kdLogDeferredVEN(const KDchar *format, ...)
+{
+    KDint result = -1;
+    KDVaListKHR ap;
+    KD_VA_START_KHR(ap, format);
+#if defined(KD_LOG_ASYNC)
+    KDVaListKHR copy;
+    KD_VA_COPY_VEN(copy, ap);
+    result = __kdLogAppend(__KD_LOG_DEFERRED, format, &copy);
+    KD_VA_END_KHR(copy);
+    if(result == -1 && !(__kd_logrunning && kdAtomicIntLoadVEN(__kd_logrunning) && kdThreadSelf()))
+#endif
+    {
+        result = __kdLogSync(__KD_LOG_DEFERRED, format, &ap);
+    }
+    KD_VA_END_KHR(ap);
+    return result;
+}
+
+/* kdLogDecodeVEN: Format a binary log written in KD_LOG_BINARY_VEN mode, to stdout if output is KD_NULL. */
+KD_API KDint KD_APIENTRY kdLogDecodeVEN(const KDchar *input, const KDchar *output)
+{
+    KDStat st;
+    if(kdStat(input, &st) == -1)
+    {
+        return -1;
+    }
+    KDsize size = (KDsize)st.st_size;
+    KDuint8 *data = (KDuint8 *)kdMalloc(size + 1);
+    if(data == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return -1;
+    }
+    KDFile *file = kdFopen(input, "r");
+    if(file == KD_NULL)
+    {
+        kdFree(data);
+        return -1;
+    }
+    size = kdFread(data, 1, size, file);
+    kdFclose(file);
+
+    _KDLogBinaryHeader header;
+    if(size < sizeof(header) || (kdMemcpy(&header, data, sizeof(header)), kdMemcmp(&header, &__kd_logheader, sizeof(header)) != 0))
+    {
+        kdFree(data);
+        kdSetError(KD_EILSEQ);
+        return -1;
+    }
+    _KDLogEmitter emitter;
+    emitter.file = KD_NULL;
+    emitter.length = 0;
+    if(output)
+    {
+        emitter.file = kdFopen(output, "w");
+        if(emitter.file == KD_NULL)
+        {
+            kdFree(data);
+            return -1;
+        }
+    }
+
+    /* Format ids are looked up linearly, logs only have a few hundred formats. */
+    KDuint64 *ids = KD_NULL;
+    const KDchar **formats = KD_NULL;
+    KDsize count = 0;
+    KDsize capacity = 0;
+    KDboolean *linestart = KD_NULL;
+    KDsize threads = 0;
+    KDint result = 0;
+    for(KDsize pos = sizeof(header); pos < size;)
+    {
+        _KDLogBinaryRecord record;
+        if(size - pos < sizeof(record))
+        {
+            result = -1;
+            break;
+        }
+        kdMemcpy(&record, data + pos, sizeof(record));
+        pos += sizeof(record);
+        if(size - pos < record.length)
+        {
+            result = -1;
+            break;
+        }
+        const KDuint8 *payload = data + pos;
+        pos += record.length;
+
+        if(record.kind == __KD_LOG_FORMAT)
+        {
+            if(record.length == 0 || payload[record.length - 1] != '\0')
+            {
+                result = -1;
+                break;
+            }
+            if(count == capacity)
+            {
+                capacity = capacity ? capacity * 2 : 64;
+                KDuint64 *newids = (KDuint64 *)kdRealloc(ids, capacity * sizeof(KDuint64));
+                ids = newids ? newids : ids;
+                const KDchar **newformats = (const KDchar **)kdRealloc(formats, capacity * sizeof(KDchar *));
+                formats = newformats ? newformats : formats;
+                if(newids == KD_NULL || newformats == KD_NULL)
+                {
+                    result = -1;
+                    break;
+                }
+            }
+            ids[count] = record.format;
+            formats[count++] = (const KDchar *)payload;
+            continue;
+        }
+
+        if(record.thread >= threads)
+        {
+            KDsize grow = (KDsize)record.thread + 16;
+            KDboolean *grown = (KDboolean *)kdRealloc(linestart, grow * sizeof(KDboolean));
+            if(grown == KD_NULL)
+            {
+                result = -1;
+                break;
+            }
+            linestart = grown;
+            for(KDsize i = threads; i < grow; i++)
+            {
+                linestart[i] = 1;
+            }
+            threads = grow;
+        }
+        emitter.linestart = &linestart[record.thread];
+        emitter.id = record.thread;
+        emitter.elapsed = record.elapsed;
+        if(record.kind == __KD_LOG_TEXT)
+        {
+            __kdLogEmit(&emitter, (const KDchar *)payload, record.length);
+        }
+        else if(record.kind == __KD_LOG_DEFERRED)
+        {
+            const KDchar *format = KD_NULL;
+            for(KDsize i = count; i > 0; i--)
+            {
+                if(ids[i - 1] == record.format)
+                {
+                    format = formats[i - 1];
+                    break;
+                }
+            }
+            if(format == KD_NULL)
+            {
+                result = -1;
+                break;
+            }
+            __kdLogDecode(&emitter, format, payload, record.length);
+        }
+    }
+    __kdLogEmitFlush(&emitter);
+    if(emitter.file)
+    {
+        kdFclose(emitter.file);
+    }
+    kdFree(linestart);
+    kdFree(formats);
+    kdFree(ids);
+    kdFree(data);
+    if(result == -1)
+    {
+        kdSetError(KD_EILSEQ);
+    }
+    return result;
+}
+
+/* kdLogMessagefKHR: Formatted output to the platform's debug logging facility. */
+#if defined(__ANDROID__) || defined(__EMSCRIPTEN__)
+__attribute__((__format__(__printf__, 1, 2)))
+#endif
+KD_API KDint KD_APIENTRY
+kdLogMessagefKHR(const KDchar *format, ...)
+{
+#ifdef KD_NDEBUG
+    return 0;
+#endif
+    KDint result = 0;
+    KDVaListKHR ap;
+    KD_VA_START_KHR(ap, format);
+
+#if defined(__ANDROID__)
+    result = __android_log_vprint(ANDROID_LOG_INFO, "OpenKODE", format, ap);
+#elif defined(__EMSCRIPTEN__)
+    result = vprintf(format, ap);
+#else
+#if defined(KD_LOG_ASYNC)
+    KDVaListKHR copy;
+    KD_VA_COPY_VEN(copy, ap);
+    result = __kdLogAppend(__KD_LOG_TEXT, format, &copy);
+    KD_VA_END_KHR(copy);
+    if(result == -1)
+#endif
+    {
+        result = __kdLogSync(__KD_LOG_TEXT, format, &ap);
+    }
+#endif
+
+    KD_VA_END_KHR(ap);
+    return result;
+}
+
+/******************************************************************************
+ * Formatted input
+ *
+ * Notes:
+ * - The format is split into operations by __kdScanfParse. kdVsscanfKHR
+ *   runs them as they are parsed, kdScanfCompileVEN stores them in a plan
+ *   so hot loops skip the format parsing entirely.
+ * - Numbers are converted directly from the input. Only fields with an
+ *   explicit width are copied, to terminate them.
+ * - Files are read through a window on the stack, unread lookahead is given
+ *   back with kdFseek when done.
+ ******************************************************************************/
+
+#define __KD_SCAN_SPACE 0
+#define __KD_SCAN_LITERAL 1
+#define __KD_SCAN_CONV 2
+
+#define __KD_SCAN_SIZE_DEFAULT 0
+#define __KD_SCAN_SIZE_CHAR 1
+#define __KD_SCAN_SIZE_SHORT 2
+#define __KD_SCAN_SIZE_LONG 3
+#define __KD_SCAN_SIZE_LONGLONG 4
+#define __KD_SCAN_SIZE_SIZE 5
+
+typedef struct __KDScanfOp {
+    const KDchar *text; /* Literal text */
+    KDuint8 set[32];    /* Scanset bitmap */
+    KDint kind;
+    KDint conv;   /* Conversion specifier */
+    KDint width;  /* Maximum field width or 0 */
+    KDint size;   /* Length modifier */
+    KDint assign; /* 0 if suppressed with '*' */
+    KDint length; /* Literal length */
+} __KDScanfOp;
+
+struct KDScanfPlanVEN {
+    KDint count;
+    KDint reserved;
+    __KDScanfOp ops[];
+};
+
+/* __kdScanfParse: Parse the next operation, returns 1 on success, 0 at the end and -1 on errors. */
+static KDint __kdScanfParse(const KDchar **format, __KDScanfOp *op)
+{
+    const KDchar *f = *format;
+    if(*f == '\0')
+    {
+        return 0;
+    }
+    if(kdIsspaceVEN(*f))
+    {
+        while(kdIsspaceVEN(*f))
+        {
+            f++;
+        }
+        op->kind = __KD_SCAN_SPACE;
+        *format = f;
+        return 1;
+    }
+    if(*f != '%' || f[1] == '%')
+    {
+        /* A literal run, "%%" only matches after whitespace is skipped. */
+        op->kind = __KD_SCAN_LITERAL;
+        op->text = f;
+        if(*f == '%')
+        {
+            op->kind = __KD_SCAN_CONV;
+            op->conv = '%';
+            op->assign = 0;
+            *format = f + 2;
+            return 1;
+        }
+        while(*f && *f != '%' && !kdIsspaceVEN(*f))
+        {
+            f++;
+        }
+        op->length = (KDint)(f - op->text);
+        *format = f;
+        return 1;
+    }
+
+    f++;
+    op->kind = __KD_SCAN_CONV;
+    op->assign = 1;
+    op->width = 0;
+    op->size = __KD_SCAN_SIZE_DEFAULT;
+    if(*f == '*')
+    {
+        op->assign = 0;
+        f++;
+    }
+    while(*f >= '0' && *f <= '9')
+    {
+        op->width = op->width * 10 + (*f++ - '0');
+    }
+    switch(*f)
+    {
+        case 'h':
+            op->size = (f[1] == 'h') ? __KD_SCAN_SIZE_CHAR : __KD_SCAN_SIZE_SHORT;
+            f += (f[1] == 'h') ? 2 : 1;
+            break;
+        case 'l':
+            op->size = (f[1] == 'l') ? __KD_SCAN_SIZE_LONGLONG : __KD_SCAN_SIZE_LONG;
+            f += (f[1] == 'l') ? 2 : 1;
+            break;
+        case 'L':
+        case 'j':
+        case 'q':
+            op->size = __KD_SCAN_SIZE_LONGLONG;
+            f++;
+            break;
+        case 'z':
+        case 't':
+            op->size = __KD_SCAN_SIZE_SIZE;
+            f++;
+            break;
+        default:
+            break;
+    }
+    op->conv = *f;
+    switch(*f)
+    {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'b':
+        case 'p':
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+        case 'c':
+        case 's':
+        case 'n':
+            f++;
+            break;
+        case '[':
+        {
+            KDboolean invert = 0;
+            kdMemset(op->set, 0, sizeof(op->set));
+            f++;
+            if(*f == '^')
+            {
+                invert = 1;
+                f++;
+            }
+            /* A leading ']' is part of the set. */
+            const KDchar *first = f;
+            for(; *f && (*f != ']' || f == first); f++)
+            {
+                KDuint8 lo = (KDuint8)*f;
+                KDuint8 hi = lo;
+                if(f[1] == '-' && f[2] && f[2] != ']')
+                {
+                    hi = (KDuint8)f[2];
+                    f += 2;
+                }
+                for(KDuint c = lo; c <= hi; c++)
+                {
+                    op->set[c >> 3] |= (KDuint8)(1 << (c & 7));
+                }
+            }
+            if(*f != ']')
+            {
+                return -1;
+            }
+            f++;
+            if(invert)
+            {
+                for(KDsize i = 0; i < sizeof(op->set); i++)
+                {
+                    op->set[i] = (KDuint8)~op->set[i];
+                }
+            }
+            /* The terminator can never match. */
+            op->set[0] &= (KDuint8)~1;
+            break;
+        }
+        default:
+            return -1;
+    }
+    *format = f;
+    return 1;
+}
+
+/* kdScanfCompileVEN: Compile a scanf format string into a reusable plan. */
+KD_API KDScanfPlanVEN *KD_APIENTRY kdScanfCompileVEN(const KDchar *format)
+{
+    __KDScanfOp op;
+    KDint count = 0;
+    KDint result = 0;
+    const KDchar *f = format;
+    while((result = __kdScanfParse(&f, &op)) == 1)
+    {
+        count++;
+    }
+    if(result == -1)
+    {
+        kdSetError(KD_EINVAL);
+        return KD_NULL;
+    }
+
+    /* Literals point into a copy of the format that follows the operations. */
+    KDsize length = kdStrlen(format) + 1;
+    KDScanfPlanVEN *plan = (KDScanfPlanVEN *)kdMalloc(sizeof(KDScanfPlanVEN) + (KDsize)count * sizeof(__KDScanfOp) + length);
+    if(plan == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    KDchar *copy = (KDchar *)(plan->ops + count);
+    kdMemcpy(copy, format, length);
+    plan->count = count;
+    plan->reserved = 0;
+    f = copy;
+    for(KDint i = 0; i < count; i++)
+    {
+        __kdScanfParse(&f, &plan->ops[i]);
+    }
+    return plan;
+}
+
+/* kdScanfFreeVEN: Free a compiled scanf plan. */
+KD_API void KD_APIENTRY kdScanfFreeVEN(KDScanfPlanVEN *plan)
+{
+    kdFree(plan);
+}
+
+/* Input is a NUL terminated window, files refill it from the stack buffer. */
+#define __KD_SCAN_WINDOW 1024
+#define __KD_SCAN_LOOKAHEAD 512
+typedef struct __KDScanner {
+    const KDchar *cur;
+    const KDchar *end;
+    KDFile *file;
+    KDchar *buffer;
+    KDsize base;     /* Characters consumed before the window */
+    KDboolean eof;   /* The last refill came up short */
+    KDint8 padding[7];
+} __KDScanner;
+
+/* __kdScanFill: Make at least n characters available if the input has them. */
+static void __kdScanFill(__KDScanner *sc, KDsize n)
+{
+    if(sc->file == KD_NULL || sc->eof || (KDsize)(sc->end - sc->cur) >= n)
+    {
+        return;
+    }
+    KDsize left = (KDsize)(sc->end - sc->cur);
+    sc->base += (KDsize)(sc->cur - sc->buffer);
+    kdMemmove(sc->buffer, sc->cur, left);
+    KDsize want = __KD_SCAN_WINDOW - 1 - left;
+    KDsize got = kdFread(sc->buffer + left, 1, want, sc->file);
+    sc->eof = (got < want);
+    sc->cur = sc->buffer;
+    sc->end = sc->buffer + left + got;
+    sc->buffer[left + got] = '\0';
+}
+
+/* __kdScanPeek: Next character or -1 at the end of the input. */
+static KDint __kdScanPeek(__KDScanner *sc)
+{
+    if(*sc->cur == '\0')
+    {
+        __kdScanFill(sc, 1);
+        if(*sc->cur == '\0')
+        {
+            return -1;
+        }
+    }
+    return (KDuint8)*sc->cur;
+}
+
+static void __kdScanSkipSpace(__KDScanner *sc)
+{
+    KDint c;
+    while((c = __kdScanPeek(sc)) != -1 && kdIsspaceVEN(c))
+    {
+        sc->cur++;
+    }
+}
+
+/* __kdScanStoreInt: Store value truncated to the size of the argument. */
+static void __kdScanStoreInt(void *arg, KDint size, KDuint64 value)
+{
+    switch(size)
+    {
+        case __KD_SCAN_SIZE_CHAR:
+            *(KDint8 *)arg = (KDint8)value;
+            break;
+        case __KD_SCAN_SIZE_SHORT:
+            *(KDint16 *)arg = (KDint16)value;
+            break;
+        case __KD_SCAN_SIZE_LONG:
+            *(long *)arg = (long)value;
+            break;
+        case __KD_SCAN_SIZE_LONGLONG:
+            *(KDint64 *)arg = (KDint64)value;
+            break;
+        case __KD_SCAN_SIZE_SIZE:
+            *(KDssize *)arg = (KDssize)value;
+            break;
+        default:
+            *(KDint *)arg = (KDint)value;
+            break;
+    }
+}
+
+/* __kdScanNumber: Convert a numeric field, returns 0 on success and -1 on a matching failure. */
+static KDint __kdScanNumber(__KDScanner *sc, const __KDScanfOp *op, void *arg)
+{
+    KDchar field[__KD_SCAN_LOOKAHEAD];
+    KDchar *end = KD_NULL;
+    __kdScanFill(sc, __KD_SCAN_LOOKAHEAD);
+    const KDchar *start = sc->cur;
+    if(op->width > 0)
+    {
+        /* Terminate the field in a copy. */
+        KDsize n = 0;
+        KDsize width = ((KDsize)op->width < sizeof(field)) ? (KDsize)op->width : sizeof(field) - 1;
+        while(n < width && start[n])
+        {
+            field[n] = start[n];
+            n++;
+        }
+        field[n] = '\0';
+        start = field;
+    }
+
+    switch(op->conv)
+    {
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+        {
+            if(op->size == __KD_SCAN_SIZE_LONG || op->size == __KD_SCAN_SIZE_LONGLONG)
+            {
+                KDfloat64KHR value = kdStrtodKHR(start, &end);
+                if(end != start && op->assign)
+                {
+                    *(KDfloat64KHR *)arg = value;
+                }
+            }
+            else
+            {
+                KDfloat32 value = kdStrtof(start, &end);
+                if(end != start && op->assign)
+                {
+                    *(KDfloat32 *)arg = value;
+                }
+            }
+            break;
+        }
+        default:
+        {
+            KDint base = 10;
+            KDboolean issigned = (op->conv == 'd' || op->conv == 'i');
+            if(op->conv == 'i')
+            {
+                base = 0;
+            }
+            else if(op->conv == 'o')
+            {
+                base = 8;
+            }
+            else if(op->conv == 'x' || op->conv == 'X' || op->conv == 'p')
+            {
+                base = 16;
+            }
+            else if(op->conv == 'b')
+            {
+                base = 2;
+            }
+            KDboolean negative = 0;
+            KDuint64 value = __kdStrtoint(start, &end, base, issigned ? (KDuint64)KDINT64_MAX : KDUINT64_MAX,
+                issigned ? (KDuint64)KDINT64_MAX + 1 : KDUINT64_MAX, &negative);
+            value = negative ? 0 - value : value;
+            if(end != start && op->assign)
+            {
+                if(op->conv == 'p')
+                {
+                    *(void **)arg = (void *)(KDuintptr)value;
+                }
+                else
+                {
+                    __kdScanStoreInt(arg, op->size, value);
+                }
+            }
+            break;
+        }
+    }
+    KDsize consumed = (KDsize)(end - start);
+    if(consumed == 0)
+    {
+        return -1;
+    }
+    sc->cur += consumed;
+    return 0;
+}
+
+/* __kdScanOp: Run one operation, returns 1 for assignments, 0, -1 on matching and -2 on input failures. */
+static KDint __kdScanOp(__KDScanner *sc, const __KDScanfOp *op, void *arg)
+{
+    KDint c = 0;
+    if(op->kind == __KD_SCAN_SPACE)
+    {
+        __kdScanSkipSpace(sc);
+        return 0;
+    }
+    if(op->kind == __KD_SCAN_LITERAL)
+    {
+        for(KDint i = 0; i < op->length; i++)
+        {
+            c = __kdScanPeek(sc);
+            if(c == -1)
+            {
+                return -2;
+            }
+            if(c != (KDuint8)op->text[i])
+            {
+                return -1;
+            }
+            sc->cur++;
+        }
+        return 0;
+    }
+
+    switch(op->conv)
+    {
+        case '%':
+            __kdScanSkipSpace(sc);
+            c = __kdScanPeek(sc);
+            if(c != '%')
+            {
+                return (c == -1) ? -2 : -1;
+            }
+            sc->cur++;
+            return 0;
+        case 'n':
+            if(op->assign)
+            {
+                KDsize consumed = sc->base + (KDsize)(sc->cur - sc->buffer);
+                __kdScanStoreInt(arg, op->size, consumed);
+            }
+            return 0;
+        case 'c':
+        {
+            KDchar *out = (KDchar *)arg;
+            KDint width = op->width ? op->width : 1;
+            for(KDint i = 0; i < width; i++)
+            {
+                c = __kdScanPeek(sc);
+                if(c == -1)
+                {
+                    if(i == 0)
+                    {
+                        return -2;
+                    }
+                    break;
+                }
+                if(op->assign)
+                {
+                    *out++ = (KDchar)c;
+                }
+                sc->cur++;
+            }
+            return op->assign;
+        }
+        case 's':
+        case '[':
+        {
+            KDchar *out = (KDchar *)arg;
+            KDint count = 0;
+            if(op->conv == 's')
+            {
+                __kdScanSkipSpace(sc);
+            }
+            while((op->width == 0 || count < op->width) && (c = __kdScanPeek(sc)) != -1)
+            {
+                KDboolean match = (op->conv == 's') ? !kdIsspaceVEN(c) : (op->set[c >> 3] >> (c & 7)) & 1;
+                if(!match)
+                {
+                    break;
+                }
+                if(op->assign)
+                {
+                    *out++ = (KDchar)c;
+                }
+                sc->cur++;
+                count++;
+            }
+            if(count == 0)
+            {
+                return (__kdScanPeek(sc) == -1) ? -2 : -1;
+            }
+            if(op->assign)
+            {
+                *out = '\0';
+            }
+            return op->assign;
+        }
+        default:
+            __kdScanSkipSpace(sc);
+            if(__kdScanPeek(sc) == -1)
+            {
+                return -2;
+            }
+            if(__kdScanNumber(sc, op, arg) == -1)
+            {
+                return -1;
+            }
+            return op->assign;
+    }
+}
+
+/* __kdScan: Run a plan, or the format directly if plan is KD_NULL. */
+static KDint __kdScan(__KDScanner *sc, const KDScanfPlanVEN *plan, const KDchar *format, KDVaListKHR ap)
+{
+    KDint count = 0;
+    KDboolean converted = 0;
+    __KDScanfOp local;
+    for(KDint i = 0;; i++)
+    {
+        const __KDScanfOp *op = &local;
+        if(plan)
+        {
+            if(i == plan->count)
+            {
+                break;
+            }
+            op = &plan->ops[i];
+        }
+        else
+        {
+            KDint result = __kdScanfParse(&format, &local);
+            if(result == -1)
+            {
+                kdSetError(KD_EINVAL);
+                break;
+            }
+            if(result == 0)
+            {
+                break;
+            }
+        }
+        void *arg = KD_NULL;
+        if(op->kind == __KD_SCAN_CONV && op->conv != '%' && (op->assign || op->conv == 'n'))
+        {
+            arg = KD_VA_ARG_PTR_KHR(ap);
+        }
+        KDint result = __kdScanOp(sc, op, arg);
+        if(result < 0)
+        {
+            if(result == -2 && !converted)
+            {
+                return KD_EOF;
+            }
+            break;
+        }
+        if(op->kind == __KD_SCAN_CONV && op->conv != 'n')
+        {
+            converted = 1;
+        }
+        count += result;
+    }
+    return count;
+}
+
+/* kdSscanfKHR, kdVsscanfKHR: Read formatted input from a buffer. */
+KD_API KDint KD_APIENTRY kdSscanfKHR(const KDchar *str, const KDchar *format, ...)
+{
+    KDint result = 0;
+    KDVaListKHR ap;
+    KD_VA_START_KHR(ap, format);
+    result = kdVsscanfKHR(str, format, ap);
+    KD_VA_END_KHR(ap);
+    return result;
+}
+
+KD_API KDint KD_APIENTRY kdVsscanfKHR(const KDchar *str, const KDchar *format, KDVaListKHR ap)
+{
+    __KDScanner sc = {str, KD_NULL, KD_NULL, KD_NULL, 0, 0, {0}};
+    kdMemcpy(&sc.buffer, &str, sizeof(KDchar *));
+    return __kdScan(&sc, KD_NULL, format, ap);
+}
+
+/* kdSscanfPlanVEN, kdVsscanfPlanVEN: Read formatted input from a buffer using a compiled plan. */
+KD_API KDint KD_APIENTRY kdSscanfPlanVEN(const KDchar *str, const KDScanfPlanVEN *plan, ...)
+{
+    KDint result = 0;
+    KDVaListKHR ap;
+    KD_VA_START_KHR(ap, plan);
+    result = kdVsscanfPlanVEN(str, plan, ap);
+    KD_VA_END_KHR(ap);
+    return result;
+}
+
+KD_API KDint KD_APIENTRY kdVsscanfPlanVEN(const KDchar *str, const KDScanfPlanVEN *plan, KDVaListKHR ap)
+{
+    __KDScanner sc = {str, KD_NULL, KD_NULL, KD_NULL, 0, 0, {0}};
+    kdMemcpy(&sc.buffer, &str, sizeof(KDchar *));
+    return __kdScan(&sc, plan, KD_NULL, ap);
+}
+
+/* kdFscanfKHR, kdVfscanfKHR: Read formatted input from a file. */
+KD_API KDint KD_APIENTRY kdFscanfKHR(KDFile *file, const KDchar *format, ...)
+{
+    KDint result = 0;
+    KDVaListKHR ap;
+    KD_VA_START_KHR(ap, format);
+    result = kdVfscanfKHR(file, format, ap);
+    KD_VA_END_KHR(ap);
+    return result;
+}
+
+KD_API KDint KD_APIENTRY kdVfscanfKHR(KDFile *file, const KDchar *format, KDVaListKHR ap)
+{
+    KDchar buffer[__KD_SCAN_WINDOW];
+    buffer[0] = '\0';
+    __KDScanner sc = {buffer, buffer, file, buffer, 0, 0, {0}};
+    KDint result = __kdScan(&sc, KD_NULL, format, ap);
+    /* Give back what was read ahead. */
+    if(sc.end != sc.cur)
+    {
+        kdFseek(file, -(KDoff)(sc.end - sc.cur), KD_SEEK_CUR);
+    }
+    return result;
 }
@@ -0,0 +1,465 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+/******************************************************************************
+ * KD includes
+ ******************************************************************************/
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wpadded"
+#if __has_warning("-Wreserved-id-macro")
+#pragma clang diagnostic ignored "-Wreserved-id-macro"
+#endif
+#endif
+#include "kdplatform.h"  // for KD_API, KD_APIENTRY
+#include <KD/kd.h>       // for kdSetError, kdFree, kdMalloc
+#include <KD/kdext.h>    // IWYU pragma: keep
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "kd_internal.h"  // for KDThread
+
+/******************************************************************************
+ * OpenKODE Core extension: KD_VEN_future
+ *
+ * Notes:
+ * - The first continuations live inside the future, further ones in an
+ *   array growing by doubling.
+ * - Continuations for another thread are pushed on an intrusive list of
+ *   that thread and run by its next kdPumpEvents, without allocating an
+ *   event.
+ * - Every registered continuation holds a reference, so a future can be
+ *   freed right after kdFutureThenVEN.
+ ******************************************************************************/
+
+#define __KD_FUTURE_INLINE 2
+
+typedef struct _KDFutureContinuation _KDFutureContinuation;
+struct _KDFutureContinuation {
+    _KDFutureContinuation *next;
+    KDFutureVEN *future;
+    KDFutureFuncVEN *func;
+    void *arg;
+    KDThread *thread;
+    KDboolean allocated;
+#if KDSIZE_MAX == KDUINT64_MAX
+    KDint8 padding[7];
+#else
+    KDint8 padding[3];
+#endif
+};
+
+struct KDFutureVEN {
+    _KDFutureContinuation inlined[__KD_FUTURE_INLINE];
+    _KDFutureContinuation *overflow;
+    KDThreadMutex *mutex;
+    KDThreadCond *cond;
+    void *value;
+    KDsize count;
+    KDsize capacity;
+    KDsize pending;
+    KDint refs;
+    KDint error;
+    KDboolean ready;
+#if KDSIZE_MAX == KDUINT64_MAX
+    KDint8 padding[7];
+#else
+    KDint8 padding[3];
+#endif
+};
+
+static void __kdFutureRelease(KDFutureVEN *future)
+{
+    kdThreadMutexLock(future->mutex);
+    KDint refs = --future->refs;
+    kdThreadMutexUnlock(future->mutex);
+    if(refs == 0)
+    {
+        kdFree(future->overflow);
+        kdThreadCondFree(future->cond);
+        kdThreadMutexFree(future->mutex);
+        kdFree(future);
+    }
+}
+
+static void __kdFutureSchedule(_KDFutureContinuation *continuation)
+{
+    if(continuation->thread == KD_NULL)
+    {
+        KDFutureVEN *future = continuation->future;
+        continuation->func(future, continuation->arg);
+        if(continuation->allocated)
+        {
+            kdFree(continuation);
+        }
+        __kdFutureRelease(future);
+        return;
+    }
+    KDAtomicPtrVEN *list = continuation->thread->continuations;
+    for(;;)
+    {
+        void *head = kdAtomicPtrLoadVEN(list);
+        continuation->next = (_KDFutureContinuation *)head;
+        if(kdAtomicPtrCompareExchangeVEN(list, head, continuation))
+        {
+            break;
+        }
+    }
+    __kdReactorWake(continuation->thread->reactor);
+}
+
+/* Called by kdPumpEvents, or with run KD_FALSE to drop them when a thread is freed. */
+void __kdFutureRunContinuations(KDThread *thread, KDboolean run)
+{
+    void *head = kdAtomicPtrLoadVEN(thread->continuations);
+    if(head == KD_NULL)
+    {
+        return;
+    }
+    while(!kdAtomicPtrCompareExchangeVEN(thread->continuations, head, KD_NULL))
+    {
+        head = kdAtomicPtrLoadVEN(thread->continuations);
+    }
+
+    /* The list is last in, first out. */
+    _KDFutureContinuation *continuation = KD_NULL;
+    _KDFutureContinuation *next = (_KDFutureContinuation *)head;
+    while(next)
+    {
+        _KDFutureContinuation *current = next;
+        next = current->next;
+        current->next = continuation;
+        continuation = current;
+    }
+
+    while(continuation)
+    {
+        next = continuation->next;
+        KDFutureVEN *future = continuation->future;
+        if(run)
+        {
+            continuation->func(future, continuation->arg);
+        }
+        if(continuation->allocated)
+        {
+            kdFree(continuation);
+        }
+        __kdFutureRelease(future);
+        continuation = next;
+    }
+}
+
+static KDboolean __kdFutureComplete(KDFutureVEN *future, void *value, KDint error)
+{
+    kdThreadMutexLock(future->mutex);
+    if(future->ready)
+    {
+        kdThreadMutexUnlock(future->mutex);
+        return KD_FALSE;
+    }
+    future->ready = KD_TRUE;
+    future->value = value;
+    future->error = error;
+    /* Continuations added from now on are scheduled directly, the slots stay put. */
+    KDsize count = future->count;
+    future->refs++;
+    kdThreadCondBroadcast(future->cond);
+    kdThreadMutexUnlock(future->mutex);
+
+    for(KDsize i = 0; i < count; i++)
+    {
+        __kdFutureSchedule(i < __KD_FUTURE_INLINE ? &future->inlined[i] : &future->overflow[i - __KD_FUTURE_INLINE]);
+    }
+    __kdFutureRelease(future);
+    return KD_TRUE;
+}
+
+/* kdFutureCreateVEN: Create a pending future, completed by kdFutureSetValueVEN or kdFutureSetErrorVEN. */
+KD_API KDFutureVEN *KD_APIENTRY kdFutureCreateVEN(void)
+{
+    KDFutureVEN *future = (KDFutureVEN *)kdMalloc(sizeof(KDFutureVEN));
+    if(future == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    kdMemset(future, 0, sizeof(KDFutureVEN));
+    future->refs = 1;
+    future->mutex = kdThreadMutexCreate(KD_NULL);
+    future->cond = kdThreadCondCreate(KD_NULL);
+    if(future->mutex == KD_NULL || future->cond == KD_NULL)
+    {
+        if(future->cond)
+        {
+            kdThreadCondFree(future->cond);
+        }
+        if(future->mutex)
+        {
+            kdThreadMutexFree(future->mutex);
+        }
+        /* Keeps the error of the primitive, KD_ENOSYS without threads. */
+        kdFree(future);
+        return KD_NULL;
+    }
+    return future;
+}
+
+/* kdFutureFreeVEN: Release a future, scheduled continuations keep it alive until they ran. */
+KD_API KDint KD_APIENTRY kdFutureFreeVEN(KDFutureVEN *future)
+{
+    __kdFutureRelease(future);
+    return 0;
+}
+
+/* kdFutureSetValueVEN: Complete a future with a value and schedule its continuations. */
+KD_API KDint KD_APIENTRY kdFutureSetValueVEN(KDFutureVEN *future, void *value)
+{
+    if(!__kdFutureComplete(future, value, 0))
+    {
+        kdSetError(KD_EBUSY);
+        return -1;
+    }
+    return 0;
+}
+
+/* kdFutureSetErrorVEN: Complete a future with a KD error code and schedule its continuations. */
+KD_API KDint KD_APIENTRY kdFutureSetErrorVEN(KDFutureVEN *future, KDint error)
+{
+    if(error == 0)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    if(!__kdFutureComplete(future, KD_NULL, error))
+    {
+        kdSetError(KD_EBUSY);
+        return -1;
+    }
+    return 0;
+}
+
+/* kdFutureIsReadyVEN: Check if a future is complete. */
+KD_API KDboolean KD_APIENTRY kdFutureIsReadyVEN(KDFutureVEN *future)
+{
+    kdThreadMutexLock(future->mutex);
+    KDboolean ready = future->ready;
+    kdThreadMutexUnlock(future->mutex);
+    return ready;
+}
+
+/* kdFutureWaitVEN: Block until a future is complete or timeout nanoseconds passed, -1 waits forever. */
+KD_API KDint KD_APIENTRY kdFutureWaitVEN(KDFutureVEN *future, KDust timeout)
+{
+    /* Saturated, huge timeouts must not wrap into the past */
+    KDust now = kdGetTimeUST();
+    KDust deadline = (timeout > KDINT64_MAX - now) ? KDINT64_MAX : now + timeout;
+    kdThreadMutexLock(future->mutex);
+    while(!future->ready)
+    {
+        if(timeout == (KDust)-1)
+        {
+            kdThreadCondWait(future->cond, future->mutex);
+        }
+        else if(kdThreadCondTimedWaitVEN(future->cond, future->mutex, deadline) == -1)
+        {
+            break;
+        }
+    }
+    KDboolean ready = future->ready;
+    kdThreadMutexUnlock(future->mutex);
+    if(!ready)
+    {
+        kdSetError(KD_ETIMEDOUT);
+        return -1;
+    }
+    return 0;
+}
+
+/* kdFutureGetVEN: Value of a complete future, KD_NULL and the error is set if it failed or is pending. */
+KD_API void *KD_APIENTRY kdFutureGetVEN(KDFutureVEN *future)
+{
+    kdThreadMutexLock(future->mutex);
+    KDboolean ready = future->ready;
+    KDint error = future->error;
+    void *value = future->value;
+    kdThreadMutexUnlock(future->mutex);
+    if(!ready)
+    {
+        kdSetError(KD_EAGAIN);
+        return KD_NULL;
+    }
+    if(error)
+    {
+        kdSetError(error);
+        return KD_NULL;
+    }
+    return value;
+}
+
+/* kdFutureGetErrorVEN: Error a future completed with, 0 on success or while pending. */
+KD_API KDint KD_APIENTRY kdFutureGetErrorVEN(KDFutureVEN *future)
+{
+    kdThreadMutexLock(future->mutex);
+    KDint error = future->ready ? future->error : 0;
+    kdThreadMutexUnlock(future->mutex);
+    return error;
+}
+
+/* kdFutureThenVEN: Call func once a future is complete. */
+KD_API KDint KD_APIENTRY kdFutureThenVEN(KDFutureVEN *future, KDThread *thread, KDFutureFuncVEN *func, void *arg)
+{
+    kdThreadMutexLock(future->mutex);
+    if(future->ready)
+    {
+        future->refs++;
+        kdThreadMutexUnlock(future->mutex);
+        if(thread == KD_NULL)
+        {
+            func(future, arg);
+            __kdFutureRelease(future);
+            return 0;
+        }
+        /* The slots may be queued already, so late continuations for a thread get their own. */
+        _KDFutureContinuation *continuation = (_KDFutureContinuation *)kdMalloc(sizeof(_KDFutureContinuation));
+        if(continuation == KD_NULL)
+        {
+            __kdFutureRelease(future);
+            kdSetError(KD_ENOMEM);
+            return -1;
+        }
+        continuation->future = future;
+        continuation->func = func;
+        continuation->arg = arg;
+        continuation->thread = thread;
+        continuation->allocated = KD_TRUE;
+        __kdFutureSchedule(continuation);
+        return 0;
+    }
+
+    if(future->count >= __KD_FUTURE_INLINE + future->capacity)
+    {
+        KDsize capacity = future->capacity ? future->capacity * 2 : 4;
+        _KDFutureContinuation *overflow = (_KDFutureContinuation *)kdRealloc(future->overflow, capacity * sizeof(_KDFutureContinuation));
+        if(overflow == KD_NULL)
+        {
+            kdThreadMutexUnlock(future->mutex);
+            kdSetError(KD_ENOMEM);
+            return -1;
+        }
+        future->overflow = overflow;
+        future->capacity = capacity;
+    }
+    _KDFutureContinuation *continuation = future->count < __KD_FUTURE_INLINE ? &future->inlined[future->count] : &future->overflow[future->count - __KD_FUTURE_INLINE];
+    continuation->next = KD_NULL;
+    continuation->future = future;
+    continuation->func = func;
+    continuation->arg = arg;
+    continuation->thread = thread;
+    continuation->allocated = KD_FALSE;
+    future->count++;
+    future->refs++;
+    kdThreadMutexUnlock(future->mutex);
+    return 0;
+}
+
+static void __kdFutureAllDone(KDFutureVEN *all, KDint error)
+{
+    kdThreadMutexLock(all->mutex);
+    /* The first error is kept in the error field until completion. */
+    if(error && all->error == 0)
+    {
+        all->error = error;
+    }
+    KDboolean done = (--all->pending == 0);
+    error = all->error;
+    kdThreadMutexUnlock(all->mutex);
+    if(done)
+    {
+        __kdFutureComplete(all, KD_NULL, error);
+    }
+    __kdFutureRelease(all);
+}
+
+static void KD_APIENTRY __kdFutureAllStep(KDFutureVEN *future, void *arg)
+{
+    __kdFutureAllDone((KDFutureVEN *)arg, kdFutureGetErrorVEN(future));
+}
+
+static void KD_APIENTRY __kdFutureAnyStep(KDFutureVEN *future, void *arg)
+{
+    KDFutureVEN *any = (KDFutureVEN *)arg;
+    __kdFutureComplete(any, future, 0);
+    __kdFutureRelease(any);
+}
+
+/* kdFutureWhenAllVEN: Future completing after all futures, with the first error if any of them failed. */
+KD_API KDFutureVEN *KD_APIENTRY kdFutureWhenAllVEN(KDFutureVEN *const *futures, KDsize count)
+{
+    KDFutureVEN *all = kdFutureCreateVEN();
+    if(all == KD_NULL)
+    {
+        return KD_NULL;
+    }
+    /* One reference per input and one to keep it alive while registering. */
+    all->pending = count + 1;
+    all->refs += (KDint)count + 1;
+    for(KDsize i = 0; i < count; i++)
+    {
+        if(kdFutureThenVEN(futures[i], KD_NULL, __kdFutureAllStep, all) == -1)
+        {
+            __kdFutureAllDone(all, KD_ENOMEM);
+        }
+    }
+    __kdFutureAllDone(all, 0);
+    return all;
+}
+
+/* kdFutureWhenAnyVEN: Future completing with the first of futures to complete as its value. */
+KD_API KDFutureVEN *KD_APIENTRY kdFutureWhenAnyVEN(KDFutureVEN *const *futures, KDsize count)
+{
+    if(count == 0)
+    {
+        kdSetError(KD_EINVAL);
+        return KD_NULL;
+    }
+    KDFutureVEN *any = kdFutureCreateVEN();
+    if(any == KD_NULL)
+    {
+        return KD_NULL;
+    }
+    any->refs += (KDint)count;
+    for(KDsize i = 0; i < count; i++)
+    {
+        if(kdFutureThenVEN(futures[i], KD_NULL, __kdFutureAnyStep, any) == -1)
+        {
+            __kdFutureComplete(any, KD_NULL, KD_ENOMEM);
+            __kdFutureRelease(any);
+        }
+    }
+    return any;
+}
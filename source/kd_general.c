@@ -200,11 +200,32 @@ KD_API void KD_APIENTRY kdSetErrorPlatformVEN(KDint error, KDint allowed)
             kderror = KD_EACCES;
             break;
         }
+        case(EADDRINUSE):
+        {
+            kderror = KD_EADDRINUSE;
+            break;
+        }
+        case(EADDRNOTAVAIL):
+        {
+            kderror = KD_EADDRNOTAVAIL;
+            break;
+        }
+        case(EAFNOSUPPORT):
+        {
+            kderror = KD_EAFNOSUPPORT;
+            break;
+        }
         case(EAGAIN):
         {
             kderror = KD_ETRY_AGAIN;
             break;
         }
+        case(EALREADY):
+        case(EINPROGRESS):
+        {
+            kderror = KD_EALREADY;
+            break;
+        }
         case(EBADF):
         {
             kderror = KD_EBADF;
@@ -215,6 +236,22 @@ KD_API void KD_APIENTRY kdSetErrorPlatformVEN(KDint error, KDint allowed)
             kderror = KD_EBUSY;
             break;
         }
+        case(ECONNREFUSED):
+        {
+            kderror = KD_ECONNREFUSED;
+            break;
+        }
+        case(ECONNRESET):
+        case(EPIPE):
+        {
+            kderror = KD_ECONNRESET;
+            break;
+        }
+        case(EDESTADDRREQ):
+        {
+            kderror = KD_EDESTADDRREQ;
+            break;
+        }
         case(EEXIST):
         case(ENOTEMPTY):
         {
@@ -226,6 +263,12 @@ KD_API void KD_APIENTRY kdSetErrorPlatformVEN(KDint error, KDint allowed)
             kderror = KD_EFBIG;
             break;
         }
+        case(EHOSTUNREACH):
+        case(ENETUNREACH):
+        {
+            kderror = KD_EHOSTUNREACH;
+            break;
+        }
         case(EINVAL):
         {
             kderror = KD_EINVAL;
@@ -236,6 +279,11 @@ KD_API void KD_APIENTRY kdSetErrorPlatformVEN(KDint error, KDint allowed)
             kderror = KD_EIO;
             break;
         }
+        case(EISCONN):
+        {
+            kderror = KD_EISCONN;
+            break;
+        }
         case(EMFILE):
         case(ENFILE):
         {
@@ -263,11 +311,26 @@ KD_API void KD_APIENTRY kdSetErrorPlatformVEN(KDint error, KDint allowed)
             kderror = KD_ENOSPC;
             break;
         }
+        case(ENOTCONN):
+        {
+            kderror = KD_ENOTCONN;
+            break;
+        }
+        case(EOPNOTSUPP):
+        {
+            kderror = KD_EOPNOTSUPP;
+            break;
+        }
         case(EOVERFLOW):
         {
             kderror = KD_EOVERFLOW;
             break;
         }
+        case(ETIMEDOUT):
+        {
+            kderror = KD_ETIMEDOUT;
+            break;
+        }
         default:
         {
             /* TODO: Handle other errorcodes */
@@ -406,6 +469,7 @@ KD_API const KDchar *KD_APIENTRY kdGetLocale(void)
 KD_API void KD_APIENTRY kdHandleAssertion(const KDchar *condition, const KDchar *filename, KDint linenumber)
 {
     kdLogMessagefKHR("---Assertion---\nCondition: %s\nFile: %s(%i)\n", condition, filename, linenumber);
+    kdLogFlushVEN();
 
 #if defined(__GNUC__) || defined(__clang__)
     __builtin_trap();
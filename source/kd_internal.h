@@ -36,14 +36,37 @@ struct KDFile {
 typedef struct _KDQueue _KDQueue;
 typedef struct _KDCallback _KDCallback;
 typedef struct _KDThreadInternal _KDThreadInternal;
+typedef struct _KDLogRing _KDLogRing;
+typedef struct _KDFiberScheduler _KDFiberScheduler;
+typedef struct _KDReactor _KDReactor;
+typedef struct _KDEventSchedule _KDEventSchedule;
+/* Event queue lanes, see KD_EVENT_PRIORITY_SYSTEM_VEN and following. */
+#define __KD_EVENT_LANES 4
+/* Events each lane holds */
+#define __KD_EVENT_QUEUE_SIZE 64
 struct KDThread {
     _KDThreadInternal *internal;
-    _KDQueue *eventqueue;
+    _KDQueue *eventqueue[__KD_EVENT_LANES];
+    /* Pulls that passed over a waiting lane since it was last served */
+    KDuint starved[__KD_EVENT_LANES];
     KDEvent *lastevent;
     KDint lasterror;
     KDint callbackindex;
     _KDCallback **callbacks;
     void *tlsptr;
+    _KDLogRing *logring;
+    _KDFiberScheduler *fibers;
+    struct KDAtomicPtrVEN *continuations;
+    /* Event held back by kdSetEventCoalescingVEN, merged counts per type */
+    KDEvent *coalesced;
+    KDuint64 coalescedcount[2];
+    KDuint coalescetypes;
+    KDint coalescedlane;
+    _KDReactor *reactor;
+    /* Events waiting for their kdPostThreadEventAtVEN deadline */
+    _KDEventSchedule *schedule;
+    /* Open while kdEventTraceStartVEN records this thread */
+    KDFile *tracefile;
 };
 
 typedef struct _KDImageATX _KDImageATX;
@@ -63,24 +86,80 @@ void __kdThreadInitOnce(void);
 void __kdThreadFree(KDThread *thread);
 
 void __kdCleanupThreadStorageKHR(void);
+void __kdThreadStorageExit(void);
+
+void __kdJobSystemShutdown(void);
+
+void __kdFiberSchedulerFree(_KDFiberScheduler *scheduler);
+KDboolean __kdFiberDispatchEvent(KDEvent *event);
+
+void __kdFutureRunContinuations(KDThread *thread, KDboolean run);
+
+_KDEventSchedule *__kdEventScheduleCreate(void);
+void __kdEventScheduleFree(_KDEventSchedule *schedule);
+KDust __kdEventScheduleNext(KDThread *thread);
+void __kdEventDropSocket(KDThread *thread, const KDSocket *socket);
+#if defined(KD_WINDOW_NULL)
+KDust __kdWindowNullNext(KDThread *thread);
+#endif
+
+void __kdEventTraceRecord(KDThread *thread, const KDEvent *event);
+
+void __kdLogInit(void);
+void __kdLogShutdown(void);
+void __kdLogRingRelease(_KDLogRing *ring);
+
+/* Per-thread wait on file descriptors, kdWaitEvent blocks in it. */
+#if defined(__linux__) && !defined(__ANDROID__) && !defined(KD_FREESTANDING)
+#define KD_REACTOR_EPOLL
+#endif
+#define __KD_REACTOR_IN 1
+#define __KD_REACTOR_OUT 2
+#define __KD_REACTOR_ERR 4
+typedef void(_KDReactorFunc)(void *arg, KDuint events);
+_KDReactor *__kdReactorCreate(void);
+void __kdReactorFree(_KDReactor *reactor);
+KDint __kdReactorWatch(_KDReactor *reactor, KDint fd, KDuint events, _KDReactorFunc *func, void *arg);
+void __kdReactorUnwatch(_KDReactor *reactor, KDint fd);
+void __kdReactorWait(KDThread *thread, KDust timeout);
+void __kdReactorWake(_KDReactor *reactor);
 
 _KDQueue* __kdQueueCreate(KDsize size);
 KDint __kdQueueFree(_KDQueue* queue);
 KDsize __kdQueueSize(_KDQueue *queue);
 KDint __kdQueuePush(_KDQueue *queue, void *value);
 void* __kdQueuePull(_KDQueue *queue);
+void __kdQueueVisit(_KDQueue *queue, void (*func)(void *value, void *arg), void *arg);
+
+KDuint64 __kdStrtoint(const KDchar *nptr, KDchar **endptr, KDint base, KDuint64 poslimit, KDuint64 neglimit, KDboolean *negative);
 
 #if !defined(_WIN32)
 KDssize __kdWrite(KDint fd, const void *buf, KDsize count);
 KDssize __kdRead(KDint fd, void *buf, KDsize count);
 KDint __kdOpen(const KDchar *pathname, KDint flags, KDuint mode);
 #endif
+#if defined(__linux__)
+KDint __kdFutex(KDuint32 *addr, KDint op, KDuint32 val, const void *timeout);
+#endif
 
 extern KDThreadOnce __kd_threadinit_once;
 #ifndef KDThreadStorageKeyKHR
 typedef KDuint32 KDThreadStorageKeyKHR;
 #endif
 extern KDThreadStorageKeyKHR __kd_threadlocal;
+void __kdThreadSetSelf(KDThread *thread);
+
+/* Native thread-local storage, the KHR key table is the fallback. */
+#if defined(_MSC_VER)
+#define KD_THREAD_LOCAL __declspec(thread)
+#elif(defined(__GNUC__) || defined(__clang__)) && !defined(__TINYC__) && !defined(KD_FREESTANDING)
+#if defined(__ELF__) && !defined(__ANDROID__)
+/* Avoids __tls_get_addr in the shared library, uses static TLS space. */
+#define KD_THREAD_LOCAL _Thread_local __attribute__((tls_model("initial-exec")))
+#else
+#define KD_THREAD_LOCAL _Thread_local
+#endif
+#endif
 extern KDThreadMutex *__kd_tls_mutex;
 
 #if !defined(_WIN32) && !defined(__ANDROID__) && defined(KD_FREESTANDING)
@@ -177,3 +177,20 @@ void *__kdQueuePull(_KDQueue *queue)
     kdAtomicIntStoreVEN(cell->sequence, (KDint)(pos + queue->buffer_mask) + 1);
     return value;
 }
+
+/* Call func on every value in the queue without taking it. Only the single
+ * consumer may visit, cells that are still being pushed are skipped. */
+void __kdQueueVisit(_KDQueue *queue, void (*func)(void *value, void *arg), void *arg)
+{
+    KDuint head = (KDuint)kdAtomicIntLoadVEN(queue->head);
+    KDuint count = (KDuint)kdAtomicIntLoadVEN(queue->tail) - head;
+    for(KDuint i = 0; i < count; i++)
+    {
+        KDuint pos = head + i;
+        _kdQueueCell *cell = &queue->buffer[pos & queue->buffer_mask];
+        if((KDuint)kdAtomicIntLoadVEN(cell->sequence) == pos + 1)
+        {
+            func(cell->data, arg);
+        }
+    }
+}
@@ -0,0 +1,334 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+/******************************************************************************
+ * KD includes
+ ******************************************************************************/
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wpadded"
+#if __has_warning("-Wreserved-id-macro")
+#pragma clang diagnostic ignored "-Wreserved-id-macro"
+#endif
+#endif
+#if defined(__linux__)
+#define _GNU_SOURCE /* EPOLLRDHUP */
+#endif
+#include "kdplatform.h"  // for KD_NULL, KDint, KDust
+#include <KD/kd.h>       // for kdMalloc, kdFree, kdSetError
+#include <KD/kdext.h>    // for kdAtomicIntLoadVEN, kdThreadSleepVEN
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "kd_internal.h"  // for _KDReactor, KDThread
+
+/******************************************************************************
+ * C includes
+ ******************************************************************************/
+
+#if defined(KD_REACTOR_EPOLL)
+#include <errno.h>  // for errno, EINTR
+#endif
+
+/******************************************************************************
+ * Platform includes
+ ******************************************************************************/
+
+#if defined(KD_REACTOR_EPOLL)
+#include <sys/epoll.h>    // for epoll_create1, epoll_ctl, epoll_wait
+#include <sys/eventfd.h>  // for eventfd, EFD_NONBLOCK
+#include <unistd.h>       // for close, read, write
+#endif
+
+/******************************************************************************
+ * Reactor
+ *
+ * Notes:
+ * - Every thread owns one. kdWaitEvent blocks in it, sockets, timers and the
+ *   window connection register their file descriptors with it.
+ * - Posting to a waiting thread writes its eventfd. The owner publishes that
+ *   it is about to wait and then looks at its queues once more, posters push
+ *   first and then look at the flag, so one side always sees the other.
+ * - The epoll and eventfd descriptors are opened on first use, threads that
+ *   never wait or watch cost no file descriptors.
+ * - Handlers run on the owning thread inside kdWaitEvent and only post events,
+ *   they never call back into application code.
+ ******************************************************************************/
+
+#if defined(KD_REACTOR_EPOLL)
+typedef struct _KDReactorWatch _KDReactorWatch;
+struct _KDReactorWatch {
+    _KDReactorWatch *next;
+    _KDReactorFunc *func;
+    void *arg;
+    KDint fd;
+    KDint8 padding[4];
+};
+#endif
+
+struct _KDReactor {
+#if defined(KD_REACTOR_EPOLL)
+    KDAtomicIntVEN *waiting;
+    _KDReactorWatch *watches;
+    KDint epollfd;
+    KDint eventfd;
+    /* Readiness was dispatched by a blocking wait, the next poll is redundant */
+    KDboolean dispatched;
+    KDint8 padding[7];
+#else
+    KDint placebo;
+#endif
+};
+
+_KDReactor *__kdReactorCreate(void)
+{
+    _KDReactor *reactor = (_KDReactor *)kdMalloc(sizeof(_KDReactor));
+    if(reactor == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+#if defined(KD_REACTOR_EPOLL)
+    reactor->waiting = kdAtomicIntCreateVEN(0);
+    if(reactor->waiting == KD_NULL)
+    {
+        kdFree(reactor);
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    reactor->watches = KD_NULL;
+    reactor->epollfd = -1;
+    reactor->eventfd = -1;
+    reactor->dispatched = KD_FALSE;
+#endif
+    return reactor;
+}
+
+void __kdReactorFree(_KDReactor *reactor)
+{
+#if defined(KD_REACTOR_EPOLL)
+    while(reactor->watches)
+    {
+        _KDReactorWatch *watch = reactor->watches;
+        reactor->watches = watch->next;
+        kdFree(watch);
+    }
+    if(reactor->epollfd != -1)
+    {
+        close(reactor->eventfd);
+        close(reactor->epollfd);
+    }
+    kdAtomicIntFreeVEN(reactor->waiting);
+#endif
+    kdFree(reactor);
+}
+
+#if defined(KD_REACTOR_EPOLL)
+static KDint __kdReactorOpen(_KDReactor *reactor)
+{
+    if(reactor->epollfd != -1)
+    {
+        return 0;
+    }
+    reactor->epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if(reactor->epollfd == -1)
+    {
+        kdSetError(KD_EMFILE);
+        return -1;
+    }
+    reactor->eventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event event = {EPOLLIN, {KD_NULL}};
+    if(reactor->eventfd == -1 || epoll_ctl(reactor->epollfd, EPOLL_CTL_ADD, reactor->eventfd, &event) == -1)
+    {
+        if(reactor->eventfd != -1)
+        {
+            close(reactor->eventfd);
+        }
+        close(reactor->epollfd);
+        reactor->epollfd = -1;
+        reactor->eventfd = -1;
+        kdSetError(KD_EMFILE);
+        return -1;
+    }
+    return 0;
+}
+
+/* Anything the owner would miss by blocking now. */
+static KDboolean __kdReactorPending(KDThread *thread)
+{
+    for(KDint i = 0; i < __KD_EVENT_LANES; i++)
+    {
+        if(__kdQueueSize(thread->eventqueue[i]) > 0)
+        {
+            return KD_TRUE;
+        }
+    }
+    return kdAtomicPtrLoadVEN(thread->continuations) != KD_NULL;
+}
+#endif
+
+/* Watch a descriptor, edge-triggered. A null func only wakes the owner. */
+KDint __kdReactorWatch(_KDReactor *reactor, KDint fd, KDuint events, _KDReactorFunc *func, void *arg)
+{
+#if defined(KD_REACTOR_EPOLL)
+    if(__kdReactorOpen(reactor) == -1)
+    {
+        return -1;
+    }
+    _KDReactorWatch *watch = (_KDReactorWatch *)kdMalloc(sizeof(_KDReactorWatch));
+    if(watch == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return -1;
+    }
+    watch->func = func;
+    watch->arg = arg;
+    watch->fd = fd;
+
+    struct epoll_event event;
+    kdMemset(&event, 0, sizeof(event));
+    event.events = EPOLLET;
+    event.events |= (events & __KD_REACTOR_IN) ? (EPOLLIN | EPOLLRDHUP) : 0;
+    event.events |= (events & __KD_REACTOR_OUT) ? EPOLLOUT : 0;
+    event.data.ptr = watch;
+    if(epoll_ctl(reactor->epollfd, EPOLL_CTL_ADD, fd, &event) == -1)
+    {
+        kdFree(watch);
+        kdSetError(errno == ENOMEM ? KD_ENOMEM : KD_EINVAL);
+        return -1;
+    }
+    watch->next = reactor->watches;
+    reactor->watches = watch;
+    return 0;
+#else
+    kdSetError(KD_ENOSYS);
+    return -1;
+#endif
+}
+
+void __kdReactorUnwatch(KD_UNUSED _KDReactor *reactor, KD_UNUSED KDint fd)
+{
+#if defined(KD_REACTOR_EPOLL)
+    for(_KDReactorWatch **link = &reactor->watches; *link; link = &(*link)->next)
+    {
+        _KDReactorWatch *watch = *link;
+        if(watch->fd == fd)
+        {
+            epoll_ctl(reactor->epollfd, EPOLL_CTL_DEL, fd, KD_NULL);
+            *link = watch->next;
+            kdFree(watch);
+            return;
+        }
+    }
+#endif
+}
+
+/* Dispatch readiness, blocking up to timeout nanoseconds unless events are
+ * pending. A zero timeout polls and costs nothing without watches. */
+void __kdReactorWait(KD_UNUSED KDThread *thread, KDust timeout)
+{
+#if defined(KD_REACTOR_EPOLL)
+    _KDReactor *reactor = thread->reactor;
+    if(timeout == 0)
+    {
+        if(reactor->watches == KD_NULL || reactor->dispatched)
+        {
+            reactor->dispatched = KD_FALSE;
+            return;
+        }
+    }
+    else if(__kdReactorOpen(reactor) == -1)
+    {
+        kdThreadSleepVEN(timeout < 1000000 ? timeout : 1000000);
+        return;
+    }
+
+    KDint ms = 0;
+    if(timeout > 0)
+    {
+        kdAtomicIntStoreVEN(reactor->waiting, 1);
+        if(!__kdReactorPending(thread))
+        {
+            /* Scheduled after the flag is up, posting the earliest one wakes us */
+            KDust next = __kdEventScheduleNext(thread);
+#if defined(KD_WINDOW_NULL)
+            KDust input = __kdWindowNullNext(thread);
+            next = (input < next) ? input : next;
+#endif
+            if(next != KDINT64_MAX)
+            {
+                KDust now = kdGetTimeUST();
+                KDust until = (next > now) ? next - now : 0;
+                timeout = (until < timeout) ? until : timeout;
+            }
+            /* Rounded up, kdWaitEvent checks its deadline again anyway */
+            KDust rounded = timeout / 1000000 + (timeout % 1000000 != 0);
+            ms = rounded > 0x7FFFFFFF ? 0x7FFFFFFF : (KDint)rounded;
+        }
+    }
+    struct epoll_event events[16];
+    KDint count = epoll_wait(reactor->epollfd, events, 16, ms);
+    kdAtomicIntStoreVEN(reactor->waiting, 0);
+    for(KDint i = 0; i < count; i++)
+    {
+        _KDReactorWatch *watch = (_KDReactorWatch *)events[i].data.ptr;
+        if(watch == KD_NULL)
+        {
+            KDuint64 value = 0;
+            KD_UNUSED KDssize result = read(reactor->eventfd, &value, sizeof(value));
+        }
+        else if(watch->func)
+        {
+            KDuint flags = 0;
+            flags |= (events[i].events & (EPOLLIN | EPOLLRDHUP)) ? __KD_REACTOR_IN : 0;
+            flags |= (events[i].events & EPOLLOUT) ? __KD_REACTOR_OUT : 0;
+            flags |= (events[i].events & (EPOLLERR | EPOLLHUP)) ? __KD_REACTOR_ERR : 0;
+            watch->func(watch->arg, flags);
+        }
+    }
+    reactor->dispatched = timeout > 0;
+#else
+    /* Without a reactor, poll in slices of at most a millisecond */
+    if(timeout > 0)
+    {
+        kdThreadSleepVEN(timeout < 1000000 ? timeout : 1000000);
+    }
+#endif
+}
+
+/* Wake the owner if it is blocked, called after posting to its thread. */
+void __kdReactorWake(KD_UNUSED _KDReactor *reactor)
+{
+#if defined(KD_REACTOR_EPOLL)
+    if(kdAtomicIntLoadVEN(reactor->waiting))
+    {
+        KDuint64 value = 1;
+        KD_UNUSED KDssize result = write(reactor->eventfd, &value, sizeof(value));
+    }
+#endif
+}
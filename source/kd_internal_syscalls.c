@@ -35,6 +35,9 @@
 #pragma clang diagnostic ignored "-Wreserved-id-macro"
 #endif
 #endif
+#if defined(__linux__)
+#define _GNU_SOURCE /* syscall */
+#endif
 #include "kdplatform.h"  // for KDssize, KDsize
 #include <KD/kd.h>       // for KDint, KDchar, KDuint
 #if defined(__clang__)
@@ -64,6 +67,10 @@
 #endif
 #endif
 
+#if defined(__linux__) && !(defined(__GNUC__) && defined(__x86_64__))
+#include <sys/syscall.h>  // for SYS_futex
+#endif
+
 /******************************************************************************
  * Syscalls
  ******************************************************************************/
@@ -81,6 +88,18 @@ inline static long __kdSyscall3(KDint nr, long arga, long argb, long argc)
     return result;
 }
 
+inline static long __kdSyscall4(KDint nr, long arga, long argb, long argc, long argd)
+{
+    long result = 0;
+    register long r10 __asm__("r10") = argd;
+    __asm__ __volatile__(
+        "syscall"
+        : "=a"(result)
+        : "0"(nr), "D"(arga), "S"(argb), "d"(argc), "r"(r10)
+        : "cc", "rcx", "r11", "memory");
+    return result;
+}
+
 inline static long __kdSyscallRes(long result)
 {
     if(result >= -4095 && result <= -1)
@@ -124,4 +143,16 @@ KDint __kdOpen(const KDchar *pathname, KDint flags, KDuint mode)
     return open(pathname, flags, mode);
 #endif
 }
+
+#if defined(__linux__)
+KDint __kdFutex(KDuint32 *addr, KDint op, KDuint32 val, const void *timeout)
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+    long result = __kdSyscall4(SYS_futex, (long)addr, (long)op, (long)val, (long)timeout);
+    return (KDint)__kdSyscallRes(result);
+#else
+    return (KDint)syscall(SYS_futex, addr, op, val, timeout);
+#endif
+}
+#endif
 #endif
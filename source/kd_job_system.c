@@ -0,0 +1,948 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+/******************************************************************************
+ * KD includes
+ ******************************************************************************/
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wpadded"
+#if __has_warning("-Wreserved-id-macro")
+#pragma clang diagnostic ignored "-Wreserved-id-macro"
+#endif
+#endif
+#include "kdplatform.h"             // for KD_API, KD_APIENTRY, KDuint
+#include <KD/kd.h>                  // for kdSetError, kdFree, kdMalloc
+#include <KD/KHR_thread_storage.h>  // for kdGetThreadStorageKHR, kdMap...
+#include <KD/kdext.h>               // IWYU pragma: keep
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+#include "kd_internal.h"  // for __kdJobSystemShutdown
+
+/******************************************************************************
+ * Platform includes
+ ******************************************************************************/
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>  // for sysconf
+#endif
+
+/******************************************************************************
+ * OpenKODE Core extension: KD_VEN_job_system
+ *
+ * Notes:
+ * - Every worker owns a Chase-Lev deque, it pushes and pops at the bottom
+ *   while idle workers steal from the top.
+ * - Jobs from other threads go to a shared deque, pushes are serialized by
+ *   a mutex and workers steal from it like from any other deque.
+ * - A full deque runs the job inline instead of blocking.
+ * - Jobs waiting for a dependency and completion events are parked on the
+ *   counter and released by the job that brings it to zero.
+ ******************************************************************************/
+
+#define __KD_JOB_DEQUE_SIZE 4096
+/* Failed searches before a thread goes to sleep */
+#define __KD_JOB_SPIN 64
+
+typedef struct _KDJob {
+    KDJobFuncVEN *func;
+    void *arg;
+    KDJobCounterVEN *counter;
+} _KDJob;
+
+typedef struct _KDJobDeque {
+    _KDJob *buffer;
+    KDAtomicIntVEN *top;
+    KDAtomicIntVEN *bottom;
+} _KDJobDeque;
+
+typedef struct _KDJobWorker {
+    KDJobSystemVEN *system;
+    KDThread *thread;
+    _KDJobDeque deque;
+    KDuint seed;
+    KDint8 padding[4];
+} _KDJobWorker;
+
+struct KDJobSystemVEN {
+    _KDJobWorker *workers;
+    KDThreadAttr *attr;
+    KDThreadMutex *sharedmutex;
+    KDThreadSem *wake;
+    KDAtomicIntVEN *sleeping;
+    KDAtomicIntVEN *running;
+    _KDJobDeque shared;
+    KDThreadStorageKeyKHR key;
+    KDint count;
+};
+
+/* Parked on a counter until it reaches zero */
+typedef struct _KDJobParked _KDJobParked;
+struct _KDJobParked {
+    _KDJobParked *next;
+    KDJobSystemVEN *system; /* Jobs only */
+    KDEvent *event;         /* Events only */
+    KDThread *thread;
+    _KDJob job;
+};
+
+struct KDJobCounterVEN {
+    KDAtomicIntVEN *value;
+    KDThreadMutex *mutex;
+    KDThreadCond *cond;
+    _KDJobParked *parked;
+};
+
+static KDint __kd_jobworker = 0;
+
+static KDint __kdJobDequeInit(_KDJobDeque *deque)
+{
+    deque->buffer = (_KDJob *)kdMalloc(sizeof(_KDJob) * __KD_JOB_DEQUE_SIZE);
+    deque->top = kdAtomicIntCreateVEN(0);
+    deque->bottom = kdAtomicIntCreateVEN(0);
+    if(deque->buffer == KD_NULL || deque->top == KD_NULL || deque->bottom == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return -1;
+    }
+    return 0;
+}
+
+static void __kdJobDequeFree(_KDJobDeque *deque)
+{
+    if(deque->bottom)
+    {
+        kdAtomicIntFreeVEN(deque->bottom);
+    }
+    if(deque->top)
+    {
+        kdAtomicIntFreeVEN(deque->top);
+    }
+    kdFree(deque->buffer);
+}
+
+/* __kdJobDequePush: Owner only, returns -1 if full. */
+static KDint __kdJobDequePush(_KDJobDeque *deque, const _KDJob *job)
+{
+    KDuint bottom = (KDuint)kdAtomicIntLoadVEN(deque->bottom);
+    KDuint top = (KDuint)kdAtomicIntLoadVEN(deque->top);
+    if(bottom - top >= __KD_JOB_DEQUE_SIZE)
+    {
+        return -1;
+    }
+    deque->buffer[bottom & (__KD_JOB_DEQUE_SIZE - 1)] = *job;
+    kdAtomicIntStoreVEN(deque->bottom, (KDint)(bottom + 1));
+    return 0;
+}
+
+/* __kdJobDequePop: Owner only, takes the newest job. */
+static KDboolean __kdJobDequePop(_KDJobDeque *deque, _KDJob *job)
+{
+    KDuint bottom = (KDuint)kdAtomicIntLoadVEN(deque->bottom) - 1;
+    kdAtomicIntStoreVEN(deque->bottom, (KDint)bottom);
+    KDuint top = (KDuint)kdAtomicIntLoadVEN(deque->top);
+    if((KDint)(bottom - top) < 0)
+    {
+        /* Empty */
+        kdAtomicIntStoreVEN(deque->bottom, (KDint)(bottom + 1));
+        return 0;
+    }
+    *job = deque->buffer[bottom & (__KD_JOB_DEQUE_SIZE - 1)];
+    if(bottom != top)
+    {
+        return 1;
+    }
+    /* Last job, race against thieves. */
+    KDboolean won = kdAtomicIntCompareExchangeVEN(deque->top, (KDint)top, (KDint)(top + 1));
+    kdAtomicIntStoreVEN(deque->bottom, (KDint)(bottom + 1));
+    return won;
+}
+
+/* __kdJobDequeSteal: Any thread, takes the oldest job. */
+static KDboolean __kdJobDequeSteal(_KDJobDeque *deque, _KDJob *job)
+{
+    KDuint top = (KDuint)kdAtomicIntLoadVEN(deque->top);
+    KDuint bottom = (KDuint)kdAtomicIntLoadVEN(deque->bottom);
+    if((KDint)(bottom - top) <= 0)
+    {
+        return 0;
+    }
+    /* The slot may be overwritten meanwhile, the exchange fails in that case. */
+    *job = deque->buffer[top & (__KD_JOB_DEQUE_SIZE - 1)];
+    return kdAtomicIntCompareExchangeVEN(deque->top, (KDint)top, (KDint)(top + 1));
+}
+
+static KDboolean __kdJobDequeEmpty(_KDJobDeque *deque)
+{
+    return (KDint)((KDuint)kdAtomicIntLoadVEN(deque->bottom) - (KDuint)kdAtomicIntLoadVEN(deque->top)) <= 0;
+}
+
+static _KDJobWorker *__kdJobWorkerSelf(KDJobSystemVEN *system)
+{
+    _KDJobWorker *worker = (_KDJobWorker *)kdGetThreadStorageKHR(system->key);
+    return (worker && worker->system == system) ? worker : KD_NULL;
+}
+
+/* __kdJobWake: Wake one sleeping worker, if any. */
+static void __kdJobWake(KDJobSystemVEN *system)
+{
+    for(;;)
+    {
+        KDint sleeping = kdAtomicIntLoadVEN(system->sleeping);
+        if(sleeping == 0)
+        {
+            return;
+        }
+        if(kdAtomicIntCompareExchangeVEN(system->sleeping, sleeping, sleeping - 1))
+        {
+            kdThreadSemPost(system->wake);
+            return;
+        }
+    }
+}
+
+static void __kdJobRun(const _KDJob *job);
+
+/* __kdJobSchedule: Make a job runnable, runs it inline if the deque is full. */
+static void __kdJobSchedule(KDJobSystemVEN *system, const _KDJob *job)
+{
+    _KDJobWorker *worker = __kdJobWorkerSelf(system);
+    KDint error = 0;
+    if(worker)
+    {
+        error = __kdJobDequePush(&worker->deque, job);
+    }
+    else
+    {
+        kdThreadMutexLock(system->sharedmutex);
+        error = __kdJobDequePush(&system->shared, job);
+        kdThreadMutexUnlock(system->sharedmutex);
+    }
+    if(error == -1)
+    {
+        __kdJobRun(job);
+        return;
+    }
+    __kdJobWake(system);
+}
+
+/* __kdJobRelease: Schedule jobs and post events parked on a counter. */
+static void __kdJobRelease(_KDJobParked *parked)
+{
+    while(parked)
+    {
+        _KDJobParked *next = parked->next;
+        if(parked->event)
+        {
+            kdPostThreadEvent(parked->event, parked->thread);
+        }
+        else
+        {
+            __kdJobSchedule(parked->system, &parked->job);
+        }
+        kdFree(parked);
+        parked = next;
+    }
+}
+
+/* __kdJobCounterDecrement: The last decrement happens under the mutex, waiters may free the counter right after. */
+static void __kdJobCounterDecrement(KDJobCounterVEN *counter)
+{
+    for(;;)
+    {
+        KDint value = kdAtomicIntLoadVEN(counter->value);
+        if(value > 1)
+        {
+            if(kdAtomicIntCompareExchangeVEN(counter->value, value, value - 1))
+            {
+                return;
+            }
+            continue;
+        }
+        kdThreadMutexLock(counter->mutex);
+        _KDJobParked *parked = KD_NULL;
+        if(kdAtomicIntFetchSubVEN(counter->value, 1) == 1)
+        {
+            parked = counter->parked;
+            counter->parked = KD_NULL;
+            if(counter->cond)
+            {
+                kdThreadCondBroadcast(counter->cond);
+            }
+        }
+        kdThreadMutexUnlock(counter->mutex);
+        __kdJobRelease(parked);
+        return;
+    }
+}
+
+static void __kdJobRun(const _KDJob *job)
+{
+    job->func(job->arg);
+    if(job->counter)
+    {
+        __kdJobCounterDecrement(job->counter);
+    }
+}
+
+/* __kdJobFind: Take a job from the own deque, the shared deque or another worker. */
+static KDboolean __kdJobFind(KDJobSystemVEN *system, _KDJobWorker *worker, KDuint *seed, _KDJob *job)
+{
+    if(worker && __kdJobDequePop(&worker->deque, job))
+    {
+        return 1;
+    }
+    if(__kdJobDequeSteal(&system->shared, job))
+    {
+        return 1;
+    }
+    /* xorshift picks the first victim. */
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    KDint start = system->count ? (KDint)(*seed % (KDuint)system->count) : 0;
+    for(KDint i = 0; i < system->count; i++)
+    {
+        _KDJobWorker *victim = &system->workers[(start + i) % system->count];
+        if(victim != worker && __kdJobDequeSteal(&victim->deque, job))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static KDboolean __kdJobPending(KDJobSystemVEN *system)
+{
+    if(!__kdJobDequeEmpty(&system->shared))
+    {
+        return 1;
+    }
+    for(KDint i = 0; i < system->count; i++)
+    {
+        if(!__kdJobDequeEmpty(&system->workers[i].deque))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void *__kdJobWorkerFunc(void *arg)
+{
+    _KDJobWorker *worker = (_KDJobWorker *)arg;
+    KDJobSystemVEN *system = worker->system;
+    kdSetThreadStorageKHR(system->key, worker);
+    KDint spins = 0;
+    for(;;)
+    {
+        _KDJob job;
+        if(__kdJobFind(system, worker, &worker->seed, &job))
+        {
+            __kdJobRun(&job);
+            spins = 0;
+            continue;
+        }
+        if(!kdAtomicIntLoadVEN(system->running))
+        {
+            /* Queued jobs are done. */
+            break;
+        }
+        if(++spins < __KD_JOB_SPIN)
+        {
+            continue;
+        }
+
+        /* Announce sleep, then look again so a concurrent push cannot be missed. */
+        kdAtomicIntFetchAddVEN(system->sleeping, 1);
+        if(__kdJobPending(system) || !kdAtomicIntLoadVEN(system->running))
+        {
+            KDint sleeping = kdAtomicIntLoadVEN(system->sleeping);
+            while(sleeping > 0 && !kdAtomicIntCompareExchangeVEN(system->sleeping, sleeping, sleeping - 1))
+            {
+                sleeping = kdAtomicIntLoadVEN(system->sleeping);
+            }
+            if(sleeping > 0)
+            {
+                spins = 0;
+                continue;
+            }
+            /* A wake up was already posted for this thread. */
+        }
+        kdThreadSemWait(system->wake);
+        spins = 0;
+    }
+    kdSetThreadStorageKHR(system->key, KD_NULL);
+    return KD_NULL;
+}
+
+static KDint __kdJobProcessorCount(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (KDint)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (KDint)count : 1;
+#else
+    return 1;
+#endif
+}
+
+/* kdJobSystemCreateVEN: Create a job system with one worker per processor if workers is 0. */
+KD_API KDJobSystemVEN *KD_APIENTRY kdJobSystemCreateVEN(KDint workers)
+{
+    if(workers < 0)
+    {
+        kdSetError(KD_EINVAL);
+        return KD_NULL;
+    }
+    if(workers == 0)
+    {
+        workers = __kdJobProcessorCount();
+    }
+    KDJobSystemVEN *system = (KDJobSystemVEN *)kdMalloc(sizeof(KDJobSystemVEN));
+    if(system == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    kdMemset(system, 0, sizeof(KDJobSystemVEN));
+    system->workers = (_KDJobWorker *)kdMalloc(sizeof(_KDJobWorker) * (KDsize)workers);
+    system->sharedmutex = kdThreadMutexCreate(KD_NULL);
+    system->wake = kdThreadSemCreate(0);
+    system->sleeping = kdAtomicIntCreateVEN(0);
+    system->running = kdAtomicIntCreateVEN(1);
+    system->key = kdMapThreadStorageKHR(&__kd_jobworker);
+    if(system->workers == KD_NULL || system->sharedmutex == KD_NULL || system->wake == KD_NULL || system->sleeping == KD_NULL || system->running == KD_NULL || system->key == 0 || __kdJobDequeInit(&system->shared) == -1)
+    {
+        kdJobSystemFreeVEN(system);
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    for(KDint i = 0; i < workers; i++)
+    {
+        _KDJobWorker *worker = &system->workers[i];
+        kdMemset(worker, 0, sizeof(_KDJobWorker));
+        worker->system = system;
+        worker->seed = 2463534242U + (KDuint)i;
+        if(__kdJobDequeInit(&worker->deque) == -1)
+        {
+            __kdJobDequeFree(&worker->deque);
+            kdJobSystemFreeVEN(system);
+            kdSetError(KD_ENOMEM);
+            return KD_NULL;
+        }
+        system->count++;
+    }
+
+    /* The attribute has to outlive the threads, it is read on startup. */
+    system->attr = kdThreadAttrCreate();
+    if(system->attr)
+    {
+        kdThreadAttrSetDebugNameVEN(system->attr, "KDJobWorker");
+    }
+    for(KDint i = 0; i < system->count; i++)
+    {
+        /* Without threads, jobs run in kdJobWaitVEN. */
+        system->workers[i].thread = kdThreadCreate(system->attr, __kdJobWorkerFunc, &system->workers[i]);
+    }
+    return system;
+}
+
+/* kdJobSystemFreeVEN: Run the queued jobs and stop the workers. */
+KD_API KDint KD_APIENTRY kdJobSystemFreeVEN(KDJobSystemVEN *system)
+{
+    if(system->running)
+    {
+        kdAtomicIntStoreVEN(system->running, 0);
+    }
+    for(KDint i = 0; i < system->count; i++)
+    {
+        kdThreadSemPost(system->wake);
+    }
+    for(KDint i = 0; i < system->count; i++)
+    {
+        if(system->workers[i].thread)
+        {
+            kdThreadJoin(system->workers[i].thread, KD_NULL);
+        }
+    }
+    /* Jobs queued to a system without threads */
+    if(system->shared.top && system->shared.bottom)
+    {
+        _KDJob job;
+        KDuint seed = 1;
+        while(__kdJobFind(system, KD_NULL, &seed, &job))
+        {
+            __kdJobRun(&job);
+        }
+    }
+    for(KDint i = 0; i < system->count; i++)
+    {
+        __kdJobDequeFree(&system->workers[i].deque);
+    }
+    __kdJobDequeFree(&system->shared);
+    if(system->attr)
+    {
+        kdThreadAttrFree(system->attr);
+    }
+    if(system->running)
+    {
+        kdAtomicIntFreeVEN(system->running);
+    }
+    if(system->sleeping)
+    {
+        kdAtomicIntFreeVEN(system->sleeping);
+    }
+    if(system->wake)
+    {
+        kdThreadSemFree(system->wake);
+    }
+    if(system->sharedmutex)
+    {
+        kdThreadMutexFree(system->sharedmutex);
+    }
+    kdFree(system->workers);
+    kdFree(system);
+    return 0;
+}
+
+/* kdJobSystemGetWorkerCountVEN: Number of worker threads. */
+KD_API KDint KD_APIENTRY kdJobSystemGetWorkerCountVEN(KDJobSystemVEN *system)
+{
+    return system->count;
+}
+
+/* kdJobCounterCreateVEN: Create a counter tracking unfinished jobs. */
+KD_API KDJobCounterVEN *KD_APIENTRY kdJobCounterCreateVEN(void)
+{
+    KDJobCounterVEN *counter = (KDJobCounterVEN *)kdMalloc(sizeof(KDJobCounterVEN));
+    if(counter == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    counter->parked = KD_NULL;
+    counter->value = kdAtomicIntCreateVEN(0);
+    counter->mutex = kdThreadMutexCreate(KD_NULL);
+    counter->cond = kdThreadCondCreate(KD_NULL);
+    /* Without threads every job runs in kdJobWaitVEN, nobody has to sleep. */
+    KDboolean threads = (counter->cond != KD_NULL || kdGetError() != KD_ENOSYS);
+    if(counter->value == KD_NULL || counter->mutex == KD_NULL || (counter->cond == KD_NULL && threads))
+    {
+        kdJobCounterFreeVEN(counter);
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    return counter;
+}
+
+/* kdJobCounterFreeVEN: Free a counter, its jobs have to be finished. */
+KD_API KDint KD_APIENTRY kdJobCounterFreeVEN(KDJobCounterVEN *counter)
+{
+    if(counter->cond)
+    {
+        kdThreadCondFree(counter->cond);
+    }
+    if(counter->mutex)
+    {
+        kdThreadMutexFree(counter->mutex);
+    }
+    if(counter->value)
+    {
+        kdAtomicIntFreeVEN(counter->value);
+    }
+    kdFree(counter);
+    return 0;
+}
+
+/* kdJobCounterGetVEN: Number of unfinished jobs. */
+KD_API KDint KD_APIENTRY kdJobCounterGetVEN(KDJobCounterVEN *counter)
+{
+    return kdAtomicIntLoadVEN(counter->value);
+}
+
+/* __kdJobPark: Park on a counter, returns 0 if it is already zero. */
+static KDboolean __kdJobPark(KDJobCounterVEN *counter, _KDJobParked *parked)
+{
+    kdThreadMutexLock(counter->mutex);
+    KDboolean waiting = (kdAtomicIntLoadVEN(counter->value) != 0);
+    if(waiting)
+    {
+        parked->next = counter->parked;
+        counter->parked = parked;
+    }
+    kdThreadMutexUnlock(counter->mutex);
+    return waiting;
+}
+
+/* kdJobSubmitVEN: Queue a job, counter and dependency may be KD_NULL. The job starts once dependency reaches zero. */
+KD_API KDint KD_APIENTRY kdJobSubmitVEN(KDJobSystemVEN *system, KDJobFuncVEN *func, void *arg, KDJobCounterVEN *counter, KDJobCounterVEN *dependency)
+{
+    if(func == KD_NULL)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    _KDJob job = {func, arg, counter};
+    _KDJobParked *parked = KD_NULL;
+    if(dependency && kdAtomicIntLoadVEN(dependency->value) != 0)
+    {
+        parked = (_KDJobParked *)kdMalloc(sizeof(_KDJobParked));
+        if(parked == KD_NULL)
+        {
+            kdSetError(KD_ENOMEM);
+            return -1;
+        }
+        kdMemset(parked, 0, sizeof(_KDJobParked));
+        parked->system = system;
+        parked->job = job;
+    }
+    if(counter)
+    {
+        kdAtomicIntFetchAddVEN(counter->value, 1);
+    }
+    if(parked)
+    {
+        if(__kdJobPark(dependency, parked))
+        {
+            return 0;
+        }
+        kdFree(parked);
+    }
+    __kdJobSchedule(system, &job);
+    return 0;
+}
+
+/* kdJobWaitVEN: Run queued jobs until counter reaches zero. */
+KD_API KDint KD_APIENTRY kdJobWaitVEN(KDJobSystemVEN *system, KDJobCounterVEN *counter)
+{
+    _KDJobWorker *worker = __kdJobWorkerSelf(system);
+    KDuint seed = (KDuint)(KDuintptr)&seed | 1;
+    KDint spins = 0;
+    while(kdAtomicIntLoadVEN(counter->value) != 0)
+    {
+        _KDJob job;
+        if(__kdJobFind(system, worker, &seed, &job))
+        {
+            __kdJobRun(&job);
+            spins = 0;
+        }
+        else if(++spins >= __KD_JOB_SPIN)
+        {
+            /* Nothing left to help with, the remaining jobs are running elsewhere. */
+            kdThreadMutexLock(counter->mutex);
+            if(counter->cond && kdAtomicIntLoadVEN(counter->value) != 0)
+            {
+                kdThreadCondWait(counter->cond, counter->mutex);
+            }
+            kdThreadMutexUnlock(counter->mutex);
+            spins = 0;
+        }
+    }
+    /* The last decrement may still hold the mutex. */
+    kdThreadMutexLock(counter->mutex);
+    kdThreadMutexUnlock(counter->mutex);
+    return 0;
+}
+
+/* kdJobNotifyVEN: Post KD_EVENT_JOB_COMPLETE_VEN to the calling thread once counter reaches zero. */
+KD_API KDint KD_APIENTRY kdJobNotifyVEN(KDJobCounterVEN *counter, void *eventuserptr)
+{
+    KDThread *thread = kdThreadSelf();
+    if(thread == KD_NULL)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    _KDJobParked *parked = (_KDJobParked *)kdMalloc(sizeof(_KDJobParked));
+    KDEvent *event = kdCreateEvent();
+    if(parked == KD_NULL || event == KD_NULL)
+    {
+        kdFree(parked);
+        if(event)
+        {
+            kdFreeEvent(event);
+        }
+        kdSetError(KD_ENOMEM);
+        return -1;
+    }
+    kdMemset(parked, 0, sizeof(_KDJobParked));
+    event->type = KD_EVENT_JOB_COMPLETE_VEN;
+    event->userptr = eventuserptr;
+    event->data.user.value1.p = counter;
+    parked->event = event;
+    parked->thread = thread;
+    if(!__kdJobPark(counter, parked))
+    {
+        kdFree(parked);
+        return kdPostThreadEvent(event, thread);
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * Parallel loops
+ *
+ * Notes:
+ * - The range is cut into blocks of grain indices. The caller and up to one
+ *   helper job per worker claim blocks, large batches first and shrinking
+ *   towards the end so the threads finish together.
+ * - Reductions use fixed chunks so partial results are joined in the same
+ *   order on every run.
+ * - Ranges of a single block, or without workers, run inline.
+ ******************************************************************************/
+
+/* Blocks per participant when grain is 0 */
+#define __KD_PARALLEL_SPLIT 32
+/* Chunks per participant of a reduction */
+#define __KD_PARALLEL_CHUNKS 4
+
+static KDJobSystemVEN *__kd_jobsystem = KD_NULL;
+static KDThreadOnce __kd_jobsystem_once = KD_THREAD_ONCE_INIT;
+
+static void __kdJobSystemInitOnce(void)
+{
+    /* The calling thread helps, one worker less keeps every processor busy. */
+    KDint workers = __kdJobProcessorCount() - 1;
+    __kd_jobsystem = kdJobSystemCreateVEN(workers > 0 ? workers : 1);
+}
+
+/* kdJobSystemGetDefaultVEN: Shared job system, created on first use and used by the parallel loops. */
+KD_API KDJobSystemVEN *KD_APIENTRY kdJobSystemGetDefaultVEN(void)
+{
+    kdThreadOnce(&__kd_jobsystem_once, __kdJobSystemInitOnce);
+    return __kd_jobsystem;
+}
+
+/* __kdJobSystemShutdown: Called after kdMain returns. */
+void __kdJobSystemShutdown(void)
+{
+    if(__kd_jobsystem)
+    {
+        kdJobSystemFreeVEN(__kd_jobsystem);
+        __kd_jobsystem = KD_NULL;
+    }
+}
+
+typedef struct _KDParallel {
+    KDParallelForFuncVEN *func;
+    KDParallelReduceFuncVEN *reduce;
+    void *ctx;
+    KDuint8 *partials;
+    KDAtomicIntVEN *next;
+    KDint64 begin;
+    KDint64 end;
+    KDint64 grain;
+    KDsize size;
+    KDint blocks; /* Chunks of a reduction */
+    KDint participants;
+} _KDParallel;
+
+static void __kdParallelRun(_KDParallel *parallel)
+{
+    if(parallel->reduce)
+    {
+        KDint64 length = parallel->end - parallel->begin;
+        KDint64 step = length / parallel->blocks;
+        KDint64 extra = length % parallel->blocks;
+        for(;;)
+        {
+            KDint chunk = kdAtomicIntFetchAddVEN(parallel->next, 1);
+            if(chunk >= parallel->blocks)
+            {
+                return;
+            }
+            KDint64 first = parallel->begin + step * chunk + ((chunk < extra) ? chunk : extra);
+            KDint64 last = first + step + ((chunk < extra) ? 1 : 0);
+            parallel->reduce(first, last, parallel->partials + parallel->size * (KDsize)chunk, parallel->ctx);
+        }
+    }
+    for(;;)
+    {
+        KDint first = kdAtomicIntLoadVEN(parallel->next);
+        if(first >= parallel->blocks)
+        {
+            return;
+        }
+        KDint take = (parallel->blocks - first) / (2 * parallel->participants);
+        take = (take > 0) ? take : 1;
+        if(kdAtomicIntCompareExchangeVEN(parallel->next, first, first + take))
+        {
+            KDint64 from = parallel->begin + (KDint64)first * parallel->grain;
+            KDint64 to = parallel->begin + (KDint64)(first + take) * parallel->grain;
+            parallel->func(from, (to < parallel->end && to > from) ? to : parallel->end, parallel->ctx);
+        }
+    }
+}
+
+static void KD_APIENTRY __kdParallelJob(void *arg)
+{
+    __kdParallelRun((_KDParallel *)arg);
+}
+
+/* __kdParallelPrepare: Pick grain and participants, returns 0 to run inline. */
+static KDboolean __kdParallelPrepare(_KDParallel *parallel, KDJobSystemVEN **system)
+{
+    *system = kdJobSystemGetDefaultVEN();
+    KDint64 length = parallel->end - parallel->begin;
+    KDint64 participants = (*system) ? (KDint64)kdJobSystemGetWorkerCountVEN(*system) + 1 : 1;
+    if(parallel->grain <= 0)
+    {
+        parallel->grain = length / (participants * __KD_PARALLEL_SPLIT);
+        parallel->grain = (parallel->grain > 0) ? parallel->grain : 1;
+    }
+    /* Block numbers have to fit an atomic int. */
+    if(length / parallel->grain >= KDINT32_MAX)
+    {
+        parallel->grain = length / (KDINT32_MAX / 2);
+    }
+    KDint64 blocks = (length + parallel->grain - 1) / parallel->grain;
+    if(participants < 2 || blocks < 2)
+    {
+        return 0;
+    }
+    parallel->participants = (KDint)((blocks < participants) ? blocks : participants);
+    parallel->blocks = (KDint)blocks;
+    if(parallel->reduce && blocks > participants * __KD_PARALLEL_CHUNKS)
+    {
+        parallel->blocks = (KDint)(participants * __KD_PARALLEL_CHUNKS);
+    }
+    return 1;
+}
+
+/* __kdParallelExecute: Run with helper jobs, returns -1 if they could not be set up. */
+static KDint __kdParallelExecute(_KDParallel *parallel, KDJobSystemVEN *system)
+{
+    KDJobCounterVEN *counter = kdJobCounterCreateVEN();
+    parallel->next = kdAtomicIntCreateVEN(0);
+    if(counter == KD_NULL || parallel->next == KD_NULL)
+    {
+        if(counter)
+        {
+            kdJobCounterFreeVEN(counter);
+        }
+        if(parallel->next)
+        {
+            kdAtomicIntFreeVEN(parallel->next);
+        }
+        return -1;
+    }
+    for(KDint i = 1; i < parallel->participants; i++)
+    {
+        kdJobSubmitVEN(system, __kdParallelJob, parallel, counter, KD_NULL);
+    }
+    __kdParallelRun(parallel);
+    kdJobWaitVEN(system, counter);
+    kdJobCounterFreeVEN(counter);
+    kdAtomicIntFreeVEN(parallel->next);
+    return 0;
+}
+
+/* kdParallelForVEN: Call func for subranges of [begin, end), at least grain indices long. grain 0 picks a size. */
+KD_API KDint KD_APIENTRY kdParallelForVEN(KDint64 begin, KDint64 end, KDint64 grain, KDParallelForFuncVEN *func, void *ctx)
+{
+    if(func == KD_NULL || grain < 0)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    if(begin >= end)
+    {
+        return 0;
+    }
+    _KDParallel parallel;
+    kdMemset(&parallel, 0, sizeof(parallel));
+    parallel.func = func;
+    parallel.ctx = ctx;
+    parallel.begin = begin;
+    parallel.end = end;
+    parallel.grain = grain;
+    KDJobSystemVEN *system = KD_NULL;
+    if(!__kdParallelPrepare(&parallel, &system) || __kdParallelExecute(&parallel, system) == -1)
+    {
+        func(begin, end, ctx);
+    }
+    return 0;
+}
+
+/* kdParallelReduceVEN: Accumulate subranges into partial results of size bytes and join them into result in order. Partial results start as copies of result, which has to hold the identity. */
+KD_API KDint KD_APIENTRY kdParallelReduceVEN(KDint64 begin, KDint64 end, KDint64 grain, KDParallelReduceFuncVEN *func, KDParallelJoinFuncVEN *join, void *result, KDsize size, void *ctx)
+{
+    if(func == KD_NULL || join == KD_NULL || result == KD_NULL || size == 0 || grain < 0)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    if(begin >= end)
+    {
+        return 0;
+    }
+    _KDParallel parallel;
+    kdMemset(&parallel, 0, sizeof(parallel));
+    parallel.reduce = func;
+    parallel.ctx = ctx;
+    parallel.begin = begin;
+    parallel.end = end;
+    parallel.grain = grain;
+    parallel.size = size;
+    KDJobSystemVEN *system = KD_NULL;
+    if(__kdParallelPrepare(&parallel, &system))
+    {
+        parallel.partials = (KDuint8 *)kdMalloc(size * (KDsize)parallel.blocks);
+    }
+    if(parallel.partials == KD_NULL)
+    {
+        func(begin, end, result, ctx);
+        return 0;
+    }
+    for(KDint i = 0; i < parallel.blocks; i++)
+    {
+        kdMemcpy(parallel.partials + size * (KDsize)i, result, size);
+    }
+    if(__kdParallelExecute(&parallel, system) == -1)
+    {
+        kdFree(parallel.partials);
+        func(begin, end, result, ctx);
+        return 0;
+    }
+    for(KDint i = 0; i < parallel.blocks; i++)
+    {
+        join(result, parallel.partials + size * (KDsize)i, ctx);
+    }
+    kdFree(parallel.partials);
+    return 0;
+}
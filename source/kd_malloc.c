@@ -815,7 +815,10 @@ struct _KDMutexAttr {
     KDThreadMutex *staticmutex;
 };
 struct KDThreadMutex {
-#if defined(KD_THREAD_C11)
+#if defined(KD_THREAD_FUTEX)
+    KDuint32 state;
+    KDuint32 spin;
+#elif defined(KD_THREAD_C11)
     mtx_t nativemutex;
 #elif defined(KD_THREAD_POSIX)
     pthread_mutex_t nativemutex;
@@ -36,7 +36,7 @@
 #endif
 #endif
 #if defined(__linux__) || defined(__EMSCRIPTEN__)
-#define _GNU_SOURCE /* O_CLOEXEC */
+#define _GNU_SOURCE /* O_CLOEXEC, accept4 */
 #endif
 #include "kdplatform.h"        // for KD_API, KD_APIENTRY, KD_UNUSED, KDuint32
 #include <KD/kd.h>             // for KDint, KDSocket, kdSetError, KDSockaddr
@@ -46,6 +46,8 @@
 #pragma clang diagnostic pop
 #endif
 
+#include "kd_internal.h"  // for KD_REACTOR_EPOLL, __kdReactorWatch, __kdEventDropSocket
+
 /******************************************************************************
  * C includes
  ******************************************************************************/
@@ -66,6 +68,12 @@
 #include <sys/socket.h>  // for socket, AF_INET, bind, connect, recv
 #endif
 
+#if defined(KD_REACTOR_EPOLL)
+#define __KD_SOCK_FLAGS (SOCK_NONBLOCK | SOCK_CLOEXEC)
+#else
+#define __KD_SOCK_FLAGS 0
+#endif
+
 #if defined(_WIN32)
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
@@ -180,8 +188,99 @@ struct KDSocket {
     KDint type;
     const struct KDSockaddr *addr;
     void *userptr;
+    KDThread *owner;
+    KDboolean connecting;
+    KDboolean listening;
+    KDboolean wantwrite;
+#if KDSIZE_MAX == KDUINT64_MAX
+    KDint8 padding[5];
+#else
+    KDint8 padding[1];
+#endif
 };
-KD_API KDSocket *KD_APIENTRY kdSocketCreate(KDint type, void *eventuserptr)
+static void __kdSocketPost(KDSocket *sock, KDint32 type, KDint32 error)
+{
+    KDEvent *event = kdCreateEvent();
+    if(event == KD_NULL)
+    {
+        return;
+    }
+    event->type = type;
+    event->userptr = sock->userptr;
+    if(type == KD_EVENT_SOCKET_CONNECT_COMPLETE)
+    {
+        event->data.socketconnect.socket = sock;
+        event->data.socketconnect.error = error;
+    }
+    else
+    {
+        /* All other socket events only carry the socket */
+        event->data.socketreadable.socket = sock;
+    }
+    kdPostEvent(event);
+}
+#if defined(KD_REACTOR_EPOLL)
+static KDint32 __kdSocketConnectError(KDint error)
+{
+    switch(error)
+    {
+        case(0):
+        {
+            return 0;
+        }
+        case(ECONNREFUSED):
+        {
+            return KD_ECONNREFUSED;
+        }
+        case(ECONNRESET):
+        {
+            return KD_ECONNRESET;
+        }
+        case(EHOSTUNREACH):
+        case(ENETUNREACH):
+        {
+            return KD_EHOSTUNREACH;
+        }
+        case(ETIMEDOUT):
+        {
+            return KD_ETIMEDOUT;
+        }
+        default:
+        {
+            return KD_EIO;
+        }
+    }
+}
+/* Runs in the owning thread's reactor. Watches are edge triggered, so every
+ * event tells the application to read or write until KD_EAGAIN. */
+static void __kdSocketReady(void *arg, KDuint events)
+{
+    KDSocket *sock = (KDSocket *)arg;
+    if(sock->connecting)
+    {
+        if(!(events & (__KD_REACTOR_OUT | __KD_REACTOR_ERR)))
+        {
+            return;
+        }
+        KDint error = 0;
+        socklen_t errorsize = sizeof(error);
+        getsockopt(sock->nativesocket, SOL_SOCKET, SO_ERROR, &error, &errorsize);
+        sock->connecting = KD_FALSE;
+        __kdSocketPost(sock, KD_EVENT_SOCKET_CONNECT_COMPLETE, __kdSocketConnectError(error));
+        return;
+    }
+    if(events & (__KD_REACTOR_IN | __KD_REACTOR_ERR))
+    {
+        __kdSocketPost(sock, sock->listening ? KD_EVENT_SOCKET_INCOMING : KD_EVENT_SOCKET_READABLE, 0);
+    }
+    if((events & __KD_REACTOR_OUT) && sock->wantwrite)
+    {
+        sock->wantwrite = KD_FALSE;
+        __kdSocketPost(sock, KD_EVENT_SOCKET_WRITABLE, 0);
+    }
+}
+#endif
+static KDSocket *__kdSocketAlloc(KDint type, void *eventuserptr)
 {
     KDSocket *sock = (KDSocket *)kdMalloc(sizeof(KDSocket));
     if(sock == KD_NULL)
@@ -189,18 +288,42 @@ KD_API KDSocket *KD_APIENTRY kdSocketCreate(KDint type, void *eventuserptr)
         kdSetError(KD_ENOMEM);
         return KD_NULL;
     }
+    kdMemset(sock, 0, sizeof(KDSocket));
     sock->type = type;
     sock->addr = KD_NULL;
     sock->userptr = eventuserptr;
+    sock->owner = kdThreadSelf();
+    return sock;
+}
+static KDint __kdSocketWatch(KD_UNUSED KDSocket *sock)
+{
+#if defined(KD_REACTOR_EPOLL)
+    if(__kdReactorWatch(sock->owner->reactor, sock->nativesocket, __KD_REACTOR_IN | __KD_REACTOR_OUT, __kdSocketReady, sock) == -1)
+    {
+        /* Keeps the reactor's error, KD_EMFILE or KD_EINVAL are possible too */
+        close(sock->nativesocket);
+        kdFree(sock);
+        return -1;
+    }
+#endif
+    return 0;
+}
+KD_API KDSocket *KD_APIENTRY kdSocketCreate(KDint type, void *eventuserptr)
+{
+    KDSocket *sock = __kdSocketAlloc(type, eventuserptr);
+    if(sock == KD_NULL)
+    {
+        return KD_NULL;
+    }
     if(sock->type == KD_SOCK_TCP)
     {
 #if defined(_WIN32)
-        sock->nativesocket = WSASocketA(AF_UNIX, SOCK_STREAM, 0, 0, 0, 0);
+        sock->nativesocket = WSASocketA(AF_INET, SOCK_STREAM, 0, 0, 0, 0);
         if(sock->nativesocket == INVALID_SOCKET)
         {
             KDint error = WSAGetLastError();
 #else
-        sock->nativesocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        sock->nativesocket = socket(AF_INET, SOCK_STREAM | __KD_SOCK_FLAGS, 0);
         if(sock->nativesocket == -1)
         {
             KDint error = errno;
@@ -213,12 +336,12 @@ KD_API KDSocket *KD_APIENTRY kdSocketCreate(KDint type, void *eventuserptr)
     else if(sock->type == KD_SOCK_UDP)
     {
 #if defined(_WIN32)
-        sock->nativesocket = WSASocketA(AF_UNIX, SOCK_DGRAM, 0, 0, 0, 0);
+        sock->nativesocket = WSASocketA(AF_INET, SOCK_DGRAM, 0, 0, 0, 0);
         if(sock->nativesocket == INVALID_SOCKET)
         {
             KDint error = WSAGetLastError();
 #else
-        sock->nativesocket = socket(AF_UNIX, SOCK_DGRAM, 0);
+        sock->nativesocket = socket(AF_INET, SOCK_DGRAM | __KD_SOCK_FLAGS, 0);
         if(sock->nativesocket == -1)
         {
             KDint error = errno;
@@ -227,11 +350,10 @@ KD_API KDSocket *KD_APIENTRY kdSocketCreate(KDint type, void *eventuserptr)
             kdSetErrorPlatformVEN(error, KD_EACCES | KD_EINVAL | KD_EIO | KD_EMFILE | KD_ENOMEM | KD_ENOSYS);
             return KD_NULL;
         }
-        KDEvent *event = kdCreateEvent();
-        event->type = KD_EVENT_SOCKET_READABLE;
-        event->userptr = sock->userptr;
-        event->data.socketreadable.socket = sock;
-        kdPostEvent(event);
+#if !defined(KD_REACTOR_EPOLL)
+        /* Without a reactor there is no readiness to report */
+        __kdSocketPost(sock, KD_EVENT_SOCKET_READABLE, 0);
+#endif
     }
     else
     {
@@ -239,28 +361,49 @@ KD_API KDSocket *KD_APIENTRY kdSocketCreate(KDint type, void *eventuserptr)
         kdSetError(KD_EINVAL);
         return KD_NULL;
     }
+    if(__kdSocketWatch(sock) == -1)
+    {
+        return KD_NULL;
+    }
     return sock;
 }
 
 /* kdSocketClose: Closes a socket. */
+/* Only the creating thread may close, its reactor and queues refer to the socket. */
 KD_API KDint KD_APIENTRY kdSocketClose(KDSocket *socket)
 {
+    if(socket->owner != kdThreadSelf())
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+#if defined(KD_REACTOR_EPOLL)
+    __kdReactorUnwatch(socket->owner->reactor, socket->nativesocket);
+#endif
 #if defined(_WIN32)
     closesocket(socket->nativesocket);
 #else
     close(socket->nativesocket);
 #endif
+    /* Readiness already posted would hand out the freed socket */
+    __kdEventDropSocket(socket->owner, socket);
+    kdFree(socket);
     return 0;
 }
 
 /* kdSocketBind: Bind a socket. */
-KD_API KDint KD_APIENTRY kdSocketBind(KDSocket *socket, const KDSockaddr *addr, KD_UNUSED KDboolean reuse)
+KD_API KDint KD_APIENTRY kdSocketBind(KDSocket *socket, const KDSockaddr *addr, KDboolean reuse)
 {
     if(addr->family != KD_AF_INET)
     {
         kdSetError(KD_EAFNOSUPPORT);
         return -1;
     }
+    if(reuse)
+    {
+        KDint enable = 1;
+        setsockopt(socket->nativesocket, SOL_SOCKET, SO_REUSEADDR, (const KDchar *)&enable, sizeof(enable));
+    }
 
     struct sockaddr_in address;
     kdMemset(&address, 0, sizeof(address));
@@ -295,14 +438,12 @@ KD_API KDint KD_APIENTRY kdSocketBind(KDSocket *socket, const KDSockaddr *addr,
     }
 
     socket->addr = addr;
+#if !defined(KD_REACTOR_EPOLL)
     if(socket->type == KD_SOCK_TCP)
     {
-        KDEvent *event = kdCreateEvent();
-        event->type = KD_EVENT_SOCKET_READABLE;
-        event->userptr = socket->userptr;
-        event->data.socketreadable.socket = socket;
-        kdPostEvent(event);
+        __kdSocketPost(socket, KD_EVENT_SOCKET_READABLE, 0);
     }
+#endif
     return 0;
 }
 
@@ -344,25 +485,90 @@ KD_API KDint KD_APIENTRY kdSocketConnect(KDSocket *socket, const KDSockaddr *add
     if(retval == -1)
     {
         KDint error = errno;
+#if defined(KD_REACTOR_EPOLL)
+        if(error == EINPROGRESS)
+        {
+            /* KD_EVENT_SOCKET_CONNECT_COMPLETE follows from the reactor */
+            socket->connecting = KD_TRUE;
+            return 0;
+        }
+#endif
 #endif
         kdSetErrorPlatformVEN(error, KD_EADDRINUSE | KD_EAFNOSUPPORT | KD_EALREADY | KD_ECONNREFUSED | KD_ECONNRESET | KD_EHOSTUNREACH | KD_EINVAL | KD_EIO | KD_EISCONN | KD_ENOMEM | KD_ETIMEDOUT);
         return -1;
     }
+    __kdSocketPost(socket, KD_EVENT_SOCKET_CONNECT_COMPLETE, 0);
     return 0;
 }
 
 /* kdSocketListen: Listen on a socket. */
 KD_API KDint KD_APIENTRY kdSocketListen(KD_UNUSED KDSocket *socket, KD_UNUSED KDint backlog)
 {
+#if defined(KD_REACTOR_EPOLL)
+    if(socket->type != KD_SOCK_TCP)
+    {
+        kdSetError(KD_EOPNOTSUPP);
+        return -1;
+    }
+    if(listen(socket->nativesocket, backlog) == -1)
+    {
+        kdSetErrorPlatformVEN(errno, KD_EADDRINUSE | KD_EINVAL | KD_EIO | KD_EISCONN | KD_ENOMEM | KD_EOPNOTSUPP);
+        return -1;
+    }
+    socket->listening = KD_TRUE;
+    return 0;
+#else
     kdSetError(KD_ENOSYS);
     return -1;
+#endif
 }
 
 /* kdSocketAccept: Accept an incoming connection. */
 KD_API KDSocket *KD_APIENTRY kdSocketAccept(KD_UNUSED KDSocket *socket, KD_UNUSED KDSockaddr *addr, KD_UNUSED void *eventuserptr)
 {
+#if defined(KD_REACTOR_EPOLL)
+    if(!socket->listening)
+    {
+        kdSetError(KD_EINVAL);
+        return KD_NULL;
+    }
+    struct sockaddr_in address;
+    kdMemset(&address, 0, sizeof(address));
+    socklen_t addresssize = sizeof(address);
+    KDint fd = accept4(socket->nativesocket, (struct sockaddr *)&address, &addresssize, __KD_SOCK_FLAGS);
+    if(fd == -1)
+    {
+        KDint error = errno;
+        if(error == EAGAIN || error == EWOULDBLOCK)
+        {
+            kdSetError(KD_EAGAIN);
+            return KD_NULL;
+        }
+        kdSetErrorPlatformVEN(error, KD_ECONNRESET | KD_EIO | KD_EMFILE | KD_ENOMEM);
+        return KD_NULL;
+    }
+    KDSocket *sock = __kdSocketAlloc(KD_SOCK_TCP, eventuserptr);
+    if(sock == KD_NULL)
+    {
+        close(fd);
+        return KD_NULL;
+    }
+    sock->nativesocket = fd;
+    if(__kdSocketWatch(sock) == -1)
+    {
+        return KD_NULL;
+    }
+    if(addr)
+    {
+        addr->family = KD_AF_INET;
+        addr->data.sin.address = kdHtonl(address.sin_addr.s_addr);
+        addr->data.sin.port = kdHtons(address.sin_port);
+    }
+    return sock;
+#else
     kdSetError(KD_EINVAL);
     return KD_NULL;
+#endif
 }
 
 /* kdSocketSend, kdSocketSendTo: Send data to a socket. */
@@ -384,6 +590,13 @@ KD_API KDint KD_APIENTRY kdSocketSend(KDSocket *socket, const void *buf, KDint l
     if(result == -1)
     {
         KDint error = errno;
+        if(error == EAGAIN || error == EWOULDBLOCK)
+        {
+            /* KD_EVENT_SOCKET_WRITABLE follows once there is room */
+            socket->wantwrite = KD_TRUE;
+            kdSetError(KD_EAGAIN);
+            return -1;
+        }
 #endif
         kdSetErrorPlatformVEN(error, KD_EAFNOSUPPORT | KD_EAGAIN | KD_ECONNRESET | KD_EDESTADDRREQ | KD_EIO | KD_ENOMEM | KD_ENOTCONN);
         return -1;
@@ -427,6 +640,12 @@ KD_API KDint KD_APIENTRY kdSocketSendTo(KDSocket *socket, const void *buf, KDint
     if(result == -1)
     {
         KDint error = errno;
+        if(error == EAGAIN || error == EWOULDBLOCK)
+        {
+            socket->wantwrite = KD_TRUE;
+            kdSetError(KD_EAGAIN);
+            return -1;
+        }
 #endif
         kdSetErrorPlatformVEN(error, KD_EAFNOSUPPORT | KD_EAGAIN | KD_ECONNRESET | KD_EDESTADDRREQ | KD_EIO | KD_ENOMEM | KD_ENOTCONN);
         return -1;
@@ -451,6 +670,11 @@ KD_API KDint KD_APIENTRY kdSocketRecv(KDSocket *socket, void *buf, KDint len)
     if(result == -1)
     {
         KDint error = errno;
+        if(error == EAGAIN || error == EWOULDBLOCK)
+        {
+            kdSetError(KD_EAGAIN);
+            return -1;
+        }
 #endif
         kdSetErrorPlatformVEN(error, KD_EAGAIN | KD_ECONNRESET | KD_EIO | KD_ENOMEM | KD_ENOTCONN | KD_ETIMEDOUT);
         return -1;
@@ -478,6 +702,11 @@ KD_API KDint KD_APIENTRY kdSocketRecvFrom(KDSocket *socket, void *buf, KDint len
     if(result == -1)
     {
         KDint error = errno;
+        if(error == EAGAIN || error == EWOULDBLOCK)
+        {
+            kdSetError(KD_EAGAIN);
+            return -1;
+        }
 #endif
         kdSetErrorPlatformVEN(error, KD_EAGAIN | KD_ECONNRESET | KD_EIO | KD_ENOMEM | KD_ENOTCONN | KD_ETIMEDOUT);
         return -1;
@@ -499,7 +728,7 @@ KD_API KDint KD_APIENTRY kdSocketRecvFrom(KDSocket *socket, void *buf, KDint len
 #undef s_addr
 #endif
     addr->data.sin.port = kdHtons(address.sin_port);
-    return 0;
+    return result;
 }
 
 /* kdHtonl: Convert a 32-bit integer from host to network byte order. */
@@ -56,9 +56,12 @@
 #include <threads.h>
 #endif
 
-#if defined(KD_THREAD_POSIX)
-#include <errno.h>  // for EINVAL, ENOMEM, ESRCH
-#include <time.h>   // for nanosleep
+#if defined(KD_THREAD_POSIX) || defined(KD_THREAD_FUTEX) || defined(__linux__)
+#include <errno.h>  // for EINVAL, ENOMEM, ESRCH, ETIMEDOUT, EINTR
+#endif
+
+#if defined(KD_THREAD_POSIX) || defined(KD_THREAD_C11)
+#include <time.h>  // for nanosleep, clock_gettime, timespec_get
 #endif
 
 /******************************************************************************
@@ -68,6 +71,7 @@
 #if defined(KD_THREAD_POSIX)
 // IWYU pragma: no_include <bits/pthread_types.h>
 #include <pthread.h>  // for pthread_attr_setdetachstate
+#include <unistd.h>   // for sysconf
 #endif
 
 #if defined(__linux__)
@@ -76,6 +80,16 @@
 // IWYU pragma: no_include <bits/types/struct_timespec.h>
 // IWYU pragma: no_include <linux/time.h>
 #include <sys/prctl.h>  // for prctl, PR_SET_NAME
+#include <sched.h>             // for sched_setaffinity, sched_setscheduler
+#include <sys/resource.h>      // for setpriority, getrlimit
+#include <sys/syscall.h>       // for SYS_set_mempolicy
+#include <linux/mempolicy.h>   // for MPOL_PREFERRED
+#include <fcntl.h>             // for O_RDONLY
+#include <unistd.h>            // for close, syscall
+#endif
+
+#if defined(KD_THREAD_FUTEX)
+#include <linux/futex.h>  // for FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
 #endif
 
 #if defined(__EMSCRIPTEN__)
@@ -95,13 +109,19 @@
  ******************************************************************************/
 
 /* kdThreadAttrCreate: Create a thread attribute object. */
+#define __KD_CPU_WORDS 16
 struct KDThreadAttr {
 #if defined(KD_THREAD_POSIX)
     pthread_attr_t nativeattr;
 #endif
+    KDuint64 affinity[__KD_CPU_WORDS];
     KDchar debugname[256];
     KDsize stacksize;
     KDint detachstate;
+    KDint affinitywords;
+    KDint schedpolicy;
+    KDint schedpriority;
+    KDint numanode;
 #if KDSIZE_MAX == KDUINT64_MAX
     KDint8 padding[4];
 #endif
@@ -120,6 +140,11 @@ KD_API KDThreadAttr *KD_APIENTRY kdThreadAttrCreate(void)
     /* Impl default */
     attr->stacksize = 100000;
     kdStrcpy_s(attr->debugname, 256, "KDThread");
+    kdMemset(attr->affinity, 0, sizeof(attr->affinity));
+    attr->affinitywords = 0;
+    attr->schedpolicy = KD_THREAD_SCHED_NORMAL_VEN;
+    attr->schedpriority = 0;
+    attr->numanode = -1;
 #if defined(KD_THREAD_POSIX)
     pthread_attr_init(&attr->nativeattr);
     pthread_attr_setdetachstate(&attr->nativeattr, PTHREAD_CREATE_JOINABLE);
@@ -182,6 +207,233 @@ KD_API KDint KD_APIENTRY kdThreadAttrSetDebugNameVEN(KDThreadAttr *attr, const c
     return 0;
 }
 
+/* kdThreadAttrSetAffinityVEN: Set the processors a thread may run on. */
+KD_API KDint KD_APIENTRY kdThreadAttrSetAffinityVEN(KDThreadAttr *attr, const KDuint64 *mask, KDint words)
+{
+    kdMemset(attr->affinity, 0, sizeof(attr->affinity));
+    attr->affinitywords = 0;
+    if(mask == KD_NULL)
+    {
+        return 0;
+    }
+    KDuint64 any = 0;
+    for(KDint i = 0; i < words && i < __KD_CPU_WORDS; i++)
+    {
+        any |= mask[i];
+    }
+    if(words < 1 || words > __KD_CPU_WORDS || any == 0)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    kdMemcpy(attr->affinity, mask, sizeof(KDuint64) * (KDsize)words);
+    attr->affinitywords = words;
+    return 0;
+}
+
+/* kdThreadAttrSetSchedulingVEN: Set scheduling policy and priority. */
+KD_API KDint KD_APIENTRY kdThreadAttrSetSchedulingVEN(KDThreadAttr *attr, KDint policy, KDint priority)
+{
+    if(!(policy == KD_THREAD_SCHED_NORMAL_VEN && priority >= -20 && priority <= 19) &&
+        !(policy == KD_THREAD_SCHED_REALTIME_VEN && priority >= 1 && priority <= 99))
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    attr->schedpolicy = policy;
+    attr->schedpriority = priority;
+    return 0;
+}
+
+/* kdThreadAttrSetNumaNodeVEN: Set the preferred NUMA node. */
+KD_API KDint KD_APIENTRY kdThreadAttrSetNumaNodeVEN(KDThreadAttr *attr, KDint node)
+{
+    if(node < -1 || node >= __KD_CPU_WORDS * 64)
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    attr->numanode = node;
+    return 0;
+}
+
+#if defined(__linux__)
+/* Read a small sysfs file into a terminated buffer. */
+static KDint __kdReadSysfs(const KDchar *path, KDchar *buffer, KDsize size)
+{
+    KDint fd = __kdOpen(path, O_RDONLY | O_CLOEXEC, 0);
+    if(fd == -1)
+    {
+        return -1;
+    }
+    KDssize length = __kdRead(fd, buffer, size - 1);
+    close(fd);
+    if(length <= 0)
+    {
+        return -1;
+    }
+    buffer[length] = '\0';
+    return 0;
+}
+
+/* Parse a list like "0-3,8,10-11" into a bit mask. */
+static KDint __kdParseCpuList(const KDchar *list, KDuint64 *mask)
+{
+    kdMemset(mask, 0, sizeof(KDuint64) * __KD_CPU_WORDS);
+    const KDchar *p = list;
+    while(kdIsdigitVEN(*p))
+    {
+        KDchar *end = KD_NULL;
+        KDint first = (KDint)kdStrtol(p, &end, 10);
+        KDint last = first;
+        if(*end == '-')
+        {
+            last = (KDint)kdStrtol(end + 1, &end, 10);
+        }
+        for(KDint cpu = first; cpu <= last && cpu < __KD_CPU_WORDS * 64; cpu++)
+        {
+            mask[cpu / 64] |= 1ULL << (cpu % 64);
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return (p == list) ? -1 : 0;
+}
+
+static KDint __kdReadSysfsCpuList(const KDchar *path, KDuint64 *mask)
+{
+    KDchar buffer[4096];
+    if(__kdReadSysfs(path, buffer, sizeof(buffer)) == -1)
+    {
+        return -1;
+    }
+    return __kdParseCpuList(buffer, mask);
+}
+
+static KDint __kdReadSysfsInt(const KDchar *path, KDint fallback)
+{
+    KDchar buffer[64];
+    if(__kdReadSysfs(path, buffer, sizeof(buffer)) == -1)
+    {
+        return fallback;
+    }
+    return (KDint)kdStrtol(buffer, KD_NULL, 10);
+}
+#endif
+
+#if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX) || defined(KD_THREAD_WIN32)
+/* Apply affinity, NUMA and scheduling attributes to the calling thread,
+ * failures leave the thread running with defaults. */
+static void __kdThreadApplyAttr(const KDThreadAttr *attr)
+{
+#if defined(__linux__)
+    KDuint64 mask[__KD_CPU_WORDS];
+    kdMemcpy(mask, attr->affinity, sizeof(mask));
+    KDboolean pin = (attr->affinitywords > 0);
+    if(attr->numanode >= 0)
+    {
+        KDuint64 nodemask[__KD_CPU_WORDS] = {0};
+        nodemask[attr->numanode / 64] = 1ULL << (attr->numanode % 64);
+        syscall(SYS_set_mempolicy, MPOL_PREFERRED, nodemask, (unsigned long)(__KD_CPU_WORDS * 64));
+
+        KDchar path[64];
+        kdSnprintfKHR(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", attr->numanode);
+        KDuint64 nodecpus[__KD_CPU_WORDS];
+        if(__kdReadSysfsCpuList(path, nodecpus) == 0)
+        {
+            KDuint64 any = 0;
+            for(KDint i = 0; i < __KD_CPU_WORDS; i++)
+            {
+                nodecpus[i] &= pin ? mask[i] : ~0ULL;
+                any |= nodecpus[i];
+            }
+            /* An affinity mask outside the node wins over the node. */
+            if(any)
+            {
+                kdMemcpy(mask, nodecpus, sizeof(mask));
+                pin = KD_TRUE;
+            }
+        }
+    }
+    if(pin)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for(KDint cpu = 0; cpu < __KD_CPU_WORDS * 64 && cpu < CPU_SETSIZE; cpu++)
+        {
+            if(mask[cpu / 64] & (1ULL << (cpu % 64)))
+            {
+                CPU_SET(cpu, &set);
+            }
+        }
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+
+    if(attr->schedpolicy == KD_THREAD_SCHED_REALTIME_VEN)
+    {
+        struct sched_param param;
+        kdMemset(&param, 0, sizeof(param));
+        param.sched_priority = attr->schedpriority;
+        if(sched_setscheduler(0, SCHED_FIFO, &param) != 0)
+        {
+            /* Without CAP_SYS_NICE use the best nice value RLIMIT_NICE allows. */
+            struct rlimit limit;
+            if(getrlimit(RLIMIT_NICE, &limit) == 0)
+            {
+                KDint nice = 20 - (KDint)((limit.rlim_cur > 40) ? 40 : limit.rlim_cur);
+                if(nice < 0)
+                {
+                    setpriority(PRIO_PROCESS, 0, nice);
+                }
+            }
+        }
+    }
+    else if(attr->schedpriority != 0)
+    {
+        /* Linux applies this to the calling thread only. */
+        setpriority(PRIO_PROCESS, 0, attr->schedpriority);
+    }
+#elif defined(KD_THREAD_WIN32)
+    if(attr->affinitywords > 0)
+    {
+        SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)attr->affinity[0]);
+    }
+    KDint priority = THREAD_PRIORITY_NORMAL;
+    if(attr->schedpolicy == KD_THREAD_SCHED_REALTIME_VEN)
+    {
+        priority = THREAD_PRIORITY_TIME_CRITICAL;
+    }
+    else if(attr->schedpriority <= -15)
+    {
+        priority = THREAD_PRIORITY_HIGHEST;
+    }
+    else if(attr->schedpriority < 0)
+    {
+        priority = THREAD_PRIORITY_ABOVE_NORMAL;
+    }
+    else if(attr->schedpriority >= 10)
+    {
+        priority = THREAD_PRIORITY_LOWEST;
+    }
+    else if(attr->schedpriority > 0)
+    {
+        priority = THREAD_PRIORITY_BELOW_NORMAL;
+    }
+    SetThreadPriority(GetCurrentThread(), priority);
+#elif defined(KD_THREAD_POSIX)
+    if(attr->schedpolicy == KD_THREAD_SCHED_REALTIME_VEN)
+    {
+        struct sched_param param;
+        kdMemset(&param, 0, sizeof(param));
+        param.sched_priority = attr->schedpriority;
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    }
+#else
+    /* cppcheck-suppress unreadVariable */
+    KD_UNUSED const KDThreadAttr *dummyattr = attr;
+#endif
+}
+#endif
+
 /* kdThreadCreate: Create a new thread. */
 struct _KDThreadInternal {
 #if defined(KD_THREAD_C11)
@@ -205,20 +457,57 @@ KDThread *__kdThreadInit(void)
         return KD_NULL;
     }
     thread->internal = (_KDThreadInternal *)kdMalloc(sizeof(_KDThreadInternal));
-    thread->eventqueue = __kdQueueCreate(64);
-    if(thread->eventqueue == KD_NULL)
+    for(KDint i = 0; i < __KD_EVENT_LANES; i++)
     {
-        kdFree(thread);
-        kdSetError(KD_EAGAIN);
-        return KD_NULL;
+        thread->starved[i] = 0;
+        thread->eventqueue[i] = __kdQueueCreate(__KD_EVENT_QUEUE_SIZE);
+        if(thread->eventqueue[i] == KD_NULL)
+        {
+            while(i-- > 0)
+            {
+                __kdQueueFree(thread->eventqueue[i]);
+            }
+            kdFree(thread->internal);
+            kdFree(thread);
+            kdSetError(KD_EAGAIN);
+            return KD_NULL;
+        }
     }
     thread->lastevent = KD_NULL;
     thread->lasterror = 0;
     thread->callbackindex = 0;
+    thread->logring = KD_NULL;
+    thread->fibers = KD_NULL;
+    thread->continuations = kdAtomicPtrCreateVEN(KD_NULL);
+    thread->coalesced = KD_NULL;
+    thread->coalescedcount[0] = 0;
+    thread->coalescedcount[1] = 0;
+    thread->coalescetypes = 0;
+    thread->coalescedlane = 0;
+    thread->tracefile = KD_NULL;
+    thread->reactor = __kdReactorCreate();
+    thread->schedule = __kdEventScheduleCreate();
     thread->callbacks = (_KDCallback **)kdMalloc(sizeof(_KDCallback *));
-    if(thread->callbacks == KD_NULL)
+    if(thread->continuations == KD_NULL || thread->reactor == KD_NULL || thread->schedule == KD_NULL || thread->callbacks == KD_NULL)
     {
-        __kdQueueFree(thread->eventqueue);
+        if(thread->continuations)
+        {
+            kdAtomicPtrFreeVEN(thread->continuations);
+        }
+        if(thread->reactor)
+        {
+            __kdReactorFree(thread->reactor);
+        }
+        if(thread->schedule)
+        {
+            __kdEventScheduleFree(thread->schedule);
+        }
+        kdFree(thread->callbacks);
+        for(KDint i = 0; i < __KD_EVENT_LANES; i++)
+        {
+            __kdQueueFree(thread->eventqueue[i]);
+        }
+        kdFree(thread->internal);
         kdFree(thread);
         kdSetError(KD_EAGAIN);
         return KD_NULL;
@@ -228,6 +517,16 @@ KDThread *__kdThreadInit(void)
 
 void __kdThreadFree(KDThread *thread)
 {
+    __kdLogRingRelease(thread->logring);
+    __kdFiberSchedulerFree(thread->fibers);
+    __kdFutureRunContinuations(thread, KD_FALSE);
+    kdAtomicPtrFreeVEN(thread->continuations);
+    __kdReactorFree(thread->reactor);
+    __kdEventScheduleFree(thread->schedule);
+    if(thread->tracefile)
+    {
+        kdFclose(thread->tracefile);
+    }
     for(KDint i = 0; i < thread->callbackindex; i++)
     {
         kdFree(thread->callbacks[i]);
@@ -237,11 +536,18 @@ void __kdThreadFree(KDThread *thread)
     {
         kdFreeEvent(thread->lastevent);
     }
-    while(__kdQueueSize(thread->eventqueue) > 0)
+    if(thread->coalesced)
+    {
+        kdFreeEvent(thread->coalesced);
+    }
+    for(KDint i = 0; i < __KD_EVENT_LANES; i++)
     {
-        kdFreeEvent((KDEvent *)__kdQueuePull(thread->eventqueue));
+        while(__kdQueueSize(thread->eventqueue[i]) > 0)
+        {
+            kdFreeEvent((KDEvent *)__kdQueuePull(thread->eventqueue[i]));
+        }
+        __kdQueueFree(thread->eventqueue[i]);
     }
-    __kdQueueFree(thread->eventqueue);
     kdFree(thread->internal);
     kdFree(thread);
 }
@@ -253,6 +559,18 @@ void __kdThreadInitOnce(void)
     __kd_threadlocal = kdMapThreadStorageKHR(&__kd_threadlocal);
 }
 
+#if defined(KD_THREAD_LOCAL)
+static KD_THREAD_LOCAL KDThread *__kd_threadself = KD_NULL;
+#endif
+void __kdThreadSetSelf(KDThread *thread)
+{
+#if defined(KD_THREAD_LOCAL)
+    __kd_threadself = thread;
+#else
+    kdSetThreadStorageKHR(__kd_threadlocal, thread);
+#endif
+}
+
 #if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX) || defined(KD_THREAD_WIN32)
 static void *__kdThreadRun(void *init)
 {
@@ -312,8 +630,13 @@ static void *__kdThreadRun(void *init)
     pthread_setname_np(threadname);
 #endif
 
-    kdSetThreadStorageKHR(__kd_threadlocal, thread);
+    __kdThreadSetSelf(thread);
+    if(thread->internal->attr)
+    {
+        __kdThreadApplyAttr(thread->internal->attr);
+    }
     void *result = thread->internal->start_routine(thread->internal->arg);
+    __kdThreadStorageExit();
     if(thread->internal->attr && thread->internal->attr->detachstate == KD_THREAD_CREATE_DETACHED)
     {
         __kdThreadFree(thread);
@@ -476,7 +799,11 @@ KD_API KDint KD_APIENTRY kdThreadDetach(KDThread *thread)
 /* kdThreadSelf: Return calling thread's ID. */
 KD_API KDThread *KD_APIENTRY kdThreadSelf(void)
 {
+#if defined(KD_THREAD_LOCAL)
+    return __kd_threadself;
+#else
     return kdGetThreadStorageKHR(__kd_threadlocal);
+#endif
 }
 
 /* kdThreadOnce: Wrap initialization code so it is executed only once. */
@@ -511,6 +838,87 @@ KD_API KDint KD_APIENTRY kdThreadOnce(KDThreadOnce *once_control, void (*init_ro
 }
 #endif /* ndef KD_NO_STATIC_DATA */
 
+/* Hint to the processor that this is a spin loop. */
+static void __kdCpuRelax(void)
+{
+#if(defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_ia32_pause();
+#elif(defined(__aarch64__) || defined(__arm__)) && (defined(__GNUC__) || defined(__clang__))
+    __asm__ __volatile__("yield" ::: "memory");
+#elif defined(_MSC_VER)
+    YieldProcessor();
+#endif
+}
+
+#if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX)
+/* Advance a timespec by nanoseconds. */
+static void __kdTimespecAddUST(struct timespec *ts, KDust ns)
+{
+    ns += ts->tv_nsec;
+    ts->tv_sec += (time_t)(ns / 1000000000);
+    ts->tv_nsec = (long)(ns % 1000000000);
+}
+#endif
+
+/******************************************************************************
+ * Futexes
+ *
+ * Notes:
+ * - Mutex states follow "Futexes Are Tricky" (Drepper): 0 unlocked, 1 locked,
+ *   2 locked with possible sleepers. Only unlocking a contended mutex wakes.
+ * - A zeroed word is a valid unlocked mutex, so static mutexes need no setup.
+ * - Contended locks spin for about as long as the lock recently stayed held
+ *   before sleeping. The estimate is kept per mutex.
+ * - Spinning cannot help on a single processor and is skipped there.
+ ******************************************************************************/
+
+#if defined(KD_THREAD_FUTEX)
+#define __KD_FUTEX_UNLOCKED 0U
+#define __KD_FUTEX_LOCKED 1U
+#define __KD_FUTEX_CONTENDED 2U
+#define __KD_FUTEX_SPIN_MAX 100U
+
+/* Upper bound for spinning, zero on uniprocessors. */
+static KDuint32 __kd_futexspin = KDUINT32_MAX;
+static KDuint32 __kdFutexSpinMax(void)
+{
+    KDuint32 spin = __atomic_load_n(&__kd_futexspin, __ATOMIC_RELAXED);
+    if(spin == KDUINT32_MAX)
+    {
+        spin = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? __KD_FUTEX_SPIN_MAX : 0;
+        __atomic_store_n(&__kd_futexspin, spin, __ATOMIC_RELAXED);
+    }
+    return spin;
+}
+
+static void __kdFutexWait(KDuint32 *addr, KDuint32 val)
+{
+    __kdFutex(addr, FUTEX_WAIT_PRIVATE, val, KD_NULL);
+}
+
+/* Returns -1 once the deadline passed, 0 after any other wakeup. */
+static KDint __kdFutexWaitUntil(KDuint32 *addr, KDuint32 val, KDust deadline)
+{
+    KDust now = kdGetTimeUST();
+    if(now >= deadline)
+    {
+        return -1;
+    }
+    struct timespec ts = {0, 0};
+    __kdTimespecAddUST(&ts, deadline - now);
+    if(__kdFutex(addr, FUTEX_WAIT_PRIVATE, val, &ts) == -1 && errno == ETIMEDOUT)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+static void __kdFutexWake(KDuint32 *addr, KDint count)
+{
+    __kdFutex(addr, FUTEX_WAKE_PRIVATE, (KDuint32)count, KD_NULL);
+}
+#endif
+
 /* kdThreadMutexCreate: Create a mutex. */
 typedef struct _KDMutexAttr _KDMutexAttr;
 struct _KDMutexAttr {
@@ -518,7 +926,10 @@ struct _KDMutexAttr {
     KDThreadMutex *staticmutex;
 };
 struct KDThreadMutex {
-#if defined(KD_THREAD_C11)
+#if defined(KD_THREAD_FUTEX)
+    KDuint32 state;
+    KDuint32 spin;
+#elif defined(KD_THREAD_C11)
     mtx_t nativemutex;
 #elif defined(KD_THREAD_POSIX)
     pthread_mutex_t nativemutex;
@@ -541,6 +952,10 @@ KD_API KDThreadMutex *KD_APIENTRY kdThreadMutexCreate(const void *mutexattr)
     else
     {
         mutex = (KDThreadMutex *)kdMalloc(sizeof(KDThreadMutex));
+        if(mutex)
+        {
+            mutex->mutexattr = KD_NULL;
+        }
     }
     if(mutex == KD_NULL)
     {
@@ -548,7 +963,10 @@ KD_API KDThreadMutex *KD_APIENTRY kdThreadMutexCreate(const void *mutexattr)
         return KD_NULL;
     }
     KDint error = 0;
-#if defined(KD_THREAD_C11)
+#if defined(KD_THREAD_FUTEX)
+    mutex->state = __KD_FUTEX_UNLOCKED;
+    mutex->spin = 0;
+#elif defined(KD_THREAD_C11)
     error = mtx_init((mtx_t *)&mutex->nativemutex, mtx_plain);
 #elif defined(KD_THREAD_POSIX)
     error = pthread_mutex_init((pthread_mutex_t *)&mutex->nativemutex, KD_NULL);
@@ -586,8 +1004,9 @@ KD_API KDint KD_APIENTRY kdThreadMutexFree(KDThreadMutex *mutex)
 {
     if(mutex)
     {
-/* No need to free anything on WIN32*/
-#if defined(KD_THREAD_C11)
+/* No need to free anything on WIN32 or with futexes */
+#if defined(KD_THREAD_FUTEX)
+#elif defined(KD_THREAD_C11)
         mtx_destroy((mtx_t *)&mutex->nativemutex);
 #elif defined(KD_THREAD_POSIX)
         pthread_mutex_destroy((pthread_mutex_t *)&mutex->nativemutex);
@@ -602,10 +1021,53 @@ KD_API KDint KD_APIENTRY kdThreadMutexFree(KDThreadMutex *mutex)
     return 0;
 }
 
+#if defined(KD_THREAD_FUTEX)
+/* Take the mutex and leave it marked as contended. */
+static void __kdFutexMutexLockContended(KDThreadMutex *mutex)
+{
+    while(__atomic_exchange_n(&mutex->state, __KD_FUTEX_CONTENDED, __ATOMIC_ACQUIRE) != __KD_FUTEX_UNLOCKED)
+    {
+        __kdFutexWait(&mutex->state, __KD_FUTEX_CONTENDED);
+    }
+}
+
+static void __kdFutexMutexLockSlow(KDThreadMutex *mutex)
+{
+    KDuint32 spin = __atomic_load_n(&mutex->spin, __ATOMIC_RELAXED);
+    KDuint32 limit = (KDuint32)kdMinVEN((KDint)(spin * 2 + 10), (KDint)__kdFutexSpinMax());
+    KDuint32 count = 0;
+    KDboolean locked = KD_FALSE;
+    while(count < limit)
+    {
+        count++;
+        __kdCpuRelax();
+        KDuint32 expected = __KD_FUTEX_UNLOCKED;
+        if(__atomic_load_n(&mutex->state, __ATOMIC_RELAXED) == __KD_FUTEX_UNLOCKED &&
+            __atomic_compare_exchange_n(&mutex->state, &expected, __KD_FUTEX_LOCKED, KD_FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            locked = KD_TRUE;
+            break;
+        }
+    }
+    /* Moving average of the spins needed, giving up counts as the limit. */
+    __atomic_store_n(&mutex->spin, (KDuint32)((KDint32)spin + ((KDint32)count - (KDint32)spin) / 8), __ATOMIC_RELAXED);
+    if(!locked)
+    {
+        __kdFutexMutexLockContended(mutex);
+    }
+}
+#endif
+
 /* kdThreadMutexLock: Lock a mutex. */
 KD_API KDint KD_APIENTRY kdThreadMutexLock(KDThreadMutex *mutex)
 {
-#if defined(KD_THREAD_C11)
+#if defined(KD_THREAD_FUTEX)
+    KDuint32 expected = __KD_FUTEX_UNLOCKED;
+    if(!__atomic_compare_exchange_n(&mutex->state, &expected, __KD_FUTEX_LOCKED, KD_FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        __kdFutexMutexLockSlow(mutex);
+    }
+#elif defined(KD_THREAD_C11)
     mtx_lock((mtx_t *)&mutex->nativemutex);
 #elif defined(KD_THREAD_POSIX)
     pthread_mutex_lock((pthread_mutex_t *)&mutex->nativemutex);
@@ -617,10 +1079,40 @@ KD_API KDint KD_APIENTRY kdThreadMutexLock(KDThreadMutex *mutex)
     return 0;
 }
 
+/* kdThreadMutexTryLockVEN: Lock a mutex if it is not held. */
+KD_API KDint KD_APIENTRY kdThreadMutexTryLockVEN(KDThreadMutex *mutex)
+{
+    KDboolean locked = KD_FALSE;
+#if defined(KD_THREAD_FUTEX)
+    KDuint32 expected = __KD_FUTEX_UNLOCKED;
+    locked = __atomic_compare_exchange_n(&mutex->state, &expected, __KD_FUTEX_LOCKED, KD_FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+#elif defined(KD_THREAD_C11)
+    locked = (mtx_trylock((mtx_t *)&mutex->nativemutex) == thrd_success);
+#elif defined(KD_THREAD_POSIX)
+    locked = (pthread_mutex_trylock((pthread_mutex_t *)&mutex->nativemutex) == 0);
+#elif defined(KD_THREAD_WIN32)
+    locked = TryAcquireSRWLockExclusive((SRWLOCK *)&mutex->nativemutex) ? KD_TRUE : KD_FALSE;
+#else
+    locked = !mutex->nativemutex;
+    mutex->nativemutex = KD_TRUE;
+#endif
+    if(!locked)
+    {
+        kdSetError(KD_EBUSY);
+        return -1;
+    }
+    return 0;
+}
+
 /* kdThreadMutexUnlock: Unlock a mutex. */
 KD_API KDint KD_APIENTRY kdThreadMutexUnlock(KDThreadMutex *mutex)
 {
-#if defined(KD_THREAD_C11)
+#if defined(KD_THREAD_FUTEX)
+    if(__atomic_exchange_n(&mutex->state, __KD_FUTEX_UNLOCKED, __ATOMIC_RELEASE) == __KD_FUTEX_CONTENDED)
+    {
+        __kdFutexWake(&mutex->state, 1);
+    }
+#elif defined(KD_THREAD_C11)
     mtx_unlock((mtx_t *)&mutex->nativemutex);
 #elif defined(KD_THREAD_POSIX)
     pthread_mutex_unlock((pthread_mutex_t *)&mutex->nativemutex);
@@ -634,7 +1126,11 @@ KD_API KDint KD_APIENTRY kdThreadMutexUnlock(KDThreadMutex *mutex)
 
 /* kdThreadCondCreate: Create a condition variable. */
 struct KDThreadCond {
-#if defined(KD_THREAD_C11)
+#if defined(KD_THREAD_FUTEX)
+    /* Bumped by every signal, waiters sleep while it is unchanged. */
+    KDuint32 sequence;
+    KDuint32 waiters;
+#elif defined(KD_THREAD_C11)
     cnd_t nativecond;
 #elif defined(KD_THREAD_POSIX)
     pthread_cond_t nativecond;
@@ -663,7 +1159,10 @@ KD_API KDThreadCond *KD_APIENTRY kdThreadCondCreate(KD_UNUSED const void *attr)
             return KD_NULL;
         }
         KDint error = 0;
-#if defined(KD_THREAD_C11)
+#if defined(KD_THREAD_FUTEX)
+        cond->sequence = 0;
+        cond->waiters = 0;
+#elif defined(KD_THREAD_C11)
         error = cnd_init(&cond->nativecond);
         if(error == thrd_nomem)
         {
@@ -695,8 +1194,9 @@ KD_API KDThreadCond *KD_APIENTRY kdThreadCondCreate(KD_UNUSED const void *attr)
 /* kdThreadCondFree: Free a condition variable. */
 KD_API KDint KD_APIENTRY kdThreadCondFree(KDThreadCond *cond)
 {
-/* No need to free anything on WIN32*/
-#if defined(KD_THREAD_C11)
+/* No need to free anything on WIN32 or with futexes */
+#if defined(KD_THREAD_FUTEX)
+#elif defined(KD_THREAD_C11)
     cnd_destroy(&cond->nativecond);
 #elif defined(KD_THREAD_POSIX)
     pthread_cond_destroy(&cond->nativecond);
@@ -708,7 +1208,13 @@ KD_API KDint KD_APIENTRY kdThreadCondFree(KDThreadCond *cond)
 /* kdThreadCondSignal, kdThreadCondBroadcast: Signal a condition variable. */
 KD_API KDint KD_APIENTRY kdThreadCondSignal(KDThreadCond *cond)
 {
-#if defined(KD_THREAD_C11)
+#if defined(KD_THREAD_FUTEX)
+    __atomic_fetch_add(&cond->sequence, 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&cond->waiters, __ATOMIC_SEQ_CST) > 0)
+    {
+        __kdFutexWake(&cond->sequence, 1);
+    }
+#elif defined(KD_THREAD_C11)
     cnd_signal(&cond->nativecond);
 #elif defined(KD_THREAD_POSIX)
     pthread_cond_signal(&cond->nativecond);
@@ -724,7 +1230,13 @@ KD_API KDint KD_APIENTRY kdThreadCondSignal(KDThreadCond *cond)
 
 KD_API KDint KD_APIENTRY kdThreadCondBroadcast(KDThreadCond *cond)
 {
-#if defined(KD_THREAD_C11)
+#if defined(KD_THREAD_FUTEX)
+    __atomic_fetch_add(&cond->sequence, 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&cond->waiters, __ATOMIC_SEQ_CST) > 0)
+    {
+        __kdFutexWake(&cond->sequence, KDINT_MAX);
+    }
+#elif defined(KD_THREAD_C11)
     cnd_broadcast(&cond->nativecond);
 #elif defined(KD_THREAD_POSIX)
     pthread_cond_broadcast(&cond->nativecond);
@@ -741,7 +1253,15 @@ KD_API KDint KD_APIENTRY kdThreadCondBroadcast(KDThreadCond *cond)
 /* kdThreadCondWait: Wait for a condition variable to be signalled. */
 KD_API KDint KD_APIENTRY kdThreadCondWait(KDThreadCond *cond, KDThreadMutex *mutex)
 {
-#if defined(KD_THREAD_C11)
+#if defined(KD_THREAD_FUTEX)
+    __atomic_fetch_add(&cond->waiters, 1, __ATOMIC_SEQ_CST);
+    KDuint32 sequence = __atomic_load_n(&cond->sequence, __ATOMIC_SEQ_CST);
+    kdThreadMutexUnlock(mutex);
+    __kdFutexWait(&cond->sequence, sequence);
+    __atomic_fetch_sub(&cond->waiters, 1, __ATOMIC_SEQ_CST);
+    /* Other woken waiters may queue up on the mutex behind us. */
+    __kdFutexMutexLockContended(mutex);
+#elif defined(KD_THREAD_C11)
     cnd_wait(&cond->nativecond, (mtx_t *)&mutex->nativemutex);
 #elif defined(KD_THREAD_POSIX)
     pthread_cond_wait(&cond->nativecond, (pthread_mutex_t *)&mutex->nativemutex);
@@ -757,24 +1277,80 @@ KD_API KDint KD_APIENTRY kdThreadCondWait(KDThreadCond *cond, KDThreadMutex *mut
     return 0;
 }
 
-/* kdThreadSemCreate: Create a semaphore. */
-struct KDThreadSem {
-    KDThreadMutex *mutex;
-#if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX) || defined(KD_THREAD_WIN32)
-    KDThreadCond *condition;
-#endif
-    KDuint count;
-    KDint8 padding[4];
-};
-KD_API KDThreadSem *KD_APIENTRY kdThreadSemCreate(KDuint value)
+/* kdThreadCondTimedWaitVEN: Wait for a condition variable until a deadline in kdGetTimeUST time. */
+KD_API KDint KD_APIENTRY kdThreadCondTimedWaitVEN(KDThreadCond *cond, KDThreadMutex *mutex, KDust deadline)
 {
-    KDThreadSem *sem = (KDThreadSem *)kdMalloc(sizeof(KDThreadSem));
+    KDboolean timedout = KD_FALSE;
+#if defined(KD_THREAD_FUTEX)
+    __atomic_fetch_add(&cond->waiters, 1, __ATOMIC_SEQ_CST);
+    KDuint32 sequence = __atomic_load_n(&cond->sequence, __ATOMIC_SEQ_CST);
+    kdThreadMutexUnlock(mutex);
+    timedout = (__kdFutexWaitUntil(&cond->sequence, sequence, deadline) == -1);
+    __atomic_fetch_sub(&cond->waiters, 1, __ATOMIC_SEQ_CST);
+    __kdFutexMutexLockContended(mutex);
+#elif defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX) || defined(KD_THREAD_WIN32)
+    KDust now = kdGetTimeUST();
+    KDust remaining = (deadline > now) ? deadline - now : 0;
+#if defined(KD_THREAD_C11)
+    /* The native clocks are realtime, only the remaining time carries over. */
+    struct timespec ts = {0, 0};
+    timespec_get(&ts, TIME_UTC);
+    __kdTimespecAddUST(&ts, remaining);
+    timedout = (cnd_timedwait(&cond->nativecond, (mtx_t *)&mutex->nativemutex, &ts) == thrd_timedout);
+#elif defined(KD_THREAD_POSIX)
+    struct timespec ts = {0, 0};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    __kdTimespecAddUST(&ts, remaining);
+    timedout = (pthread_cond_timedwait(&cond->nativecond, (pthread_mutex_t *)&mutex->nativemutex, &ts) == ETIMEDOUT);
+#elif defined(KD_THREAD_WIN32)
+    DWORD milliseconds = (DWORD)((remaining + 999999) / 1000000);
+    timedout = (!SleepConditionVariableSRW(&cond->nativecond, (SRWLOCK *)&mutex->nativemutex, milliseconds, 0) && GetLastError() == ERROR_TIMEOUT);
+#endif
+#else
+    /* cppcheck-suppress unreadVariable */
+    KD_UNUSED KDThreadCond *dummycond = cond;
+    /* cppcheck-suppress unreadVariable */
+    KD_UNUSED KDThreadMutex *dummymutex = mutex;
+    /* cppcheck-suppress unreadVariable */
+    KD_UNUSED KDust dummydeadline = deadline;
+    kdAssert(0);
+#endif
+    if(timedout)
+    {
+        kdSetError(KD_ETIMEDOUT);
+        return -1;
+    }
+    return 0;
+}
+
+/* kdThreadSemCreate: Create a semaphore. */
+struct KDThreadSem {
+#if defined(KD_THREAD_FUTEX)
+    KDuint32 count;
+    KDuint32 waiters;
+#else
+    KDThreadMutex *mutex;
+#if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX) || defined(KD_THREAD_WIN32)
+    KDThreadCond *condition;
+#endif
+    KDuint count;
+    KDint8 padding[4];
+#endif
+};
+KD_API KDThreadSem *KD_APIENTRY kdThreadSemCreate(KDuint value)
+{
+    KDThreadSem *sem = (KDThreadSem *)kdMalloc(sizeof(KDThreadSem));
     if(sem == KD_NULL)
     {
         kdSetError(KD_ENOSPC);
         return KD_NULL;
     }
 
+#if defined(KD_THREAD_FUTEX)
+    sem->count = value;
+    sem->waiters = 0;
+    return sem;
+#else
     sem->mutex = kdThreadMutexCreate(KD_NULL);
     if(sem->mutex == KD_NULL)
     {
@@ -797,22 +1373,61 @@ KD_API KDThreadSem *KD_APIENTRY kdThreadSemCreate(KDuint value)
     }
 #endif
     return sem;
+#endif
 }
 
 /* kdThreadSemFree: Free a semaphore. */
 KD_API KDint KD_APIENTRY kdThreadSemFree(KDThreadSem *sem)
 {
+#if !defined(KD_THREAD_FUTEX)
     kdThreadMutexFree(sem->mutex);
 #if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX) || defined(KD_THREAD_WIN32)
     kdThreadCondFree(sem->condition);
+#endif
 #endif
     kdFree(sem);
     return 0;
 }
 
+#if defined(KD_THREAD_FUTEX)
+static KDboolean __kdFutexSemTryWait(KDThreadSem *sem)
+{
+    KDuint32 count = __atomic_load_n(&sem->count, __ATOMIC_SEQ_CST);
+    while(count > 0)
+    {
+        if(__atomic_compare_exchange_n(&sem->count, &count, count - 1, KD_TRUE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            return KD_TRUE;
+        }
+    }
+    return KD_FALSE;
+}
+#endif
+
 /* kdThreadSemWait: Lock a semaphore. */
 KD_API KDint KD_APIENTRY kdThreadSemWait(KDThreadSem *sem)
 {
+#if defined(KD_THREAD_FUTEX)
+    if(__kdFutexSemTryWait(sem))
+    {
+        return 0;
+    }
+    KDuint32 limit = __kdFutexSpinMax();
+    for(KDuint32 i = 0; i < limit; i++)
+    {
+        __kdCpuRelax();
+        if(__atomic_load_n(&sem->count, __ATOMIC_RELAXED) > 0 && __kdFutexSemTryWait(sem))
+        {
+            return 0;
+        }
+    }
+    __atomic_fetch_add(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+    while(!__kdFutexSemTryWait(sem))
+    {
+        __kdFutexWait(&sem->count, 0);
+    }
+    __atomic_fetch_sub(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+#else
     kdThreadMutexLock(sem->mutex);
 #if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX) || defined(KD_THREAD_WIN32)
     while(sem->count == 0)
@@ -822,39 +1437,594 @@ KD_API KDint KD_APIENTRY kdThreadSemWait(KDThreadSem *sem)
 #endif
     --sem->count;
     kdThreadMutexUnlock(sem->mutex);
+#endif
+    return 0;
+}
+
+/* kdThreadSemTryWaitVEN: Lock a semaphore if its value is above zero. */
+KD_API KDint KD_APIENTRY kdThreadSemTryWaitVEN(KDThreadSem *sem)
+{
+    KDboolean locked = KD_FALSE;
+#if defined(KD_THREAD_FUTEX)
+    locked = __kdFutexSemTryWait(sem);
+#else
+    kdThreadMutexLock(sem->mutex);
+    if(sem->count > 0)
+    {
+        --sem->count;
+        locked = KD_TRUE;
+    }
+    kdThreadMutexUnlock(sem->mutex);
+#endif
+    if(!locked)
+    {
+        kdSetError(KD_EBUSY);
+        return -1;
+    }
+    return 0;
+}
+
+/* kdThreadSemTimedWaitVEN: Lock a semaphore, giving up at a deadline in kdGetTimeUST time. */
+KD_API KDint KD_APIENTRY kdThreadSemTimedWaitVEN(KDThreadSem *sem, KD_UNUSED KDust deadline)
+{
+    KDboolean locked = KD_TRUE;
+#if defined(KD_THREAD_FUTEX)
+    if(__kdFutexSemTryWait(sem))
+    {
+        return 0;
+    }
+    __atomic_fetch_add(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+    while(!__kdFutexSemTryWait(sem))
+    {
+        if(__kdFutexWaitUntil(&sem->count, 0, deadline) == -1)
+        {
+            locked = __kdFutexSemTryWait(sem);
+            break;
+        }
+    }
+    __atomic_fetch_sub(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+#else
+    kdThreadMutexLock(sem->mutex);
+#if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX) || defined(KD_THREAD_WIN32)
+    while(sem->count == 0)
+    {
+        if(kdThreadCondTimedWaitVEN(sem->condition, sem->mutex, deadline) == -1)
+        {
+            break;
+        }
+    }
+#endif
+    if(sem->count > 0)
+    {
+        --sem->count;
+    }
+    else
+    {
+        locked = KD_FALSE;
+    }
+    kdThreadMutexUnlock(sem->mutex);
+#endif
+    if(!locked)
+    {
+        kdSetError(KD_ETIMEDOUT);
+        return -1;
+    }
     return 0;
 }
 
 /* kdThreadSemPost: Unlock a semaphore. */
 KD_API KDint KD_APIENTRY kdThreadSemPost(KDThreadSem *sem)
 {
+#if defined(KD_THREAD_FUTEX)
+    __atomic_fetch_add(&sem->count, 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&sem->waiters, __ATOMIC_SEQ_CST) > 0)
+    {
+        __kdFutexWake(&sem->count, 1);
+    }
+#else
     kdThreadMutexLock(sem->mutex);
     ++sem->count;
 #if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX) || defined(KD_THREAD_WIN32)
     kdThreadCondSignal(sem->condition);
 #endif
     kdThreadMutexUnlock(sem->mutex);
+#endif
     return 0;
 }
 
-/* kdThreadSleepVEN: Blocks the current thread for nanoseconds. */
-KD_API KDint KD_APIENTRY kdThreadSleepVEN(KDust timeout)
+/* kdThreadRWLockCreateVEN: Create a reader-writer lock. */
+#if defined(KD_THREAD_FUTEX)
+/* Readers count in one of several cache lines picked per thread, a writer
+ * announces itself and then waits for all of them to drain. */
+#define __KD_RWLOCK_SLOTS 16
+#define __KD_RWLOCK_PENDING 1U
+#define __KD_RWLOCK_HELD 2U
+typedef struct _KDRWLockSlot _KDRWLockSlot;
+struct _KDRWLockSlot {
+    KDuint32 readers;
+    KDint8 padding[60];
+};
+#if defined(KD_THREAD_LOCAL)
+static KDuint32 __kd_rwlockslots = 0;
+static KD_THREAD_LOCAL KDuint32 __kd_rwlockslot = KDUINT32_MAX;
+#endif
+#endif
+struct KDThreadRWLockVEN {
+#if defined(KD_THREAD_FUTEX)
+    _KDRWLockSlot *slots;
+    KDThreadMutex writelock;
+    /* Readers sleep on writer, a pending writer sleeps on drain. */
+    KDuint32 writer;
+    KDuint32 waiting;
+    KDuint32 drain;
+    KDint8 padding[4];
+#elif defined(KD_THREAD_POSIX)
+    pthread_rwlock_t nativerwlock;
+#elif defined(KD_THREAD_WIN32)
+    SRWLOCK nativerwlock;
+#else
+    KDThreadMutex *mutex;
+    KDThreadCond *readcond;
+    KDThreadCond *writecond;
+    KDuint readers;
+    KDuint writers;
+    KDboolean writer;
+#if KDSIZE_MAX == KDUINT64_MAX
+    KDint8 padding[4];
+#endif
+#endif
+};
+KD_API KDThreadRWLockVEN *KD_APIENTRY kdThreadRWLockCreateVEN(void)
 {
-#if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX)
-    struct timespec ts;
-    kdMemset(&ts, 0, sizeof(ts));
-    /* Determine seconds from the overall nanoseconds */
-    if((timeout % 1000000000) == 0)
+#if defined(KD_THREAD_FUTEX)
+    /* The slots follow the lock, aligned to a cache line. */
+    KDThreadRWLockVEN *rwlock = (KDThreadRWLockVEN *)kdMalloc(sizeof(KDThreadRWLockVEN) + sizeof(_KDRWLockSlot) * (__KD_RWLOCK_SLOTS + 1));
+    if(rwlock == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    KDuintptr slots = ((KDuintptr)(rwlock + 1) + sizeof(_KDRWLockSlot) - 1) & ~(KDuintptr)(sizeof(_KDRWLockSlot) - 1);
+    rwlock->slots = (_KDRWLockSlot *)slots;
+    kdMemset(rwlock->slots, 0, sizeof(_KDRWLockSlot) * __KD_RWLOCK_SLOTS);
+    rwlock->writelock.state = __KD_FUTEX_UNLOCKED;
+    rwlock->writelock.spin = 0;
+    rwlock->writelock.mutexattr = KD_NULL;
+    rwlock->writer = 0;
+    rwlock->waiting = 0;
+    rwlock->drain = 0;
+    return rwlock;
+#else
+    KDThreadRWLockVEN *rwlock = (KDThreadRWLockVEN *)kdMalloc(sizeof(KDThreadRWLockVEN));
+    if(rwlock == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+#if defined(KD_THREAD_POSIX)
+    KDint error = pthread_rwlock_init(&rwlock->nativerwlock, KD_NULL);
+    if(error != 0)
     {
-        ts.tv_sec = (time_t)(timeout / 1000000000);
+        kdSetError(error == ENOMEM ? KD_ENOMEM : KD_EAGAIN);
+        kdFree(rwlock);
+        return KD_NULL;
+    }
+#elif defined(KD_THREAD_WIN32)
+    InitializeSRWLock(&rwlock->nativerwlock);
+#else
+    rwlock->readers = 0;
+    rwlock->writers = 0;
+    rwlock->writer = KD_FALSE;
+    rwlock->mutex = kdThreadMutexCreate(KD_NULL);
+    rwlock->readcond = kdThreadCondCreate(KD_NULL);
+    rwlock->writecond = kdThreadCondCreate(KD_NULL);
+    if(rwlock->mutex == KD_NULL || rwlock->readcond == KD_NULL || rwlock->writecond == KD_NULL)
+    {
+        /* Keep KD_ENOSYS when there are no threads */
+        KDint error = kdGetError();
+        if(rwlock->writecond)
+        {
+            kdThreadCondFree(rwlock->writecond);
+        }
+        if(rwlock->readcond)
+        {
+            kdThreadCondFree(rwlock->readcond);
+        }
+        kdThreadMutexFree(rwlock->mutex);
+        kdFree(rwlock);
+        kdSetError(error == KD_ENOSYS ? KD_ENOSYS : KD_EAGAIN);
+        return KD_NULL;
+    }
+#endif
+    return rwlock;
+#endif
+}
+
+/* kdThreadRWLockFreeVEN: Free a reader-writer lock. */
+KD_API KDint KD_APIENTRY kdThreadRWLockFreeVEN(KDThreadRWLockVEN *rwlock)
+{
+#if defined(KD_THREAD_FUTEX)
+#elif defined(KD_THREAD_POSIX)
+    pthread_rwlock_destroy(&rwlock->nativerwlock);
+#elif !defined(KD_THREAD_WIN32)
+    kdThreadCondFree(rwlock->writecond);
+    kdThreadCondFree(rwlock->readcond);
+    kdThreadMutexFree(rwlock->mutex);
+#endif
+    kdFree(rwlock);
+    return 0;
+}
+
+#if defined(KD_THREAD_FUTEX)
+static _KDRWLockSlot *__kdRWLockSlot(KDThreadRWLockVEN *rwlock)
+{
+#if defined(KD_THREAD_LOCAL)
+    if(__kd_rwlockslot == KDUINT32_MAX)
+    {
+        __kd_rwlockslot = __atomic_fetch_add(&__kd_rwlockslots, 1, __ATOMIC_RELAXED) % __KD_RWLOCK_SLOTS;
+    }
+    return &rwlock->slots[__kd_rwlockslot];
+#else
+    /* Any value that stays the same for a thread will do. */
+    return &rwlock->slots[((KDuintptr)kdThreadSelf() / sizeof(KDThread)) % __KD_RWLOCK_SLOTS];
+#endif
+}
+
+/* Tell a pending writer that a reader left. */
+static void __kdRWLockDrain(KDThreadRWLockVEN *rwlock)
+{
+    if(__atomic_load_n(&rwlock->writer, __ATOMIC_SEQ_CST) == __KD_RWLOCK_PENDING)
+    {
+        __atomic_fetch_add(&rwlock->drain, 1, __ATOMIC_SEQ_CST);
+        __kdFutexWake(&rwlock->drain, 1);
+    }
+}
+#endif
+
+/* kdThreadRWLockReadLockVEN: Acquire a reader-writer lock for reading. */
+KD_API KDint KD_APIENTRY kdThreadRWLockReadLockVEN(KDThreadRWLockVEN *rwlock)
+{
+#if defined(KD_THREAD_FUTEX)
+    _KDRWLockSlot *slot = __kdRWLockSlot(rwlock);
+    for(;;)
+    {
+        __atomic_fetch_add(&slot->readers, 1, __ATOMIC_SEQ_CST);
+        if(__atomic_load_n(&rwlock->writer, __ATOMIC_SEQ_CST) == 0)
+        {
+            return 0;
+        }
+        /* Back off so waiting writers go first. */
+        __atomic_fetch_sub(&slot->readers, 1, __ATOMIC_SEQ_CST);
+        __kdRWLockDrain(rwlock);
+        __atomic_fetch_add(&rwlock->waiting, 1, __ATOMIC_SEQ_CST);
+        KDuint32 writer = __atomic_load_n(&rwlock->writer, __ATOMIC_SEQ_CST);
+        while(writer != 0)
+        {
+            __kdFutexWait(&rwlock->writer, writer);
+            writer = __atomic_load_n(&rwlock->writer, __ATOMIC_SEQ_CST);
+        }
+        __atomic_fetch_sub(&rwlock->waiting, 1, __ATOMIC_SEQ_CST);
+    }
+#elif defined(KD_THREAD_POSIX)
+    pthread_rwlock_rdlock(&rwlock->nativerwlock);
+#elif defined(KD_THREAD_WIN32)
+    AcquireSRWLockShared(&rwlock->nativerwlock);
+#else
+    kdThreadMutexLock(rwlock->mutex);
+    while(rwlock->writer || rwlock->writers > 0)
+    {
+        kdThreadCondWait(rwlock->readcond, rwlock->mutex);
+    }
+    rwlock->readers++;
+    kdThreadMutexUnlock(rwlock->mutex);
+#endif
+    return 0;
+}
+
+/* kdThreadRWLockReadUnlockVEN: Release a reader-writer lock held for reading. */
+KD_API KDint KD_APIENTRY kdThreadRWLockReadUnlockVEN(KDThreadRWLockVEN *rwlock)
+{
+#if defined(KD_THREAD_FUTEX)
+    __atomic_fetch_sub(&__kdRWLockSlot(rwlock)->readers, 1, __ATOMIC_SEQ_CST);
+    __kdRWLockDrain(rwlock);
+#elif defined(KD_THREAD_POSIX)
+    pthread_rwlock_unlock(&rwlock->nativerwlock);
+#elif defined(KD_THREAD_WIN32)
+    ReleaseSRWLockShared(&rwlock->nativerwlock);
+#else
+    kdThreadMutexLock(rwlock->mutex);
+    if(--rwlock->readers == 0 && rwlock->writers > 0)
+    {
+        kdThreadCondSignal(rwlock->writecond);
+    }
+    kdThreadMutexUnlock(rwlock->mutex);
+#endif
+    return 0;
+}
+
+/* kdThreadRWLockWriteLockVEN: Acquire a reader-writer lock for writing. */
+KD_API KDint KD_APIENTRY kdThreadRWLockWriteLockVEN(KDThreadRWLockVEN *rwlock)
+{
+#if defined(KD_THREAD_FUTEX)
+    kdThreadMutexLock(&rwlock->writelock);
+    __atomic_store_n(&rwlock->writer, __KD_RWLOCK_PENDING, __ATOMIC_SEQ_CST);
+    for(;;)
+    {
+        KDuint32 drain = __atomic_load_n(&rwlock->drain, __ATOMIC_SEQ_CST);
+        /* Counts may wrap in a slot, only the sum matters. */
+        KDuint32 readers = 0;
+        for(KDint i = 0; i < __KD_RWLOCK_SLOTS; i++)
+        {
+            readers += __atomic_load_n(&rwlock->slots[i].readers, __ATOMIC_SEQ_CST);
+        }
+        if(readers == 0)
+        {
+            break;
+        }
+        __kdFutexWait(&rwlock->drain, drain);
+    }
+    __atomic_store_n(&rwlock->writer, __KD_RWLOCK_HELD, __ATOMIC_SEQ_CST);
+#elif defined(KD_THREAD_POSIX)
+    pthread_rwlock_wrlock(&rwlock->nativerwlock);
+#elif defined(KD_THREAD_WIN32)
+    AcquireSRWLockExclusive(&rwlock->nativerwlock);
+#else
+    kdThreadMutexLock(rwlock->mutex);
+    rwlock->writers++;
+    while(rwlock->writer || rwlock->readers > 0)
+    {
+        kdThreadCondWait(rwlock->writecond, rwlock->mutex);
+    }
+    rwlock->writers--;
+    rwlock->writer = KD_TRUE;
+    kdThreadMutexUnlock(rwlock->mutex);
+#endif
+    return 0;
+}
+
+/* kdThreadRWLockWriteUnlockVEN: Release a reader-writer lock held for writing. */
+KD_API KDint KD_APIENTRY kdThreadRWLockWriteUnlockVEN(KDThreadRWLockVEN *rwlock)
+{
+#if defined(KD_THREAD_FUTEX)
+    __atomic_store_n(&rwlock->writer, 0, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&rwlock->waiting, __ATOMIC_SEQ_CST) > 0)
+    {
+        __kdFutexWake(&rwlock->writer, KDINT_MAX);
+    }
+    kdThreadMutexUnlock(&rwlock->writelock);
+#elif defined(KD_THREAD_POSIX)
+    pthread_rwlock_unlock(&rwlock->nativerwlock);
+#elif defined(KD_THREAD_WIN32)
+    ReleaseSRWLockExclusive(&rwlock->nativerwlock);
+#else
+    kdThreadMutexLock(rwlock->mutex);
+    rwlock->writer = KD_FALSE;
+    if(rwlock->writers > 0)
+    {
+        kdThreadCondSignal(rwlock->writecond);
     }
     else
     {
-        ts.tv_sec = (time_t)(timeout - (timeout % 1000000000)) / 1000000000;
+        kdThreadCondBroadcast(rwlock->readcond);
+    }
+    kdThreadMutexUnlock(rwlock->mutex);
+#endif
+    return 0;
+}
+
+/* kdThreadBarrierCreateVEN: Create a barrier for a number of threads. */
+struct KDThreadBarrierVEN {
+#if !defined(KD_THREAD_FUTEX)
+    KDThreadMutex *mutex;
+    KDThreadCond *cond;
+#endif
+    KDuint32 count;
+    KDuint32 arrived;
+    /* Bumped by the last thread to arrive, releasing the others. */
+    KDuint32 generation;
+    KDint8 padding[4];
+};
+KD_API KDThreadBarrierVEN *KD_APIENTRY kdThreadBarrierCreateVEN(KDuint count)
+{
+    if(count == 0)
+    {
+        kdSetError(KD_EINVAL);
+        return KD_NULL;
+    }
+    KDThreadBarrierVEN *barrier = (KDThreadBarrierVEN *)kdMalloc(sizeof(KDThreadBarrierVEN));
+    if(barrier == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    barrier->count = count;
+    barrier->arrived = 0;
+    barrier->generation = 0;
+#if !defined(KD_THREAD_FUTEX)
+    barrier->mutex = kdThreadMutexCreate(KD_NULL);
+    barrier->cond = kdThreadCondCreate(KD_NULL);
+    if(barrier->mutex == KD_NULL || barrier->cond == KD_NULL)
+    {
+        if(barrier->cond)
+        {
+            kdThreadCondFree(barrier->cond);
+        }
+        kdThreadMutexFree(barrier->mutex);
+        kdFree(barrier);
+        kdSetError(KD_EAGAIN);
+        return KD_NULL;
     }
+#endif
+    return barrier;
+}
 
-    /* Remaining nanoseconds */
-    ts.tv_nsec = (KDint32)timeout - ((KDint32)ts.tv_sec * 1000000000);
+/* kdThreadBarrierFreeVEN: Free a barrier. */
+KD_API KDint KD_APIENTRY kdThreadBarrierFreeVEN(KDThreadBarrierVEN *barrier)
+{
+#if !defined(KD_THREAD_FUTEX)
+    kdThreadCondFree(barrier->cond);
+    kdThreadMutexFree(barrier->mutex);
+#endif
+    kdFree(barrier);
+    return 0;
+}
+
+/* kdThreadBarrierWaitVEN: Wait until all threads reached the barrier. */
+KD_API KDint KD_APIENTRY kdThreadBarrierWaitVEN(KDThreadBarrierVEN *barrier)
+{
+#if defined(KD_THREAD_FUTEX)
+    KDuint32 generation = __atomic_load_n(&barrier->generation, __ATOMIC_ACQUIRE);
+    if(__atomic_add_fetch(&barrier->arrived, 1, __ATOMIC_ACQ_REL) == barrier->count)
+    {
+        __atomic_store_n(&barrier->arrived, 0, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&barrier->generation, 1, __ATOMIC_RELEASE);
+        __kdFutexWake(&barrier->generation, KDINT_MAX);
+        return KD_THREAD_BARRIER_SERIAL_VEN;
+    }
+    KDuint32 limit = __kdFutexSpinMax();
+    for(KDuint32 i = 0; i < limit && __atomic_load_n(&barrier->generation, __ATOMIC_ACQUIRE) == generation; i++)
+    {
+        __kdCpuRelax();
+    }
+    while(__atomic_load_n(&barrier->generation, __ATOMIC_ACQUIRE) == generation)
+    {
+        __kdFutexWait(&barrier->generation, generation);
+    }
+#else
+    kdThreadMutexLock(barrier->mutex);
+    KDuint32 generation = barrier->generation;
+    if(++barrier->arrived == barrier->count)
+    {
+        barrier->arrived = 0;
+        barrier->generation++;
+        kdThreadCondBroadcast(barrier->cond);
+        kdThreadMutexUnlock(barrier->mutex);
+        return KD_THREAD_BARRIER_SERIAL_VEN;
+    }
+    while(barrier->generation == generation)
+    {
+        kdThreadCondWait(barrier->cond, barrier->mutex);
+    }
+    kdThreadMutexUnlock(barrier->mutex);
+#endif
+    return 0;
+}
+
+/* kdThreadLatchCreateVEN: Create a single-use latch counting down from count. */
+struct KDThreadLatchVEN {
+#if !defined(KD_THREAD_FUTEX)
+    KDThreadMutex *mutex;
+    KDThreadCond *cond;
+#endif
+    KDuint32 count;
+    KDuint32 waiters;
+};
+KD_API KDThreadLatchVEN *KD_APIENTRY kdThreadLatchCreateVEN(KDuint count)
+{
+    KDThreadLatchVEN *latch = (KDThreadLatchVEN *)kdMalloc(sizeof(KDThreadLatchVEN));
+    if(latch == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    latch->count = count;
+    latch->waiters = 0;
+#if !defined(KD_THREAD_FUTEX)
+    latch->mutex = kdThreadMutexCreate(KD_NULL);
+    latch->cond = kdThreadCondCreate(KD_NULL);
+    if(latch->mutex == KD_NULL || latch->cond == KD_NULL)
+    {
+        if(latch->cond)
+        {
+            kdThreadCondFree(latch->cond);
+        }
+        kdThreadMutexFree(latch->mutex);
+        kdFree(latch);
+        kdSetError(KD_EAGAIN);
+        return KD_NULL;
+    }
+#endif
+    return latch;
+}
+
+/* kdThreadLatchFreeVEN: Free a latch. */
+KD_API KDint KD_APIENTRY kdThreadLatchFreeVEN(KDThreadLatchVEN *latch)
+{
+#if !defined(KD_THREAD_FUTEX)
+    kdThreadCondFree(latch->cond);
+    kdThreadMutexFree(latch->mutex);
+#endif
+    kdFree(latch);
+    return 0;
+}
+
+/* kdThreadLatchCountDownVEN: Decrement a latch, releasing waiters at zero. */
+KD_API KDint KD_APIENTRY kdThreadLatchCountDownVEN(KDThreadLatchVEN *latch)
+{
+#if defined(KD_THREAD_FUTEX)
+    KDuint32 count = __atomic_load_n(&latch->count, __ATOMIC_RELAXED);
+    do
+    {
+        if(count == 0)
+        {
+            kdSetError(KD_EINVAL);
+            return -1;
+        }
+    } while(!__atomic_compare_exchange_n(&latch->count, &count, count - 1, KD_TRUE, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+    if(count == 1 && __atomic_load_n(&latch->waiters, __ATOMIC_SEQ_CST) > 0)
+    {
+        __kdFutexWake(&latch->count, KDINT_MAX);
+    }
+#else
+    kdThreadMutexLock(latch->mutex);
+    if(latch->count == 0)
+    {
+        kdThreadMutexUnlock(latch->mutex);
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    if(--latch->count == 0)
+    {
+        kdThreadCondBroadcast(latch->cond);
+    }
+    kdThreadMutexUnlock(latch->mutex);
+#endif
+    return 0;
+}
+
+/* kdThreadLatchWaitVEN: Wait until a latch reached zero. */
+KD_API KDint KD_APIENTRY kdThreadLatchWaitVEN(KDThreadLatchVEN *latch)
+{
+#if defined(KD_THREAD_FUTEX)
+    if(__atomic_load_n(&latch->count, __ATOMIC_ACQUIRE) == 0)
+    {
+        return 0;
+    }
+    __atomic_fetch_add(&latch->waiters, 1, __ATOMIC_SEQ_CST);
+    KDuint32 count = __atomic_load_n(&latch->count, __ATOMIC_SEQ_CST);
+    while(count != 0)
+    {
+        __kdFutexWait(&latch->count, count);
+        count = __atomic_load_n(&latch->count, __ATOMIC_SEQ_CST);
+    }
+    __atomic_fetch_sub(&latch->waiters, 1, __ATOMIC_SEQ_CST);
+#else
+    kdThreadMutexLock(latch->mutex);
+    while(latch->count != 0)
+    {
+        kdThreadCondWait(latch->cond, latch->mutex);
+    }
+    kdThreadMutexUnlock(latch->mutex);
+#endif
+    return 0;
+}
+
+/* kdThreadSleepVEN: Blocks the current thread for nanoseconds. */
+KD_API KDint KD_APIENTRY kdThreadSleepVEN(KDust timeout)
+{
+#if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX)
+    struct timespec ts = {0, 0};
+    __kdTimespecAddUST(&ts, timeout);
 #endif
 
 #if defined(__EMSCRIPTEN__)
@@ -887,3 +2057,257 @@ KD_API KDint KD_APIENTRY kdThreadSleepVEN(KDust timeout)
 #endif
     return 0;
 }
+
+/* kdThreadSleepUntilVEN: Blocks the current thread until an absolute UST. */
+KD_API KDint KD_APIENTRY kdThreadSleepUntilVEN(KDust deadline)
+{
+    KDust now = kdGetTimeUST();
+    if(now >= deadline)
+    {
+        return 0;
+    }
+#if defined(__linux__) && (defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX))
+    /* UST is read from CLOCK_MONOTONIC_RAW, which clock_nanosleep does not
+     * accept. The deadline is translated to CLOCK_MONOTONIC, so the wait
+     * itself is absolute and a preempted caller does not oversleep. The two
+     * clocks differ by NTP slew, a short wakeup is translated again. */
+    struct timespec ts = {0, 0};
+    while(now < deadline && clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+    {
+        __kdTimespecAddUST(&ts, deadline - now);
+        while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, KD_NULL) == EINTR)
+        {
+        }
+        now = kdGetTimeUST();
+    }
+#endif
+    while(now < deadline)
+    {
+        kdThreadSleepVEN(deadline - now);
+        now = kdGetTimeUST();
+    }
+    return 0;
+}
+
+/* Oversleep allowance for kdThreadSleepUntilPreciseVEN, in nanoseconds. */
+#define __KD_SLEEP_MARGIN_MIN 20000LL
+#define __KD_SLEEP_MARGIN_MAX 2000000LL
+#define __KD_SLEEP_MARGIN_INIT 100000LL
+#if defined(KD_THREAD_LOCAL)
+static KD_THREAD_LOCAL KDust __kd_sleep_margin = __KD_SLEEP_MARGIN_INIT;
+#endif
+
+/* kdThreadSleepUntilPreciseVEN: Sleeps, then spins the remainder to an absolute UST. */
+KD_API KDint KD_APIENTRY kdThreadSleepUntilPreciseVEN(KDust deadline)
+{
+#if defined(KD_THREAD_LOCAL)
+    KDust margin = __kd_sleep_margin;
+#else
+    KDust margin = __KD_SLEEP_MARGIN_INIT;
+#endif
+    KDust now = kdGetTimeUST();
+    if(deadline > now + margin)
+    {
+        /* Sleep short of the deadline and learn how late the wakeup was. The
+         * margin grows quickly after a late wakeup and shrinks slowly, so it
+         * settles just above the scheduler's usual latency. */
+        KDust target = deadline - margin;
+        kdThreadSleepUntilVEN(target);
+        now = kdGetTimeUST();
+#if defined(KD_THREAD_LOCAL)
+        KDust late = (now > target) ? now - target : 0;
+        if(late + late / 2 > margin)
+        {
+            margin = late + late / 2;
+        }
+        else
+        {
+            margin -= (margin - (late + late / 2)) / 16;
+        }
+        if(margin < __KD_SLEEP_MARGIN_MIN)
+        {
+            margin = __KD_SLEEP_MARGIN_MIN;
+        }
+        else if(margin > __KD_SLEEP_MARGIN_MAX)
+        {
+            margin = __KD_SLEEP_MARGIN_MAX;
+        }
+        __kd_sleep_margin = margin;
+#endif
+    }
+    while(now < deadline)
+    {
+        __kdCpuRelax();
+        now = kdGetTimeUST();
+    }
+    return 0;
+}
+
+/* kdGetCpuTopologyVEN: Query processors, physical cores, NUMA nodes and caches. */
+KD_API KDint KD_APIENTRY kdGetCpuTopologyVEN(KDCpuTopologyVEN *topology, KDCpuVEN *cpus, KDint count)
+{
+    kdMemset(topology, 0, sizeof(KDCpuTopologyVEN));
+#if defined(__linux__)
+    KDuint64 online[__KD_CPU_WORDS];
+    if(__kdReadSysfsCpuList("/sys/devices/system/cpu/online", online) == -1)
+    {
+        kdMemset(online, 0, sizeof(online));
+        for(long cpu = 0; cpu < sysconf(_SC_NPROCESSORS_ONLN) && cpu < __KD_CPU_WORDS * 64; cpu++)
+        {
+            online[cpu / 64] |= 1ULL << (cpu % 64);
+        }
+    }
+
+    /* Cores are numbered densely by their (package, core_id) pair. */
+    typedef struct _KDCpuCore {
+        KDint package;
+        KDint coreid;
+        KDint threads;
+    } _KDCpuCore;
+    _KDCpuCore *cores = (_KDCpuCore *)kdMalloc(sizeof(_KDCpuCore) * __KD_CPU_WORDS * 64);
+    KDint *nodes = (KDint *)kdMalloc(sizeof(KDint) * __KD_CPU_WORDS * 64);
+    if(cores == KD_NULL || nodes == KD_NULL)
+    {
+        kdFree(nodes);
+        kdFree(cores);
+        kdSetError(KD_ENOMEM);
+        return -1;
+    }
+    kdMemset(nodes, 0, sizeof(KDint) * __KD_CPU_WORDS * 64);
+
+    KDuint64 nodemask[__KD_CPU_WORDS];
+    if(__kdReadSysfsCpuList("/sys/devices/system/node/online", nodemask) == -1)
+    {
+        kdMemset(nodemask, 0, sizeof(nodemask));
+        nodemask[0] = 1;
+    }
+    for(KDint node = 0; node < __KD_CPU_WORDS * 64; node++)
+    {
+        if(nodemask[node / 64] & (1ULL << (node % 64)))
+        {
+            topology->nodes++;
+            KDchar path[64];
+            kdSnprintfKHR(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+            KDuint64 nodecpus[__KD_CPU_WORDS];
+            if(__kdReadSysfsCpuList(path, nodecpus) == 0)
+            {
+                for(KDint cpu = 0; cpu < __KD_CPU_WORDS * 64; cpu++)
+                {
+                    if(nodecpus[cpu / 64] & (1ULL << (cpu % 64)))
+                    {
+                        nodes[cpu] = node;
+                    }
+                }
+            }
+        }
+    }
+
+    KDint first = -1;
+    for(KDint cpu = 0; cpu < __KD_CPU_WORDS * 64; cpu++)
+    {
+        if(!(online[cpu / 64] & (1ULL << (cpu % 64))))
+        {
+            continue;
+        }
+        first = (first == -1) ? cpu : first;
+        KDchar path[96];
+        kdSnprintfKHR(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+        KDint package = __kdReadSysfsInt(path, 0);
+        kdSnprintfKHR(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+        KDint coreid = __kdReadSysfsInt(path, cpu);
+
+        KDint core = 0;
+        while(core < topology->cores && (cores[core].package != package || cores[core].coreid != coreid))
+        {
+            core++;
+        }
+        if(core == topology->cores)
+        {
+            cores[core].package = package;
+            cores[core].coreid = coreid;
+            cores[core].threads = 0;
+            topology->cores++;
+            KDboolean seen = KD_FALSE;
+            for(KDint i = 0; i < core && !seen; i++)
+            {
+                seen = (cores[i].package == package);
+            }
+            topology->packages += seen ? 0 : 1;
+        }
+        if(cpus && topology->processors < count)
+        {
+            KDCpuVEN *info = &cpus[topology->processors];
+            info->id = cpu;
+            info->core = core;
+            info->package = package;
+            info->node = nodes[cpu];
+            info->smt = cores[core].threads;
+        }
+        cores[core].threads++;
+        topology->processors++;
+    }
+    kdFree(nodes);
+    kdFree(cores);
+
+    for(KDint index = 0; first != -1; index++)
+    {
+        KDchar path[96];
+        KDchar buffer[64];
+        kdSnprintfKHR(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/level", first, index);
+        KDint level = __kdReadSysfsInt(path, -1);
+        if(level == -1)
+        {
+            break;
+        }
+        kdSnprintfKHR(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/type", first, index);
+        if(__kdReadSysfs(path, buffer, sizeof(buffer)) == -1 || buffer[0] == 'I')
+        {
+            continue;
+        }
+        kdSnprintfKHR(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/size", first, index);
+        if(__kdReadSysfs(path, buffer, sizeof(buffer)) == -1)
+        {
+            continue;
+        }
+        KDchar *unit = KD_NULL;
+        KDint size = (KDint)kdStrtol(buffer, &unit, 10);
+        size *= (*unit == 'K') ? 1024 : (*unit == 'M') ? 1024 * 1024 : 1;
+        if(level == 1)
+        {
+            topology->l1cachesize = size;
+            kdSnprintfKHR(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/coherency_line_size", first, index);
+            topology->cachelinesize = __kdReadSysfsInt(path, 0);
+        }
+        else if(level == 2)
+        {
+            topology->l2cachesize = size;
+        }
+        else if(level == 3)
+        {
+            topology->l3cachesize = size;
+        }
+    }
+#else
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    topology->processors = (KDint)info.dwNumberOfProcessors;
+#elif defined(KD_THREAD_POSIX)
+    topology->processors = (KDint)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    /* Without topology information every processor is its own core. */
+    topology->processors = kdMaxVEN(topology->processors, 1);
+    topology->cores = topology->processors;
+    topology->packages = 1;
+    topology->nodes = 1;
+    for(KDint cpu = 0; cpus && cpu < count && cpu < topology->processors; cpu++)
+    {
+        cpus[cpu].id = cpu;
+        cpus[cpu].core = cpu;
+        cpus[cpu].package = 0;
+        cpus[cpu].node = 0;
+        cpus[cpu].smt = 0;
+    }
+#endif
+    return 0;
+}
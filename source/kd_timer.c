@@ -35,6 +35,9 @@
 #pragma clang diagnostic ignored "-Wreserved-id-macro"
 #endif
 #endif
+#if defined(__linux__)
+#define _GNU_SOURCE /* CLOCK_MONOTONIC, TFD_CLOEXEC */
+#endif
 #include "kdplatform.h"  // for KD_API, KD_APIENTRY, KDint64
 #include <KD/kd.h>       // for kdFree, KDTimer, kdSetError, KD_NULL, kdThre...
 #include <KD/kdext.h>    // for kdThreadSleepVEN
@@ -42,11 +45,134 @@
 #pragma clang diagnostic pop
 #endif
 
+#include "kd_internal.h"  // for KD_REACTOR_EPOLL, __kdReactorWatch
+
+/******************************************************************************
+ * Platform includes
+ ******************************************************************************/
+
+#if defined(KD_REACTOR_EPOLL)
+#include <sys/timerfd.h>  // for timerfd_create, timerfd_settime
+#include <time.h>         // for CLOCK_MONOTONIC
+#include <unistd.h>       // for close, read
+#endif
+
 /******************************************************************************
  * Timer functions
  ******************************************************************************/
 
 /* kdSetTimer: Set timer. */
+#if defined(KD_REACTOR_EPOLL)
+/* Timers are timerfds in the reactor of the thread that set them, no thread
+ * per timer. KD_TIMER_PERIODIC_MINIMUM rearms after every expiry, so events
+ * are at least interval apart even when the thread falls behind. With
+ * KD_TIMER_PERIODIC_AVERAGE a thread that falls behind gets one event per
+ * missed expiry, up to __KD_TIMER_CATCHUP at once, so the average period
+ * holds. Expiries past that are dropped rather than flooding the queue. */
+#define __KD_TIMER_CATCHUP 16
+struct KDTimer {
+    KDThread *originthr;
+    void *eventuserptr;
+    KDint64 interval;
+    KDint periodic;
+    KDint fd;
+};
+static void __kdTimerArm(KDTimer *timer)
+{
+    struct itimerspec spec;
+    kdMemset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = (time_t)(timer->interval / 1000000000);
+    spec.it_value.tv_nsec = (long)(timer->interval % 1000000000);
+    if(spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+    {
+        /* Zero would disarm */
+        spec.it_value.tv_nsec = 1;
+    }
+    if(timer->periodic == KD_TIMER_PERIODIC_AVERAGE)
+    {
+        spec.it_interval = spec.it_value;
+    }
+    timerfd_settime(timer->fd, 0, &spec, KD_NULL);
+}
+static void __kdTimerReady(void *arg, KD_UNUSED KDuint events)
+{
+    KDTimer *timer = (KDTimer *)arg;
+    KDuint64 expirations = 0;
+    if(read(timer->fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+    {
+        return;
+    }
+    for(KDuint64 i = 0; i < expirations && i < __KD_TIMER_CATCHUP; i++)
+    {
+        KDEvent *timerevent = kdCreateEvent();
+        if(timerevent == KD_NULL)
+        {
+            break;
+        }
+        timerevent->type = KD_EVENT_TIMER;
+        timerevent->userptr = timer->eventuserptr;
+        if(kdPostEvent(timerevent) == -1)
+        {
+            break;
+        }
+    }
+    if(timer->periodic == KD_TIMER_PERIODIC_MINIMUM)
+    {
+        __kdTimerArm(timer);
+    }
+}
+KD_API KDTimer *KD_APIENTRY kdSetTimer(KDint64 interval, KDint periodic, void *eventuserptr)
+{
+    if(periodic != KD_TIMER_ONESHOT && periodic != KD_TIMER_PERIODIC_AVERAGE && periodic != KD_TIMER_PERIODIC_MINIMUM)
+    {
+        kdLogMessage("kdSetTimer() encountered unknown periodic value.");
+        return KD_NULL;
+    }
+
+    KDTimer *timer = (KDTimer *)kdMalloc(sizeof(KDTimer));
+    if(timer == KD_NULL)
+    {
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    timer->originthr = kdThreadSelf();
+    timer->eventuserptr = eventuserptr;
+    timer->interval = interval;
+    timer->periodic = periodic;
+    /* KD_ENOMEM is the only error the specification allows here, out of
+     * descriptors included */
+    timer->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if(timer->fd == -1)
+    {
+        kdFree(timer);
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    if(__kdReactorWatch(timer->originthr->reactor, timer->fd, __KD_REACTOR_IN, __kdTimerReady, timer) == -1)
+    {
+        close(timer->fd);
+        kdFree(timer);
+        kdSetError(KD_ENOMEM);
+        return KD_NULL;
+    }
+    __kdTimerArm(timer);
+    return timer;
+}
+
+/* kdCancelTimer: Cancel and free a timer. */
+KD_API KDint KD_APIENTRY kdCancelTimer(KDTimer *timer)
+{
+    if(timer->originthr != kdThreadSelf())
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    __kdReactorUnwatch(timer->originthr->reactor, timer->fd);
+    close(timer->fd);
+    kdFree(timer);
+    return 0;
+}
+#else
 typedef struct {
     KDint64 interval;
     void *eventuserptr;
@@ -152,3 +278,4 @@ KD_API KDint KD_APIENTRY kdCancelTimer(KDTimer *timer)
     kdFree(timer);
     return 0;
 }
+#endif
@@ -39,6 +39,7 @@
 #include "kdplatform.h"             // for KD_APIENTRY, KD_THREAD_POSIX, KD_API
 #include <KD/kd.h>                  // for kdThreadMutexUnlock, kdSetError, kdThreadMu...
 #include <KD/KHR_thread_storage.h>  // IWYU pragma: keep
+#include <KD/kdext.h>               // IWYU pragma: keep
 #if defined(__clang__)
 #pragma clang diagnostic pop
 #endif
@@ -85,111 +86,378 @@ KD_API void KD_APIENTRY kdSetTLS(void *ptr)
     kdThreadSelf()->tlsptr = ptr;
 }
 
-/* kdMapThreadStorageKHR: Maps an arbitrary pointer to a global thread storage key. */
-struct _KDThreadStorage {
-    KDThreadStorageKeyKHR key;
+/* Keys are handed out densely from 1, every thread keeps its values in a
+ * slot array indexed by key. The id to key registry is an open-addressed hash
+ * table which is only ever appended to, so lookups of already mapped ids do
+ * not take a lock. Inserts and growth are serialized by __kd_tls_mutex, tables
+ * replaced by growth stay alive until cleanup for concurrent readers. */
+#if defined(KD_ATOMIC_C11) || defined(KD_ATOMIC_BUILTIN)
+#define __KD_TLS_LOCKFREE
+#define __kdTlsLoad(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define __kdTlsStore(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#else
+#define __kdTlsLoad(ptr) (*(ptr))
+#define __kdTlsStore(ptr, value) (*(ptr) = (value))
+#endif
+
+typedef struct _KDThreadStorageTable _KDThreadStorageTable;
+struct _KDThreadStorageTable {
+    _KDThreadStorageTable *previous;
+    const void **ids;
+    KDThreadStorageKeyKHR *keys;
+    KDsize mask;
+};
+
+typedef struct _KDThreadStorageSlots _KDThreadStorageSlots;
+struct _KDThreadStorageSlots {
+    KDsize count;
+    void *values[];
+};
+
+typedef void(KD_APIENTRY *_KDThreadStorageDestructor)(void *);
+
+KDThreadMutex *__kd_tls_mutex = KD_NULL;
+static _KDThreadStorageTable *__kd_tls_table = KD_NULL;
+static KDThreadStorageKeyKHR __kd_tls_count = 0;
+static _KDThreadStorageDestructor *__kd_tls_destructors = KD_NULL;
+
+#if defined(KD_THREAD_C11)
+static tss_t __kd_tls_nativekey;
+#elif defined(KD_THREAD_POSIX)
+static pthread_key_t __kd_tls_nativekey;
+#elif defined(KD_THREAD_WIN32)
+static DWORD __kd_tls_nativekey;
+#endif
+#if defined(KD_THREAD_C11) || defined(KD_THREAD_POSIX) || defined(KD_THREAD_WIN32)
+#define __KD_TLS_NATIVEKEY
+static KDboolean __kd_tls_nativekeyvalid = KD_FALSE;
+#endif
+
+#if defined(KD_THREAD_LOCAL)
+static KD_THREAD_LOCAL _KDThreadStorageSlots *__kd_tls_slots = KD_NULL;
+#elif !defined(__KD_TLS_NATIVEKEY)
+static _KDThreadStorageSlots *__kd_tls_slots = KD_NULL;
+#endif
+
+static _KDThreadStorageSlots *__kdThreadStorageSlots(void)
+{
+#if defined(KD_THREAD_LOCAL) || !defined(__KD_TLS_NATIVEKEY)
+    return __kd_tls_slots;
+#elif defined(KD_THREAD_C11)
+    return __kd_tls_nativekeyvalid ? (_KDThreadStorageSlots *)tss_get(__kd_tls_nativekey) : KD_NULL;
+#elif defined(KD_THREAD_POSIX)
+    return __kd_tls_nativekeyvalid ? (_KDThreadStorageSlots *)pthread_getspecific(__kd_tls_nativekey) : KD_NULL;
+#elif defined(KD_THREAD_WIN32)
+    return __kd_tls_nativekeyvalid ? (_KDThreadStorageSlots *)FlsGetValue(__kd_tls_nativekey) : KD_NULL;
+#endif
+}
+
+/* The native key only carries the slot array so destructors run on exit of
+ * threads not created by kdThreadCreate. */
+static KDint __kdThreadStorageSetSlots(_KDThreadStorageSlots *slots)
+{
+#if defined(KD_THREAD_LOCAL) || !defined(__KD_TLS_NATIVEKEY)
+    __kd_tls_slots = slots;
+#endif
 #if defined(KD_THREAD_C11)
-    tss_t nativekey;
+    return (tss_set(__kd_tls_nativekey, slots) == thrd_error) ? -1 : 0;
 #elif defined(KD_THREAD_POSIX)
-    pthread_key_t nativekey;
+    return (pthread_setspecific(__kd_tls_nativekey, slots) == 0) ? 0 : -1;
 #elif defined(KD_THREAD_WIN32)
-    DWORD nativekey;
+    return (FlsSetValue(__kd_tls_nativekey, slots) == 0) ? -1 : 0;
 #else
-    void *nativekey;
+    return 0;
 #endif
-    void *id;
-};
-typedef struct _KDThreadStorage _KDThreadStorage;
+}
 
-static _KDThreadStorage __kd_tls[999];
-static KDuint __kd_tls_index = 0;
-KDThreadMutex *__kd_tls_mutex = KD_NULL;
-KD_API KDThreadStorageKeyKHR KD_APIENTRY KD_APIENTRY kdMapThreadStorageKHR(const void *id)
+/* __kdThreadStorageExit: Run key destructors for the calling thread and release its slots. */
+void __kdThreadStorageExit(void)
 {
-    KDThreadStorageKeyKHR retval = 0;
-    kdThreadMutexLock(__kd_tls_mutex);
-    for(KDuint i = 0; i < __kd_tls_index; i++)
+    /* Destructors may store new values, repeat a bounded number of times. */
+    for(KDint pass = 0; pass < 4; pass++)
     {
-        if(__kd_tls[i].id == id)
+        KDboolean called = KD_FALSE;
+        _KDThreadStorageSlots *slots = KD_NULL;
+        for(KDsize i = 0; (slots = __kdThreadStorageSlots()) != KD_NULL && i < slots->count; i++)
         {
+            void *value = slots->values[i];
+            if(value == KD_NULL)
+            {
+                continue;
+            }
+            _KDThreadStorageDestructor destructor = KD_NULL;
+            kdThreadMutexLock(__kd_tls_mutex);
+            if(i < __kd_tls_count)
+            {
+                destructor = __kd_tls_destructors[i];
+            }
             kdThreadMutexUnlock(__kd_tls_mutex);
-            return __kd_tls[i].key;
+            if(destructor)
+            {
+                slots->values[i] = KD_NULL;
+                destructor(value);
+                called = KD_TRUE;
+            }
+        }
+        if(!called)
+        {
+            break;
         }
     }
 
-    /* Key is only 0 when an error occurs. */
-    __kd_tls[__kd_tls_index].key = __kd_tls_index + 1;
-    kdMemcpy(&__kd_tls[__kd_tls_index].id, &id, sizeof(void *));
+    _KDThreadStorageSlots *slots = __kdThreadStorageSlots();
+    if(slots)
+    {
+        __kdThreadStorageSetSlots(KD_NULL);
+        kdFree(slots);
+    }
+}
+
+#if defined(__KD_TLS_NATIVEKEY)
+#if defined(KD_THREAD_WIN32)
+static void WINAPI __kdThreadStorageNativeExit(void *slots)
+#else
+static void __kdThreadStorageNativeExit(void *slots)
+#endif
+{
+    if(slots)
+    {
+        /* The native value is already cleared, reinstall it for the destructors. */
+        __kdThreadStorageSetSlots((_KDThreadStorageSlots *)slots);
+        __kdThreadStorageExit();
+    }
+}
+#endif
+
+static KDsize __kdThreadStorageHash(const void *id, KDsize mask)
+{
+    /* Fibonacci hashing, the low bits of a pointer are mostly alignment. */
+    KDuint64 hash = (KDuint64)(KDuintptr)id * 0x9E3779B97F4A7C15ULL;
+    return (KDsize)(hash >> 32) & mask;
+}
+
+static KDThreadStorageKeyKHR __kdThreadStorageFind(const _KDThreadStorageTable *table, const void *id)
+{
+    if(table == KD_NULL)
+    {
+        return 0;
+    }
+    for(KDsize i = __kdThreadStorageHash(id, table->mask);; i = (i + 1) & table->mask)
+    {
+        const void *slot = __kdTlsLoad(&table->ids[i]);
+        if(slot == id)
+        {
+            return table->keys[i];
+        }
+        if(slot == KD_NULL)
+        {
+            return 0;
+        }
+    }
+}
+
+static void __kdThreadStorageInsert(_KDThreadStorageTable *table, const void *id, KDThreadStorageKeyKHR key)
+{
+    KDsize i = __kdThreadStorageHash(id, table->mask);
+    while(table->ids[i] != KD_NULL)
+    {
+        i = (i + 1) & table->mask;
+    }
+    table->keys[i] = key;
+    __kdTlsStore(&table->ids[i], id);
+}
+
+/* kdMapThreadStorageKHR: Maps an arbitrary pointer to a global thread storage key. */
+KD_API KDThreadStorageKeyKHR KD_APIENTRY KD_APIENTRY kdMapThreadStorageKHR(const void *id)
+{
+#if defined(__KD_TLS_LOCKFREE)
+    KDThreadStorageKeyKHR retval = __kdThreadStorageFind(__kdTlsLoad(&__kd_tls_table), id);
+    if(retval)
+    {
+        return retval;
+    }
+#else
+    KDThreadStorageKeyKHR retval = 0;
+#endif
+
+    kdThreadMutexLock(__kd_tls_mutex);
+    _KDThreadStorageTable *table = __kd_tls_table;
+    retval = __kdThreadStorageFind(table, id);
+    if(retval)
+    {
+        kdThreadMutexUnlock(__kd_tls_mutex);
+        return retval;
+    }
+
+#if defined(__KD_TLS_NATIVEKEY)
+    if(!__kd_tls_nativekeyvalid)
+    {
 #if defined(KD_THREAD_C11)
-    if(tss_create(&__kd_tls[__kd_tls_index].nativekey, KD_NULL) != 0)
+        if(tss_create(&__kd_tls_nativekey, __kdThreadStorageNativeExit) != thrd_success)
 #elif defined(KD_THREAD_POSIX)
-    if(pthread_key_create(&__kd_tls[__kd_tls_index].nativekey, KD_NULL) != 0)
+        if(pthread_key_create(&__kd_tls_nativekey, __kdThreadStorageNativeExit) != 0)
 #elif defined(KD_THREAD_WIN32)
-    __kd_tls[__kd_tls_index].nativekey = FlsAlloc(NULL);
-    if(__kd_tls[__kd_tls_index].nativekey == TLS_OUT_OF_INDEXES)
-#else
-    if((0))
+        __kd_tls_nativekey = FlsAlloc(__kdThreadStorageNativeExit);
+        if(__kd_tls_nativekey == FLS_OUT_OF_INDEXES)
 #endif
-    {
-        kdSetError(KD_ENOMEM);
+        {
+            kdThreadMutexUnlock(__kd_tls_mutex);
+            kdSetError(KD_ENOMEM);
+            return 0;
+        }
+        __kd_tls_nativekeyvalid = KD_TRUE;
     }
-    else
+#endif
+
+    /* Keep the load factor at or below one half. */
+    if(table == KD_NULL || (KDsize)__kd_tls_count + 1 > (table->mask + 1) / 2)
     {
-        retval = __kd_tls[__kd_tls_index].key;
-        __kd_tls_index++;
+        KDsize capacity = table ? (table->mask + 1) * 2 : 64;
+        _KDThreadStorageTable *grown = (_KDThreadStorageTable *)kdMalloc(sizeof(_KDThreadStorageTable));
+        const void **ids = (const void **)kdCallocVEN(capacity, sizeof(void *));
+        KDThreadStorageKeyKHR *keys = (KDThreadStorageKeyKHR *)kdMalloc(capacity * sizeof(KDThreadStorageKeyKHR));
+        _KDThreadStorageDestructor *destructors = (_KDThreadStorageDestructor *)kdRealloc(__kd_tls_destructors, capacity / 2 * sizeof(_KDThreadStorageDestructor));
+        if(destructors)
+        {
+            __kd_tls_destructors = destructors;
+        }
+        if(grown == KD_NULL || ids == KD_NULL || keys == KD_NULL || destructors == KD_NULL)
+        {
+            kdFree(keys);
+            kdFree(ids);
+            kdFree(grown);
+            kdThreadMutexUnlock(__kd_tls_mutex);
+            kdSetError(KD_ENOMEM);
+            return 0;
+        }
+        grown->previous = table;
+        grown->ids = ids;
+        grown->keys = keys;
+        grown->mask = capacity - 1;
+        for(KDsize i = 0; table && i <= table->mask; i++)
+        {
+            if(table->ids[i])
+            {
+                __kdThreadStorageInsert(grown, table->ids[i], table->keys[i]);
+            }
+        }
+        table = grown;
+        __kdTlsStore(&__kd_tls_table, table);
     }
+
+    /* Key is only 0 when an error occurs. */
+    retval = __kd_tls_count + 1;
+    __kd_tls_destructors[__kd_tls_count] = KD_NULL;
+    __kdThreadStorageInsert(table, id, retval);
+    __kdTlsStore(&__kd_tls_count, retval);
     kdThreadMutexUnlock(__kd_tls_mutex);
     return retval;
 }
 
+/* kdSetThreadStorageDestructorVEN: Set a function called with the value of a key on thread exit. */
+KD_API KDint KD_APIENTRY kdSetThreadStorageDestructorVEN(KDThreadStorageKeyKHR key, void(KD_APIENTRY *destructor)(void *))
+{
+    kdThreadMutexLock(__kd_tls_mutex);
+    if(key == 0 || key > __kd_tls_count)
+    {
+        kdThreadMutexUnlock(__kd_tls_mutex);
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    __kd_tls_destructors[key - 1] = destructor;
+    kdThreadMutexUnlock(__kd_tls_mutex);
+    return 0;
+}
+
 /* kdSetThreadStorageKHR: Stores thread-local data. */
 KD_API KDint KD_APIENTRY KD_APIENTRY kdSetThreadStorageKHR(KDThreadStorageKeyKHR key, void *data)
 {
-    KDint retval = -1;
-#if defined(KD_THREAD_C11)
-    retval = (tss_set(__kd_tls[key - 1].nativekey, data) == thrd_error) ? -1 : 0;
-#elif defined(KD_THREAD_POSIX)
-    retval = (pthread_setspecific(__kd_tls[key - 1].nativekey, data) == 0) ? 0 : -1;
-#elif defined(KD_THREAD_WIN32)
-    retval = (FlsSetValue(__kd_tls[key - 1].nativekey, data) == 0) ? -1 : 0;
-#else
-    retval = 0;
-    __kd_tls[key - 1].nativekey = data;
-#endif
-    /* cppcheck-suppress knownConditionTrueFalse */
-    if(retval == -1)
+    _KDThreadStorageSlots *slots = __kdThreadStorageSlots();
+    if(slots && (KDsize)key - 1 < slots->count)
+    {
+        slots->values[key - 1] = data;
+        return 0;
+    }
+    if(key == 0 || key > __kdTlsLoad(&__kd_tls_count))
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+    if(data == KD_NULL)
+    {
+        return 0;
+    }
+
+    KDsize count = slots ? slots->count : 0;
+    KDsize capacity = count ? count * 2 : 16;
+    while(capacity < key)
+    {
+        capacity *= 2;
+    }
+    _KDThreadStorageSlots *grown = (_KDThreadStorageSlots *)kdCallocVEN(1, sizeof(_KDThreadStorageSlots) + capacity * sizeof(void *));
+    if(grown == KD_NULL)
     {
         kdSetError(KD_ENOMEM);
+        return -1;
     }
-    return retval;
+    if(slots)
+    {
+        kdMemcpy(grown->values, slots->values, count * sizeof(void *));
+    }
+    grown->count = capacity;
+    grown->values[key - 1] = data;
+    if(__kdThreadStorageSetSlots(grown) == -1)
+    {
+        __kdThreadStorageSetSlots(slots);
+        kdFree(grown);
+        kdSetError(KD_ENOMEM);
+        return -1;
+    }
+    kdFree(slots);
+    return 0;
 }
 
 /* kdGetThreadStorageKHR: Retrieves previously stored thread-local data. */
 KD_API void *KD_APIENTRY KD_APIENTRY kdGetThreadStorageKHR(KDThreadStorageKeyKHR key)
 {
-#if defined(KD_THREAD_C11)
-    return tss_get(__kd_tls[key - 1].nativekey);
-#elif defined(KD_THREAD_POSIX)
-    return pthread_getspecific(__kd_tls[key - 1].nativekey);
-#elif defined(KD_THREAD_WIN32)
-    return FlsGetValue(__kd_tls[key - 1].nativekey);
-#else
-    return __kd_tls[key - 1].nativekey;
-#endif
+    _KDThreadStorageSlots *slots = __kdThreadStorageSlots();
+    if(slots && (KDsize)key - 1 < slots->count)
+    {
+        return slots->values[key - 1];
+    }
+    return KD_NULL;
 }
 
 void __kdCleanupThreadStorageKHR(void)
 {
+    __kdThreadStorageExit();
+
     kdThreadMutexLock(__kd_tls_mutex);
-    for(KDuint i = 0; i < __kd_tls_index; i++)
+#if defined(__KD_TLS_NATIVEKEY)
+    if(__kd_tls_nativekeyvalid)
     {
 #if defined(KD_THREAD_C11)
-        tss_delete(__kd_tls[i].nativekey);
+        tss_delete(__kd_tls_nativekey);
 #elif defined(KD_THREAD_POSIX)
-        pthread_key_delete(__kd_tls[i].nativekey);
+        pthread_key_delete(__kd_tls_nativekey);
 #elif defined(KD_THREAD_WIN32)
-        FlsFree(__kd_tls[i].nativekey);
+        FlsFree(__kd_tls_nativekey);
+#endif
+        __kd_tls_nativekeyvalid = KD_FALSE;
+    }
 #endif
+    _KDThreadStorageTable *table = __kd_tls_table;
+    while(table)
+    {
+        _KDThreadStorageTable *previous = table->previous;
+        kdFree(table->keys);
+        kdFree((void *)table->ids);
+        kdFree(table);
+        table = previous;
     }
+    __kd_tls_table = KD_NULL;
+    __kd_tls_count = 0;
+    kdFree(__kd_tls_destructors);
+    __kd_tls_destructors = KD_NULL;
     kdThreadMutexUnlock(__kd_tls_mutex);
 }
@@ -0,0 +1,689 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+/******************************************************************************
+ * KD includes
+ ******************************************************************************/
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wpadded"
+#if __has_warning("-Wreserved-id-macro")
+#pragma clang diagnostic ignored "-Wreserved-id-macro"
+#endif
+#endif
+#include "kdplatform.h"        // for KD_API, KD_APIENTRY, KDsize
+#include <KD/kd.h>             // for KDfloat32, kdSqrtf, kdSinf, kdCosf
+#include <KD/kdext.h>          // IWYU pragma: keep
+#include <KD/VEN_vecmath.h>    // for KDMat4VEN, KDVec3VEN, KDVec4VEN, KDQuatVEN
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+/******************************************************************************
+ * Platform includes
+ ******************************************************************************/
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/******************************************************************************
+ * Vector and matrix math
+ *
+ * Notes:
+ * - Matrices are column-major, m[col * 4 + row], like OpenGL expects them
+ * - All types are 16 bytes (or a multiple thereof) so a column, a KDVec4VEN
+ *   and a KDVec3VEN (with its pad lane) map onto a single SIMD register
+ ******************************************************************************/
+
+/* Transform modes for the w lane of the input. */
+#define __KD_VECMATH_W_INPUT 0 /* Use w from input (KDVec4VEN, matrix columns). */
+#define __KD_VECMATH_W_ONE 1   /* Treat input as point (w = 1). */
+#define __KD_VECMATH_W_ZERO 2  /* Treat input as direction (w = 0). */
+
+/* __kdMat4Transform: Multiply count 4-component columns by m. */
+static void __kdMat4Transform(KDfloat32 *out, const KDfloat32 *m, const KDfloat32 *in, KDsize count, KDint mode)
+{
+#if defined(__SSE__)
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+    for(KDsize i = 0; i < count; i++)
+    {
+        __m128 v = _mm_loadu_ps(&in[i * 4]);
+        __m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+        if(mode == __KD_VECMATH_W_INPUT)
+        {
+            r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+        }
+        else if(mode == __KD_VECMATH_W_ONE)
+        {
+            r = _mm_add_ps(r, c3);
+        }
+        _mm_storeu_ps(&out[i * 4], r);
+    }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    float32x4_t c0 = vld1q_f32(&m[0]);
+    float32x4_t c1 = vld1q_f32(&m[4]);
+    float32x4_t c2 = vld1q_f32(&m[8]);
+    float32x4_t c3 = vld1q_f32(&m[12]);
+    for(KDsize i = 0; i < count; i++)
+    {
+        float32x4_t v = vld1q_f32(&in[i * 4]);
+        float32x4_t r = vmulq_lane_f32(c0, vget_low_f32(v), 0);
+        r = vmlaq_lane_f32(r, c1, vget_low_f32(v), 1);
+        r = vmlaq_lane_f32(r, c2, vget_high_f32(v), 0);
+        if(mode == __KD_VECMATH_W_INPUT)
+        {
+            r = vmlaq_lane_f32(r, c3, vget_high_f32(v), 1);
+        }
+        else if(mode == __KD_VECMATH_W_ONE)
+        {
+            r = vaddq_f32(r, c3);
+        }
+        vst1q_f32(&out[i * 4], r);
+    }
+#else
+    for(KDsize i = 0; i < count; i++)
+    {
+        KDfloat32 x = in[i * 4 + 0];
+        KDfloat32 y = in[i * 4 + 1];
+        KDfloat32 z = in[i * 4 + 2];
+        KDfloat32 w = in[i * 4 + 3];
+        if(mode == __KD_VECMATH_W_ONE)
+        {
+            w = 1.0f;
+        }
+        else if(mode == __KD_VECMATH_W_ZERO)
+        {
+            w = 0.0f;
+        }
+        for(KDint row = 0; row < 4; row++)
+        {
+            out[i * 4 + row] = m[row] * x + m[4 + row] * y + m[8 + row] * z + m[12 + row] * w;
+        }
+    }
+#endif
+}
+
+/* kdVec3SetVEN: Initialize a 3-component vector. */
+KD_API void KD_APIENTRY kdVec3SetVEN(KDVec3VEN *out, KDfloat32 x, KDfloat32 y, KDfloat32 z)
+{
+    out->x = x;
+    out->y = y;
+    out->z = z;
+    out->pad = 0.0f;
+}
+
+/* kdVec3AddVEN: Add two 3-component vectors. */
+KD_API void KD_APIENTRY kdVec3AddVEN(KDVec3VEN *out, const KDVec3VEN *a, const KDVec3VEN *b)
+{
+    kdVec3SetVEN(out, a->x + b->x, a->y + b->y, a->z + b->z);
+}
+
+/* kdVec3SubVEN: Subtract two 3-component vectors. */
+KD_API void KD_APIENTRY kdVec3SubVEN(KDVec3VEN *out, const KDVec3VEN *a, const KDVec3VEN *b)
+{
+    kdVec3SetVEN(out, a->x - b->x, a->y - b->y, a->z - b->z);
+}
+
+/* kdVec3ScaleVEN: Multiply a 3-component vector by a scalar. */
+KD_API void KD_APIENTRY kdVec3ScaleVEN(KDVec3VEN *out, const KDVec3VEN *v, KDfloat32 s)
+{
+    kdVec3SetVEN(out, v->x * s, v->y * s, v->z * s);
+}
+
+/* kdVec3DotVEN: Dot product of two 3-component vectors. */
+KD_API KDfloat32 KD_APIENTRY kdVec3DotVEN(const KDVec3VEN *a, const KDVec3VEN *b)
+{
+    return a->x * b->x + a->y * b->y + a->z * b->z;
+}
+
+/* kdVec3CrossVEN: Cross product of two 3-component vectors. */
+KD_API void KD_APIENTRY kdVec3CrossVEN(KDVec3VEN *out, const KDVec3VEN *a, const KDVec3VEN *b)
+{
+    kdVec3SetVEN(out, a->y * b->z - a->z * b->y, a->z * b->x - a->x * b->z, a->x * b->y - a->y * b->x);
+}
+
+/* kdVec3LengthVEN: Euclidean length of a 3-component vector. */
+KD_API KDfloat32 KD_APIENTRY kdVec3LengthVEN(const KDVec3VEN *v)
+{
+    return kdSqrtf(kdVec3DotVEN(v, v));
+}
+
+/* kdVec3NormalizeVEN: Scale a 3-component vector to unit length. */
+KD_API void KD_APIENTRY kdVec3NormalizeVEN(KDVec3VEN *out, const KDVec3VEN *v)
+{
+    KDfloat32 len = kdVec3LengthVEN(v);
+    if(len > 0.0f)
+    {
+        kdVec3ScaleVEN(out, v, 1.0f / len);
+    }
+    else
+    {
+        kdVec3SetVEN(out, 0.0f, 0.0f, 0.0f);
+    }
+}
+
+/* kdVec4SetVEN: Initialize a 4-component vector. */
+KD_API void KD_APIENTRY kdVec4SetVEN(KDVec4VEN *out, KDfloat32 x, KDfloat32 y, KDfloat32 z, KDfloat32 w)
+{
+    out->x = x;
+    out->y = y;
+    out->z = z;
+    out->w = w;
+}
+
+/* kdVec4AddVEN: Add two 4-component vectors. */
+KD_API void KD_APIENTRY kdVec4AddVEN(KDVec4VEN *out, const KDVec4VEN *a, const KDVec4VEN *b)
+{
+    kdVec4SetVEN(out, a->x + b->x, a->y + b->y, a->z + b->z, a->w + b->w);
+}
+
+/* kdVec4SubVEN: Subtract two 4-component vectors. */
+KD_API void KD_APIENTRY kdVec4SubVEN(KDVec4VEN *out, const KDVec4VEN *a, const KDVec4VEN *b)
+{
+    kdVec4SetVEN(out, a->x - b->x, a->y - b->y, a->z - b->z, a->w - b->w);
+}
+
+/* kdVec4ScaleVEN: Multiply a 4-component vector by a scalar. */
+KD_API void KD_APIENTRY kdVec4ScaleVEN(KDVec4VEN *out, const KDVec4VEN *v, KDfloat32 s)
+{
+    kdVec4SetVEN(out, v->x * s, v->y * s, v->z * s, v->w * s);
+}
+
+/* kdVec4DotVEN: Dot product of two 4-component vectors. */
+KD_API KDfloat32 KD_APIENTRY kdVec4DotVEN(const KDVec4VEN *a, const KDVec4VEN *b)
+{
+    return a->x * b->x + a->y * b->y + a->z * b->z + a->w * b->w;
+}
+
+/* kdMat4IdentityVEN: Build an identity matrix. */
+KD_API void KD_APIENTRY kdMat4IdentityVEN(KDMat4VEN *out)
+{
+    kdMemset(out->m, 0, sizeof(out->m));
+    out->m[0] = 1.0f;
+    out->m[5] = 1.0f;
+    out->m[10] = 1.0f;
+    out->m[15] = 1.0f;
+}
+
+/* kdMat4TranslationVEN: Build a translation matrix. */
+KD_API void KD_APIENTRY kdMat4TranslationVEN(KDMat4VEN *out, KDfloat32 x, KDfloat32 y, KDfloat32 z)
+{
+    kdMat4IdentityVEN(out);
+    out->m[12] = x;
+    out->m[13] = y;
+    out->m[14] = z;
+}
+
+/* kdMat4ScalingVEN: Build a scaling matrix. */
+KD_API void KD_APIENTRY kdMat4ScalingVEN(KDMat4VEN *out, KDfloat32 x, KDfloat32 y, KDfloat32 z)
+{
+    kdMat4IdentityVEN(out);
+    out->m[0] = x;
+    out->m[5] = y;
+    out->m[10] = z;
+}
+
+/* kdMat4RotationVEN: Build a rotation matrix around an arbitrary axis. */
+KD_API void KD_APIENTRY kdMat4RotationVEN(KDMat4VEN *out, KDfloat32 angle, KDfloat32 x, KDfloat32 y, KDfloat32 z)
+{
+    kdMat4IdentityVEN(out);
+    KDfloat32 len = kdSqrtf(x * x + y * y + z * z);
+    if(!(len > 0.0f))
+    {
+        return;
+    }
+    x /= len;
+    y /= len;
+    z /= len;
+
+    KDfloat32 s = kdSinf(angle);
+    KDfloat32 c = kdCosf(angle);
+    KDfloat32 t = 1.0f - c;
+
+    out->m[0] = x * x * t + c;
+    out->m[1] = y * x * t + z * s;
+    out->m[2] = z * x * t - y * s;
+    out->m[4] = x * y * t - z * s;
+    out->m[5] = y * y * t + c;
+    out->m[6] = z * y * t + x * s;
+    out->m[8] = x * z * t + y * s;
+    out->m[9] = y * z * t - x * s;
+    out->m[10] = z * z * t + c;
+}
+
+/* kdMat4FrustumVEN: Build a perspective projection from clip planes. */
+KD_API void KD_APIENTRY kdMat4FrustumVEN(KDMat4VEN *out, KDfloat32 left, KDfloat32 right, KDfloat32 bottom, KDfloat32 top, KDfloat32 nearz, KDfloat32 farz)
+{
+    KDfloat32 dx = right - left;
+    KDfloat32 dy = top - bottom;
+    KDfloat32 dz = farz - nearz;
+
+    kdMemset(out->m, 0, sizeof(out->m));
+    out->m[0] = 2.0f * nearz / dx;
+    out->m[5] = 2.0f * nearz / dy;
+    out->m[8] = (right + left) / dx;
+    out->m[9] = (top + bottom) / dy;
+    out->m[10] = -(farz + nearz) / dz;
+    out->m[11] = -1.0f;
+    out->m[14] = -2.0f * nearz * farz / dz;
+}
+
+/* kdMat4PerspectiveVEN: Build a perspective projection from a vertical field of view. */
+KD_API void KD_APIENTRY kdMat4PerspectiveVEN(KDMat4VEN *out, KDfloat32 fovy, KDfloat32 aspect, KDfloat32 nearz, KDfloat32 farz)
+{
+    KDfloat32 f = 1.0f / kdTanf(fovy * 0.5f);
+    KDfloat32 dz = nearz - farz;
+
+    kdMemset(out->m, 0, sizeof(out->m));
+    out->m[0] = f / aspect;
+    out->m[5] = f;
+    out->m[10] = (farz + nearz) / dz;
+    out->m[11] = -1.0f;
+    out->m[14] = 2.0f * farz * nearz / dz;
+}
+
+/* kdMat4OrthoVEN: Build an orthographic projection. */
+KD_API void KD_APIENTRY kdMat4OrthoVEN(KDMat4VEN *out, KDfloat32 left, KDfloat32 right, KDfloat32 bottom, KDfloat32 top, KDfloat32 nearz, KDfloat32 farz)
+{
+    KDfloat32 dx = right - left;
+    KDfloat32 dy = top - bottom;
+    KDfloat32 dz = farz - nearz;
+
+    kdMat4IdentityVEN(out);
+    out->m[0] = 2.0f / dx;
+    out->m[5] = 2.0f / dy;
+    out->m[10] = -2.0f / dz;
+    out->m[12] = -(right + left) / dx;
+    out->m[13] = -(top + bottom) / dy;
+    out->m[14] = -(farz + nearz) / dz;
+}
+
+/* kdMat4LookAtVEN: Build a viewing matrix. */
+KD_API void KD_APIENTRY kdMat4LookAtVEN(KDMat4VEN *out, const KDVec3VEN *eye, const KDVec3VEN *center, const KDVec3VEN *up)
+{
+    KDVec3VEN f;
+    KDVec3VEN s;
+    KDVec3VEN u;
+    kdVec3SubVEN(&f, center, eye);
+    kdVec3NormalizeVEN(&f, &f);
+    kdVec3CrossVEN(&s, &f, up);
+    kdVec3NormalizeVEN(&s, &s);
+    kdVec3CrossVEN(&u, &s, &f);
+
+    out->m[0] = s.x;
+    out->m[1] = u.x;
+    out->m[2] = -f.x;
+    out->m[3] = 0.0f;
+    out->m[4] = s.y;
+    out->m[5] = u.y;
+    out->m[6] = -f.y;
+    out->m[7] = 0.0f;
+    out->m[8] = s.z;
+    out->m[9] = u.z;
+    out->m[10] = -f.z;
+    out->m[11] = 0.0f;
+    out->m[12] = -kdVec3DotVEN(&s, eye);
+    out->m[13] = -kdVec3DotVEN(&u, eye);
+    out->m[14] = kdVec3DotVEN(&f, eye);
+    out->m[15] = 1.0f;
+}
+
+/* kdMat4FromQuatVEN: Build a rotation matrix from a unit quaternion. */
+KD_API void KD_APIENTRY kdMat4FromQuatVEN(KDMat4VEN *out, const KDQuatVEN *q)
+{
+    KDfloat32 xx = q->x * q->x;
+    KDfloat32 yy = q->y * q->y;
+    KDfloat32 zz = q->z * q->z;
+    KDfloat32 xy = q->x * q->y;
+    KDfloat32 xz = q->x * q->z;
+    KDfloat32 yz = q->y * q->z;
+    KDfloat32 wx = q->w * q->x;
+    KDfloat32 wy = q->w * q->y;
+    KDfloat32 wz = q->w * q->z;
+
+    kdMat4IdentityVEN(out);
+    out->m[0] = 1.0f - 2.0f * (yy + zz);
+    out->m[1] = 2.0f * (xy + wz);
+    out->m[2] = 2.0f * (xz - wy);
+    out->m[4] = 2.0f * (xy - wz);
+    out->m[5] = 1.0f - 2.0f * (xx + zz);
+    out->m[6] = 2.0f * (yz + wx);
+    out->m[8] = 2.0f * (xz + wy);
+    out->m[9] = 2.0f * (yz - wx);
+    out->m[10] = 1.0f - 2.0f * (xx + yy);
+}
+
+/* kdMat4MultiplyVEN: Multiply two matrices (out = a * b). */
+KD_API void KD_APIENTRY kdMat4MultiplyVEN(KDMat4VEN *out, const KDMat4VEN *a, const KDMat4VEN *b)
+{
+#if defined(__SSE__)
+    /* Keep everything in registers so out may alias a or b. */
+    __m128 c0 = _mm_loadu_ps(&a->m[0]);
+    __m128 c1 = _mm_loadu_ps(&a->m[4]);
+    __m128 c2 = _mm_loadu_ps(&a->m[8]);
+    __m128 c3 = _mm_loadu_ps(&a->m[12]);
+    __m128 v[4];
+    for(KDint i = 0; i < 4; i++)
+    {
+        v[i] = _mm_loadu_ps(&b->m[i * 4]);
+    }
+    for(KDint i = 0; i < 4; i++)
+    {
+        __m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(v[i], v[i], _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(v[i], v[i], _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v[i], v[i], _MM_SHUFFLE(2, 2, 2, 2))));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(v[i], v[i], _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm_storeu_ps(&out->m[i * 4], r);
+    }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    float32x4_t c0 = vld1q_f32(&a->m[0]);
+    float32x4_t c1 = vld1q_f32(&a->m[4]);
+    float32x4_t c2 = vld1q_f32(&a->m[8]);
+    float32x4_t c3 = vld1q_f32(&a->m[12]);
+    float32x4_t v[4];
+    for(KDint i = 0; i < 4; i++)
+    {
+        v[i] = vld1q_f32(&b->m[i * 4]);
+    }
+    for(KDint i = 0; i < 4; i++)
+    {
+        float32x4_t r = vmulq_lane_f32(c0, vget_low_f32(v[i]), 0);
+        r = vmlaq_lane_f32(r, c1, vget_low_f32(v[i]), 1);
+        r = vmlaq_lane_f32(r, c2, vget_high_f32(v[i]), 0);
+        r = vmlaq_lane_f32(r, c3, vget_high_f32(v[i]), 1);
+        vst1q_f32(&out->m[i * 4], r);
+    }
+#else
+    KDMat4VEN tmp;
+    __kdMat4Transform(tmp.m, a->m, b->m, 4, __KD_VECMATH_W_INPUT);
+    kdMemcpy(out->m, tmp.m, sizeof(tmp.m));
+#endif
+}
+
+/* kdMat4TransposeVEN: Transpose a matrix. */
+KD_API void KD_APIENTRY kdMat4TransposeVEN(KDMat4VEN *out, const KDMat4VEN *m)
+{
+#if defined(__SSE__)
+    __m128 c0 = _mm_loadu_ps(&m->m[0]);
+    __m128 c1 = _mm_loadu_ps(&m->m[4]);
+    __m128 c2 = _mm_loadu_ps(&m->m[8]);
+    __m128 c3 = _mm_loadu_ps(&m->m[12]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_storeu_ps(&out->m[0], c0);
+    _mm_storeu_ps(&out->m[4], c1);
+    _mm_storeu_ps(&out->m[8], c2);
+    _mm_storeu_ps(&out->m[12], c3);
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    float32x4x4_t t = vld4q_f32(m->m);
+    vst1q_f32(&out->m[0], t.val[0]);
+    vst1q_f32(&out->m[4], t.val[1]);
+    vst1q_f32(&out->m[8], t.val[2]);
+    vst1q_f32(&out->m[12], t.val[3]);
+#else
+    KDMat4VEN tmp;
+    for(KDint col = 0; col < 4; col++)
+    {
+        for(KDint row = 0; row < 4; row++)
+        {
+            tmp.m[row * 4 + col] = m->m[col * 4 + row];
+        }
+    }
+    kdMemcpy(out->m, tmp.m, sizeof(tmp.m));
+#endif
+}
+
+/* kdMat4InverseVEN: Invert a matrix. */
+KD_API KDint KD_APIENTRY kdMat4InverseVEN(KDMat4VEN *out, const KDMat4VEN *m)
+{
+    /* Cofactors from 2x2 sub-determinants. The expansion is symmetric in
+     * rows and columns, so it does not care about the storage order. */
+    const KDfloat32 *a = m->m;
+    KDfloat32 s0 = a[0] * a[5] - a[4] * a[1];
+    KDfloat32 s1 = a[0] * a[6] - a[4] * a[2];
+    KDfloat32 s2 = a[0] * a[7] - a[4] * a[3];
+    KDfloat32 s3 = a[1] * a[6] - a[5] * a[2];
+    KDfloat32 s4 = a[1] * a[7] - a[5] * a[3];
+    KDfloat32 s5 = a[2] * a[7] - a[6] * a[3];
+    KDfloat32 c5 = a[10] * a[15] - a[14] * a[11];
+    KDfloat32 c4 = a[9] * a[15] - a[13] * a[11];
+    KDfloat32 c3 = a[9] * a[14] - a[13] * a[10];
+    KDfloat32 c2 = a[8] * a[15] - a[12] * a[11];
+    KDfloat32 c1 = a[8] * a[14] - a[12] * a[10];
+    KDfloat32 c0 = a[8] * a[13] - a[12] * a[9];
+
+    KDfloat32 det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if(!(det > 0.0f || det < 0.0f))
+    {
+        kdSetError(KD_EINVAL);
+        return -1;
+    }
+
+    KDMat4VEN tmp;
+    tmp.m[0] = a[5] * c5 - a[6] * c4 + a[7] * c3;
+    tmp.m[1] = -a[1] * c5 + a[2] * c4 - a[3] * c3;
+    tmp.m[2] = a[13] * s5 - a[14] * s4 + a[15] * s3;
+    tmp.m[3] = -a[9] * s5 + a[10] * s4 - a[11] * s3;
+    tmp.m[4] = -a[4] * c5 + a[6] * c2 - a[7] * c1;
+    tmp.m[5] = a[0] * c5 - a[2] * c2 + a[3] * c1;
+    tmp.m[6] = -a[12] * s5 + a[14] * s2 - a[15] * s1;
+    tmp.m[7] = a[8] * s5 - a[10] * s2 + a[11] * s1;
+    tmp.m[8] = a[4] * c4 - a[5] * c2 + a[7] * c0;
+    tmp.m[9] = -a[0] * c4 + a[1] * c2 - a[3] * c0;
+    tmp.m[10] = a[12] * s4 - a[13] * s2 + a[15] * s0;
+    tmp.m[11] = -a[8] * s4 + a[9] * s2 - a[11] * s0;
+    tmp.m[12] = -a[4] * c3 + a[5] * c1 - a[6] * c0;
+    tmp.m[13] = a[0] * c3 - a[1] * c1 + a[2] * c0;
+    tmp.m[14] = -a[12] * s3 + a[13] * s1 - a[14] * s0;
+    tmp.m[15] = a[8] * s3 - a[9] * s1 + a[10] * s0;
+
+    KDfloat32 invdet = 1.0f / det;
+#if defined(__SSE__)
+    __m128 d = _mm_set1_ps(invdet);
+    for(KDint i = 0; i < 16; i += 4)
+    {
+        _mm_storeu_ps(&out->m[i], _mm_mul_ps(_mm_loadu_ps(&tmp.m[i]), d));
+    }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for(KDint i = 0; i < 16; i += 4)
+    {
+        vst1q_f32(&out->m[i], vmulq_n_f32(vld1q_f32(&tmp.m[i]), invdet));
+    }
+#else
+    for(KDint i = 0; i < 16; i++)
+    {
+        out->m[i] = tmp.m[i] * invdet;
+    }
+#endif
+    return 0;
+}
+
+/* kdMat4TranslateVEN: Apply a translation to a matrix (m = m * T). */
+KD_API void KD_APIENTRY kdMat4TranslateVEN(KDMat4VEN *m, KDfloat32 x, KDfloat32 y, KDfloat32 z)
+{
+    for(KDint row = 0; row < 4; row++)
+    {
+        m->m[12 + row] += m->m[row] * x + m->m[4 + row] * y + m->m[8 + row] * z;
+    }
+}
+
+/* kdMat4RotateVEN: Apply a rotation to a matrix (m = m * R). */
+KD_API void KD_APIENTRY kdMat4RotateVEN(KDMat4VEN *m, KDfloat32 angle, KDfloat32 x, KDfloat32 y, KDfloat32 z)
+{
+    KDMat4VEN r;
+    kdMat4RotationVEN(&r, angle, x, y, z);
+    kdMat4MultiplyVEN(m, m, &r);
+}
+
+/* kdMat4ScaleVEN: Apply a scaling to a matrix (m = m * S). */
+KD_API void KD_APIENTRY kdMat4ScaleVEN(KDMat4VEN *m, KDfloat32 x, KDfloat32 y, KDfloat32 z)
+{
+    for(KDint row = 0; row < 4; row++)
+    {
+        m->m[row] *= x;
+        m->m[4 + row] *= y;
+        m->m[8 + row] *= z;
+    }
+}
+
+/* kdMat4TransformVec4VEN: Transform a 4-component vector. */
+KD_API void KD_APIENTRY kdMat4TransformVec4VEN(KDVec4VEN *out, const KDMat4VEN *m, const KDVec4VEN *v)
+{
+    KDVec4VEN tmp;
+    __kdMat4Transform(&tmp.x, m->m, &v->x, 1, __KD_VECMATH_W_INPUT);
+    *out = tmp;
+}
+
+/* kdMat4TransformVec4ArrayVEN: Transform an array of 4-component vectors. */
+KD_API void KD_APIENTRY kdMat4TransformVec4ArrayVEN(KDVec4VEN *out, const KDMat4VEN *m, const KDVec4VEN *in, KDsize count)
+{
+    if(count)
+    {
+        __kdMat4Transform(&out->x, m->m, &in->x, count, __KD_VECMATH_W_INPUT);
+    }
+}
+
+/* kdMat4TransformPointsVEN: Transform an array of points (w = 1, no projective divide). */
+KD_API void KD_APIENTRY kdMat4TransformPointsVEN(KDVec3VEN *out, const KDMat4VEN *m, const KDVec3VEN *in, KDsize count)
+{
+    if(count)
+    {
+        __kdMat4Transform(&out->x, m->m, &in->x, count, __KD_VECMATH_W_ONE);
+    }
+}
+
+/* kdMat4TransformNormalsVEN: Transform an array of directions (w = 0). */
+KD_API void KD_APIENTRY kdMat4TransformNormalsVEN(KDVec3VEN *out, const KDMat4VEN *m, const KDVec3VEN *in, KDsize count)
+{
+    if(count)
+    {
+        __kdMat4Transform(&out->x, m->m, &in->x, count, __KD_VECMATH_W_ZERO);
+    }
+}
+
+/* kdQuatIdentityVEN: Build an identity quaternion. */
+KD_API void KD_APIENTRY kdQuatIdentityVEN(KDQuatVEN *out)
+{
+    out->x = 0.0f;
+    out->y = 0.0f;
+    out->z = 0.0f;
+    out->w = 1.0f;
+}
+
+/* kdQuatFromAxisAngleVEN: Build a quaternion from a rotation axis and angle. */
+KD_API void KD_APIENTRY kdQuatFromAxisAngleVEN(KDQuatVEN *out, const KDVec3VEN *axis, KDfloat32 angle)
+{
+    KDVec3VEN n;
+    kdVec3NormalizeVEN(&n, axis);
+    KDfloat32 s = kdSinf(angle * 0.5f);
+    out->x = n.x * s;
+    out->y = n.y * s;
+    out->z = n.z * s;
+    out->w = kdCosf(angle * 0.5f);
+}
+
+/* kdQuatMultiplyVEN: Concatenate two rotations (out = a * b, b is applied first). */
+KD_API void KD_APIENTRY kdQuatMultiplyVEN(KDQuatVEN *out, const KDQuatVEN *a, const KDQuatVEN *b)
+{
+    KDQuatVEN tmp;
+    tmp.x = a->w * b->x + a->x * b->w + a->y * b->z - a->z * b->y;
+    tmp.y = a->w * b->y - a->x * b->z + a->y * b->w + a->z * b->x;
+    tmp.z = a->w * b->z + a->x * b->y - a->y * b->x + a->z * b->w;
+    tmp.w = a->w * b->w - a->x * b->x - a->y * b->y - a->z * b->z;
+    *out = tmp;
+}
+
+/* kdQuatNormalizeVEN: Scale a quaternion to unit length. */
+KD_API void KD_APIENTRY kdQuatNormalizeVEN(KDQuatVEN *out, const KDQuatVEN *q)
+{
+    KDfloat32 len = kdSqrtf(q->x * q->x + q->y * q->y + q->z * q->z + q->w * q->w);
+    if(!(len > 0.0f))
+    {
+        kdQuatIdentityVEN(out);
+        return;
+    }
+    KDfloat32 inv = 1.0f / len;
+    out->x = q->x * inv;
+    out->y = q->y * inv;
+    out->z = q->z * inv;
+    out->w = q->w * inv;
+}
+
+/* kdQuatSlerpVEN: Spherical linear interpolation between two unit quaternions. */
+KD_API void KD_APIENTRY kdQuatSlerpVEN(KDQuatVEN *out, const KDQuatVEN *a, const KDQuatVEN *b, KDfloat32 t)
+{
+    KDQuatVEN end = *b;
+    KDfloat32 cosom = a->x * b->x + a->y * b->y + a->z * b->z + a->w * b->w;
+    /* Take the shorter arc. */
+    if(cosom < 0.0f)
+    {
+        cosom = -cosom;
+        end.x = -end.x;
+        end.y = -end.y;
+        end.z = -end.z;
+        end.w = -end.w;
+    }
+
+    KDfloat32 k0 = 1.0f - t;
+    KDfloat32 k1 = t;
+    /* Fall back to nlerp when the quaternions are nearly parallel. */
+    if(cosom < 0.9995f)
+    {
+        KDfloat32 omega = kdAcosf(cosom);
+        KDfloat32 sinom = kdSinf(omega);
+        k0 = kdSinf(k0 * omega) / sinom;
+        k1 = kdSinf(k1 * omega) / sinom;
+    }
+
+    KDQuatVEN tmp;
+    tmp.x = k0 * a->x + k1 * end.x;
+    tmp.y = k0 * a->y + k1 * end.y;
+    tmp.z = k0 * a->z + k1 * end.z;
+    tmp.w = k0 * a->w + k1 * end.w;
+    kdQuatNormalizeVEN(out, &tmp);
+}
+
+/* kdQuatRotateVec3VEN: Rotate a 3-component vector by a unit quaternion. */
+KD_API void KD_APIENTRY kdQuatRotateVec3VEN(KDVec3VEN *out, const KDQuatVEN *q, const KDVec3VEN *v)
+{
+    /* v' = v + w * t + q x t, with t = 2 * (q x v) */
+    KDVec3VEN u;
+    KDVec3VEN t;
+    KDVec3VEN c;
+    kdVec3SetVEN(&u, q->x, q->y, q->z);
+    kdVec3CrossVEN(&t, &u, v);
+    kdVec3ScaleVEN(&t, &t, 2.0f);
+    kdVec3CrossVEN(&c, &u, &t);
+    kdVec3SetVEN(out, v->x + q->w * t.x + c.x, v->y + q->w * t.y + c.y, v->z + q->w * t.z + c.z);
+}
@@ -31,11 +31,11 @@ KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
     KDssize sizef = kdFtostr(stringf, KD_FTOSTR_MAXLEN, 1.23456789f);
     KDfloat32 f = kdStrtof(stringf, KD_NULL);
     TEST_APPROXF(f, 1.23456789f);
-    TEST_EXPR(sizef == 10);
+    TEST_EXPR(sizef == 9);
     sizef = kdFtostr(stringf, KD_FTOSTR_MAXLEN, -1.23456789f);
     f = kdStrtof(stringf, KD_NULL);
     TEST_APPROXF(f, -1.23456789f);
-    TEST_EXPR(sizef == 11);
+    TEST_EXPR(sizef == 10);
 
     KDchar string[KD_DTOSTR_MAXLEN_KHR];
     KDssize size = kdDtostrKHR(string, KD_DTOSTR_MAXLEN_KHR, 1.2345678910111213);
@@ -0,0 +1,131 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include <KD/KHR_float64.h>
+#include "test.h"
+
+typedef union {
+    KDfloat64KHR f;
+    KDuint64 u;
+} test_bits64;
+
+typedef union {
+    KDfloat32 f;
+    KDuint32 u;
+} test_bits32;
+
+static void test_ftostr(KDfloat32 number, const KDchar *expected)
+{
+    KDchar buffer[KD_FTOSTR_MAXLEN];
+    KDssize size = kdFtostr(buffer, KD_FTOSTR_MAXLEN, number);
+    TEST_STREQ(buffer, expected);
+    TEST_EQ(size, (KDssize)kdStrlen(expected));
+}
+
+static void test_dtostr(KDfloat64KHR number, const KDchar *expected)
+{
+    KDchar buffer[KD_DTOSTR_MAXLEN_KHR];
+    KDssize size = kdDtostrKHR(buffer, KD_DTOSTR_MAXLEN_KHR, number);
+    TEST_STREQ(buffer, expected);
+    TEST_EQ(size, (KDssize)kdStrlen(expected));
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    /* Shortest digits that round-trip */
+    test_ftostr(0.0f, "0");
+    test_ftostr(-0.0f, "-0");
+    test_ftostr(1.0f, "1");
+    test_ftostr(0.1f, "0.1");
+    test_ftostr(-1.5f, "-1.5");
+    test_ftostr(1.23456789f, "1.2345679");
+    test_ftostr(16777216.0f, "16777216");
+    test_ftostr(123456789.0f, "123456790");
+    test_ftostr(1e9f, "1e+09");
+    test_ftostr(0.0001f, "0.0001");
+    test_ftostr(0.00001f, "1e-05");
+    test_ftostr(3.4028235e38f, "3.4028235e+38");
+    test_ftostr(-1.17549435e-38f, "-1.1754944e-38");
+    test_ftostr(1.4e-45f, "1e-45");
+    test_ftostr(2.9427e-44f, "3e-44");
+    test_ftostr(KD_INFINITY, "Inf");
+    test_ftostr(-KD_INFINITY, "-Inf");
+    test_ftostr(KD_NANF, "NaN");
+
+    test_dtostr(0.0, "0");
+    test_dtostr(0.1, "0.1");
+    test_dtostr(0.3, "0.3");
+    test_dtostr(2.0 / 3.0, "0.6666666666666666");
+    test_dtostr(1e16, "10000000000000000");
+    test_dtostr(1e17, "1e+17");
+    test_dtostr(9007199254740993.0, "9007199254740992");
+    test_dtostr(123456789012345678.0, "1.2345678901234568e+17");
+    test_dtostr(1e21, "1e+21");
+    test_dtostr(1e100, "1e+100");
+    test_dtostr(5.684341886080802e-14, "5.684341886080802e-14");
+    test_dtostr(1.7976931348623157e308, "1.7976931348623157e+308");
+    test_dtostr(-2.2250738585072014e-308, "-2.2250738585072014e-308");
+    test_dtostr(4.9406564584124654e-324, "5e-324");
+    test_dtostr(KD_HUGE_VAL_KHR, "Inf");
+
+    /* Round-trip through kdStrtodKHR and kdStrtof */
+    KDchar buffer[KD_DTOSTR_MAXLEN_KHR];
+    KDuint64 seed = 0x2545F4914F6CDD1DULL;
+    for(KDint i = 0; i < 100000; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        test_bits64 d, d2;
+        d.u = seed;
+        if(!kdIsNan(d.f) && kdDtostrKHR(buffer, sizeof(buffer), d.f) > 0)
+        {
+            d2.f = kdStrtodKHR(buffer, KD_NULL);
+            TEST_EXPR(d.u == d2.u);
+        }
+        test_bits32 f, f2;
+        f.u = (KDuint32)seed;
+        if(!kdIsNan(f.f) && kdFtostr(buffer, KD_FTOSTR_MAXLEN, f.f) > 0)
+        {
+            f2.f = kdStrtof(buffer, KD_NULL);
+            TEST_EXPR(f.u == f2.u);
+        }
+    }
+
+    /* Buffer too small */
+    TEST_EQ(kdFtostr(buffer, 3, 1.5f), -1);
+    TEST_EQ(kdFtostr(buffer, 4, 1.5f), 3);
+    TEST_EQ(kdFtostr(buffer, 0, 1.5f), -1);
+
+    /* Arrays */
+    const KDfloat32 numbers[] = {1.0f, -0.5f, 0.1f, 1e20f};
+    KDchar line[64];
+    TEST_EQ(kdFtostrArrayVEN(line, sizeof(line), numbers, 4, ' '), 16);
+    TEST_STREQ(line, "1 -0.5 0.1 1e+20");
+    TEST_EQ(kdFtostrArrayVEN(line, sizeof(line), numbers, 0, ','), 0);
+    TEST_STREQ(line, "");
+    TEST_EQ(kdFtostrArrayVEN(line, 10, numbers, 4, ','), -1);
+    return 0;
+}
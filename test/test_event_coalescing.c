@@ -0,0 +1,133 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+static KDint window1 = 0;
+static KDint window2 = 0;
+
+static void post_motion(void *userptr, KDint32 x, KDust timestamp)
+{
+    KDEvent *event = kdCreateEvent();
+    event->type = KD_EVENT_INPUT_POINTER;
+    event->userptr = userptr;
+    event->timestamp = timestamp;
+    event->data.inputpointer.index = KD_INPUT_POINTER_X;
+    event->data.inputpointer.select = 0;
+    event->data.inputpointer.x = x;
+    event->data.inputpointer.y = -x;
+    TEST_EQ(kdPostEvent(event), 0);
+}
+
+#if defined(KD_WINDOW_SUPPORTED)
+static void post_property(KDint32 pname, KDust timestamp)
+{
+    KDEvent *event = kdCreateEvent();
+    event->type = KD_EVENT_WINDOWPROPERTY_CHANGE;
+    event->userptr = &window1;
+    event->timestamp = timestamp;
+    event->data.windowproperty.pname = pname;
+    TEST_EQ(kdPostEvent(event), 0);
+}
+#endif
+
+static const KDEvent *next_event(void)
+{
+    const KDEvent *event = kdWaitEvent(-1);
+    TEST_EXPR(event != KD_NULL);
+    return event;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    TEST_EQ(kdSetEventCoalescingVEN(KD_EVENT_QUIT, 1), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    TEST_EQ(kdGetEventCoalescedCountVEN(KD_EVENT_INPUT_POINTER), 0);
+
+    /* Disabled by default, every event is delivered */
+    post_motion(&window1, 1, 1);
+    post_motion(&window1, 2, 2);
+    TEST_EQ(next_event()->data.inputpointer.x, 1);
+    TEST_EQ(next_event()->data.inputpointer.x, 2);
+    TEST_EQ(kdWaitEvent(-1), KD_NULL);
+
+    TEST_EQ(kdSetEventCoalescingVEN(KD_EVENT_INPUT_POINTER, 1), 0);
+#if defined(KD_WINDOW_SUPPORTED)
+    TEST_EQ(kdSetEventCoalescingVEN(KD_EVENT_WINDOWPROPERTY_CHANGE, 1), 0);
+#endif
+
+    /* A run of motion merges into the latest position at the earliest time */
+    for(KDint32 i = 0; i < 40; i++)
+    {
+        post_motion(&window1, i, 100 + i);
+    }
+    /* Other windows and button presses end a run */
+    post_motion(&window2, 7, 200);
+    KDEvent *select = kdCreateEvent();
+    select->type = KD_EVENT_INPUT_POINTER;
+    select->userptr = &window1;
+    select->data.inputpointer.index = KD_INPUT_POINTER_SELECT;
+    select->data.inputpointer.select = 1;
+    TEST_EQ(kdPostEvent(select), 0);
+    post_motion(&window1, 50, 300);
+    post_motion(&window1, 51, 301);
+
+    const KDEvent *event = next_event();
+    TEST_EQ(event->userptr, &window1);
+    TEST_EQ(event->timestamp, 100);
+    TEST_EQ(event->data.inputpointer.x, 39);
+    TEST_EQ(event->data.inputpointer.y, -39);
+    event = next_event();
+    TEST_EQ(event->userptr, &window2);
+    TEST_EQ(event->data.inputpointer.x, 7);
+    event = next_event();
+    TEST_EQ(event->data.inputpointer.index, KD_INPUT_POINTER_SELECT);
+    event = next_event();
+    TEST_EQ(event->timestamp, 300);
+    TEST_EQ(event->data.inputpointer.x, 51);
+    TEST_EQ(kdWaitEvent(-1), KD_NULL);
+    TEST_EQ(kdGetEventCoalescedCountVEN(KD_EVENT_INPUT_POINTER), 40);
+
+#if defined(KD_WINDOW_SUPPORTED)
+    /* Property changes merge only for the same property */
+    post_property(KD_WINDOWPROPERTY_SIZE, 10);
+    post_property(KD_WINDOWPROPERTY_SIZE, 11);
+    post_property(KD_WINDOWPROPERTY_FOCUS, 12);
+    post_property(KD_WINDOWPROPERTY_FOCUS, 13);
+    TEST_EQ(next_event()->data.windowproperty.pname, KD_WINDOWPROPERTY_SIZE);
+    TEST_EQ(next_event()->data.windowproperty.pname, KD_WINDOWPROPERTY_FOCUS);
+    TEST_EQ(kdWaitEvent(-1), KD_NULL);
+    TEST_EQ(kdGetEventCoalescedCountVEN(KD_EVENT_WINDOWPROPERTY_CHANGE), 2);
+#endif
+
+    /* Disabling delivers events one by one again */
+    TEST_EQ(kdSetEventCoalescingVEN(KD_EVENT_INPUT_POINTER, 0), 0);
+    post_motion(&window1, 1, 1);
+    post_motion(&window1, 2, 2);
+    TEST_EQ(next_event()->data.inputpointer.x, 1);
+    TEST_EQ(next_event()->data.inputpointer.x, 2);
+    TEST_EQ(kdGetEventCoalescedCountVEN(KD_EVENT_INPUT_POINTER), 40);
+    return 0;
+}
@@ -0,0 +1,104 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+static void post(KDint32 type, KDint64 value)
+{
+    KDEvent *event = kdCreateEvent();
+    event->type = type;
+    event->data.user.value1.i64 = value;
+    TEST_EQ(kdPostEvent(event), 0);
+}
+
+static const KDEvent *next_event(void)
+{
+    const KDEvent *event = kdWaitEvent(-1);
+    TEST_EXPR(event != KD_NULL);
+    return event;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    /* Lanes by type, first in first out within a lane */
+    post(KD_EVENT_USER, 1);
+    post(KD_EVENT_USER, 2);
+    post(KD_EVENT_TIMER, 3);
+    post(KD_EVENT_INPUT, 4);
+    post(KD_EVENT_QUIT, 5);
+    TEST_EQ(next_event()->type, KD_EVENT_QUIT);
+    TEST_EQ(next_event()->type, KD_EVENT_INPUT);
+    TEST_EQ(next_event()->type, KD_EVENT_TIMER);
+    TEST_EQ(next_event()->data.user.value1.i64, 1);
+    TEST_EQ(next_event()->data.user.value1.i64, 2);
+    TEST_EQ(kdWaitEvent(-1), KD_NULL);
+    TEST_EQ(kdGetError(), KD_EAGAIN);
+
+    /* Explicit lanes */
+    KDEvent *event = kdCreateEvent();
+    event->type = KD_EVENT_USER;
+    TEST_EQ(kdPostThreadEventPriorityVEN(event, kdThreadSelf(), 4), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    post(KD_EVENT_INPUT, 0);
+    event = kdCreateEvent();
+    event->type = KD_EVENT_USER;
+    TEST_EQ(kdPostThreadEventPriorityVEN(event, kdThreadSelf(), KD_EVENT_PRIORITY_SYSTEM_VEN), 0);
+    TEST_EQ(next_event()->type, KD_EVENT_USER);
+    TEST_EQ(next_event()->type, KD_EVENT_INPUT);
+
+    /* A busy higher lane does not starve the lower ones */
+    for(KDint i = 0; i < 40; i++)
+    {
+        post(KD_EVENT_INPUT, i);
+    }
+    post(KD_EVENT_USER, 100);
+    KDint position = -1;
+    for(KDint i = 0; i < 41; i++)
+    {
+        if(next_event()->type == KD_EVENT_USER)
+        {
+            position = i;
+        }
+    }
+    TEST_EXPR(position > 0 && position < 10);
+    TEST_EQ(kdWaitEvent(-1), KD_NULL);
+
+    /* A full user lane still takes quit */
+    while(1)
+    {
+        event = kdCreateEvent();
+        event->type = KD_EVENT_USER;
+        if(kdPostEvent(event) == -1)
+        {
+            break;
+        }
+    }
+    post(KD_EVENT_QUIT, 0);
+    TEST_EQ(next_event()->type, KD_EVENT_QUIT);
+    while(kdWaitEvent(-1))
+    {
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define MILLISECOND 1000000LL
+#define MANY 10000
+
+static KDEvent *user_event(KDint64 value)
+{
+    KDEvent *event = kdCreateEvent();
+    event->type = KD_EVENT_USER;
+    event->data.user.value1.i64 = value;
+    return event;
+}
+
+static void *poster(void *arg)
+{
+    TEST_EQ(kdPostThreadEventAtVEN(user_event(7), (KDThread *)arg, kdGetTimeUST() + 50 * MILLISECOND), 0);
+    return KD_NULL;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    /* Delivered by deadline, ties in posting order, never early */
+    KDust start = kdGetTimeUST();
+    TEST_EQ(kdPostEventAtVEN(user_event(3), start + 30 * MILLISECOND), 0);
+    TEST_EQ(kdPostEventAtVEN(user_event(1), start + 10 * MILLISECOND), 0);
+    TEST_EQ(kdPostEventAtVEN(user_event(2), start + 20 * MILLISECOND), 0);
+    TEST_EQ(kdPostEventAtVEN(user_event(4), start + 30 * MILLISECOND), 0);
+    TEST_EQ(kdWaitEvent(-1), KD_NULL);
+    for(KDint64 i = 1; i <= 4; i++)
+    {
+        const KDEvent *event = kdWaitEvent(5000 * MILLISECOND);
+        TEST_EXPR(event != KD_NULL);
+        TEST_EQ(event->data.user.value1.i64, i);
+        TEST_EXPR(kdGetTimeUST() >= start + ((i < 4) ? i : 3) * 10 * MILLISECOND);
+    }
+    TEST_EXPR(kdGetTimeUST() - start < 1000 * MILLISECOND);
+
+    /* A deadline in the past is due right away */
+    TEST_EQ(kdPostEventAtVEN(user_event(5), 0), 0);
+    const KDEvent *event = kdWaitEvent(-1);
+    TEST_EXPR(event != KD_NULL && event->data.user.value1.i64 == 5);
+
+    /* Many scheduled events cost heap entries, not threads */
+    start = kdGetTimeUST();
+    KDuint32 seed = 1;
+    for(KDint i = 0; i < MANY; i++)
+    {
+        seed = seed * 1103515245U + 12345U;
+        TEST_EQ(kdPostEventAtVEN(user_event((KDint64)(seed % 50) * MILLISECOND), start + (KDust)(seed % 50) * MILLISECOND), 0);
+    }
+    KDint64 last = -1;
+    for(KDint i = 0; i < MANY; i++)
+    {
+        event = kdWaitEvent(5000 * MILLISECOND);
+        TEST_EXPR(event != KD_NULL);
+        TEST_EXPR(event->data.user.value1.i64 >= last);
+        last = event->data.user.value1.i64;
+    }
+    TEST_EQ(kdWaitEvent(-1), KD_NULL);
+
+    /* Scheduling from another thread shortens a blocked wait */
+    KDThread *thread = kdThreadCreate(KD_NULL, poster, kdThreadSelf());
+    if(thread == KD_NULL && kdGetError() == KD_ENOSYS)
+    {
+        return 0;
+    }
+    TEST_EXPR(thread != KD_NULL);
+    start = kdGetTimeUST();
+    event = kdWaitEvent(5000 * MILLISECOND);
+    TEST_EXPR(event != KD_NULL && event->data.user.value1.i64 == 7);
+    TEST_EXPR(kdGetTimeUST() - start < 2000 * MILLISECOND);
+    TEST_EQ(kdThreadJoin(thread, KD_NULL), 0);
+
+    /* Pending events go away with their thread */
+    TEST_EQ(kdPostEventAtVEN(user_event(8), kdGetTimeUST() + 60000 * MILLISECOND), 0);
+    return 0;
+}
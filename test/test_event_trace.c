@@ -0,0 +1,125 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define MILLISECOND 1000000LL
+#define RECORDED 20
+
+static KDint64 handled[RECORDED];
+static KDint handledcount = 0;
+
+static void KD_APIENTRY callback(const KDEvent *event)
+{
+    handled[handledcount++] = event->data.user.value1.i64;
+}
+
+static KDEvent *user_event(KDint32 type, KDint64 value)
+{
+    KDEvent *event = kdCreateEvent();
+    event->type = type;
+    event->userptr = (void *)(KDuintptr)(0x1000 + value);
+    event->data.user.value1.i64 = value;
+    event->data.user.value23.i64 = -value;
+    return event;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    const KDchar *path = "test_event_trace.bin";
+    kdRemove(path);
+    TEST_EQ(kdEventTraceStopVEN(), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+
+    /* Every other event is taken by a callback, the rest by kdWaitEvent */
+    for(KDint64 i = 0; i < RECORDED; i += 2)
+    {
+        kdInstallCallback(&callback, KD_EVENT_USER + 1, (void *)(KDuintptr)(0x1000 + i + 1));
+    }
+    TEST_EQ(kdEventTraceStartVEN(path), 0);
+    TEST_EQ(kdEventTraceStartVEN(path), -1);
+    TEST_EQ(kdGetError(), KD_EBUSY);
+    for(KDint64 i = 0; i < RECORDED; i++)
+    {
+        TEST_EQ(kdPostEvent(user_event((i % 2) ? KD_EVENT_USER + 1 : KD_EVENT_USER, i)), 0);
+        kdThreadSleepVEN(1 * MILLISECOND);
+        if(i % 2 == 0)
+        {
+            const KDEvent *event = kdWaitEvent(-1);
+            TEST_EXPR(event != KD_NULL && event->data.user.value1.i64 == i);
+        }
+        else
+        {
+            kdPumpEvents();
+        }
+    }
+    TEST_EQ(kdEventTraceStopVEN(), 0);
+    TEST_EQ(handledcount, RECORDED / 2);
+    for(KDint i = 0; i < handledcount; i++)
+    {
+        TEST_EQ(handled[i], 2 * i + 1);
+    }
+
+    /* Replay as fast as possible, same order, types, tags and data */
+    handledcount = 0;
+    TEST_EQ(kdEventTraceReplayVEN(path, kdThreadSelf(), 0.0f), RECORDED);
+    for(KDint64 i = 0; i < RECORDED; i += 2)
+    {
+        const KDEvent *event = kdWaitEvent(-1);
+        TEST_EXPR(event != KD_NULL);
+        TEST_EQ(event->type, KD_EVENT_USER);
+        TEST_EXPR(event->userptr == (void *)(KDuintptr)(0x1000 + i));
+        TEST_EQ(event->data.user.value1.i64, i);
+        TEST_EQ(event->data.user.value23.i64, -i);
+    }
+    TEST_EQ(kdWaitEvent(-1), KD_NULL);
+    TEST_EQ(handledcount, RECORDED / 2);
+    for(KDint i = 0; i < handledcount; i++)
+    {
+        TEST_EQ(handled[i], 2 * i + 1);
+    }
+
+    /* Accelerated replay keeps the gaps, scaled down */
+    KDust start = kdGetTimeUST();
+    TEST_EQ(kdEventTraceReplayVEN(path, kdThreadSelf(), 2.0f), RECORDED);
+    TEST_EQ(kdWaitEvent(-1)->data.user.value1.i64, 0);
+    for(KDint64 i = 2; i < RECORDED; i += 2)
+    {
+        const KDEvent *event = kdWaitEvent(5000 * MILLISECOND);
+        TEST_EXPR(event != KD_NULL && event->data.user.value1.i64 == i);
+    }
+    TEST_EXPR(kdGetTimeUST() - start >= (RECORDED - 2) * MILLISECOND / 2);
+    kdPumpEvents();
+
+    /* Not a trace */
+    KDFile *file = kdFopen(path, "wb");
+    TEST_EXPR(file != KD_NULL);
+    TEST_EQ(kdFwrite("nothing", 8, 1, file), 1);
+    TEST_EQ(kdFclose(file), 0);
+    TEST_EQ(kdEventTraceReplayVEN(path, kdThreadSelf(), 0.0f), -1);
+    TEST_EQ(kdGetError(), KD_EILSEQ);
+    kdRemove(path);
+    return 0;
+}
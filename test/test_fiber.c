@@ -0,0 +1,188 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define STEPS 1000
+#define FIBERS 64
+
+static KDint trace[8];
+static KDint tracelen = 0;
+static KDint steps = 0;
+static KDint received = 0;
+static KDint timers = 0;
+
+static void KD_APIENTRY trace_func(void *arg)
+{
+    trace[tracelen++] = (KDint)(KDuintptr)arg;
+    kdFiberYieldVEN();
+    trace[tracelen++] = (KDint)(KDuintptr)arg + 1;
+}
+
+static void KD_APIENTRY step_func(KD_UNUSED void *arg)
+{
+    for(KDint i = 0; i < STEPS; i++)
+    {
+        steps++;
+        kdFiberYieldVEN();
+    }
+}
+
+/* Touches most of a small stack to catch a wrong stack setup. */
+static KDint deep(KDint depth)
+{
+    volatile KDchar buffer[256];
+    buffer[0] = (KDchar)depth;
+    return depth ? deep(depth - 1) + buffer[0] : 0;
+}
+
+static void KD_APIENTRY deep_func(void *arg)
+{
+    *(KDint *)arg = deep(32);
+}
+
+static void KD_APIENTRY event_func(void *arg)
+{
+    const KDEvent *event = kdFiberWaitEventVEN(KD_EVENT_USER, arg);
+    if(event && event->type == KD_EVENT_USER && event->userptr == arg && event->data.user.value1.i64 == 42)
+    {
+        received++;
+    }
+}
+
+static void KD_APIENTRY timer_func(void *arg)
+{
+    for(KDint i = 0; i < 3; i++)
+    {
+        const KDEvent *event = kdFiberWaitEventVEN(KD_EVENT_TIMER, arg);
+        if(event && event->type == KD_EVENT_TIMER)
+        {
+            timers++;
+        }
+    }
+}
+
+static void post_user(void *userptr, KDint32 value)
+{
+    KDEvent *event = kdCreateEvent();
+    event->type = KD_EVENT_USER;
+    event->userptr = userptr;
+    event->data.user.value1.i64 = value;
+    kdPostEvent(event);
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    KDFiberVEN *first = kdFiberCreateVEN(0, trace_func, (void *)10);
+    if(first == KD_NULL && kdGetError() == KD_ENOSYS)
+    {
+        return 0;
+    }
+    TEST_EXPR(first != KD_NULL);
+    KDFiberVEN *second = kdFiberCreateVEN(0, trace_func, (void *)20);
+    TEST_EXPR(second != KD_NULL);
+    TEST_EQ(kdFiberSelfVEN(), KD_NULL);
+    TEST_EQ(kdFiberYieldVEN(), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+
+    TEST_EQ(kdFiberSwitchVEN(first), 0);
+    TEST_EQ(kdFiberSwitchVEN(second), 0);
+    TEST_EQ(kdFiberSwitchVEN(first), 0);
+    TEST_EXPR(kdFiberIsFinishedVEN(first));
+    TEST_EXPR(!kdFiberIsFinishedVEN(second));
+    TEST_EQ(kdFiberSwitchVEN(second), 0);
+    TEST_EXPR(kdFiberIsFinishedVEN(second));
+    TEST_EQ(tracelen, 4);
+    TEST_EQ(trace[0], 10);
+    TEST_EQ(trace[1], 20);
+    TEST_EQ(trace[2], 11);
+    TEST_EQ(trace[3], 21);
+    TEST_EQ(kdFiberSwitchVEN(first), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    TEST_EQ(kdFiberFreeVEN(first), 0);
+    TEST_EQ(kdFiberFreeVEN(second), 0);
+
+    KDFiberVEN *stepper = kdFiberCreateVEN(0, step_func, KD_NULL);
+    while(!kdFiberIsFinishedVEN(stepper))
+    {
+        kdFiberSwitchVEN(stepper);
+    }
+    TEST_EQ(steps, STEPS);
+    kdFiberFreeVEN(stepper);
+
+    /* Stacks come back from the pool. */
+    for(KDint i = 0; i < FIBERS; i++)
+    {
+        KDint result = -1;
+        KDFiberVEN *fiber = kdFiberCreateVEN(16 * 1024, deep_func, &result);
+        TEST_EXPR(fiber != KD_NULL);
+        kdFiberSwitchVEN(fiber);
+        TEST_EXPR(kdFiberIsFinishedVEN(fiber));
+        TEST_EQ(result, 528);
+        kdFiberFreeVEN(fiber);
+    }
+
+    /* Only the event with the matching userptr resumes a fiber. */
+    KDint waiters[2] = {0};
+    KDFiberVEN *listeners[2] = {KD_NULL};
+    for(KDint i = 0; i < 2; i++)
+    {
+        listeners[i] = kdFiberCreateVEN(0, event_func, &waiters[i]);
+        kdFiberSwitchVEN(listeners[i]);
+        TEST_EXPR(!kdFiberIsFinishedVEN(listeners[i]));
+    }
+    TEST_EQ(kdFiberSwitchVEN(listeners[0]), -1);
+    post_user(KD_NULL, 1);
+    post_user(&waiters[1], 42);
+    kdPumpEvents();
+    TEST_EQ(received, 1);
+    TEST_EXPR(!kdFiberIsFinishedVEN(listeners[0]));
+    TEST_EXPR(kdFiberIsFinishedVEN(listeners[1]));
+    const KDEvent *event = kdWaitEvent(0);
+    TEST_EXPR(event != KD_NULL);
+    TEST_EQ(event->userptr, KD_NULL);
+    post_user(&waiters[0], 42);
+    kdPumpEvents();
+    TEST_EQ(received, 2);
+    TEST_EXPR(kdFiberIsFinishedVEN(listeners[0]));
+    kdFiberFreeVEN(listeners[0]);
+    kdFiberFreeVEN(listeners[1]);
+
+    /* Sequential code waiting for a periodic timer. */
+    KDTimer *timer = kdSetTimer(1000000, KD_TIMER_PERIODIC_AVERAGE, &timers);
+    if(timer)
+    {
+        KDFiberVEN *waiter = kdFiberCreateVEN(0, timer_func, &timers);
+        kdFiberSwitchVEN(waiter);
+        while(!kdFiberIsFinishedVEN(waiter))
+        {
+            kdWaitEvent(1000000);
+        }
+        TEST_EQ(timers, 3);
+        kdFiberFreeVEN(waiter);
+        kdCancelTimer(timer);
+    }
+    return 0;
+}
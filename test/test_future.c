@@ -0,0 +1,156 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+static KDint inlined = 0;
+static KDint pumped = 0;
+static KDThread *mainthread = KD_NULL;
+static KDThread *ranon = KD_NULL;
+static void *seen = KD_NULL;
+
+static void KD_APIENTRY count_func(KDFutureVEN *future, void *arg)
+{
+    (*(KDint *)arg)++;
+    seen = kdFutureGetVEN(future);
+    ranon = kdThreadSelf();
+}
+
+static void *complete_thread(void *arg)
+{
+    kdThreadSleepVEN(1000000);
+    kdFutureSetValueVEN((KDFutureVEN *)arg, &inlined);
+    return KD_NULL;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    mainthread = kdThreadSelf();
+
+    /* Polling and blocking with timeout */
+    KDFutureVEN *future = kdFutureCreateVEN();
+    if(future == KD_NULL && kdGetError() == KD_ENOSYS)
+    {
+        return 0;
+    }
+    TEST_EXPR(future != KD_NULL);
+    TEST_EXPR(!kdFutureIsReadyVEN(future));
+    TEST_EQ(kdFutureGetVEN(future), KD_NULL);
+    TEST_EQ(kdGetError(), KD_EAGAIN);
+    TEST_EQ(kdFutureWaitVEN(future, 1000000), -1);
+    TEST_EQ(kdGetError(), KD_ETIMEDOUT);
+
+    /* More continuations than fit inside the future */
+    for(KDint i = 0; i < 5; i++)
+    {
+        TEST_EQ(kdFutureThenVEN(future, KD_NULL, count_func, &inlined), 0);
+    }
+    TEST_EQ(kdFutureThenVEN(future, mainthread, count_func, &pumped), 0);
+
+    KDThread *thread = kdThreadCreate(KD_NULL, complete_thread, future);
+    if(thread == KD_NULL)
+    {
+        TEST_EQ(kdFutureSetValueVEN(future, &inlined), 0);
+    }
+    TEST_EQ(kdFutureWaitVEN(future, (KDust)-1), 0);
+    if(thread)
+    {
+        kdThreadJoin(thread, KD_NULL);
+    }
+    TEST_EXPR(kdFutureIsReadyVEN(future));
+    TEST_EQ(kdFutureGetVEN(future), &inlined);
+    TEST_EQ(kdFutureGetErrorVEN(future), 0);
+    TEST_EQ(inlined, 5);
+    TEST_EQ(kdFutureSetValueVEN(future, KD_NULL), -1);
+    TEST_EQ(kdGetError(), KD_EBUSY);
+
+    /* The longest timeout blocks instead of wrapping into the past */
+    KDFutureVEN *later = kdFutureCreateVEN();
+    TEST_EXPR(later != KD_NULL);
+    thread = kdThreadCreate(KD_NULL, complete_thread, later);
+    if(thread)
+    {
+        TEST_EQ(kdFutureWaitVEN(later, KDINT64_MAX), 0);
+        kdThreadJoin(thread, KD_NULL);
+    }
+    kdFutureFreeVEN(later);
+
+    /* Continuations for a thread run in its kdPumpEvents */
+    TEST_EQ(pumped, 0);
+    kdPumpEvents();
+    TEST_EQ(pumped, 1);
+    TEST_EQ(ranon, mainthread);
+    TEST_EQ(seen, &inlined);
+
+    /* Late continuations run right away or on the next pump. */
+    TEST_EQ(kdFutureThenVEN(future, KD_NULL, count_func, &inlined), 0);
+    TEST_EQ(inlined, 6);
+    TEST_EQ(kdFutureThenVEN(future, mainthread, count_func, &pumped), 0);
+    /* A scheduled continuation keeps the future alive. */
+    kdFutureFreeVEN(future);
+    TEST_EQ(pumped, 1);
+    kdPumpEvents();
+    TEST_EQ(pumped, 2);
+
+    /* Errors */
+    KDFutureVEN *failed = kdFutureCreateVEN();
+    TEST_EQ(kdFutureSetErrorVEN(failed, 0), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    TEST_EQ(kdFutureSetErrorVEN(failed, KD_EIO), 0);
+    TEST_EQ(kdFutureGetVEN(failed), KD_NULL);
+    TEST_EQ(kdGetError(), KD_EIO);
+    TEST_EQ(kdFutureGetErrorVEN(failed), KD_EIO);
+    kdFutureFreeVEN(failed);
+
+    /* when_all waits for every input and keeps the first error. */
+    KDFutureVEN *inputs[3] = {kdFutureCreateVEN(), kdFutureCreateVEN(), kdFutureCreateVEN()};
+    KDFutureVEN *all = kdFutureWhenAllVEN(inputs, 3);
+    KDFutureVEN *any = kdFutureWhenAnyVEN(inputs, 3);
+    TEST_EXPR(all != KD_NULL);
+    TEST_EXPR(any != KD_NULL);
+    kdFutureSetValueVEN(inputs[1], KD_NULL);
+    TEST_EXPR(kdFutureIsReadyVEN(any));
+    TEST_EQ(kdFutureGetVEN(any), inputs[1]);
+    TEST_EXPR(!kdFutureIsReadyVEN(all));
+    kdFutureSetErrorVEN(inputs[2], KD_ENOMEM);
+    TEST_EXPR(!kdFutureIsReadyVEN(all));
+    kdFutureSetErrorVEN(inputs[0], KD_EIO);
+    TEST_EXPR(kdFutureIsReadyVEN(all));
+    TEST_EQ(kdFutureGetErrorVEN(all), KD_ENOMEM);
+    TEST_EQ(kdFutureGetVEN(any), inputs[1]);
+    kdFutureFreeVEN(any);
+    kdFutureFreeVEN(all);
+    for(KDint i = 0; i < 3; i++)
+    {
+        kdFutureFreeVEN(inputs[i]);
+    }
+
+    KDFutureVEN *none = kdFutureWhenAllVEN(KD_NULL, 0);
+    TEST_EXPR(kdFutureIsReadyVEN(none));
+    kdFutureFreeVEN(none);
+    TEST_EQ(kdFutureWhenAnyVEN(KD_NULL, 0), KD_NULL);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    return 0;
+}
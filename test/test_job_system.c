@@ -0,0 +1,174 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define JOB_COUNT 10000
+#define CHILD_COUNT 16
+
+static KDJobSystemVEN *system = KD_NULL;
+static KDAtomicIntVEN *done = KD_NULL;
+static KDAtomicIntVEN *second = KD_NULL;
+static KDAtomicIntVEN *order_errors = KD_NULL;
+
+static void KD_APIENTRY count_job(KD_UNUSED void *arg)
+{
+    kdAtomicIntFetchAddVEN(done, 1);
+}
+
+/* Forks from a worker and waits while helping. */
+static void KD_APIENTRY fork_job(KD_UNUSED void *arg)
+{
+    KDJobCounterVEN *children = kdJobCounterCreateVEN();
+    for(KDint i = 0; i < CHILD_COUNT; i++)
+    {
+        kdJobSubmitVEN(system, count_job, KD_NULL, children, KD_NULL);
+    }
+    kdJobWaitVEN(system, children);
+    if(kdJobCounterGetVEN(children) != 0)
+    {
+        kdAtomicIntFetchAddVEN(order_errors, 1);
+    }
+    kdJobCounterFreeVEN(children);
+}
+
+/* Runs only after all count_job instances of the first stage. */
+static void KD_APIENTRY second_job(void *arg)
+{
+    if(kdAtomicIntLoadVEN(done) != *(KDint *)arg)
+    {
+        kdAtomicIntFetchAddVEN(order_errors, 1);
+    }
+    kdAtomicIntFetchAddVEN(second, 1);
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    TEST_EXPR(kdJobSystemCreateVEN(-1) == KD_NULL);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+
+    system = kdJobSystemCreateVEN(0);
+    TEST_EXPR(system != KD_NULL);
+    TEST_EXPR(kdJobSystemGetWorkerCountVEN(system) >= 1);
+    TEST_EQ(kdJobSystemFreeVEN(system), 0);
+
+    system = kdJobSystemCreateVEN(4);
+    TEST_EXPR(system != KD_NULL);
+    TEST_EQ(kdJobSystemGetWorkerCountVEN(system), 4);
+    done = kdAtomicIntCreateVEN(0);
+    second = kdAtomicIntCreateVEN(0);
+    order_errors = kdAtomicIntCreateVEN(0);
+    KDJobCounterVEN *counter = kdJobCounterCreateVEN();
+    TEST_EXPR(counter != KD_NULL);
+    TEST_EQ(kdJobSubmitVEN(system, KD_NULL, KD_NULL, counter, KD_NULL), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+
+    /* Plain jobs from outside the system */
+    for(KDint i = 0; i < JOB_COUNT; i++)
+    {
+        TEST_EQ(kdJobSubmitVEN(system, count_job, KD_NULL, counter, KD_NULL), 0);
+    }
+    TEST_EQ(kdJobWaitVEN(system, counter), 0);
+    TEST_EQ(kdJobCounterGetVEN(counter), 0);
+    TEST_EQ(kdAtomicIntLoadVEN(done), JOB_COUNT);
+
+    /* Nested jobs */
+    kdAtomicIntStoreVEN(done, 0);
+    for(KDint i = 0; i < 100; i++)
+    {
+        TEST_EQ(kdJobSubmitVEN(system, fork_job, KD_NULL, counter, KD_NULL), 0);
+    }
+    kdJobWaitVEN(system, counter);
+    TEST_EQ(kdAtomicIntLoadVEN(done), 100 * CHILD_COUNT);
+    TEST_EQ(kdAtomicIntLoadVEN(order_errors), 0);
+
+    /* Dependencies */
+    kdAtomicIntStoreVEN(done, 0);
+    KDJobCounterVEN *stage = kdJobCounterCreateVEN();
+    KDint expected = JOB_COUNT;
+    for(KDint i = 0; i < JOB_COUNT; i++)
+    {
+        kdJobSubmitVEN(system, count_job, KD_NULL, stage, KD_NULL);
+    }
+    for(KDint i = 0; i < 100; i++)
+    {
+        kdJobSubmitVEN(system, second_job, &expected, counter, stage);
+    }
+    kdJobWaitVEN(system, counter);
+    TEST_EQ(kdAtomicIntLoadVEN(second), 100);
+    TEST_EQ(kdAtomicIntLoadVEN(order_errors), 0);
+    TEST_EQ(kdJobCounterGetVEN(stage), 0);
+
+    /* A satisfied dependency starts right away. */
+    kdJobSubmitVEN(system, second_job, &expected, counter, stage);
+    kdJobWaitVEN(system, counter);
+    TEST_EQ(kdAtomicIntLoadVEN(second), 101);
+
+    /* Completion as event */
+    kdAtomicIntStoreVEN(done, 0);
+    for(KDint i = 0; i < JOB_COUNT; i++)
+    {
+        kdJobSubmitVEN(system, count_job, KD_NULL, counter, KD_NULL);
+    }
+    TEST_EQ(kdJobNotifyVEN(counter, &expected), 0);
+    for(;;)
+    {
+        const KDEvent *event = kdWaitEvent(-1);
+        if(event && event->type == KD_EVENT_JOB_COMPLETE_VEN)
+        {
+            TEST_EXPR(event->userptr == &expected);
+            TEST_EXPR(event->data.user.value1.p == counter);
+            break;
+        }
+        if(event == KD_NULL)
+        {
+            /* Help out, without threads nobody else runs the jobs. */
+            kdJobWaitVEN(system, counter);
+        }
+        kdDefaultEvent(event);
+    }
+    TEST_EQ(kdAtomicIntLoadVEN(done), JOB_COUNT);
+
+    /* Counter already zero */
+    TEST_EQ(kdJobNotifyVEN(counter, KD_NULL), 0);
+    const KDEvent *event = kdWaitEvent(0);
+    TEST_EXPR(event != KD_NULL && event->type == KD_EVENT_JOB_COMPLETE_VEN);
+
+    /* Queued jobs finish before the system goes away. */
+    kdAtomicIntStoreVEN(done, 0);
+    for(KDint i = 0; i < 1000; i++)
+    {
+        kdJobSubmitVEN(system, count_job, KD_NULL, KD_NULL, KD_NULL);
+    }
+    TEST_EQ(kdJobSystemFreeVEN(system), 0);
+    TEST_EQ(kdAtomicIntLoadVEN(done), 1000);
+
+    kdJobCounterFreeVEN(stage);
+    kdJobCounterFreeVEN(counter);
+    kdAtomicIntFreeVEN(order_errors);
+    kdAtomicIntFreeVEN(second);
+    kdAtomicIntFreeVEN(done);
+    return 0;
+}
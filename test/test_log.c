@@ -0,0 +1,129 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/KHR_formatted.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define THREAD_COUNT 4
+#define MESSAGE_COUNT 2000
+
+static void *test_func(void *arg)
+{
+    KDint id = *(KDint *)arg;
+    for(KDint i = 0; i < MESSAGE_COUNT; i++)
+    {
+        kdLogMessagefKHR("thread %d message %d\n", id, i);
+    }
+    return 0;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+#if defined(KD_NDEBUG)
+    /* kdLogMessagefKHR is compiled out. */
+    return 0;
+#endif
+    const KDchar *path = "test_log.txt";
+    kdRemove(path);
+    TEST_EQ(kdLogSetSinkVEN(path), 0);
+    KDint dropped = kdLogGetDroppedVEN();
+
+    /* Lines of one message are prefixed separately. */
+    kdLogMessagefKHR("first\nsecond\n");
+    kdLogMessage("third");
+    /* Order between threads is only kept across a flush. */
+    kdLogFlushVEN();
+
+    KDThread *threads[THREAD_COUNT] = {KD_NULL};
+    KDint ids[THREAD_COUNT];
+    for(KDint i = 0; i < THREAD_COUNT; i++)
+    {
+        ids[i] = i;
+        threads[i] = kdThreadCreate(KD_NULL, test_func, &ids[i]);
+        if(threads[i] == KD_NULL)
+        {
+            if(kdGetError() == KD_ENOSYS)
+            {
+                return 0;
+            }
+            TEST_FAIL();
+        }
+    }
+    for(KDint i = 0; i < THREAD_COUNT; i++)
+    {
+        kdThreadJoin(threads[i], KD_NULL);
+    }
+    kdLogFlushVEN();
+    dropped = kdLogGetDroppedVEN() - dropped;
+    TEST_EQ(kdLogSetSinkVEN(KD_NULL), 0);
+
+    KDsize size = 1 << 20;
+    KDchar *text = (KDchar *)kdMalloc(size);
+    KDFile *file = kdFopen(path, "r");
+    TEST_EXPR(file != KD_NULL);
+    KDsize length = kdFread(text, 1, size - 1, file);
+    text[length] = '\0';
+    kdFclose(file);
+    kdRemove(path);
+
+    /* Every line carries time and thread, every message is either written or counted. */
+    KDint lines = 0;
+    KDint last[THREAD_COUNT] = {-1, -1, -1, -1};
+    for(KDchar *line = text; *line; lines++)
+    {
+        KDchar *end = line;
+        while(*end != '\n')
+        {
+            TEST_EXPR(*end != '\0');
+            end++;
+        }
+        *end = '\0';
+        TEST_EXPR(line[0] == '[');
+        KDchar *message = kdStrstrVEN(line, "] ");
+        TEST_EXPR(message != KD_NULL);
+        message = kdStrstrVEN(message + 2, "] ");
+        TEST_EXPR(message != KD_NULL);
+        message += 2;
+        if(lines < 3)
+        {
+            const KDchar *expected[] = {"first", "second", "third"};
+            TEST_STREQ(message, expected[lines]);
+        }
+        else
+        {
+            /* Order within a thread is kept. */
+            KDint id = 0, index = 0;
+            TEST_EQ(kdSscanfKHR(message, "thread %d message %d", &id, &index), 2);
+            TEST_EXPR(id >= 0 && id < THREAD_COUNT);
+            TEST_EXPR(index > last[id]);
+            last[id] = index;
+        }
+        line = end + 1;
+    }
+    TEST_EQ(lines - 3 + dropped, THREAD_COUNT * MESSAGE_COUNT);
+
+    kdFree(text);
+    return 0;
+}
@@ -0,0 +1,164 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/KHR_formatted.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define BUFFER_SIZE 4096
+
+static KDchar expected[BUFFER_SIZE];
+static KDsize expected_length = 0;
+
+/* Deferred messages have to match what kdSnprintfKHR makes of them. */
+#define LOG(...)                                                                                    \
+    do                                                                                              \
+    {                                                                                               \
+        TEST_EQ(kdLogDeferredVEN(__VA_ARGS__), 0);                                                  \
+        expected_length += (KDsize)kdSnprintfKHR(expected + expected_length, BUFFER_SIZE - expected_length, __VA_ARGS__); \
+    } while(0)
+
+static void test_messages(void)
+{
+    KDint64 big = -1234567890123LL;
+    KDsize size = 42;
+    LOG("plain text\n");
+    LOG("%d %i %u %x %X %o\n", -42, 17, 4000000000U, 0xbeef, 0xBEEF, 8);
+    LOG("%lld %llu %zu %hd %ld %hhd\n", big, 18446744073709551615ULL, size, 70000, -5L);
+    LOG("%5.2f|%e|%g|%-8.3f|\n", 3.14159, 1e-10, 0.1, -2.5);
+    LOG("%s|%-8s|%8s|%.3s|\n", "hello", "left", "right", "truncated");
+    LOG("%*d|%-*d|%.*f|%*.*s|\n", 6, 42, 5, 7, 2, 1.005, 6, 2, "abcdef");
+    LOG("%c%c%c 100%% %+d % d %#x %08.3f\n", 'a', 'b', 'c', 5, 5, 255, 3.5);
+    LOG("two\nlines %d\n", 2);
+}
+
+/* Remove the time and thread prefixes. */
+static KDsize strip_prefixes(KDchar *text, KDsize length)
+{
+    KDsize out = 0;
+    for(KDsize i = 0; i < length;)
+    {
+        TEST_EXPR(text[i] == '[');
+        KDchar *message = kdStrstrVEN(text + i, "] ");
+        TEST_EXPR(message != KD_NULL);
+        message = kdStrstrVEN(message + 2, "] ");
+        TEST_EXPR(message != KD_NULL);
+        i = (KDsize)(message + 2 - text);
+        while(i < length)
+        {
+            text[out++] = text[i];
+            if(text[i++] == '\n')
+            {
+                break;
+            }
+        }
+    }
+    text[out] = '\0';
+    return out;
+}
+
+static KDsize read_file(const KDchar *path, KDchar *text)
+{
+    KDFile *file = kdFopen(path, "r");
+    TEST_EXPR(file != KD_NULL);
+    KDsize length = kdFread(text, 1, BUFFER_SIZE - 1, file);
+    text[length] = '\0';
+    kdFclose(file);
+    kdRemove(path);
+    return length;
+}
+
+static void *test_func(KD_UNUSED void *arg)
+{
+    LOG("from thread %s\n", "two");
+    return 0;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    static KDchar text[BUFFER_SIZE];
+    TEST_EQ(kdLogSetModeVEN(7), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+
+    /* Without threads there is no writer, messages go out unprefixed and never binary. */
+    KDThreadCond *cond = kdThreadCondCreate(KD_NULL);
+    if(cond == KD_NULL && kdGetError() == KD_ENOSYS)
+    {
+        return 0;
+    }
+    kdThreadCondFree(cond);
+
+    /* Text mode, the writer formats deferred messages. */
+    const KDchar *path = "test_log_binary.txt";
+    kdRemove(path);
+    TEST_EQ(kdLogSetSinkVEN(path), 0);
+    KDint dropped = kdLogGetDroppedVEN();
+    test_messages();
+    kdLogFlushVEN();
+    TEST_EQ(kdLogSetSinkVEN(KD_NULL), 0);
+    KDsize length = strip_prefixes(text, read_file(path, text));
+    TEST_EQ(length, expected_length);
+    TEST_STREQ(text, expected);
+
+    /* Binary mode, formatting happens in kdLogDecodeVEN. */
+    const KDchar *binary = "test_log_binary.bin";
+    kdRemove(binary);
+    expected_length = 0;
+    TEST_EQ(kdLogSetSinkVEN(binary), 0);
+    TEST_EQ(kdLogSetModeVEN(KD_LOG_BINARY_VEN), 0);
+    test_messages();
+#if !defined(KD_NDEBUG)
+    kdLogMessagefKHR("text %d\n", 1);
+    expected_length += (KDsize)kdSnprintfKHR(expected + expected_length, BUFFER_SIZE - expected_length, "text %d\n", 1);
+#endif
+    test_messages();
+
+    /* Order between threads is only kept across a flush. */
+    kdLogFlushVEN();
+    KDThread *thread = kdThreadCreate(KD_NULL, test_func, KD_NULL);
+    if(thread)
+    {
+        kdThreadJoin(thread, KD_NULL);
+    }
+    kdLogFlushVEN();
+    TEST_EQ(kdLogSetModeVEN(KD_LOG_TEXT_VEN), 0);
+    TEST_EQ(kdLogSetSinkVEN(KD_NULL), 0);
+    TEST_EQ(kdLogGetDroppedVEN(), dropped);
+
+    TEST_EQ(kdLogDecodeVEN(binary, path), 0);
+    length = strip_prefixes(text, read_file(path, text));
+    TEST_EQ(length, expected_length);
+    TEST_STREQ(text, expected);
+
+    /* Not a binary log */
+    KDFile *file = kdFopen(binary, "w");
+    TEST_EXPR(file != KD_NULL);
+    kdFwrite("KDLOGTXT", 1, 8, file);
+    kdFclose(file);
+    TEST_EQ(kdLogDecodeVEN(binary, path), -1);
+    TEST_EQ(kdGetError(), KD_EILSEQ);
+    kdRemove(binary);
+    kdRemove(path);
+    return 0;
+}
@@ -0,0 +1,140 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define COUNT 100000
+
+static KDuint8 visits[COUNT];
+
+static void KD_APIENTRY visit(KDint64 begin, KDint64 end, void *ctx)
+{
+    KDint64 offset = *(KDint64 *)ctx;
+    TEST_EXPR(begin < end);
+    for(KDint64 i = begin; i < end; i++)
+    {
+        visits[i - offset]++;
+    }
+}
+
+static void KD_APIENTRY sum(KDint64 begin, KDint64 end, void *partial, KD_UNUSED void *ctx)
+{
+    for(KDint64 i = begin; i < end; i++)
+    {
+        *(KDint64 *)partial += i;
+    }
+}
+
+static void KD_APIENTRY sum_join(void *result, const void *partial, KD_UNUSED void *ctx)
+{
+    *(KDint64 *)result += *(const KDint64 *)partial;
+}
+
+static void KD_APIENTRY harmonic(KDint64 begin, KDint64 end, void *partial, KD_UNUSED void *ctx)
+{
+    for(KDint64 i = begin; i < end; i++)
+    {
+        *(KDfloat64KHR *)partial += 1.0 / (KDfloat64KHR)(i + 1);
+    }
+}
+
+static void KD_APIENTRY harmonic_join(void *result, const void *partial, KD_UNUSED void *ctx)
+{
+    *(KDfloat64KHR *)result += *(const KDfloat64KHR *)partial;
+}
+
+/* Loops nested in loops */
+static KDint64 nested[8];
+static void KD_APIENTRY outer(KDint64 begin, KDint64 end, KD_UNUSED void *ctx)
+{
+    for(KDint64 i = begin; i < end; i++)
+    {
+        nested[i] = 0;
+        kdParallelReduceVEN(0, 1000, 10, sum, sum_join, &nested[i], sizeof(KDint64), KD_NULL);
+    }
+}
+
+static void KD_APIENTRY never(KD_UNUSED KDint64 begin, KD_UNUSED KDint64 end, KD_UNUSED void *ctx)
+{
+    TEST_FAIL();
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    TEST_EXPR(kdJobSystemGetDefaultVEN() != KD_NULL);
+    TEST_EXPR(kdJobSystemGetDefaultVEN() == kdJobSystemGetDefaultVEN());
+
+    TEST_EQ(kdParallelForVEN(0, 10, 1, KD_NULL, KD_NULL), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    TEST_EQ(kdParallelForVEN(0, 10, -1, never, KD_NULL), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    TEST_EQ(kdParallelForVEN(10, 10, 1, never, KD_NULL), 0);
+    TEST_EQ(kdParallelForVEN(10, 0, 1, never, KD_NULL), 0);
+
+    /* Every index exactly once */
+    const KDint64 grains[] = {0, 1, 7, 1000, COUNT, 2 * COUNT};
+    const KDint64 offsets[] = {0, -COUNT / 2};
+    for(KDsize o = 0; o < sizeof(offsets) / sizeof(offsets[0]); o++)
+    {
+        for(KDsize g = 0; g < sizeof(grains) / sizeof(grains[0]); g++)
+        {
+            kdMemset(visits, 0, sizeof(visits));
+            KDint64 offset = offsets[o];
+            TEST_EQ(kdParallelForVEN(offset, offset + COUNT, grains[g], visit, &offset), 0);
+            for(KDint i = 0; i < COUNT; i++)
+            {
+                TEST_EQ(visits[i], 1);
+            }
+        }
+    }
+
+    /* Reductions */
+    KDint64 total = 0;
+    TEST_EQ(kdParallelReduceVEN(0, 10, 1, sum, KD_NULL, &total, sizeof(total), KD_NULL), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    for(KDsize g = 0; g < sizeof(grains) / sizeof(grains[0]); g++)
+    {
+        total = 0;
+        TEST_EQ(kdParallelReduceVEN(0, COUNT, grains[g], sum, sum_join, &total, sizeof(total), KD_NULL), 0);
+        TEST_EXPR(total == (KDint64)COUNT * (COUNT - 1) / 2);
+    }
+
+    /* Partial results are joined in a fixed order. */
+    total = 0;
+    kdParallelReduceVEN(0, 3, 1, sum, sum_join, &total, sizeof(total), KD_NULL);
+    TEST_EXPR(total == 3);
+    KDfloat64KHR first = 0.0, second = 0.0;
+    kdParallelReduceVEN(0, COUNT, 100, harmonic, harmonic_join, &first, sizeof(first), KD_NULL);
+    kdParallelReduceVEN(0, COUNT, 100, harmonic, harmonic_join, &second, sizeof(second), KD_NULL);
+    TEST_EXPR(kdMemcmp(&first, &second, sizeof(first)) == 0);
+    TEST_EXPR(first > 12.0 && first < 12.1);
+
+    TEST_EQ(kdParallelForVEN(0, 8, 1, outer, KD_NULL), 0);
+    for(KDint i = 0; i < 8; i++)
+    {
+        TEST_EXPR(nested[i] == 999 * 1000 / 2);
+    }
+    return 0;
+}
@@ -0,0 +1,220 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define LOOPBACK 0x7f000001
+
+static void *poster(void *arg)
+{
+    kdThreadSleepVEN(50000000LL);
+    KDEvent *event = kdCreateEvent();
+    event->type = KD_EVENT_USER;
+    kdPostThreadEvent(event, (KDThread *)arg);
+    return KD_NULL;
+}
+
+static void *closer(void *arg)
+{
+    /* Sockets belong to the thread that created them */
+    TEST_EQ(kdSocketClose((KDSocket *)arg), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    return KD_NULL;
+}
+
+/* Wait for a socket event, skipping anything else that shows up */
+static const KDEvent *wait_socket(KDint32 type, KDSocket *socket)
+{
+    KDust deadline = kdGetTimeUST() + 5000000000LL;
+    while(kdGetTimeUST() < deadline)
+    {
+        const KDEvent *event = kdWaitEvent(1000000000LL);
+        if(event && event->type == type && event->data.socketreadable.socket == socket)
+        {
+            return event;
+        }
+    }
+    return KD_NULL;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    /* Timeouts are honoured */
+    KDust start = kdGetTimeUST();
+    TEST_EQ(kdWaitEvent(50000000LL), KD_NULL);
+    TEST_EQ(kdGetError(), KD_EAGAIN);
+    TEST_EXPR(kdGetTimeUST() - start >= 45000000LL);
+
+    /* Timers fire without a thread of their own */
+    KDint marker = 0;
+    KDTimer *timer = kdSetTimer(20000000LL, KD_TIMER_ONESHOT, &marker);
+    TEST_EXPR(timer != KD_NULL);
+    const KDEvent *event = kdWaitEvent(5000000000LL);
+    TEST_EXPR(event != KD_NULL);
+    TEST_EQ(event->type, KD_EVENT_TIMER);
+    TEST_EQ(event->userptr, &marker);
+    TEST_EQ(kdCancelTimer(timer), 0);
+
+    /* A periodic timer that was not served still reports every expiry */
+    timer = kdSetTimer(10000000LL, KD_TIMER_PERIODIC_AVERAGE, &marker);
+    TEST_EXPR(timer != KD_NULL);
+    kdThreadSleepVEN(55000000LL);
+    KDint ticks = 0;
+    while((event = kdWaitEvent(-1)) != KD_NULL)
+    {
+        ticks += event->type == KD_EVENT_TIMER && event->userptr == &marker;
+    }
+    TEST_EXPR(ticks >= 4);
+    TEST_EQ(kdCancelTimer(timer), 0);
+
+    /* UDP datagrams make their socket readable */
+    KDSocket *receiver = kdSocketCreate(KD_SOCK_UDP, KD_NULL);
+    KDSocket *sender = kdSocketCreate(KD_SOCK_UDP, KD_NULL);
+    TEST_EXPR(receiver != KD_NULL && sender != KD_NULL);
+    KDSockaddr addr;
+    kdMemset(&addr, 0, sizeof(addr));
+    addr.family = KD_AF_INET;
+    addr.data.sin.address = LOOPBACK;
+    addr.data.sin.port = 38517;
+    TEST_EQ(kdSocketBind(receiver, &addr, KD_TRUE), 0);
+    TEST_EQ(kdSocketSendTo(sender, "ping", 4, &addr), 4);
+    TEST_EXPR(wait_socket(KD_EVENT_SOCKET_READABLE, receiver) != KD_NULL);
+    KDchar buffer[8] = "";
+    KDSockaddr from;
+    TEST_EQ(kdSocketRecvFrom(receiver, buffer, sizeof(buffer), &from), 4);
+    TEST_EQ(kdStrncmp(buffer, "ping", 4), 0);
+    TEST_EQ(kdSocketClose(sender), 0);
+    TEST_EQ(kdSocketClose(receiver), 0);
+
+    /* Closing drops readiness that is still queued, the open socket keeps its event */
+    KDSocket *closed = kdSocketCreate(KD_SOCK_UDP, KD_NULL);
+    receiver = kdSocketCreate(KD_SOCK_UDP, KD_NULL);
+    sender = kdSocketCreate(KD_SOCK_UDP, KD_NULL);
+    TEST_EXPR(closed != KD_NULL && receiver != KD_NULL && sender != KD_NULL);
+    addr.data.sin.port = 38519;
+    TEST_EQ(kdSocketBind(closed, &addr, KD_TRUE), 0);
+    TEST_EQ(kdSocketSendTo(sender, "ping", 4, &addr), 4);
+    KDSockaddr other = addr;
+    other.data.sin.port = 38520;
+    TEST_EQ(kdSocketBind(receiver, &other, KD_TRUE), 0);
+    TEST_EQ(kdSocketSendTo(sender, "ping", 4, &other), 4);
+    kdThreadSleepVEN(20000000LL);
+    TEST_EQ(kdPumpEvents(), 0);
+    TEST_EQ(kdSocketClose(closed), 0);
+    KDboolean readable = KD_FALSE;
+    while((event = kdWaitEvent(-1)) != KD_NULL)
+    {
+        if(event->type == KD_EVENT_SOCKET_READABLE)
+        {
+            TEST_EXPR(event->data.socketreadable.socket == receiver || event->data.socketreadable.socket == sender);
+            readable |= event->data.socketreadable.socket == receiver;
+        }
+    }
+    TEST_EXPR(readable);
+    TEST_EQ(kdSocketClose(sender), 0);
+    TEST_EQ(kdSocketClose(receiver), 0);
+
+    /* Events keep the type kdCreateEvent gave them, they are not dropped */
+    KDEvent *fresh = kdCreateEvent();
+    TEST_EQ(kdPostEvent(fresh), 0);
+    event = kdWaitEvent(0);
+    TEST_EXPR(event == fresh);
+    TEST_EQ(event->type, -1);
+
+    /* TCP connect, accept and receive are all driven by events */
+    KDSocket *listener = kdSocketCreate(KD_SOCK_TCP, KD_NULL);
+    TEST_EXPR(listener != KD_NULL);
+    addr.data.sin.port = 38518;
+    TEST_EQ(kdSocketBind(listener, &addr, KD_TRUE), 0);
+    if(kdSocketListen(listener, 4) == 0)
+    {
+        KDSocket *client = kdSocketCreate(KD_SOCK_TCP, KD_NULL);
+        TEST_EQ(kdSocketConnect(client, &addr), 0);
+        /* Either side may be reported first */
+        KDboolean connected = KD_FALSE, incoming = KD_FALSE;
+        KDust deadline = kdGetTimeUST() + 5000000000LL;
+        while(!(connected && incoming) && kdGetTimeUST() < deadline)
+        {
+            event = kdWaitEvent(1000000000LL);
+            if(event && event->type == KD_EVENT_SOCKET_CONNECT_COMPLETE && event->data.socketconnect.socket == client)
+            {
+                TEST_EQ(event->data.socketconnect.error, 0);
+                connected = KD_TRUE;
+            }
+            else if(event && event->type == KD_EVENT_SOCKET_INCOMING && event->data.socketincoming.socket == listener)
+            {
+                incoming = KD_TRUE;
+            }
+        }
+        TEST_EXPR(connected && incoming);
+        KDSocket *server = kdSocketAccept(listener, KD_NULL, KD_NULL);
+        TEST_EXPR(server != KD_NULL);
+        TEST_EQ(kdSocketRecv(server, buffer, sizeof(buffer)), -1);
+        TEST_EQ(kdGetError(), KD_EAGAIN);
+        TEST_EQ(kdSocketSend(client, "pong", 4), 4);
+        TEST_EXPR(wait_socket(KD_EVENT_SOCKET_READABLE, server) != KD_NULL);
+        TEST_EQ(kdSocketRecv(server, buffer, sizeof(buffer)), 4);
+        TEST_EQ(kdStrncmp(buffer, "pong", 4), 0);
+        TEST_EQ(kdSocketClose(server), 0);
+        TEST_EQ(kdSocketClose(client), 0);
+    }
+    else
+    {
+        TEST_EQ(kdGetError(), KD_ENOSYS);
+    }
+    TEST_EQ(kdSocketClose(listener), 0);
+
+    /* Posts from other threads wake a blocked wait right away */
+    KDThread *thread = kdThreadCreate(KD_NULL, poster, kdThreadSelf());
+    if(thread == KD_NULL && kdGetError() == KD_ENOSYS)
+    {
+        return 0;
+    }
+    TEST_EXPR(thread != KD_NULL);
+    start = kdGetTimeUST();
+    event = kdWaitEvent(5000000000LL);
+    TEST_EXPR(event != KD_NULL);
+    TEST_EQ(event->type, KD_EVENT_USER);
+    TEST_EXPR(kdGetTimeUST() - start < 2000000000LL);
+    TEST_EQ(kdThreadJoin(thread, KD_NULL), 0);
+
+    /* The longest timeout blocks instead of wrapping into the past */
+    thread = kdThreadCreate(KD_NULL, poster, kdThreadSelf());
+    TEST_EXPR(thread != KD_NULL);
+    start = kdGetTimeUST();
+    event = kdWaitEvent(KDINT64_MAX);
+    TEST_EXPR(event != KD_NULL);
+    TEST_EQ(event->type, KD_EVENT_USER);
+    TEST_EXPR(kdGetTimeUST() - start >= 40000000LL);
+    TEST_EQ(kdThreadJoin(thread, KD_NULL), 0);
+
+    KDSocket *socket = kdSocketCreate(KD_SOCK_UDP, KD_NULL);
+    TEST_EXPR(socket != KD_NULL);
+    thread = kdThreadCreate(KD_NULL, closer, socket);
+    TEST_EXPR(thread != KD_NULL);
+    TEST_EQ(kdThreadJoin(thread, KD_NULL), 0);
+    TEST_EQ(kdSocketClose(socket), 0);
+    return 0;
+}
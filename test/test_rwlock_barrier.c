@@ -0,0 +1,162 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define READERS 4
+#define WRITERS 2
+#define READS 20000
+#define WRITES 2000
+#define PHASES 200
+
+static KDThreadRWLockVEN *rwlock = KD_NULL;
+static KDThreadBarrierVEN *barrier = KD_NULL;
+static KDThreadLatchVEN *latch = KD_NULL;
+static KDAtomicIntVEN *errors = KD_NULL;
+static KDAtomicIntVEN *serials = KD_NULL;
+static KDint first = 0;
+static KDint second = 0;
+static KDint phase[READERS] = {0};
+
+/* Readers must never see a half-done write. */
+static void *reader_func(KD_UNUSED void *arg)
+{
+    for(KDint i = 0; i < READS; i++)
+    {
+        kdThreadRWLockReadLockVEN(rwlock);
+        if(first != second)
+        {
+            kdAtomicIntFetchAddVEN(errors, 1);
+        }
+        kdThreadRWLockReadUnlockVEN(rwlock);
+    }
+    return KD_NULL;
+}
+
+static void *writer_func(KD_UNUSED void *arg)
+{
+    for(KDint i = 0; i < WRITES; i++)
+    {
+        kdThreadRWLockWriteLockVEN(rwlock);
+        first++;
+        second++;
+        kdThreadRWLockWriteUnlockVEN(rwlock);
+    }
+    return KD_NULL;
+}
+
+/* Every thread sees all others finish a phase before the next one. */
+static void *phase_func(void *arg)
+{
+    KDint index = (KDint)(KDuintptr)arg;
+    for(KDint p = 1; p <= PHASES; p++)
+    {
+        phase[index] = p;
+        if(kdThreadBarrierWaitVEN(barrier) == KD_THREAD_BARRIER_SERIAL_VEN)
+        {
+            kdAtomicIntFetchAddVEN(serials, 1);
+        }
+        for(KDint i = 0; i < READERS; i++)
+        {
+            if(phase[i] != p)
+            {
+                kdAtomicIntFetchAddVEN(errors, 1);
+            }
+        }
+        kdThreadBarrierWaitVEN(barrier);
+    }
+    return KD_NULL;
+}
+
+static void *latch_func(KD_UNUSED void *arg)
+{
+    kdThreadLatchCountDownVEN(latch);
+    kdThreadLatchWaitVEN(latch);
+    return KD_NULL;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    rwlock = kdThreadRWLockCreateVEN();
+    if(rwlock == KD_NULL && kdGetError() == KD_ENOSYS)
+    {
+        return 0;
+    }
+    TEST_EXPR(rwlock != KD_NULL);
+    errors = kdAtomicIntCreateVEN(0);
+    serials = kdAtomicIntCreateVEN(0);
+
+    KDThread *threads[READERS + WRITERS] = {KD_NULL};
+    for(KDint i = 0; i < READERS + WRITERS; i++)
+    {
+        threads[i] = kdThreadCreate(KD_NULL, (i < READERS) ? reader_func : writer_func, KD_NULL);
+        TEST_EXPR(threads[i] != KD_NULL);
+    }
+    for(KDint i = 0; i < READERS + WRITERS; i++)
+    {
+        kdThreadJoin(threads[i], KD_NULL);
+    }
+    TEST_EQ(kdAtomicIntLoadVEN(errors), 0);
+    TEST_EQ(first, WRITERS * WRITES);
+    TEST_EQ(kdThreadRWLockFreeVEN(rwlock), 0);
+
+    TEST_EXPR(kdThreadBarrierCreateVEN(0) == KD_NULL);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    barrier = kdThreadBarrierCreateVEN(READERS);
+    TEST_EXPR(barrier != KD_NULL);
+    for(KDint i = 0; i < READERS; i++)
+    {
+        threads[i] = kdThreadCreate(KD_NULL, phase_func, (void *)(KDuintptr)i);
+        TEST_EXPR(threads[i] != KD_NULL);
+    }
+    for(KDint i = 0; i < READERS; i++)
+    {
+        kdThreadJoin(threads[i], KD_NULL);
+    }
+    TEST_EQ(kdAtomicIntLoadVEN(errors), 0);
+    TEST_EQ(kdAtomicIntLoadVEN(serials), PHASES);
+    TEST_EQ(kdThreadBarrierFreeVEN(barrier), 0);
+
+    latch = kdThreadLatchCreateVEN(READERS);
+    TEST_EXPR(latch != KD_NULL);
+    for(KDint i = 0; i < READERS; i++)
+    {
+        threads[i] = kdThreadCreate(KD_NULL, latch_func, KD_NULL);
+        TEST_EXPR(threads[i] != KD_NULL);
+    }
+    TEST_EQ(kdThreadLatchWaitVEN(latch), 0);
+    for(KDint i = 0; i < READERS; i++)
+    {
+        kdThreadJoin(threads[i], KD_NULL);
+    }
+    TEST_EQ(kdThreadLatchCountDownVEN(latch), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    TEST_EQ(kdThreadLatchWaitVEN(latch), 0);
+    TEST_EQ(kdThreadLatchFreeVEN(latch), 0);
+
+    kdAtomicIntFreeVEN(serials);
+    kdAtomicIntFreeVEN(errors);
+    return 0;
+}
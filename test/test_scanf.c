@@ -0,0 +1,134 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/KHR_formatted.h>
+#include <KD/KHR_float64.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    KDint i = 0, j = 0, n = 0;
+    KDuint u = 0;
+    KDint64 ll = 0;
+    KDint16 h = 0;
+    KDfloat32 f = 0.0f;
+    KDfloat64KHR d = 0.0;
+    KDchar str[32];
+    KDchar chars[4] = {'x', 'x', 'x', 'x'};
+
+    /* Integers, sizes and bases */
+    TEST_EQ(kdSscanfKHR(" 42 -7 0x1f", "%d %i %x", &i, &j, &u), 3);
+    TEST_EQ(i, 42);
+    TEST_EQ(j, -7);
+    TEST_EQ(u, 0x1f);
+    TEST_EQ(kdSscanfKHR("-9223372036854775808 70000", "%lld %hd", &ll, &h), 2);
+    TEST_EQ(ll, KDINT64_MIN);
+    TEST_EQ(h, (KDint16)70000);
+    TEST_EQ(kdSscanfKHR("0777 017", "%i %o", &i, &j), 2);
+    TEST_EQ(i, 511);
+    TEST_EQ(j, 15);
+    TEST_EQ(kdSscanfKHR("-1", "%u", &u), 1);
+    TEST_EQ(u, KDUINT_MAX);
+
+    /* Field widths split numbers */
+    TEST_EQ(kdSscanfKHR("123456", "%2d%3d%n", &i, &j, &n), 2);
+    TEST_EQ(i, 12);
+    TEST_EQ(j, 345);
+    TEST_EQ(n, 5);
+
+    /* Floats */
+    TEST_EQ(kdSscanfKHR("1.5e3 0.1", "%f %lf", &f, &d), 2);
+    TEST_EQ(f, 1500.0f);
+    TEST_EQ(d, 0.1);
+
+    /* Strings, characters and scansets */
+    TEST_EQ(kdSscanfKHR("  hello world", "%s", str), 1);
+    TEST_STREQ(str, "hello");
+    TEST_EQ(kdSscanfKHR("abcdef", "%3c", chars), 1);
+    TEST_EXPR(chars[0] == 'a' && chars[2] == 'c' && chars[3] == 'x');
+    TEST_EQ(kdSscanfKHR("key=value;rest", "%[^=]=%[a-z]", str, str + 16), 2);
+    TEST_STREQ(str, "key");
+    TEST_STREQ(str + 16, "value");
+    TEST_EQ(kdSscanfKHR("]]x", "%[]]", str), 1);
+    TEST_STREQ(str, "]]");
+
+    /* Suppression, literals and percent */
+    TEST_EQ(kdSscanfKHR("skip 5 100%", "%*s %d %d%%", &i, &j), 2);
+    TEST_EQ(i, 5);
+    TEST_EQ(j, 100);
+
+    /* Matching and input failures */
+    TEST_EQ(kdSscanfKHR("abc", "%d", &i), 0);
+    TEST_EQ(kdSscanfKHR("", "%d", &i), KD_EOF);
+    TEST_EQ(kdSscanfKHR("   ", "%d", &i), KD_EOF);
+    TEST_EQ(kdSscanfKHR("1,", "%d,%d", &i, &j), 1);
+    TEST_EQ(kdSscanfKHR("1", "%d%%", &i), 1);
+
+    /* Invalid formats */
+    kdSetError(0);
+    TEST_EXPR(kdScanfCompileVEN("%[abc") == KD_NULL);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    TEST_EXPR(kdScanfCompileVEN("%y") == KD_NULL);
+
+    /* Compiled plans are reusable */
+    KDScanfPlanVEN *plan = kdScanfCompileVEN("v %f %f %f");
+    TEST_EXPR(plan != KD_NULL);
+    KDfloat32 v[3];
+    for(KDint k = 0; k < 3; k++)
+    {
+        const KDchar *lines[] = {"v 1 2 3", "v -0.5 0.25 1e2", "v 7"};
+        KDint expected[] = {3, 3, 1};
+        TEST_EQ(kdSscanfPlanVEN(lines[k], plan, &v[0], &v[1], &v[2]), expected[k]);
+    }
+    TEST_EQ(v[0], 7.0f);
+    TEST_EQ(v[1], 0.25f);
+    TEST_EQ(v[2], 100.0f);
+    kdScanfFreeVEN(plan);
+
+    /* Files are read through a window and lookahead is given back */
+    KDFile *file = kdFopen("test_scanf.txt", "w");
+    TEST_EXPR(file != KD_NULL);
+    for(KDint k = 0; k < 1000; k++)
+    {
+        kdFprintfKHR(file, "%d ", k);
+    }
+    kdFprintfKHR(file, "end");
+    kdFclose(file);
+    file = kdFopen("test_scanf.txt", "r");
+    TEST_EXPR(file != KD_NULL);
+    for(KDint k = 0; k < 1000; k++)
+    {
+        TEST_EQ(kdFscanfKHR(file, "%d", &i), 1);
+        TEST_EQ(i, k);
+    }
+    TEST_EQ(kdFscanfKHR(file, "%d", &i), 0);
+    TEST_EQ(kdFscanfKHR(file, "%s", str), 1);
+    TEST_STREQ(str, "end");
+    TEST_EQ(kdFscanfKHR(file, "%s", str), KD_EOF);
+    kdFclose(file);
+    kdRemove("test_scanf.txt");
+
+    return 0;
+}
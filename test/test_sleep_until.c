@@ -0,0 +1,59 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define PERIOD 200000LL
+#define FRAMES 20
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    /* Past deadlines return immediately */
+    KDust start = kdGetTimeUST();
+    TEST_EQ(kdThreadSleepUntilVEN(start - PERIOD), 0);
+    TEST_EQ(kdThreadSleepUntilPreciseVEN(0), 0);
+    TEST_EXPR(kdGetTimeUST() - start < 100 * PERIOD);
+
+    /* Neither function may return before its deadline */
+    KDust deadline = kdGetTimeUST();
+    for(KDint i = 0; i < FRAMES; i++)
+    {
+        deadline += PERIOD;
+        TEST_EQ(kdThreadSleepUntilVEN(deadline), 0);
+        TEST_EXPR(kdGetTimeUST() >= deadline);
+    }
+    for(KDint i = 0; i < FRAMES; i++)
+    {
+        deadline += PERIOD;
+        TEST_EQ(kdThreadSleepUntilPreciseVEN(deadline), 0);
+        TEST_EXPR(kdGetTimeUST() >= deadline);
+    }
+
+    /* Sub-second remainders above 2^31 ns are carried correctly */
+    start = kdGetTimeUST();
+    TEST_EQ(kdThreadSleepVEN(2100000000LL), 0);
+    TEST_EXPR(kdGetTimeUST() - start >= 2100000000LL);
+    return 0;
+}
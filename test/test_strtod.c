@@ -0,0 +1,178 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/KHR_float64.h>
+#include "test.h"
+
+typedef union {
+    KDfloat32 f;
+    KDuint32 u;
+} test_bits32;
+
+typedef union {
+    KDfloat64KHR f;
+    KDuint64 u;
+} test_bits64;
+
+/* Parse the whole string and compare bit patterns. */
+static KDboolean test_strtod(const KDchar *s, KDfloat64KHR expected)
+{
+    KDchar *end = KD_NULL;
+    test_bits64 a, b;
+    a.f = kdStrtodKHR(s, &end);
+    b.f = expected;
+    return a.u == b.u && *end == '\0';
+}
+
+static KDboolean test_strtof(const KDchar *s, KDfloat32 expected)
+{
+    KDchar *end = KD_NULL;
+    test_bits32 a, b;
+    a.f = kdStrtof(s, &end);
+    b.f = expected;
+    return a.u == b.u && *end == '\0';
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    /* Exact values and the Clinger fast path */
+    TEST_EXPR(test_strtod("0", 0.0));
+    TEST_EXPR(test_strtod("-0", -0.0));
+    TEST_EXPR(test_strtod("1", 1.0));
+    TEST_EXPR(test_strtod("+1.5", 1.5));
+    TEST_EXPR(test_strtod(".25", 0.25));
+    TEST_EXPR(test_strtod("25.", 25.0));
+    TEST_EXPR(test_strtod("0.1", 0.1));
+    TEST_EXPR(test_strtod("3.14159265358979323846", 3.14159265358979323846));
+    TEST_EXPR(test_strtod("9007199254740993", 9007199254740993.0));
+    TEST_EXPR(test_strtof("0.1", 0.1f));
+    TEST_EXPR(test_strtof("-123.456", -123.456f));
+    TEST_EXPR(test_strtof("16777217", 16777217.0f));
+
+    /* Exponents */
+    TEST_EXPR(test_strtod("1e10", 1e10));
+    TEST_EXPR(test_strtod("1E+10", 1e10));
+    TEST_EXPR(test_strtod("2.5e-3", 2.5e-3));
+    TEST_EXPR(test_strtod("1e23", 1e23));
+    TEST_EXPR(test_strtod("8.98846567431158e307", 8.98846567431158e307));
+    TEST_EXPR(test_strtod("1.7976931348623157e308", 1.7976931348623157e308));
+    TEST_EXPR(test_strtod("2.2250738585072014e-308", 2.2250738585072014e-308));
+    TEST_EXPR(test_strtod("0.000001e6", 1.0));
+    TEST_EXPR(test_strtof("3.4028234e38", 3.4028234e38f));
+    TEST_EXPR(test_strtof("1.17549435e-38", 1.17549435e-38f));
+    TEST_EXPR(test_strtof("7.038531e-26", 7.038531e-26f));
+
+    /* Subnormals */
+    TEST_EXPR(test_strtod("4.9406564584124654e-324", 4.9406564584124654e-324));
+    TEST_EXPR(test_strtod("2.4703282292062328e-324", 4.9406564584124654e-324));
+    TEST_EXPR(test_strtod("2.2250738585072011e-308", 2.2250738585072011e-308));
+    TEST_EXPR(test_strtof("1.4e-45", 1.4e-45f));
+    TEST_EXPR(test_strtof("1e-40", 1e-40f));
+
+    /* Halfway cases and long inputs that need the slow path */
+    TEST_EXPR(test_strtod("9007199254740993.0000000000000000001", 9007199254740994.0));
+    TEST_EXPR(test_strtod("9007199254740992.9999999999999999999", 9007199254740992.0));
+    TEST_EXPR(test_strtod("2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435931802849936536152500319370457678249219365623669863658480757001585769269903706311928279558551332927834338409351978015531246597263579574622766465272827220056374006485499977096599470454020828166226237857393450736339007967761930577506740176324673600968951340535537458516661134223766678604162159680461914467291840300530057530849048765391711386591646239524912623653881879636239373280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186948667994968324049705821028513185451396213837722826145437693412532098591327667236328125e-324", 0.0));
+    TEST_EXPR(test_strtod("2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435931802849936536152500319370457678249219365623669863658480757001585769269903706311928279558551332927834338409351978015531246597263579574622766465272827220056374006485499977096599470454020828166226237857393450736339007967761930577506740176324673600968951340535537458516661134223766678604162159680461914467291840300530057530849048765391711386591646239524912623653881879636239373280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186948667994968324049705821028513185451396213837722826145437693412532098591327667236328125001e-324", 4.9406564584124654e-324));
+    TEST_EXPR(test_strtod("1.00000000000000011102230246251565404236316680908203125", 1.0));
+    TEST_EXPR(test_strtod("1.00000000000000011102230246251565404236316680908203126", 1.0000000000000002));
+    TEST_EXPR(test_strtod("123456789012345678901234567890", 123456789012345678901234567890.0));
+    TEST_EXPR(test_strtod("0.000000000000000000000000000000000000000000001234567890123456789012345", 1.234567890123456789012345e-45));
+    TEST_EXPR(test_strtof("1.00000005960464477539062499", 1.0f));
+    TEST_EXPR(test_strtof("1.000000059604644775390625", 1.0f));
+    TEST_EXPR(test_strtof("1.00000005960464477539062501", 1.00000012f));
+
+    /* Hexadecimal */
+    TEST_EXPR(test_strtod("0x1p0", 1.0));
+    TEST_EXPR(test_strtod("0X1.8P1", 3.0));
+    TEST_EXPR(test_strtod("-0x.8p-1", -0.25));
+    TEST_EXPR(test_strtod("0x1.fffffffffffffp1023", 0x1.fffffffffffffp1023));
+    TEST_EXPR(test_strtod("0x1p-1074", 0x1p-1074));
+    TEST_EXPR(test_strtod("0x1.00000000000008p0", 1.0));
+    TEST_EXPR(test_strtod("0x1.000000000000081p0", 0x1.0000000000001p0));
+    TEST_EXPR(test_strtod("0x123456789abcdef0123p0", 0x123456789abcdef0123p0));
+    TEST_EXPR(test_strtof("0x1.fffffep127", 0x1.fffffep127f));
+    TEST_EXPR(test_strtof("0x1.000001p0", 1.0f));
+
+    /* Infinity and NaN */
+    test_bits64 bits;
+    TEST_EXPR(test_strtod("inf", KD_HUGE_VAL_KHR));
+    TEST_EXPR(test_strtod("-Infinity", -KD_HUGE_VAL_KHR));
+    TEST_EXPR(test_strtof("INF", KD_INFINITY));
+    bits.f = kdStrtodKHR("nan", KD_NULL);
+    TEST_EXPR(kdIsNan(bits.f));
+    bits.f = kdStrtodKHR("-NaN(123)", KD_NULL);
+    TEST_EXPR(kdIsNan(bits.f) && (bits.u >> 63));
+    TEST_EXPR(kdIsNan(kdStrtof("nan", KD_NULL)));
+
+    /* Range errors */
+    kdSetError(0);
+    TEST_EXPR(test_strtod("1e309", KD_HUGE_VAL_KHR));
+    TEST_EQ(kdGetError(), KD_ERANGE);
+    kdSetError(0);
+    TEST_EXPR(test_strtod("-1e-400", -0.0));
+    TEST_EQ(kdGetError(), KD_ERANGE);
+    kdSetError(0);
+    TEST_EXPR(test_strtof("1e39", KD_INFINITY));
+    TEST_EQ(kdGetError(), KD_ERANGE);
+    kdSetError(0);
+    TEST_EXPR(test_strtod("0e999999999", 0.0));
+    TEST_EQ(kdGetError(), 0);
+    /* Short exact inputs take the fast path, it must not report one either */
+    kdSetError(0);
+    TEST_EXPR(test_strtod("3.5", 3.5));
+    TEST_EXPR(test_strtod("1e3", 1000.0));
+    TEST_EQ(kdGetError(), 0);
+    kdSetError(0);
+    TEST_EXPR(test_strtof("3.5", 3.5f));
+    TEST_EXPR(test_strtof("1e3", 1000.0f));
+    TEST_EQ(kdGetError(), 0);
+
+    /* End pointer */
+    KDchar *end = KD_NULL;
+    const KDchar *s = "  12.5e3xyz";
+    TEST_EXPR(kdStrtodKHR(s, &end) > 12499.0);
+    TEST_EXPR(end == s + 8);
+    s = "1.5e+";
+    kdStrtodKHR(s, &end);
+    TEST_EXPR(end == s + 3);
+    s = "0x";
+    kdStrtodKHR(s, &end);
+    TEST_EXPR(end == s + 1);
+    s = "infinit";
+    kdStrtodKHR(s, &end);
+    TEST_EXPR(end == s + 3);
+    s = "nan(abc";
+    kdStrtodKHR(s, &end);
+    TEST_EXPR(end == s + 3);
+    s = " -.e1";
+    kdStrtodKHR(s, &end);
+    TEST_EXPR(end == s);
+    s = "1 2 3";
+    kdStrtof(s, &end);
+    TEST_EXPR(end == s + 1);
+    TEST_EXPR(kdStrtof(end, &end) > 1.5f);
+    TEST_EXPR(end == s + 3);
+    return 0;
+}
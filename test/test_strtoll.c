@@ -0,0 +1,111 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    KDchar *end = KD_NULL;
+    const KDchar *s = KD_NULL;
+
+    /* Eight digit runs, leading zeros and signs */
+    TEST_EQ(kdStrtollVEN("12345678", KD_NULL, 10), 12345678LL);
+    TEST_EQ(kdStrtollVEN("1234567890123456789", KD_NULL, 10), 1234567890123456789LL);
+    TEST_EQ(kdStrtollVEN("  -000000000000000000000042", KD_NULL, 10), -42LL);
+    TEST_EQ(kdStrtollVEN("+9223372036854775807", KD_NULL, 10), KDINT64_MAX);
+    TEST_EQ(kdStrtollVEN("-9223372036854775808", KD_NULL, 10), KDINT64_MIN);
+    TEST_EQ(kdStrtol("-2147483648", KD_NULL, 10), KDINT_MIN);
+    TEST_EQ(kdStrtoul("4294967295", KD_NULL, 10), KDUINT_MAX);
+    TEST_EQ(kdStrtoul("-1", KD_NULL, 10), KDUINT_MAX);
+
+    /* Other bases */
+    TEST_EQ(kdStrtollVEN("0x7fffffffffffffff", KD_NULL, 0), KDINT64_MAX);
+    TEST_EQ(kdStrtollVEN("0777", KD_NULL, 0), 511LL);
+    TEST_EQ(kdStrtollVEN("zz", KD_NULL, 36), 1295LL);
+    TEST_EQ(kdStrtol("-101", KD_NULL, 2), -5);
+    TEST_EQ(kdStrtoul("DeadBeef", KD_NULL, 16), 0xDEADBEEFU);
+
+    /* Range errors saturate */
+    kdSetError(0);
+    TEST_EQ(kdStrtollVEN("9223372036854775808", KD_NULL, 10), KDINT64_MAX);
+    TEST_EQ(kdGetError(), KD_ERANGE);
+    kdSetError(0);
+    TEST_EQ(kdStrtollVEN("-99999999999999999999999", KD_NULL, 10), KDINT64_MIN);
+    TEST_EQ(kdGetError(), KD_ERANGE);
+    kdSetError(0);
+    TEST_EQ(kdStrtol("2147483648", KD_NULL, 10), KDINT_MAX);
+    TEST_EQ(kdGetError(), KD_ERANGE);
+    kdSetError(0);
+    TEST_EQ(kdStrtoul("18446744073709551616", KD_NULL, 10), KDUINT_MAX);
+    TEST_EQ(kdGetError(), KD_ERANGE);
+    kdSetError(0);
+    TEST_EQ(kdStrtollVEN("1", KD_NULL, 37), 0LL);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+
+    /* End pointer */
+    s = "123456789012abc";
+    kdStrtollVEN(s, &end, 10);
+    TEST_EXPR(end == s + 12);
+    s = "0x";
+    TEST_EQ(kdStrtollVEN(s, &end, 16), 0LL);
+    TEST_EXPR(end == s + 1);
+    s = " - 1";
+    kdStrtol(s, &end, 10);
+    TEST_EXPR(end == s);
+    s = "99999999999999999999999 next";
+    kdStrtollVEN(s, &end, 10);
+    TEST_EXPR(end == s + 23);
+
+    /* Formatting */
+    KDchar buffer[KD_LLTOSTR_MAXLEN_VEN];
+    TEST_EQ(kdLltostrVEN(buffer, sizeof(buffer), 0), 1);
+    TEST_STREQ(buffer, "0");
+    TEST_EQ(kdLltostrVEN(buffer, sizeof(buffer), KDINT64_MIN), 20);
+    TEST_STREQ(buffer, "-9223372036854775808");
+    TEST_EQ(kdLltostrVEN(buffer, sizeof(buffer), 1000000000000LL), 13);
+    TEST_STREQ(buffer, "1000000000000");
+    TEST_EQ(kdLtostr(buffer, KD_LTOSTR_MAXLEN, KDINT_MIN), 11);
+    TEST_STREQ(buffer, "-2147483648");
+    TEST_EQ(kdUltostr(buffer, KD_ULTOSTR_MAXLEN, KDUINT_MAX, 8), 11);
+    TEST_STREQ(buffer, "37777777777");
+    TEST_EQ(kdUltostr(buffer, KD_ULTOSTR_MAXLEN, 0xABCU, 16), 3);
+    TEST_STREQ(buffer, "abc");
+    TEST_EQ(kdLtostr(buffer, 3, 123), -1);
+    TEST_EQ(kdLtostr(buffer, 4, 123), 3);
+
+    /* Round-trip */
+    KDint64 v = 1;
+    for(KDint i = 0; i < 64; i++)
+    {
+        KDint64 values[] = {v, -v, v - 1, v + 1};
+        for(KDint j = 0; j < 4; j++)
+        {
+            kdLltostrVEN(buffer, sizeof(buffer), values[j]);
+            TEST_EQ(kdStrtollVEN(buffer, KD_NULL, 10), values[j]);
+        }
+        v = (KDint64)((KDuint64)v * 3);
+    }
+    return 0;
+}
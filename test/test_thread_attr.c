@@ -0,0 +1,98 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define MAX_CPUS 1024
+
+static KDCpuVEN cpus[MAX_CPUS];
+static KDint ran = 0;
+
+static void *thread_func(KD_UNUSED void *arg)
+{
+    ran++;
+    return KD_NULL;
+}
+
+static void run_thread(const KDThreadAttr *attr)
+{
+    KDThread *thread = kdThreadCreate(attr, thread_func, KD_NULL);
+    if(thread == KD_NULL && kdGetError() == KD_ENOSYS)
+    {
+        ran++;
+        return;
+    }
+    TEST_EXPR(thread != KD_NULL);
+    kdThreadJoin(thread, KD_NULL);
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    KDCpuTopologyVEN topology;
+    TEST_EQ(kdGetCpuTopologyVEN(&topology, cpus, MAX_CPUS), 0);
+    TEST_EXPR(topology.processors >= 1);
+    TEST_EXPR(topology.cores >= 1 && topology.cores <= topology.processors);
+    TEST_EXPR(topology.packages >= 1 && topology.packages <= topology.cores);
+    TEST_EXPR(topology.nodes >= 1);
+    TEST_EXPR(topology.cachelinesize >= 0 && topology.l1cachesize >= 0);
+
+    /* One first hardware thread per physical core */
+    KDint first = 0;
+    for(KDint i = 0; i < topology.processors && i < MAX_CPUS; i++)
+    {
+        TEST_EXPR(cpus[i].core >= 0 && cpus[i].core < topology.cores);
+        TEST_EXPR(cpus[i].node >= 0 && cpus[i].smt >= 0);
+        TEST_EXPR(i == 0 || cpus[i].id > cpus[i - 1].id);
+        first += (cpus[i].smt == 0) ? 1 : 0;
+    }
+    TEST_EQ(first, topology.cores);
+    TEST_EQ(kdGetCpuTopologyVEN(&topology, KD_NULL, 0), 0);
+
+    KDThreadAttr *attr = kdThreadAttrCreate();
+    KDuint64 mask[2] = {0, 0};
+    TEST_EQ(kdThreadAttrSetAffinityVEN(attr, mask, 2), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    mask[cpus[0].id / 64] = 1ULL << (cpus[0].id % 64);
+    TEST_EQ(kdThreadAttrSetAffinityVEN(attr, mask, 0), -1);
+    TEST_EQ(kdThreadAttrSetAffinityVEN(attr, mask, 2), 0);
+    TEST_EQ(kdThreadAttrSetSchedulingVEN(attr, KD_THREAD_SCHED_NORMAL_VEN, 20), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    TEST_EQ(kdThreadAttrSetSchedulingVEN(attr, KD_THREAD_SCHED_REALTIME_VEN, 0), -1);
+    TEST_EQ(kdThreadAttrSetSchedulingVEN(attr, 2, 1), -1);
+    TEST_EQ(kdThreadAttrSetSchedulingVEN(attr, KD_THREAD_SCHED_NORMAL_VEN, 5), 0);
+    TEST_EQ(kdThreadAttrSetNumaNodeVEN(attr, -2), -1);
+    TEST_EQ(kdThreadAttrSetNumaNodeVEN(attr, cpus[0].node), 0);
+    run_thread(attr);
+
+    /* Realtime falls back quietly without permission */
+    TEST_EQ(kdThreadAttrSetAffinityVEN(attr, KD_NULL, 0), 0);
+    TEST_EQ(kdThreadAttrSetNumaNodeVEN(attr, -1), 0);
+    TEST_EQ(kdThreadAttrSetSchedulingVEN(attr, KD_THREAD_SCHED_REALTIME_VEN, 10), 0);
+    run_thread(attr);
+    TEST_EQ(ran, 2);
+
+    kdThreadAttrFree(attr);
+    return 0;
+}
@@ -0,0 +1,124 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define THREADS 4
+#define KEYS 4096
+
+static KDchar ids[KEYS];
+static KDThreadStorageKeyKHR keys[KEYS];
+static KDAtomicIntVEN *errors = KD_NULL;
+static KDAtomicIntVEN *destroyed = KD_NULL;
+
+static void KD_APIENTRY destructor(void *value)
+{
+    if(value == &ids[0])
+    {
+        kdAtomicIntFetchAddVEN(destroyed, 1);
+    }
+}
+
+/* Threads race to map the same ids and must agree on the keys. */
+static void *thread_func(void *arg)
+{
+    KDint index = (KDint)(KDuintptr)arg;
+    for(KDint i = index; i < KEYS + index; i++)
+    {
+        KDint id = i % KEYS;
+        if(kdMapThreadStorageKHR(&ids[id]) != keys[id])
+        {
+            kdAtomicIntFetchAddVEN(errors, 1);
+        }
+        if(kdGetThreadStorageKHR(keys[id]) != KD_NULL)
+        {
+            kdAtomicIntFetchAddVEN(errors, 1);
+        }
+        kdSetThreadStorageKHR(keys[id], &ids[(id + index) % KEYS]);
+    }
+    for(KDint i = 0; i < KEYS; i++)
+    {
+        if(kdGetThreadStorageKHR(keys[i]) != &ids[(i + index) % KEYS])
+        {
+            kdAtomicIntFetchAddVEN(errors, 1);
+        }
+    }
+    return KD_NULL;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    errors = kdAtomicIntCreateVEN(0);
+    destroyed = kdAtomicIntCreateVEN(0);
+
+    /* No fixed limit on the number of keys. */
+    for(KDint i = 0; i < KEYS; i++)
+    {
+        keys[i] = kdMapThreadStorageKHR(&ids[i]);
+        TEST_EXPR(keys[i] != 0);
+        TEST_EQ(kdGetThreadStorageKHR(keys[i]), KD_NULL);
+    }
+    for(KDint i = 0; i < KEYS; i++)
+    {
+        TEST_EQ(kdMapThreadStorageKHR(&ids[i]), keys[i]);
+    }
+
+    TEST_EQ(kdSetThreadStorageKHR(keys[KEYS - 1], &ids[1]), 0);
+    TEST_EQ(kdGetThreadStorageKHR(keys[KEYS - 1]), &ids[1]);
+    TEST_EQ(kdSetThreadStorageKHR(0, &ids[1]), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    TEST_EQ(kdGetThreadStorageKHR(0), KD_NULL);
+
+    TEST_EQ(kdSetThreadStorageDestructorVEN(keys[0], destructor), 0);
+    TEST_EQ(kdSetThreadStorageDestructorVEN(0, destructor), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+
+    KDThread *threads[THREADS] = {KD_NULL};
+    for(KDint i = 0; i < THREADS; i++)
+    {
+        threads[i] = kdThreadCreate(KD_NULL, thread_func, (void *)(KDuintptr)i);
+        if(threads[i] == KD_NULL)
+        {
+            if(kdGetError() == KD_ENOSYS)
+            {
+                return 0;
+            }
+            TEST_FAIL();
+        }
+    }
+    for(KDint i = 0; i < THREADS; i++)
+    {
+        kdThreadJoin(threads[i], KD_NULL);
+    }
+    TEST_EQ(kdAtomicIntLoadVEN(errors), 0);
+    /* Only the first thread stored &ids[0] under the key with a destructor. */
+    TEST_EQ(kdAtomicIntLoadVEN(destroyed), 1);
+    /* Values of other threads do not leak into this one. */
+    TEST_EQ(kdGetThreadStorageKHR(keys[0]), KD_NULL);
+
+    kdAtomicIntFreeVEN(destroyed);
+    kdAtomicIntFreeVEN(errors);
+    return 0;
+}
@@ -0,0 +1,150 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define THREAD_COUNT 4
+#define ITERATIONS 20000
+#define ITEMS 5000
+
+static KDThreadMutex *mutex = KD_NULL;
+static KDThreadCond *cond = KD_NULL;
+static KDThreadSem *items = KD_NULL;
+static KDThreadSem *slots = KD_NULL;
+static KDint counter = 0;
+static KDint ready = 0;
+static KDint released = 0;
+static KDint consumed = 0;
+
+/* Plain increments only add up if the mutex excludes. */
+static void *increment_func(KD_UNUSED void *arg)
+{
+    for(KDint i = 0; i < ITERATIONS; i++)
+    {
+        kdThreadMutexLock(mutex);
+        counter++;
+        kdThreadMutexUnlock(mutex);
+    }
+    return KD_NULL;
+}
+
+/* Waits until the main thread broadcasts. */
+static void *broadcast_func(KD_UNUSED void *arg)
+{
+    kdThreadMutexLock(mutex);
+    ready++;
+    /* Siblings wait on the same condition, a signal could wake one of them instead of the main thread. */
+    kdThreadCondBroadcast(cond);
+    while(!released)
+    {
+        kdThreadCondWait(cond, mutex);
+    }
+    ready--;
+    kdThreadMutexUnlock(mutex);
+    return KD_NULL;
+}
+
+/* Bounded buffer with two semaphores. */
+static void *consumer_func(KD_UNUSED void *arg)
+{
+    for(KDint i = 0; i < ITEMS; i++)
+    {
+        kdThreadSemWait(items);
+        kdThreadMutexLock(mutex);
+        consumed++;
+        kdThreadMutexUnlock(mutex);
+        kdThreadSemPost(slots);
+    }
+    return KD_NULL;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    mutex = kdThreadMutexCreate(KD_NULL);
+    TEST_EXPR(mutex != KD_NULL);
+    cond = kdThreadCondCreate(KD_NULL);
+    if(cond == KD_NULL && kdGetError() == KD_ENOSYS)
+    {
+        kdThreadMutexFree(mutex);
+        return 0;
+    }
+    TEST_EXPR(cond != KD_NULL);
+
+    KDThread *threads[THREAD_COUNT] = {KD_NULL};
+    for(KDint i = 0; i < THREAD_COUNT; i++)
+    {
+        threads[i] = kdThreadCreate(KD_NULL, increment_func, KD_NULL);
+        TEST_EXPR(threads[i] != KD_NULL);
+    }
+    for(KDint i = 0; i < THREAD_COUNT; i++)
+    {
+        kdThreadJoin(threads[i], KD_NULL);
+    }
+    TEST_EQ(counter, THREAD_COUNT * ITERATIONS);
+
+    for(KDint i = 0; i < THREAD_COUNT; i++)
+    {
+        threads[i] = kdThreadCreate(KD_NULL, broadcast_func, KD_NULL);
+        TEST_EXPR(threads[i] != KD_NULL);
+    }
+    kdThreadMutexLock(mutex);
+    while(ready < THREAD_COUNT)
+    {
+        kdThreadCondWait(cond, mutex);
+    }
+    released = 1;
+    kdThreadCondBroadcast(cond);
+    kdThreadMutexUnlock(mutex);
+    for(KDint i = 0; i < THREAD_COUNT; i++)
+    {
+        kdThreadJoin(threads[i], KD_NULL);
+    }
+    TEST_EQ(ready, 0);
+
+    items = kdThreadSemCreate(0);
+    slots = kdThreadSemCreate(8);
+    TEST_EXPR(items != KD_NULL && slots != KD_NULL);
+    for(KDint i = 0; i < THREAD_COUNT; i++)
+    {
+        threads[i] = kdThreadCreate(KD_NULL, consumer_func, KD_NULL);
+        TEST_EXPR(threads[i] != KD_NULL);
+    }
+    for(KDint i = 0; i < THREAD_COUNT * ITEMS; i++)
+    {
+        kdThreadSemWait(slots);
+        kdThreadSemPost(items);
+    }
+    for(KDint i = 0; i < THREAD_COUNT; i++)
+    {
+        kdThreadJoin(threads[i], KD_NULL);
+    }
+    TEST_EQ(consumed, THREAD_COUNT * ITEMS);
+
+    kdThreadSemFree(slots);
+    kdThreadSemFree(items);
+    kdThreadCondFree(cond);
+    kdThreadMutexFree(mutex);
+    return 0;
+}
@@ -0,0 +1,138 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include "test.h"
+
+#define TIMEOUT 20000000LL
+#define DELAY 5000000LL
+#define PATIENCE 5000000000LL
+
+static KDThreadMutex *mutex = KD_NULL;
+static KDThreadCond *cond = KD_NULL;
+static KDThreadSem *sem = KD_NULL;
+static KDboolean signalled = KD_FALSE;
+static KDboolean busy = KD_FALSE;
+
+static void *trylock_func(KD_UNUSED void *arg)
+{
+    KDint result = kdThreadMutexTryLockVEN(mutex);
+    if(result == 0)
+    {
+        kdThreadMutexUnlock(mutex);
+    }
+    busy = (result == -1 && kdGetError() == KD_EBUSY);
+    return KD_NULL;
+}
+
+static void *post_func(KD_UNUSED void *arg)
+{
+    kdThreadSleepVEN(DELAY);
+    kdThreadSemPost(sem);
+    return KD_NULL;
+}
+
+static void *signal_func(KD_UNUSED void *arg)
+{
+    kdThreadSleepVEN(DELAY);
+    kdThreadMutexLock(mutex);
+    signalled = KD_TRUE;
+    kdThreadCondSignal(cond);
+    kdThreadMutexUnlock(mutex);
+    return KD_NULL;
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    mutex = kdThreadMutexCreate(KD_NULL);
+    cond = kdThreadCondCreate(KD_NULL);
+    if(cond == KD_NULL && kdGetError() == KD_ENOSYS)
+    {
+        kdThreadMutexFree(mutex);
+        return 0;
+    }
+    sem = kdThreadSemCreate(0);
+    TEST_EXPR(mutex != KD_NULL && cond != KD_NULL && sem != KD_NULL);
+
+    /* Try-lock */
+    TEST_EQ(kdThreadMutexTryLockVEN(mutex), 0);
+    KDThread *thread = kdThreadCreate(KD_NULL, trylock_func, KD_NULL);
+    TEST_EXPR(thread != KD_NULL);
+    kdThreadJoin(thread, KD_NULL);
+    TEST_EXPR(busy);
+    kdThreadMutexUnlock(mutex);
+    thread = kdThreadCreate(KD_NULL, trylock_func, KD_NULL);
+    kdThreadJoin(thread, KD_NULL);
+    TEST_EXPR(!busy);
+
+    /* Try-wait */
+    TEST_EQ(kdThreadSemTryWaitVEN(sem), -1);
+    TEST_EQ(kdGetError(), KD_EBUSY);
+    kdThreadSemPost(sem);
+    TEST_EQ(kdThreadSemTryWaitVEN(sem), 0);
+    TEST_EQ(kdThreadSemTryWaitVEN(sem), -1);
+
+    /* Timed semaphore waits */
+    KDust start = kdGetTimeUST();
+    TEST_EQ(kdThreadSemTimedWaitVEN(sem, start + TIMEOUT), -1);
+    TEST_EQ(kdGetError(), KD_ETIMEDOUT);
+    TEST_EXPR(kdGetTimeUST() - start >= TIMEOUT);
+    TEST_EQ(kdThreadSemTimedWaitVEN(sem, 0), -1);
+    kdThreadSemPost(sem);
+    TEST_EQ(kdThreadSemTimedWaitVEN(sem, 0), 0);
+
+    thread = kdThreadCreate(KD_NULL, post_func, KD_NULL);
+    start = kdGetTimeUST();
+    TEST_EQ(kdThreadSemTimedWaitVEN(sem, start + PATIENCE), 0);
+    TEST_EXPR(kdGetTimeUST() - start < PATIENCE);
+    kdThreadJoin(thread, KD_NULL);
+
+    /* Timed condition waits, the mutex is held again in both cases */
+    kdThreadMutexLock(mutex);
+    start = kdGetTimeUST();
+    KDint result = 0;
+    while(result == 0)
+    {
+        result = kdThreadCondTimedWaitVEN(cond, mutex, start + TIMEOUT);
+    }
+    TEST_EQ(kdGetError(), KD_ETIMEDOUT);
+    TEST_EXPR(kdGetTimeUST() - start >= TIMEOUT);
+    thread = kdThreadCreate(KD_NULL, trylock_func, KD_NULL);
+    kdThreadJoin(thread, KD_NULL);
+    TEST_EXPR(busy);
+
+    thread = kdThreadCreate(KD_NULL, signal_func, KD_NULL);
+    start = kdGetTimeUST();
+    while(!signalled)
+    {
+        TEST_EQ(kdThreadCondTimedWaitVEN(cond, mutex, start + PATIENCE), 0);
+    }
+    kdThreadMutexUnlock(mutex);
+    kdThreadJoin(thread, KD_NULL);
+
+    kdThreadSemFree(sem);
+    kdThreadCondFree(cond);
+    kdThreadMutexFree(mutex);
+    return 0;
+}
@@ -0,0 +1,191 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/VEN_vecmath.h>
+#include "test.h"
+
+#define TEST_NEAR(a, b) TEST_EXPR(kdFabsf((a) - (b)) < 1e-4f)
+
+static void test_mat4_near(const KDMat4VEN *a, const KDMat4VEN *b)
+{
+    for(KDint i = 0; i < 16; i++)
+    {
+        TEST_NEAR(a->m[i], b->m[i]);
+    }
+}
+
+/* Reference column-major multiply. */
+static void test_mat4_multiply(KDMat4VEN *out, const KDMat4VEN *a, const KDMat4VEN *b)
+{
+    for(KDint col = 0; col < 4; col++)
+    {
+        for(KDint row = 0; row < 4; row++)
+        {
+            KDfloat32 sum = 0.0f;
+            for(KDint k = 0; k < 4; k++)
+            {
+                sum += a->m[k * 4 + row] * b->m[col * 4 + k];
+            }
+            out->m[col * 4 + row] = sum;
+        }
+    }
+}
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    TEST_EQ(sizeof(KDVec3VEN), 16);
+    TEST_EQ(sizeof(KDVec4VEN), 16);
+    TEST_EQ(sizeof(KDMat4VEN), 64);
+
+    /* vectors */
+    KDVec3VEN a, b, c;
+    kdVec3SetVEN(&a, 1.0f, 0.0f, 0.0f);
+    kdVec3SetVEN(&b, 0.0f, 1.0f, 0.0f);
+    kdVec3CrossVEN(&c, &a, &b);
+    TEST_NEAR(c.z, 1.0f);
+    TEST_NEAR(kdVec3DotVEN(&a, &b), 0.0f);
+    kdVec3SetVEN(&a, 3.0f, 4.0f, 0.0f);
+    TEST_NEAR(kdVec3LengthVEN(&a), 5.0f);
+    kdVec3NormalizeVEN(&a, &a);
+    TEST_NEAR(kdVec3LengthVEN(&a), 1.0f);
+
+    /* multiply, including aliasing */
+    KDMat4VEN m, n, r, ref, id;
+    for(KDint i = 0; i < 16; i++)
+    {
+        m.m[i] = (KDfloat32)(i + 1) * 0.5f;
+        n.m[i] = (KDfloat32)(16 - i) * 0.25f;
+    }
+    test_mat4_multiply(&ref, &m, &n);
+    kdMat4MultiplyVEN(&r, &m, &n);
+    test_mat4_near(&r, &ref);
+    r = m;
+    kdMat4MultiplyVEN(&r, &r, &n);
+    test_mat4_near(&r, &ref);
+
+    /* transpose */
+    kdMat4TransposeVEN(&r, &m);
+    for(KDint col = 0; col < 4; col++)
+    {
+        for(KDint row = 0; row < 4; row++)
+        {
+            TEST_NEAR(r.m[row * 4 + col], m.m[col * 4 + row]);
+        }
+    }
+
+    /* inverse */
+    kdMat4IdentityVEN(&id);
+    kdMat4PerspectiveVEN(&m, KD_PI_F / 3.0f, 1.5f, 0.5f, 100.0f);
+    kdMat4RotateVEN(&m, 0.7f, 1.0f, 2.0f, 3.0f);
+    kdMat4TranslateVEN(&m, 1.0f, -2.0f, 3.0f);
+    TEST_EQ(kdMat4InverseVEN(&n, &m), 0);
+    kdMat4MultiplyVEN(&r, &m, &n);
+    test_mat4_near(&r, &id);
+    kdMemset(&m, 0, sizeof(m));
+    TEST_EQ(kdMat4InverseVEN(&n, &m), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+
+    /* in-place builders match explicit products */
+    kdMat4RotationVEN(&m, 0.3f, 0.0f, 0.0f, 1.0f);
+    kdMat4TranslationVEN(&n, 4.0f, 5.0f, 6.0f);
+    test_mat4_multiply(&ref, &m, &n);
+    kdMat4TranslateVEN(&m, 4.0f, 5.0f, 6.0f);
+    test_mat4_near(&m, &ref);
+    kdMat4ScalingVEN(&n, 2.0f, 3.0f, 4.0f);
+    test_mat4_multiply(&ref, &m, &n);
+    kdMat4ScaleVEN(&m, 2.0f, 3.0f, 4.0f);
+    test_mat4_near(&m, &ref);
+
+    /* transforms */
+    KDVec3VEN pts[5];
+    KDVec3VEN out[5];
+    kdMat4TranslationVEN(&m, 1.0f, 2.0f, 3.0f);
+    kdMat4RotateVEN(&m, KD_PI_2_F, 0.0f, 0.0f, 1.0f);
+    for(KDint i = 0; i < 5; i++)
+    {
+        kdVec3SetVEN(&pts[i], (KDfloat32)i, 0.0f, 0.0f);
+    }
+    kdMat4TransformPointsVEN(out, &m, pts, 5);
+    for(KDint i = 0; i < 5; i++)
+    {
+        TEST_NEAR(out[i].x, 1.0f);
+        TEST_NEAR(out[i].y, 2.0f + (KDfloat32)i);
+        TEST_NEAR(out[i].z, 3.0f);
+    }
+    kdMat4TransformNormalsVEN(out, &m, pts, 5);
+    TEST_NEAR(out[4].x, 0.0f);
+    TEST_NEAR(out[4].y, 4.0f);
+
+    KDVec4VEN v;
+    kdVec4SetVEN(&v, 1.0f, 0.0f, 0.0f, 1.0f);
+    kdMat4TransformVec4VEN(&v, &m, &v);
+    TEST_NEAR(v.x, 1.0f);
+    TEST_NEAR(v.y, 3.0f);
+    TEST_NEAR(v.w, 1.0f);
+
+    /* look-at maps eye to origin and center onto -z */
+    KDVec3VEN eye, center, up;
+    kdVec3SetVEN(&eye, 0.0f, 0.0f, 5.0f);
+    kdVec3SetVEN(&center, 0.0f, 0.0f, 0.0f);
+    kdVec3SetVEN(&up, 0.0f, 1.0f, 0.0f);
+    kdMat4LookAtVEN(&m, &eye, &center, &up);
+    kdMat4TransformPointsVEN(out, &m, &center, 1);
+    TEST_NEAR(out[0].x, 0.0f);
+    TEST_NEAR(out[0].z, -5.0f);
+
+    /* perspective maps near/far planes to -1/1 */
+    kdMat4PerspectiveVEN(&m, KD_PI_2_F, 1.0f, 1.0f, 10.0f);
+    kdVec4SetVEN(&v, 0.0f, 0.0f, -1.0f, 1.0f);
+    kdMat4TransformVec4VEN(&v, &m, &v);
+    TEST_NEAR(v.z / v.w, -1.0f);
+    kdVec4SetVEN(&v, 0.0f, 0.0f, -10.0f, 1.0f);
+    kdMat4TransformVec4VEN(&v, &m, &v);
+    TEST_NEAR(v.z / v.w, 1.0f);
+
+    /* quaternions agree with matrices */
+    KDQuatVEN q, p, s;
+    kdVec3SetVEN(&a, 1.0f, 1.0f, 0.0f);
+    kdQuatFromAxisAngleVEN(&q, &a, 1.1f);
+    kdMat4FromQuatVEN(&m, &q);
+    kdMat4RotationVEN(&n, 1.1f, 1.0f, 1.0f, 0.0f);
+    test_mat4_near(&m, &n);
+    kdVec3SetVEN(&b, 0.2f, -0.4f, 0.9f);
+    kdQuatRotateVec3VEN(&c, &q, &b);
+    kdMat4TransformNormalsVEN(out, &m, &b, 1);
+    TEST_NEAR(c.x, out[0].x);
+    TEST_NEAR(c.y, out[0].y);
+    TEST_NEAR(c.z, out[0].z);
+
+    kdQuatIdentityVEN(&p);
+    kdQuatSlerpVEN(&s, &p, &q, 0.0f);
+    TEST_NEAR(s.w, 1.0f);
+    kdQuatSlerpVEN(&s, &p, &q, 1.0f);
+    TEST_NEAR(s.w, q.w);
+    kdQuatMultiplyVEN(&s, &q, &q);
+    kdQuatFromAxisAngleVEN(&p, &a, 2.2f);
+    TEST_NEAR(s.x, p.x);
+    TEST_NEAR(s.w, p.w);
+
+    return 0;
+}
@@ -0,0 +1,201 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+#include <KD/ATX_keyboard.h>
+#include <KD/NV_extwindowprops.h>
+#include "test.h"
+
+#if defined(KD_WINDOW_X11) || defined(KD_WINDOW_WAYLAND)
+#include <xkbcommon/xkbcommon-keysyms.h>
+#elif defined(KD_WINDOW_WIN32)
+#include <windows.h>
+#elif defined(KD_WINDOW_ANDROID)
+#include <android/keycodes.h>
+#endif
+
+#define MILLISECOND 1000000LL
+
+#if defined(KD_WINDOW_SUPPORTED)
+static KDint tag = 0;
+
+static void *injector(void *arg)
+{
+    kdThreadSleepVEN(20 * MILLISECOND);
+    TEST_EQ(kdInjectInputKeyCharVEN((KDWindow *)arg, 'x', 0, 0), 0);
+    return KD_NULL;
+}
+
+static const KDEvent *next_event(void)
+{
+    const KDEvent *event = kdWaitEvent(5000 * MILLISECOND);
+    TEST_EXPR(event != KD_NULL);
+    /* Dpad and game keys events carry no window, as with other backends */
+    TEST_EXPR(event->userptr == &tag || event->type == KD_EVENT_INPUT);
+    return event;
+}
+#endif
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+#if defined(KD_WINDOW_SUPPORTED)
+    KDWindow *window = kdCreateWindow(KD_NULL, KD_NULL, &tag);
+    TEST_EXPR(window != KD_NULL);
+    /* No backend has a native key 0, out of range keys are not translated */
+    TEST_EQ(kdTranslateKeycodeVEN(0), 0);
+    TEST_EQ(kdTranslateKeycodeVEN(-1), 0);
+    TEST_EQ(kdTranslateKeycodeVEN(KDINT_MAX), 0);
+#if defined(KD_WINDOW_X11) || defined(KD_WINDOW_WAYLAND)
+    TEST_EQ(kdTranslateKeycodeVEN(XKB_KEY_Home), KD_KEY_HOME_ATX);
+    TEST_EQ(kdTranslateKeycodeVEN(XKB_KEY_ISO_Enter), KD_KEY_ENTER_ATX);
+    TEST_EQ(kdTranslateKeycodeVEN(XKB_KEY_XF86AudioPlay), KD_KEY_MEDIAPLAYPAUSE_ATX);
+    /* Printable keysyms arrive as characters, other pages have no keys */
+    TEST_EQ(kdTranslateKeycodeVEN(XKB_KEY_a), 0);
+    TEST_EQ(kdTranslateKeycodeVEN(XKB_KEY_Home + 0x10000), 0);
+#elif defined(KD_WINDOW_WIN32)
+    TEST_EQ(kdTranslateKeycodeVEN(VK_HOME), KD_KEY_HOME_ATX);
+    TEST_EQ(kdTranslateKeycodeVEN(VK_F1), KD_KEY_F1_ATX);
+    TEST_EQ(kdTranslateKeycodeVEN(0x100), 0);
+#elif defined(KD_WINDOW_ANDROID)
+    TEST_EQ(kdTranslateKeycodeVEN(AKEYCODE_DPAD_UP), KD_KEY_UP_ATX);
+    TEST_EQ(kdTranslateKeycodeVEN(AKEYCODE_MEDIA_PLAY), KD_KEY_PLAY_ATX);
+    TEST_EQ(kdTranslateKeycodeVEN(0x10000), 0);
+#elif defined(KD_WINDOW_EMSCRIPTEN)
+    TEST_EQ(kdTranslateKeycodeVEN(36), KD_KEY_HOME_ATX);
+    TEST_EQ(kdTranslateKeycodeVEN(0x10000), 0);
+#else
+    /* Headless builds have no native keys */
+    TEST_EQ(kdTranslateKeycodeVEN(0xff50), 0);
+#endif
+    if(kdInjectInputPointerVEN(window, KD_INPUT_POINTER_X, 0, 0, 0, 0) == -1)
+    {
+        /* A real window, input comes from the display server */
+        TEST_EXPR(kdGetError() == KD_EINVAL || kdGetError() == KD_ENOSYS);
+        TEST_EQ(kdDestroyWindow(window), 0);
+        return 0;
+    }
+    while(kdWaitEvent(-1))
+    {
+    }
+
+    /* Properties are kept in memory */
+    KDint32 size[2] = {320, 240};
+    TEST_EQ(kdSetWindowPropertyiv(window, KD_WINDOWPROPERTY_SIZE, size), 0);
+    TEST_EQ(kdSetWindowPropertycv(window, KD_WINDOWPROPERTY_CAPTION, "headless"), 0);
+    KDboolean fullscreen = 1;
+    TEST_EQ(kdSetWindowPropertybv(window, KD_WINDOWPROPERTY_FULLSCREEN_NV, &fullscreen), 0);
+    TEST_EQ(kdRealizeWindow(window, KD_NULL), 0);
+    KDint32 got[2] = {0, 0};
+    TEST_EQ(kdGetWindowPropertyiv(window, KD_WINDOWPROPERTY_SIZE, got), 0);
+    TEST_EQ(got[0], 320);
+    TEST_EQ(got[1], 240);
+    KDchar caption[256] = {0};
+    KDsize length = sizeof(caption);
+    TEST_EQ(kdGetWindowPropertycv(window, KD_WINDOWPROPERTY_CAPTION, caption, &length), 0);
+    TEST_EQ(length, 8);
+    TEST_STREQ(caption, "headless");
+    KDboolean flag = 0;
+    TEST_EQ(kdGetWindowPropertybv(window, KD_WINDOWPROPERTY_FULLSCREEN_NV, &flag), 0);
+    TEST_EQ(flag, 1);
+    TEST_EQ(kdGetWindowPropertybv(window, KD_WINDOWPROPERTY_FOCUS, &flag), 0);
+    TEST_EQ(flag, 1);
+    TEST_EQ(kdGetWindowPropertyiv(window, KD_WINDOWPROPERTY_CAPTION, got), -1);
+    TEST_EQ(kdGetError(), KD_EINVAL);
+    while(kdWaitEvent(-1))
+    {
+    }
+
+    /* Injected input arrives in order and updates the state */
+    KDust now = kdGetTimeUST();
+    TEST_EQ(kdInjectInputPointerVEN(window, KD_INPUT_POINTER_X, 0, 10, 20, now), 0);
+    TEST_EQ(kdInjectInputKeyVEN(window, KD_KEY_UP_ATX, KD_KEY_PRESS_ATX, now), 0);
+    TEST_EQ(kdInjectInputKeyCharVEN(window, 'a', 0, now), 0);
+    const KDEvent *event = next_event();
+    TEST_EQ(event->type, KD_EVENT_INPUT_POINTER);
+    TEST_EQ(event->data.inputpointer.x, 10);
+    TEST_EQ(event->data.inputpointer.y, 20);
+    event = next_event();
+    TEST_EQ(event->type, KD_EVENT_INPUT);
+    TEST_EQ(event->data.input.index, KD_INPUT_DPAD_UP);
+    event = next_event();
+    TEST_EQ(event->type, KD_EVENT_INPUT);
+    TEST_EQ(event->data.input.index, KD_INPUT_GAMEKEYS_UP);
+    event = next_event();
+    TEST_EQ(event->type, KD_EVENT_INPUT_KEY_ATX);
+    TEST_EQ(((const KDEventInputKeyATX *)&event->data)->keycode, KD_KEY_UP_ATX);
+    event = next_event();
+    TEST_EQ(event->type, KD_EVENT_INPUT_KEYCHAR_ATX);
+    TEST_EQ(((const KDEventInputKeyCharATX *)&event->data)->character, 'a');
+    KDint32 state[3] = {0, 0, 0};
+    kdStateGeti(KD_INPUT_POINTER_X, 2, state);
+    TEST_EQ(state[0], 10);
+    TEST_EQ(state[1], 20);
+    kdStateGeti(KD_INPUT_DPAD_UP, 1, state);
+    TEST_EXPR(state[0] != 0);
+    kdStateGeti(KD_INPUT_KEYBOARD_CHAR_ATX, 1, state);
+    TEST_EQ(state[0], 'a');
+
+    /* Input for later is held back, a blocked wait wakes for it */
+    now = kdGetTimeUST();
+    TEST_EQ(kdInjectInputPointerVEN(window, KD_INPUT_POINTER_SELECT, 1, 30, 40, now + 30 * MILLISECOND), 0);
+    TEST_EQ(kdWaitEvent(-1), KD_NULL);
+    event = next_event();
+    TEST_EQ(event->type, KD_EVENT_INPUT_POINTER);
+    TEST_EQ(event->data.inputpointer.select, 1);
+    TEST_EXPR(kdGetTimeUST() >= now + 30 * MILLISECOND);
+    TEST_EXPR(kdGetTimeUST() - now < 2000 * MILLISECOND);
+
+    /* A flood of motion goes through coalescing like display server input */
+    TEST_EQ(kdSetEventCoalescingVEN(KD_EVENT_INPUT_POINTER, 1), 0);
+    now = kdGetTimeUST();
+    for(KDint32 i = 0; i < 1000; i++)
+    {
+        TEST_EQ(kdInjectInputPointerVEN(window, KD_INPUT_POINTER_X, 0, i, -i, now), 0);
+    }
+    event = next_event();
+    TEST_EQ(event->type, KD_EVENT_INPUT_POINTER);
+    TEST_EQ(event->data.inputpointer.x, 999);
+    TEST_EQ(kdWaitEvent(-1), KD_NULL);
+    TEST_EQ(kdSetEventCoalescingVEN(KD_EVENT_INPUT_POINTER, 0), 0);
+
+    /* Any thread may inject */
+    KDThread *thread = kdThreadCreate(KD_NULL, injector, window);
+    if(thread == KD_NULL)
+    {
+        TEST_EQ(kdGetError(), KD_ENOSYS);
+    }
+    else
+    {
+        event = next_event();
+        TEST_EQ(event->type, KD_EVENT_INPUT_KEYCHAR_ATX);
+        TEST_EQ(((const KDEventInputKeyCharATX *)&event->data)->character, 'x');
+        TEST_EQ(kdThreadJoin(thread, KD_NULL), 0);
+    }
+
+    /* Pending input goes away with the window */
+    TEST_EQ(kdInjectInputKeyCharVEN(window, 'z', 0, kdGetTimeUST() + 60000 * MILLISECOND), 0);
+    TEST_EQ(kdDestroyWindow(window), 0);
+#endif
+    return 0;
+}
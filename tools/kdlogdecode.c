@@ -0,0 +1,48 @@
+/******************************************************************************
+ * libKD
+ * zlib/libpng License
+ ******************************************************************************
+ * Copyright (c) 2014-2019 Kevin Schmidt
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ ******************************************************************************/
+
+/******************************************************************************
+ * kdlogdecode
+ *
+ * Formats a binary log written with kdLogSetModeVEN(KD_LOG_BINARY_VEN).
+ *
+ * Usage: kdlogdecode input [output]
+ ******************************************************************************/
+
+#include <KD/kd.h>
+#include <KD/kdext.h>
+
+KDint KD_APIENTRY kdMain(KDint argc, const KDchar *const *argv)
+{
+    if(argc < 2 || argc > 3)
+    {
+        kdLogDeferredVEN("Usage: kdlogdecode input [output]\n");
+        return 1;
+    }
+    if(kdLogDecodeVEN(argv[1], (argc == 3) ? argv[2] : KD_NULL) == -1)
+    {
+        kdLogDeferredVEN("kdlogdecode: Could not decode %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}